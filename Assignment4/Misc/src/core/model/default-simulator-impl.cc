@@ -19,11 +19,14 @@
 
 #include "default-simulator-impl.h"
 
+#include "abort.h"
 #include "assert.h"
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "uinteger.h"
 
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -42,13 +45,24 @@ NS_LOG_COMPONENT_DEFINE("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED(DefaultSimulatorImpl);
 
+/** Default number of slots of the events with context ring. */
+constexpr uint32_t EVENTS_WITH_CONTEXT_CAPACITY = 4096;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId()
 {
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("EventsWithContextCapacity",
+                                          "The number of slots of the lock-free ring used by "
+                                          "other threads to schedule events with a context. "
+                                          "Events which find it full go to a locked list.",
+                                          UintegerValue(EVENTS_WITH_CONTEXT_CAPACITY),
+                                          MakeUintegerAccessor(
+                                              &DefaultSimulatorImpl::SetEventsWithContextCapacity),
+                                          MakeUintegerChecker<uint32_t>(1));
     return tid;
 }
 
@@ -56,13 +70,17 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
 {
     NS_LOG_FUNCTION(this);
     m_stop = false;
+    m_started = false;
     m_uid = EventId::UID::VALID;
     m_currentUid = EventId::UID::INVALID;
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
     m_eventCount = 0;
+    m_eventsWithContextRing = std::make_unique<EventsWithContextRing>(EVENTS_WITH_CONTEXT_CAPACITY);
     m_eventsWithContextEmpty = true;
+    m_eventsWithContextMaxDepth = 0;
+    m_eventsWithContextOverflows = 0;
     m_mainThreadId = std::this_thread::get_id();
 }
 
@@ -156,39 +174,75 @@ DefaultSimulatorImpl::IsFinished() const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext()
 {
-    if (m_eventsWithContextEmpty)
+    if (m_eventsWithContextEmpty.load(std::memory_order_acquire))
     {
+        if (m_eventsWithContextRing->IsEmpty())
+        {
+            return;
+        }
+        m_eventsWithContextMaxDepth =
+            std::max(m_eventsWithContextMaxDepth, m_eventsWithContextRing->GetSize());
+        EventWithContext event;
+        while (m_eventsWithContextRing->TryPop(event))
+        {
+            InsertEventWithContext(event);
+        }
         return;
     }
 
     // swap queues
     EventsWithContext eventsWithContext;
+    uint64_t ringEnd;
     {
         std::unique_lock lock{m_eventsWithContextMutex};
         m_eventsWithContext.swap(eventsWithContext);
-        m_eventsWithContextEmpty = true;
+        ringEnd = m_eventsWithContextRing->GetPushPosition();
+        m_eventsWithContextEmpty.store(true, std::memory_order_release);
     }
-    while (!eventsWithContext.empty())
+    m_eventsWithContextMaxDepth =
+        std::max(m_eventsWithContextMaxDepth, m_eventsWithContextRing->GetSize());
+    // A thread only diverts events to the list after its previous events
+    // claimed a ring slot, and goes back to the ring only once the list has
+    // been swapped: drain the slots claimed before the swap first, waiting
+    // for producers which have claimed a slot but not filled it yet.
+    EventWithContext event;
+    while (m_eventsWithContextRing->GetPopPosition() < ringEnd)
     {
-        EventWithContext event = eventsWithContext.front();
-        eventsWithContext.pop_front();
-        Scheduler::Event ev;
-        ev.impl = event.event;
-        ev.key.m_ts = m_currentTs + event.timestamp;
-        ev.key.m_context = event.context;
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        if (m_eventsWithContextRing->TryPop(event))
+        {
+            InsertEventWithContext(event);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    for (const auto& overflow : eventsWithContext)
+    {
+        InsertEventWithContext(overflow);
     }
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext(const EventWithContext& event)
+{
+    Scheduler::Event ev;
+    ev.impl = event.event;
+    ev.key.m_ts = m_currentTs + event.timestamp;
+    ev.key.m_context = event.context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_unscheduledEvents++;
+    m_events->Insert(ev);
+}
+
 void
 DefaultSimulatorImpl::Run()
 {
     NS_LOG_FUNCTION(this);
     // Set the current threadId as the main threadId
     m_mainThreadId = std::this_thread::get_id();
+    m_started = true;
     ProcessEventsWithContext();
     m_stop = false;
 
@@ -264,11 +318,19 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         // Current time added in ProcessEventsWithContext()
         ev.timestamp = delay.GetTimeStep();
         ev.event = event;
+        // Once an event has been diverted to the overflow list, keep using
+        // the list until the main thread drains it, to preserve ordering.
+        if (m_eventsWithContextEmpty.load(std::memory_order_acquire) &&
+            m_eventsWithContextRing->TryPush(ev))
+        {
+            return;
+        }
         {
             std::unique_lock lock{m_eventsWithContextMutex};
             m_eventsWithContext.push_back(ev);
-            m_eventsWithContextEmpty = false;
+            m_eventsWithContextEmpty.store(false, std::memory_order_release);
         }
+        m_eventsWithContextOverflows.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
@@ -397,4 +459,38 @@ DefaultSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+void
+DefaultSimulatorImpl::SetEventsWithContextCapacity(uint32_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    NS_ASSERT_MSG(m_mainThreadId == std::this_thread::get_id(),
+                  "DefaultSimulatorImpl::SetEventsWithContextCapacity Thread-unsafe invocation!");
+    NS_ABORT_MSG_IF(m_started,
+                    "Cannot resize the events with context ring once the simulation has run");
+    if (capacity == m_eventsWithContextRing->GetCapacity())
+    {
+        return;
+    }
+    // Move whatever is pending so that no event is lost
+    if (m_events)
+    {
+        ProcessEventsWithContext();
+    }
+    NS_ASSERT_MSG(m_eventsWithContextRing->IsEmpty(),
+                  "Cannot resize the events with context ring while it is in use");
+    m_eventsWithContextRing = std::make_unique<EventsWithContextRing>(capacity);
+}
+
+uint32_t
+DefaultSimulatorImpl::GetEventsWithContextMaxDepth() const
+{
+    return m_eventsWithContextMaxDepth;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetEventsWithContextOverflows() const
+{
+    return m_eventsWithContextOverflows.load(std::memory_order_relaxed);
+}
+
 } // namespace ns3
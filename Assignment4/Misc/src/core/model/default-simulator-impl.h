@@ -20,9 +20,12 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "mpsc-queue.h"
 #include "simulator-impl.h"
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -78,6 +81,29 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * Set the number of slots of the lock-free ring used by other threads
+     * to inject events with Simulator::ScheduleWithContext().
+     *
+     * The ring can only be resized before Run(), since other threads may be
+     * injecting events into it afterwards.
+     *
+     * \param [in] capacity The number of slots, rounded up to a power of two.
+     */
+    void SetEventsWithContextCapacity(uint32_t capacity);
+
+    /**
+     * \return The largest number of events found waiting in the injection
+     *         ring when the main thread drained it.
+     */
+    uint32_t GetEventsWithContextMaxDepth() const;
+
+    /**
+     * \return The number of events which found the injection ring full
+     *         and were diverted to the mutex-protected overflow list.
+     */
+    uint64_t GetEventsWithContextOverflows() const;
+
   private:
     void DoDispose() override;
 
@@ -97,17 +123,38 @@ class DefaultSimulatorImpl : public SimulatorImpl
         EventImpl* event;
     };
 
+    /**
+     * Insert an event received from a different thread in the main event queue.
+     * \param [in] event The event and its context.
+     */
+    void InsertEventWithContext(const EventWithContext& event);
+
+    /** Ring type for the events from a different context. */
+    typedef MpscQueue<EventWithContext> EventsWithContextRing;
+    /**
+     * The lock-free ring through which other threads inject events.
+     * Only the main thread pops from it.
+     */
+    std::unique_ptr<EventsWithContextRing> m_eventsWithContextRing;
     /** Container type for the events from a different context. */
     typedef std::list<EventWithContext> EventsWithContext;
-    /** The container of events from a different context. */
+    /**
+     * The overflow list of events from a different context, used when
+     * the ring is full.
+     */
     EventsWithContext m_eventsWithContext;
     /**
-     * Flag \c true if all events with context have been moved to the
-     * primary event queue.
+     * Flag \c true if the overflow list is empty.  While it is \c false
+     * producers append to the list rather than to the ring, so that the
+     * events of each thread keep their order.
      */
-    bool m_eventsWithContextEmpty;
-    /** Mutex to control access to the list of events with context. */
+    std::atomic<bool> m_eventsWithContextEmpty;
+    /** Mutex to control access to the overflow list of events with context. */
     std::mutex m_eventsWithContextMutex;
+    /** Largest ring depth observed by ProcessEventsWithContext(). */
+    uint32_t m_eventsWithContextMaxDepth;
+    /** Number of events diverted to the overflow list. */
+    std::atomic<uint64_t> m_eventsWithContextOverflows;
 
     /** Container type for the events to run at Simulator::Destroy() */
     typedef std::list<EventId> DestroyEvents;
@@ -115,6 +162,8 @@ class DefaultSimulatorImpl : public SimulatorImpl
     DestroyEvents m_destroyEvents;
     /** Flag calling for the end of the simulation. */
     bool m_stop;
+    /** Flag set once Run() has been called. */
+    bool m_started;
     /** The event priority queue. */
     Ptr<Scheduler> m_events;
 
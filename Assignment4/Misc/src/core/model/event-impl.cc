@@ -21,6 +21,9 @@
 
 #include "log.h"
 
+#include <atomic>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +35,84 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/** Granularity of the event size classes, in bytes. */
+constexpr std::size_t EVENT_SIZE_STEP = 16;
+/** Number of event size classes: events up to 256 bytes are pooled. */
+constexpr std::size_t EVENT_SIZE_CLASSES = 16;
+/** Maximum number of free blocks kept per size class and per thread. */
+constexpr uint32_t EVENT_CACHE_LIMIT = 4096;
+
+/** A free block, linked in the free list of its size class. */
+struct EventFreeBlock
+{
+    EventFreeBlock* next; //!< Next free block.
+};
+
+/**
+ * Per-thread free lists of event blocks.
+ *
+ * This is trivially destructible so that it remains usable while the
+ * thread exits, e.g. when static objects holding events are destroyed.
+ */
+struct EventCache
+{
+    EventFreeBlock* head[EVENT_SIZE_CLASSES]; //!< Free list of each size class.
+    uint32_t count[EVENT_SIZE_CLASSES];       //!< Length of each free list.
+    bool open;                                //!< The flusher has been set up.
+    bool closed;                              //!< The thread is exiting.
+};
+
+/** The free lists of the current thread. */
+thread_local EventCache t_eventCache{};
+
+/** Release the blocks of the current thread free lists when it exits. */
+struct EventCacheFlusher
+{
+    bool active{false}; //!< Set on first use, to construct the flusher.
+
+    ~EventCacheFlusher()
+    {
+        for (std::size_t i = 0; i < EVENT_SIZE_CLASSES; ++i)
+        {
+            while (t_eventCache.head[i] != nullptr)
+            {
+                EventFreeBlock* block = t_eventCache.head[i];
+                t_eventCache.head[i] = block->next;
+                ::operator delete(block);
+            }
+            t_eventCache.count[i] = 0;
+        }
+        t_eventCache.closed = true;
+    }
+};
+
+/** Flushes the free lists of the current thread on exit. */
+thread_local EventCacheFlusher t_eventCacheFlusher;
+
+/** Number of events allocated from the heap. */
+std::atomic<uint64_t> g_eventHeapAllocations{0};
+
+/**
+ * Get the free lists of the current thread, making sure they will be
+ * released when the thread exits.
+ * \return The free lists.
+ */
+inline EventCache&
+GetEventCache()
+{
+    if (!t_eventCache.open)
+    {
+        t_eventCache.open = true;
+        t_eventCacheFlusher.active = true;
+    }
+    return t_eventCache;
+}
+
+} // namespace
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -67,4 +148,66 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+void*
+EventImpl::operator new(std::size_t size)
+{
+    // Do not log here: this is called before the event exists
+    std::size_t sizeClass = (size - 1) / EVENT_SIZE_STEP;
+    if (sizeClass >= EVENT_SIZE_CLASSES)
+    {
+        g_eventHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    EventCache& cache = GetEventCache();
+    EventFreeBlock* block = cache.head[sizeClass];
+    if (block != nullptr)
+    {
+        cache.head[sizeClass] = block->next;
+        cache.count[sizeClass]--;
+        return block;
+    }
+    g_eventHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new((sizeClass + 1) * EVENT_SIZE_STEP);
+}
+
+void*
+EventImpl::operator new(std::size_t size, std::align_val_t alignment)
+{
+    g_eventHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size, alignment);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    std::size_t sizeClass = (size - 1) / EVENT_SIZE_STEP;
+    if (sizeClass >= EVENT_SIZE_CLASSES)
+    {
+        ::operator delete(p);
+        return;
+    }
+    EventCache& cache = GetEventCache();
+    if (cache.closed || cache.count[sizeClass] >= EVENT_CACHE_LIMIT)
+    {
+        ::operator delete(p);
+        return;
+    }
+    auto block = static_cast<EventFreeBlock*>(p);
+    block->next = cache.head[sizeClass];
+    cache.head[sizeClass] = block;
+    cache.count[sizeClass]++;
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t /* size */, std::align_val_t alignment)
+{
+    ::operator delete(p, alignment);
+}
+
+uint64_t
+EventImpl::GetHeapAllocationCount()
+{
+    return g_eventHeapAllocations.load(std::memory_order_relaxed);
+}
+
 } // namespace ns3
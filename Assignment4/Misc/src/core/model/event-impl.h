@@ -21,6 +21,8 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
+#include <new>
 #include <stdint.h>
 
 /**
@@ -41,6 +43,11 @@ namespace ns3
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from per-thread free lists, one per size class,
+ * so that once a simulation has reached its steady state scheduling an
+ * event does not reach the heap.  Events larger than the biggest size
+ * class use the global allocator directly.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -67,6 +74,43 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Allocate an event from the free list of its size class.
+     *
+     * \param [in] size The size of the event object.
+     * \return The memory for the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Allocate an over-aligned event from the heap.
+     *
+     * \param [in] size The size of the event object.
+     * \param [in] alignment The alignment of the event object.
+     * \return The memory for the event.
+     */
+    static void* operator new(std::size_t size, std::align_val_t alignment);
+    /**
+     * Return an event to the free list of its size class.
+     *
+     * \param [in] p The memory of the event.
+     * \param [in] size The size of the event object.
+     */
+    static void operator delete(void* p, std::size_t size);
+    /**
+     * Release an over-aligned event.
+     *
+     * \param [in] p The memory of the event.
+     * \param [in] size The size of the event object.
+     * \param [in] alignment The alignment of the event object.
+     */
+    static void operator delete(void* p, std::size_t size, std::align_val_t alignment);
+
+    /**
+     * \return The number of events for which no pooled block was
+     *          available, so that memory had to be taken from the heap.
+     */
+    static uint64_t GetHeapAllocationCount();
+
   protected:
     /**
      * Implementation for Invoke().
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "type-id.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "Number of events in a bucket above which the bucket "
+                          "is split into a new rung rather than sorted.",
+                          TypeId::ATTR_CONSTRUCT,
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::SetThreshold),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxRungs",
+                          "Maximum number of rungs in the ladder.",
+                          TypeId::ATTR_CONSTRUCT,
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&LadderScheduler::SetMaxRungs),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_free(NIL),
+      m_top(NIL),
+      m_topCount(0),
+      m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_nRungs(0),
+      m_maxRungs(8),
+      m_threshold(50),
+      m_bottom(NIL),
+      m_bottomTail(NIL),
+      m_bottomCount(0),
+      m_bottomLimit(50),
+      m_qSize(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_rungs.resize(m_maxRungs);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LadderScheduler::SetThreshold(uint32_t threshold)
+{
+    NS_LOG_FUNCTION(this << threshold);
+    m_threshold = threshold;
+    m_bottomLimit = threshold;
+}
+
+void
+LadderScheduler::SetMaxRungs(uint32_t maxRungs)
+{
+    NS_LOG_FUNCTION(this << maxRungs);
+    NS_ASSERT_MSG(m_nRungs == 0, "Cannot change the number of rungs of a ladder in use");
+    m_maxRungs = maxRungs;
+    // Rung references stay valid while spawning rungs
+    m_rungs.resize(m_maxRungs);
+}
+
+uint32_t
+LadderScheduler::AllocateNode(const Scheduler::Event& ev)
+{
+    uint32_t node = m_free;
+    if (node != NIL)
+    {
+        m_free = m_nodes[node].next;
+    }
+    else
+    {
+        NS_ASSERT_MSG(m_nodes.size() < NIL, "Too many events for the LadderScheduler");
+        node = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[node].ev = ev;
+    m_nodes[node].next = NIL;
+    m_nodes[node].prev = NIL;
+    return node;
+}
+
+void
+LadderScheduler::ReleaseNode(uint32_t node)
+{
+    m_nodes[node].ev.impl = nullptr;
+    m_nodes[node].next = m_free;
+    m_free = node;
+}
+
+uint32_t
+LadderScheduler::FindRung(uint64_t ts) const
+{
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        const Rung& rung = m_rungs[i];
+        if (ts >= rung.start + rung.current * rung.width)
+        {
+            return i;
+        }
+    }
+    return m_nRungs;
+}
+
+uint32_t
+LadderScheduler::Bucket(const Rung& rung, uint64_t ts) const
+{
+    uint64_t bucket = (ts - rung.start) / rung.width;
+    NS_ASSERT(bucket >= rung.current && bucket < rung.buckets.size());
+    return static_cast<uint32_t>(bucket);
+}
+
+LadderScheduler::Rung&
+LadderScheduler::PushRung(uint64_t start, uint64_t span, uint32_t nBuckets)
+{
+    NS_LOG_FUNCTION(this << start << span << nBuckets);
+    NS_ASSERT(m_nRungs < m_maxRungs);
+    Rung& rung = m_rungs[m_nRungs];
+    m_nRungs++;
+    rung.start = start;
+    rung.width = std::max<uint64_t>((span + nBuckets - 1) / nBuckets, 1);
+    rung.buckets.assign((span + rung.width - 1) / rung.width, NIL);
+    rung.current = 0;
+    rung.count = 0;
+    return rung;
+}
+
+void
+LadderScheduler::InsertInRung(Rung& rung, uint32_t node)
+{
+    uint32_t bucket = Bucket(rung, m_nodes[node].ev.key.m_ts);
+    m_nodes[node].next = rung.buckets[bucket];
+    rung.buckets[bucket] = node;
+    rung.count++;
+}
+
+void
+LadderScheduler::InsertInBottom(uint32_t node)
+{
+    // New events usually land near the end of Bottom: search from the tail
+    const Scheduler::EventKey& key = m_nodes[node].ev.key;
+    uint32_t after = m_bottomTail;
+    while (after != NIL && key < m_nodes[after].ev.key)
+    {
+        after = m_nodes[after].prev;
+    }
+    m_nodes[node].prev = after;
+    m_nodes[node].next = (after == NIL) ? m_bottom : m_nodes[after].next;
+    if (after == NIL)
+    {
+        m_bottom = node;
+    }
+    else
+    {
+        m_nodes[after].next = node;
+    }
+    if (m_nodes[node].next == NIL)
+    {
+        m_bottomTail = node;
+    }
+    else
+    {
+        m_nodes[m_nodes[node].next].prev = node;
+    }
+    m_bottomCount++;
+}
+
+void
+LadderScheduler::SortIntoBottom(uint32_t head)
+{
+    NS_ASSERT(m_bottom == NIL);
+    m_sort.clear();
+    for (uint32_t i = head; i != NIL; i = m_nodes[i].next)
+    {
+        m_sort.push_back(i);
+    }
+    std::sort(m_sort.begin(), m_sort.end(), [this](uint32_t a, uint32_t b) {
+        return m_nodes[a].ev.key < m_nodes[b].ev.key;
+    });
+    uint32_t prev = NIL;
+    for (uint32_t node : m_sort)
+    {
+        m_nodes[node].prev = prev;
+        if (prev == NIL)
+        {
+            m_bottom = node;
+        }
+        else
+        {
+            m_nodes[prev].next = node;
+        }
+        prev = node;
+    }
+    m_nodes[prev].next = NIL;
+    m_bottomTail = prev;
+    m_bottomCount = static_cast<uint32_t>(m_sort.size());
+    m_bottomLimit = std::max(m_threshold, 2 * m_bottomCount);
+}
+
+void
+LadderScheduler::UnlinkFromBottom(uint32_t node)
+{
+    uint32_t prev = m_nodes[node].prev;
+    uint32_t next = m_nodes[node].next;
+    if (prev == NIL)
+    {
+        m_bottom = next;
+    }
+    else
+    {
+        m_nodes[prev].next = next;
+    }
+    if (next == NIL)
+    {
+        m_bottomTail = prev;
+    }
+    else
+    {
+        m_nodes[next].prev = prev;
+    }
+    m_bottomCount--;
+}
+
+uint32_t
+LadderScheduler::UnlinkFromList(uint32_t& head, const Scheduler::Event& ev)
+{
+    uint32_t* link = &head;
+    while (*link != NIL)
+    {
+        uint32_t node = *link;
+        if (m_nodes[node].ev.key.m_uid == ev.key.m_uid)
+        {
+            *link = m_nodes[node].next;
+            return node;
+        }
+        link = &m_nodes[node].next;
+    }
+    return NIL;
+}
+
+void
+LadderScheduler::TransferTop()
+{
+    NS_LOG_FUNCTION(this << m_topCount << m_topMin << m_topMax);
+    NS_ASSERT(m_nRungs == 0 && m_topCount > 0);
+    Rung& rung = PushRung(m_topMin, m_topMax - m_topMin + 1, m_topCount);
+    m_topStart = rung.start + rung.buckets.size() * rung.width;
+    uint32_t node = m_top;
+    while (node != NIL)
+    {
+        uint32_t next = m_nodes[node].next;
+        InsertInRung(rung, node);
+        node = next;
+    }
+    m_top = NIL;
+    m_topCount = 0;
+    m_topMin = std::numeric_limits<uint64_t>::max();
+    m_topMax = 0;
+}
+
+void
+LadderScheduler::RefillBottom()
+{
+    while (m_bottom == NIL && m_qSize > 0)
+    {
+        if (m_nRungs == 0)
+        {
+            TransferTop();
+        }
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current] == NIL)
+        {
+            rung.current++;
+        }
+        uint32_t head = rung.buckets[rung.current];
+        rung.buckets[rung.current] = NIL;
+        uint64_t bucketEnd = rung.start + (rung.current + 1) * rung.width;
+        rung.current++;
+
+        uint32_t count = 0;
+        uint64_t minTs = std::numeric_limits<uint64_t>::max();
+        uint64_t maxTs = 0;
+        for (uint32_t i = head; i != NIL; i = m_nodes[i].next)
+        {
+            count++;
+            minTs = std::min(minTs, m_nodes[i].ev.key.m_ts);
+            maxTs = std::max(maxTs, m_nodes[i].ev.key.m_ts);
+        }
+        rung.count -= count;
+
+        if (count > m_threshold && minTs != maxTs && m_nRungs < m_maxRungs)
+        {
+            NS_LOG_LOGIC("spawn rung " << m_nRungs << " for " << count << " events");
+            // Events arriving later for this bucket are not earlier than minTs
+            Rung& child = PushRung(minTs, bucketEnd - minTs, count);
+            uint32_t node = head;
+            while (node != NIL)
+            {
+                uint32_t next = m_nodes[node].next;
+                InsertInRung(child, node);
+                node = next;
+            }
+        }
+        else
+        {
+            SortIntoBottom(head);
+        }
+    }
+}
+
+void
+LadderScheduler::SpawnFromBottom()
+{
+    NS_LOG_FUNCTION(this << m_bottomCount);
+    // Bottom holds the events before the current bucket of the lowest rung
+    uint64_t end = m_topStart;
+    if (m_nRungs > 0)
+    {
+        const Rung& lowest = m_rungs[m_nRungs - 1];
+        end = lowest.start + lowest.current * lowest.width;
+    }
+    uint64_t start = m_nodes[m_bottom].ev.key.m_ts;
+    Rung& rung = PushRung(start, end - start, m_bottomCount);
+    uint32_t node = m_bottom;
+    while (node != NIL)
+    {
+        uint32_t next = m_nodes[node].next;
+        InsertInRung(rung, node);
+        node = next;
+    }
+    m_bottom = NIL;
+    m_bottomTail = NIL;
+    m_bottomCount = 0;
+}
+
+void
+LadderScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint32_t node = AllocateNode(ev);
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        m_nodes[node].next = m_top;
+        m_top = node;
+        m_topCount++;
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+    }
+    else
+    {
+        uint32_t rung = FindRung(ts);
+        if (rung < m_nRungs)
+        {
+            InsertInRung(m_rungs[rung], node);
+        }
+        else
+        {
+            InsertInBottom(node);
+            if (m_bottomCount > m_bottomLimit && m_nRungs < m_maxRungs &&
+                m_nodes[m_bottom].ev.key.m_ts != m_nodes[m_bottomTail].ev.key.m_ts)
+            {
+                SpawnFromBottom();
+            }
+        }
+    }
+    m_qSize++;
+    RefillBottom();
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_nodes[m_bottom].ev;
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    uint32_t node = m_bottom;
+    Scheduler::Event ev = m_nodes[node].ev;
+    UnlinkFromBottom(node);
+    ReleaseNode(node);
+    m_qSize--;
+    RefillBottom();
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    uint64_t ts = ev.key.m_ts;
+    uint32_t node = NIL;
+    if (ts >= m_topStart)
+    {
+        node = UnlinkFromList(m_top, ev);
+        m_topCount--;
+    }
+    else
+    {
+        uint32_t index = FindRung(ts);
+        if (index < m_nRungs)
+        {
+            Rung& rung = m_rungs[index];
+            node = UnlinkFromList(rung.buckets[Bucket(rung, ts)], ev);
+            rung.count--;
+        }
+        else
+        {
+            for (node = m_bottom; node != NIL; node = m_nodes[node].next)
+            {
+                if (m_nodes[node].ev.key.m_uid == ev.key.m_uid)
+                {
+                    UnlinkFromBottom(node);
+                    break;
+                }
+            }
+        }
+    }
+    NS_ASSERT(node != NIL);
+    NS_ASSERT(m_nodes[node].ev.impl == ev.impl);
+    ReleaseNode(node);
+    m_qSize--;
+    RefillBottom();
+}
+
+} // namespace ns3
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by W. T. Tang, R. S. M. Goh and
+ * I. L.-J. Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * Events are kept in three tiers:
+ *
+ * - Top, an unsorted list of the events far in the future;
+ * - the Ladder, a stack of rungs of buckets. Each rung splits
+ *   one bucket of the rung above into finer buckets; events within
+ *   a bucket are not sorted;
+ * - Bottom, a short sorted list holding the events which will
+ *   be dequeued next.
+ *
+ * When Bottom runs empty the first non-empty bucket of the lowest rung
+ * is either sorted into Bottom, or, if it holds more than `Threshold`
+ * events, split into a new rung.  Conversely, when insertions make Bottom
+ * grow too large, its events are moved to a new lowest rung.  When the
+ * Ladder runs empty, Top is spread over a new first rung sized after the
+ * number of events in Top.
+ * The bucket widths therefore follow the local event density, which
+ * keeps heavily clustered timestamps from piling up in one bucket.
+ *
+ * Events are stored in nodes taken from a pool owned by the scheduler,
+ * linked by index: once the pool has grown to the peak event population
+ * no memory is allocated per event.
+ *
+ * Bottom is always refilled eagerly, so PeekNext() is a constant time,
+ * read only operation.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Push to Top or to a rung bucket
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Head of Bottom
+ * Remove()     | ~Constant       | Search within one bucket
+ * RemoveNext() | ~Constant       | Pop Bottom; bucket transfer amortized
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | One bucket index per rung bucket | `std::vector<uint32_t>`
+ * Per Event | 2 x `uint32_t`                   | Intrusive links in the node pool
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Index marking the end of a list of nodes. */
+    static constexpr uint32_t NIL = 0xffffffff;
+
+    /** A pooled event node. */
+    struct Node
+    {
+        Scheduler::Event ev; //!< The event.
+        uint32_t next;       //!< Next node in the list.
+        uint32_t prev;       //!< Previous node, in Bottom only.
+    };
+
+    /** A rung of the ladder. */
+    struct Rung
+    {
+        std::vector<uint32_t> buckets; //!< Head node of each bucket.
+        uint64_t start;                //!< Timestamp at the start of the first bucket.
+        uint64_t width;                //!< Bucket width, in dimensionless time units.
+        uint32_t current;              //!< First bucket not yet transferred.
+        uint32_t count;                //!< Number of events in the rung.
+    };
+
+    /**
+     * Take a node from the pool.
+     * \param [in] ev The event to store.
+     * \return The node index.
+     */
+    uint32_t AllocateNode(const Scheduler::Event& ev);
+    /**
+     * Return a node to the pool.
+     * \param [in] node The node index.
+     */
+    void ReleaseNode(uint32_t node);
+
+    /**
+     * Find the rung which should hold a timestamp.
+     * \param [in] ts The timestamp, which must be below the start of Top.
+     * \return The rung index, or the number of rungs if the event belongs in Bottom.
+     */
+    uint32_t FindRung(uint64_t ts) const;
+    /**
+     * Compute the bucket of a rung holding a timestamp.
+     * \param [in] rung The rung.
+     * \param [in] ts The timestamp.
+     * \return The bucket index.
+     */
+    uint32_t Bucket(const Rung& rung, uint64_t ts) const;
+    /**
+     * Set up the rung at index \c m_nRungs, reusing its bucket storage.
+     * \param [in] start The timestamp at the start of the first bucket.
+     * \param [in] span The time range to cover.
+     * \param [in] nBuckets The number of buckets.
+     * \return The new rung.
+     */
+    Rung& PushRung(uint64_t start, uint64_t span, uint32_t nBuckets);
+    /**
+     * Insert a node in a rung bucket.
+     * \param [in] rung The rung.
+     * \param [in] node The node index.
+     */
+    void InsertInRung(Rung& rung, uint32_t node);
+    /**
+     * Insert a node in Bottom, keeping it sorted.
+     * \param [in] node The node index.
+     */
+    void InsertInBottom(uint32_t node);
+    /**
+     * Move a list of nodes to Bottom, which must be empty, sorting them.
+     * \param [in] head The head of the list.
+     */
+    void SortIntoBottom(uint32_t head);
+    /**
+     * Unlink a node from Bottom.
+     * \param [in] node The node index.
+     */
+    void UnlinkFromBottom(uint32_t node);
+    /**
+     * Search a singly linked list for an event, and unlink it.
+     * \param [in,out] head The head of the list.
+     * \param [in] ev The event to find.
+     * \return The node index, or NIL.
+     */
+    uint32_t UnlinkFromList(uint32_t& head, const Scheduler::Event& ev);
+    /** Refill Bottom from the Ladder and Top, if Bottom is empty. */
+    void RefillBottom();
+    /** Move the events of an overgrown Bottom to a new lowest rung. */
+    void SpawnFromBottom();
+    /** Spread the events in Top over a new first rung. */
+    void TransferTop();
+
+    /**
+     * Set the bucket size above which a new rung is spawned.
+     * \param [in] threshold The bucket size.
+     */
+    void SetThreshold(uint32_t threshold);
+    /**
+     * Set the maximum number of rungs.
+     * \param [in] maxRungs The maximum number of rungs.
+     */
+    void SetMaxRungs(uint32_t maxRungs);
+
+    /** The node pool. */
+    std::vector<Node> m_nodes;
+    /** Head of the free list of nodes. */
+    uint32_t m_free;
+
+    /** Head of Top. */
+    uint32_t m_top;
+    /** Number of events in Top. */
+    uint32_t m_topCount;
+    /** Smallest timestamp inserted in Top. */
+    uint64_t m_topMin;
+    /** Largest timestamp inserted in Top. */
+    uint64_t m_topMax;
+    /** Events at or after this timestamp go to Top. */
+    uint64_t m_topStart;
+
+    /** The rungs; only the first \c m_nRungs are in use. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+    /** Maximum number of rungs. */
+    uint32_t m_maxRungs;
+    /** Bucket size above which a new rung is spawned. */
+    uint32_t m_threshold;
+
+    /** Head of Bottom. */
+    uint32_t m_bottom;
+    /** Tail of Bottom. */
+    uint32_t m_bottomTail;
+    /** Number of events in Bottom. */
+    uint32_t m_bottomCount;
+    /**
+     * Bottom size above which inserting in Bottom spawns a new rung:
+     * at least twice the size of the last refill, to amortize the
+     * rung creation over the insertions.
+     */
+    uint32_t m_bottomLimit;
+
+    /** Scratch space used to sort buckets into Bottom. */
+    std::vector<uint32_t> m_sort;
+    /** Number of events in queue. */
+    uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
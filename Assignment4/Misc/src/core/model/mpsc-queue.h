@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "assert.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup simulator
+ *
+ * \brief A bounded, lock-free, multiple producer / single consumer ring.
+ *
+ * Each slot carries a sequence number which tells producers whether the
+ * slot is free and tells the consumer whether the slot has been published
+ * (D. Vyukov's bounded queue).  Producers claim a slot with a single
+ * compare-and-swap on the push position; the consumer never writes the
+ * push position and producers never write the pop position, so the two
+ * sides only share the per-slot sequence numbers.
+ *
+ * Items pushed by the same producer are popped in the same order.
+ * TryPush() fails instead of blocking when the ring is full: the caller
+ * is responsible for providing a fallback path.
+ *
+ * \tparam T \explicit The item type; it must be default constructible
+ *         and copy assignable.
+ */
+template <typename T>
+class MpscQueue
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] capacity The number of slots, rounded up to a power of two.
+     */
+    MpscQueue(uint32_t capacity = 1024);
+
+    /// Non-copyable.
+    MpscQueue(const MpscQueue&) = delete;
+    /**
+     * Non-copyable.
+     * \return The queue.
+     */
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * Push an item.  Safe to call from any number of threads.
+     *
+     * \param [in] item The item to push.
+     * \return \c false if the ring is full.
+     */
+    bool TryPush(const T& item);
+
+    /**
+     * Pop the oldest published item.  Must only be called by the consumer.
+     *
+     * \param [out] item The item popped.
+     * \return \c false if the ring is empty or if the oldest slot has been
+     *         claimed by a producer which has not published it yet.
+     */
+    bool TryPop(T& item);
+
+    /**
+     * \return The number of slots claimed by producers so far.
+     *
+     * Together with GetPopPosition() this lets the consumer drain
+     * exactly the items claimed before a given point in time.
+     */
+    uint64_t GetPushPosition() const;
+
+    /**
+     * \return The number of items popped so far.  Consumer side only.
+     */
+    uint64_t GetPopPosition() const;
+
+    /**
+     * \return A snapshot of the number of claimed but not yet popped slots.
+     *         Exact only when called by the consumer with no producer active.
+     */
+    uint32_t GetSize() const;
+
+    /**
+     * \return \c true if the consumer would find no published item.
+     *         Consumer side only.
+     */
+    bool IsEmpty() const;
+
+    /**
+     * \return The number of slots.
+     */
+    uint32_t GetCapacity() const;
+
+  private:
+    /** A ring slot. */
+    struct Cell
+    {
+        /**
+         * Slot state: equal to the push position when the slot is free,
+         * to the push position plus one once the item has been published.
+         */
+        std::atomic<uint64_t> sequence;
+        /** The item. */
+        T item;
+    };
+
+    /** Size of a cache line, used to keep the two ends of the ring apart. */
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    std::vector<Cell> m_cells; //!< The slots.
+    uint64_t m_mask;           //!< Capacity minus one.
+    /** Next position to be claimed by a producer. */
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_pushPosition;
+    /** Next position to be popped by the consumer. */
+    alignas(CACHE_LINE) uint64_t m_popPosition;
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3
+{
+
+template <typename T>
+MpscQueue<T>::MpscQueue(uint32_t capacity)
+    : m_pushPosition(0),
+      m_popPosition(0)
+{
+    NS_ASSERT_MSG(capacity > 0, "MpscQueue needs at least one slot");
+    uint64_t slots = 1;
+    while (slots < capacity)
+    {
+        slots <<= 1;
+    }
+    m_cells = std::vector<Cell>(slots);
+    for (uint64_t i = 0; i < slots; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_mask = slots - 1;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::TryPush(const T& item)
+{
+    uint64_t position = m_pushPosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &m_cells[position & m_mask];
+        uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<int64_t>(sequence - position);
+        if (diff == 0)
+        {
+            if (m_pushPosition.compare_exchange_weak(position,
+                                                     position + 1,
+                                                     std::memory_order_relaxed))
+            {
+                break;
+            }
+            // position has been reloaded by the failed exchange
+        }
+        else if (diff < 0)
+        {
+            // the consumer has not released this slot yet: full
+            return false;
+        }
+        else
+        {
+            position = m_pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+    cell->item = item;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::TryPop(T& item)
+{
+    Cell* cell = &m_cells[m_popPosition & m_mask];
+    uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (sequence != m_popPosition + 1)
+    {
+        return false;
+    }
+    item = cell->item;
+    cell->sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+    ++m_popPosition;
+    return true;
+}
+
+template <typename T>
+uint64_t
+MpscQueue<T>::GetPushPosition() const
+{
+    return m_pushPosition.load(std::memory_order_acquire);
+}
+
+template <typename T>
+uint64_t
+MpscQueue<T>::GetPopPosition() const
+{
+    return m_popPosition;
+}
+
+template <typename T>
+uint32_t
+MpscQueue<T>::GetSize() const
+{
+    return static_cast<uint32_t>(GetPushPosition() - m_popPosition);
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty() const
+{
+    const Cell& cell = m_cells[m_popPosition & m_mask];
+    return cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1;
+}
+
+template <typename T>
+uint32_t
+MpscQueue<T>::GetCapacity() const
+{
+    return static_cast<uint32_t>(m_mask + 1);
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
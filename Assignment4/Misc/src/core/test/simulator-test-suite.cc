@@ -18,11 +18,17 @@
  */
 #include "ns3/calendar-scheduler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <set>
+#include <utility>
 
 using namespace ns3;
 
@@ -707,6 +713,102 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the event order of a scheduler against a reference set,
+ * with clustered timestamps and random removals.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory);
+
+  private:
+    void DoRun() override;
+
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check the event order with clustered timestamps with " +
+               schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    // Reference: (timestamp, uid) of the pending events
+    std::set<std::pair<uint64_t, uint32_t>> reference;
+    uint32_t uid = 0;
+    uint64_t now = 0;
+
+    auto insert = [&](uint64_t ts) {
+        Scheduler::Event ev;
+        ev.impl = nullptr;
+        ev.key.m_ts = ts;
+        ev.key.m_uid = uid++;
+        ev.key.m_context = 0;
+        scheduler->Insert(ev);
+        reference.insert({ts, ev.key.m_uid});
+    };
+
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        double choice = rng->GetValue();
+        if (choice < 0.6 || reference.empty())
+        {
+            // Half the events share a few slot boundaries, half are spread out
+            uint64_t delay = (rng->GetValue() < 0.5) ? rng->GetInteger(0, 3) * 9000
+                                                     : rng->GetInteger(0, 10000000);
+            insert(now + delay);
+        }
+        else if (choice < 0.7)
+        {
+            auto it = reference.lower_bound({now + rng->GetInteger(0, 10000000), 0});
+            if (it == reference.end())
+            {
+                it = reference.begin();
+            }
+            Scheduler::Event ev;
+            ev.impl = nullptr;
+            ev.key.m_ts = it->first;
+            ev.key.m_uid = it->second;
+            ev.key.m_context = 0;
+            scheduler->Remove(ev);
+            reference.erase(it);
+        }
+        else
+        {
+            Scheduler::Event peek = scheduler->PeekNext();
+            Scheduler::Event next = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(peek.key.m_uid, next.key.m_uid, "PeekNext and RemoveNext differ");
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_ts, reference.begin()->first, "Bad timestamp order");
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, reference.begin()->second, "Bad uid order");
+            reference.erase(reference.begin());
+            now = next.key.m_ts;
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), reference.empty(), "Bad queue size");
+    }
+    while (!reference.empty())
+    {
+        Scheduler::Event next = scheduler->RemoveNext();
+        NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, reference.begin()->second, "Bad drain order");
+        reference.erase(reference.begin());
+    }
+    NS_TEST_EXPECT_MSG_EQ(scheduler->IsEmpty(), true, "Scheduler should be empty");
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -730,6 +832,18 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::Duration::QUICK);
+
+        factory.SetTypeId(MapScheduler::GetTypeId());
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(CalendarScheduler::GetTypeId());
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::Duration::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::Duration::QUICK);
+        factory.Set("Threshold", UintegerValue(2));
+        factory.Set("MaxRungs", UintegerValue(3));
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::Duration::QUICK);
     }
 };
 
@@ -18,18 +18,23 @@
  */
 #include "ns3/calendar-scheduler.h"
 #include "ns3/config.h"
+#include "ns3/default-simulator-impl.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
+#include <atomic>
 #include <chrono> // seconds, milliseconds
 #include <ctime>
 #include <list>
 #include <thread> // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -278,6 +283,167 @@ ThreadedSimulatorEventsTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * \ingroup threaded-tests
+ *
+ * \brief Check that events injected by other threads keep their per-thread
+ * order when the DefaultSimulatorImpl injection ring overflows.
+ */
+class ThreadedSimulatorOrderingTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param capacity The number of slots of the injection ring.
+     * \param threads The number of threads.
+     * \param overflow Whether to let the ring overflow before running.
+     */
+    ThreadedSimulatorOrderingTestCase(uint32_t capacity, unsigned int threads, bool overflow);
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /**
+     * Inject events with increasing sequence numbers.
+     * \param threadno The thread number, used as the event context.
+     */
+    void InjectingThread(unsigned int threadno);
+    /**
+     * Record an injected event.
+     * \param threadno The thread number.
+     * \param sequence The sequence number of the event in its thread.
+     */
+    void Received(unsigned int threadno, uint32_t sequence);
+    /** Keep the simulation alive until every event has been received. */
+    void Poll();
+
+    /// Number of events injected by each thread.
+    static constexpr uint32_t EVENTS_PER_THREAD = 5000;
+
+    uint32_t m_capacity;                  //!< Injection ring size.
+    unsigned int m_threads;               //!< The number of threads.
+    bool m_overflow;                      //!< Let the ring overflow before running.
+    std::atomic<unsigned int> m_finished; //!< Number of threads done injecting.
+    std::vector<uint32_t> m_next;         //!< Next expected sequence number, per thread.
+    uint64_t m_received;                  //!< Total events received.
+    std::string m_error;                  //!< Error condition.
+};
+
+ThreadedSimulatorOrderingTestCase::ThreadedSimulatorOrderingTestCase(uint32_t capacity,
+                                                                     unsigned int threads,
+                                                                     bool overflow)
+    : TestCase("Check per-thread event order with " + std::to_string(threads) +
+               " threads and an injection ring of " + std::to_string(capacity) + " slots" +
+               (overflow ? ", overflowing" : "")),
+      m_capacity(capacity),
+      m_threads(threads),
+      m_overflow(overflow),
+      m_finished(0),
+      m_received(0)
+{
+}
+
+void
+ThreadedSimulatorOrderingTestCase::InjectingThread(unsigned int threadno)
+{
+    for (uint32_t sequence = 0; sequence < EVENTS_PER_THREAD; ++sequence)
+    {
+        Simulator::ScheduleWithContext(threadno,
+                                       Time(0),
+                                       &ThreadedSimulatorOrderingTestCase::Received,
+                                       this,
+                                       threadno,
+                                       sequence);
+    }
+    ++m_finished;
+}
+
+void
+ThreadedSimulatorOrderingTestCase::Received(unsigned int threadno, uint32_t sequence)
+{
+    if (sequence != m_next[threadno])
+    {
+        m_error = "Events of thread " + std::to_string(threadno) + " out of order";
+    }
+    m_next[threadno] = sequence + 1;
+    ++m_received;
+}
+
+void
+ThreadedSimulatorOrderingTestCase::Poll()
+{
+    if (m_finished == m_threads && m_received == uint64_t(m_threads) * EVENTS_PER_THREAD)
+    {
+        return;
+    }
+    Simulator::Schedule(MicroSeconds(1), &ThreadedSimulatorOrderingTestCase::Poll, this);
+}
+
+void
+ThreadedSimulatorOrderingTestCase::DoSetup()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventsWithContextCapacity",
+                       UintegerValue(m_capacity));
+    m_next.assign(m_threads, 0);
+}
+
+void
+ThreadedSimulatorOrderingTestCase::DoTeardown()
+{
+    Config::Reset();
+}
+
+void
+ThreadedSimulatorOrderingTestCase::DoRun()
+{
+    Ptr<DefaultSimulatorImpl> impl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Expected a DefaultSimulatorImpl");
+    Simulator::Schedule(MicroSeconds(1), &ThreadedSimulatorOrderingTestCase::Poll, this);
+
+    std::list<std::thread> threads;
+    for (unsigned int i = 0; i < m_threads; ++i)
+    {
+        threads.emplace_back(&ThreadedSimulatorOrderingTestCase::InjectingThread, this, i);
+    }
+
+    if (m_overflow)
+    {
+        // Nothing drains the ring before Run(): wait for it to overflow, so
+        // that the events are split between the ring and the overflow list
+        while (impl->GetEventsWithContextOverflows() == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    Simulator::Run();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(impl->GetEventsWithContextMaxDepth(),
+                                m_capacity,
+                                "Ring depth exceeds its capacity");
+    if (m_overflow)
+    {
+        NS_TEST_EXPECT_MSG_GT(impl->GetEventsWithContextOverflows(),
+                              0,
+                              "The overflow list was not used");
+    }
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_error.empty(), true, m_error);
+    NS_TEST_EXPECT_MSG_EQ(m_received,
+                          uint64_t(m_threads) * EVENTS_PER_THREAD,
+                          "Injected events were lost");
+}
+
 /**
  * \ingroup threaded-tests
  *
@@ -298,6 +464,7 @@ class ThreadedSimulatorTestSuite : public TestSuite
             "ns3::HeapScheduler",
             "ns3::MapScheduler",
             "ns3::CalendarScheduler",
+            "ns3::LadderScheduler",
         };
         unsigned int threadCounts[] = {0, 2, 10, 20};
         ObjectFactory factory;
@@ -315,6 +482,9 @@ class ThreadedSimulatorTestSuite : public TestSuite
                 }
             }
         }
+        AddTestCase(new ThreadedSimulatorOrderingTestCase(4, 4, true), TestCase::Duration::QUICK);
+        AddTestCase(new ThreadedSimulatorOrderingTestCase(4096, 4, false),
+                    TestCase::Duration::QUICK);
     }
 };
 
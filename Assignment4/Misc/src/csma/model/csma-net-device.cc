@@ -26,6 +26,7 @@
 #include "ns3/error-model.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/ethernet-trailer.h"
+#include "ns3/gso-tag.h"
 #include "ns3/llc-snap-header.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
@@ -219,6 +220,7 @@ CsmaNetDevice::DoDispose()
     m_channel = nullptr;
     m_node = nullptr;
     m_queue = nullptr;
+    m_gsoSegments.clear();
     NetDevice::DoDispose();
 }
 
@@ -535,6 +537,45 @@ CsmaNetDevice::TransmitStart()
     }
 }
 
+Ptr<Packet>
+CsmaNetDevice::DequeueForTransmission()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    if (!m_gsoSegments.empty())
+    {
+        Ptr<Packet> segment = m_gsoSegments.front();
+        m_gsoSegments.pop_front();
+        return segment;
+    }
+
+    Ptr<Packet> packet = m_queue->Dequeue();
+    GsoTag gsoTag;
+    if (!packet || !packet->PeekPacketTag(gsoTag))
+    {
+        return packet;
+    }
+
+    //
+    // Split the batch, and give each segment its own Ethernet header, padding
+    // and trailer.
+    //
+    NS_LOG_LOGIC("Split a GSO batch of " << gsoTag.GetSegments() << " segments");
+    Ptr<Packet> batch = packet->Copy();
+    EthernetHeader header(false);
+    batch->RemoveHeader(header);
+    EthernetTrailer trailer;
+    batch->RemoveTrailer(trailer);
+    for (const auto& segment : GsoTag::Segment(batch, header.GetLengthType()))
+    {
+        AddHeader(segment, header.GetSource(), header.GetDestination(), header.GetLengthType());
+        m_gsoSegments.push_back(segment);
+    }
+    packet = m_gsoSegments.front();
+    m_gsoSegments.pop_front();
+    return packet;
+}
+
 void
 CsmaNetDevice::TransmitAbort()
 {
@@ -566,13 +607,13 @@ CsmaNetDevice::TransmitAbort()
     // get that out.  If the queue is empty we just wait until someone puts one
     // in.
     //
-    if (m_queue->IsEmpty())
+    if (m_gsoSegments.empty() && m_queue->IsEmpty())
     {
         return;
     }
     else
     {
-        Ptr<Packet> packet = m_queue->Dequeue();
+        Ptr<Packet> packet = DequeueForTransmission();
         NS_ASSERT_MSG(packet,
                       "CsmaNetDevice::TransmitAbort(): IsEmpty false but no Packet on queue?");
         m_currentPkt = packet;
@@ -638,13 +679,13 @@ CsmaNetDevice::TransmitReadyEvent()
     //
     // Get the next packet from the queue for transmitting
     //
-    if (m_queue->IsEmpty())
+    if (m_gsoSegments.empty() && m_queue->IsEmpty())
     {
         return;
     }
     else
     {
-        Ptr<Packet> packet = m_queue->Dequeue();
+        Ptr<Packet> packet = DequeueForTransmission();
         NS_ASSERT_MSG(packet,
                       "CsmaNetDevice::TransmitReadyEvent(): IsEmpty false but no Packet on queue?");
         m_currentPkt = packet;
@@ -1006,7 +1047,7 @@ CsmaNetDevice::SendFrom(Ptr<Packet> packet,
     {
         if (!m_queue->IsEmpty())
         {
-            Ptr<Packet> packet = m_queue->Dequeue();
+            Ptr<Packet> packet = DequeueForTransmission();
             NS_ASSERT_MSG(packet,
                           "CsmaNetDevice::SendFrom(): IsEmpty false but no Packet on queue?");
             m_currentPkt = packet;
@@ -1070,6 +1111,14 @@ CsmaNetDevice::SupportsSendFrom() const
     return true;
 }
 
+bool
+CsmaNetDevice::SupportsGso() const
+{
+    NS_LOG_FUNCTION_NOARGS();
+    // The length interpretation of the LLC mode does not fit the batches
+    return m_encapMode == DIX;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams(int64_t stream)
 {
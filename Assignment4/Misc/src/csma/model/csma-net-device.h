@@ -35,6 +35,7 @@
 #include "ns3/traced-callback.h"
 
 #include <cstring>
+#include <deque>
 
 namespace ns3
 {
@@ -333,6 +334,11 @@ class CsmaNetDevice : public NetDevice
     void SetPromiscReceiveCallback(PromiscReceiveCallback cb) override;
     bool SupportsSendFrom() const override;
 
+    /**
+     * \return true in DIX encapsulation mode, false otherwise.
+     */
+    bool SupportsGso() const override;
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -438,6 +444,17 @@ class CsmaNetDevice : public NetDevice
      */
     void TransmitReadyEvent();
 
+    /**
+     * Get the next packet to transmit.
+     *
+     * This is the next segment of the GSO batch being transmitted if any, or
+     * else the packet at the head of the queue. A packet carrying a GsoTag is
+     * split into segments, and its first segment is returned.
+     *
+     * \returns the next packet to transmit, or null if there is none
+     */
+    Ptr<Packet> DequeueForTransmission();
+
     /**
      * Aborts the transmission of the current packet
      *
@@ -521,6 +538,12 @@ class CsmaNetDevice : public NetDevice
      */
     Ptr<Packet> m_currentPkt;
 
+    /**
+     * Segments of a GSO batch left to transmit, before the next packet of
+     * the queue.
+     */
+    std::deque<Ptr<Packet>> m_gsoSegments;
+
     /**
      * The CsmaChannel to which this CsmaNetDevice has been
      * attached.
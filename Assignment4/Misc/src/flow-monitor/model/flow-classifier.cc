@@ -19,6 +19,8 @@
 
 #include "flow-classifier.h"
 
+#include "ns3/assert.h"
+
 namespace ns3
 {
 
@@ -37,4 +39,37 @@ FlowClassifier::GetNewFlowId()
     return ++m_lastNewFlowId;
 }
 
+void
+FlowIdTable::Insert(uint32_t hash, FlowId flowId)
+{
+    NS_ASSERT(flowId != 0);
+    // keep at least half of the slots free, so that the probe sequences are short
+    if (2 * (m_nFlows + 1) > m_slots.size())
+    {
+        std::vector<Slot> slots(m_slots.empty() ? 64 : 2 * m_slots.size(), Slot{0, 0});
+        std::size_t mask = slots.size() - 1;
+        for (const auto& slot : m_slots)
+        {
+            if (slot.flowId != 0)
+            {
+                std::size_t i = slot.hash & mask;
+                while (slots[i].flowId != 0)
+                {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = slot;
+            }
+        }
+        m_slots = std::move(slots);
+    }
+    std::size_t mask = m_slots.size() - 1;
+    std::size_t i = hash & mask;
+    while (m_slots[i].flowId != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    m_slots[i] = Slot{hash, flowId};
+    m_nFlows++;
+}
+
 } // namespace ns3
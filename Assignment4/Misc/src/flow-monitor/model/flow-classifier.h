@@ -23,6 +23,7 @@
 #include "ns3/simple-ref-count.h"
 
 #include <ostream>
+#include <vector>
 
 namespace ns3
 {
@@ -80,6 +81,83 @@ class FlowClassifier : public SimpleRefCount<FlowClassifier>
     void Indent(std::ostream& os, uint16_t level) const;
 };
 
+/// \ingroup flow-monitor
+/// Open addressing hash table (with linear probing) storing the FlowIds of
+/// the flows by the hash of their key, e.g., a five-tuple.  The keys are not
+/// stored in the table: the classifier stores them by FlowId, and provides the
+/// function comparing the key of a packet with that of a flow.  The hash of
+/// each flow is stored along with its FlowId, so that the flows with another
+/// hash are skipped without looking at their key, and the table is grown
+/// without computing the hashes again.
+class FlowIdTable
+{
+  public:
+    /**
+     * Find a flow
+     * \tparam Match \deduced Type of the function comparing the keys
+     * \param hash the hash of the key
+     * \param match function returning whether the flow with the given FlowId has the key
+     * \return the FlowId of the flow, or zero if no flow has the key
+     */
+    template <typename Match>
+    FlowId Find(uint32_t hash, Match match) const;
+
+    /**
+     * Insert a flow, which must not be in the table
+     * \param hash the hash of the key of the flow
+     * \param flowId the FlowId of the flow, not zero
+     */
+    void Insert(uint32_t hash, FlowId flowId);
+
+    /**
+     * Mix a value into a hash
+     * \param seed the hash of the previous values
+     * \param value the value
+     * \return the hash of the previous values and of the given value
+     */
+    static uint64_t Combine(uint64_t seed, uint64_t value);
+
+  private:
+    /// A slot of the table
+    struct Slot
+    {
+        uint32_t hash; //!< the hash of the key of the flow
+        FlowId flowId; //!< the FlowId of the flow, zero if the slot is free
+    };
+
+    std::vector<Slot> m_slots; //!< the slots, whose number is zero or a power of two
+    std::size_t m_nFlows{0};   //!< the number of flows in the table
+};
+
+template <typename Match>
+FlowId
+FlowIdTable::Find(uint32_t hash, Match match) const
+{
+    if (m_slots.empty())
+    {
+        return 0;
+    }
+    std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = hash & mask; m_slots[i].flowId != 0; i = (i + 1) & mask)
+    {
+        if (m_slots[i].hash == hash && match(m_slots[i].flowId))
+        {
+            return m_slots[i].flowId;
+        }
+    }
+    return 0;
+}
+
+inline uint64_t
+FlowIdTable::Combine(uint64_t seed, uint64_t value)
+{
+    // splitmix64 finalizer
+    uint64_t x = seed ^ (value + 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 inline void
 FlowClassifier::Indent(std::ostream& os, uint16_t level) const
 {
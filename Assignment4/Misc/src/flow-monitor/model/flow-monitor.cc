@@ -19,10 +19,14 @@
 
 #include "flow-monitor.h"
 
+#include "ns3/abort.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
@@ -35,6 +39,34 @@ NS_LOG_COMPONENT_DEFINE("FlowMonitor");
 
 NS_OBJECT_ENSURE_REGISTERED(FlowMonitor);
 
+/**
+ * \param flowId the flow identification
+ * \param packetId the packet identification
+ * \return the key of the packet in the tracked packets map
+ */
+static inline uint64_t
+TrackedPacketKey(FlowId flowId, FlowPacketId packetId)
+{
+    return (static_cast<uint64_t>(flowId) << 32) | packetId;
+}
+
+/**
+ * Write an unsigned integer in little endian order
+ * \param os the output stream
+ * \param value the value
+ * \param size the number of bytes to write
+ */
+static void
+WriteLittleEndian(std::ostream& os, uint64_t value, uint32_t size)
+{
+    char bytes[8];
+    for (uint32_t i = 0; i < size; i++)
+    {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    os.write(bytes, size);
+}
+
 TypeId
 FlowMonitor::GetTypeId()
 {
@@ -80,7 +112,33 @@ FlowMonitor::GetTypeId()
                 ("The minimum inter-arrival time that is considered a flow interruption."),
                 TimeValue(Seconds(0.5)),
                 MakeTimeAccessor(&FlowMonitor::m_flowInterruptionsMinTime),
-                MakeTimeChecker());
+                MakeTimeChecker())
+            .AddAttribute("SnapshotInterval",
+                          "The interval between two snapshots of the flow statistics "
+                          "written to the SnapshotFile (zero to disable the snapshots).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&FlowMonitor::m_snapshotInterval),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("SnapshotFile",
+                          "The name of the file the snapshots are written to.",
+                          StringValue("flow-monitor-snapshots.csv"),
+                          MakeStringAccessor(&FlowMonitor::m_snapshotFile),
+                          MakeStringChecker())
+            .AddAttribute("SnapshotFormat",
+                          "The format of the snapshots.",
+                          EnumValue(FlowMonitor::SNAPSHOT_CSV),
+                          MakeEnumAccessor<SnapshotFormat>(&FlowMonitor::m_snapshotFormat),
+                          MakeEnumChecker(FlowMonitor::SNAPSHOT_CSV,
+                                          "Csv",
+                                          FlowMonitor::SNAPSHOT_BINARY,
+                                          "Binary"))
+            .AddAttribute("IdleFlowTimeout",
+                          "The time after which a flow that neither transmitted nor received "
+                          "packets is removed from the flow table when a snapshot is written "
+                          "(zero to never remove the flows).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&FlowMonitor::m_idleFlowTimeout),
+                          MakeTimeChecker(Seconds(0)));
     return tid;
 }
 
@@ -102,6 +160,11 @@ FlowMonitor::DoDispose()
     NS_LOG_FUNCTION(this);
     Simulator::Cancel(m_startEvent);
     Simulator::Cancel(m_stopEvent);
+    Simulator::Cancel(m_snapshotEvent);
+    if (m_snapshotStream.is_open())
+    {
+        m_snapshotStream.close();
+    }
     for (auto iter = m_classifiers.begin(); iter != m_classifiers.end(); iter++)
     {
         *iter = nullptr;
@@ -114,14 +177,17 @@ FlowMonitor::DoDispose()
     Object::DoDispose();
 }
 
-inline FlowMonitor::FlowStats&
-FlowMonitor::GetStatsForFlow(FlowId flowId)
+inline FlowMonitor::FlowEntry&
+FlowMonitor::GetFlowEntry(FlowId flowId)
 {
     NS_LOG_FUNCTION(this);
-    auto iter = m_flowStats.find(flowId);
-    if (iter == m_flowStats.end())
+    auto entry = m_flowIndex.find(flowId);
+    if (entry == m_flowIndex.end())
     {
-        FlowMonitor::FlowStats& ref = m_flowStats[flowId];
+        // flow identifiers are mostly allocated in increasing order
+        auto iter = m_flowStats.emplace_hint(m_flowStats.end(), flowId, FlowStats());
+        entry = m_flowIndex.emplace(flowId, FlowEntry{iter, FlowCounters()}).first;
+        FlowMonitor::FlowStats& ref = iter->second;
         ref.delaySum = Seconds(0);
         ref.jitterSum = Seconds(0);
         ref.lastDelay = Seconds(0);
@@ -135,12 +201,32 @@ FlowMonitor::GetStatsForFlow(FlowId flowId)
         ref.jitterHistogram.SetDefaultBinWidth(m_jitterBinWidth);
         ref.packetSizeHistogram.SetDefaultBinWidth(m_packetSizeBinWidth);
         ref.flowInterruptionsHistogram.SetDefaultBinWidth(m_flowInterruptionsBinWidth);
-        return ref;
     }
-    else
+    return entry->second;
+}
+
+inline FlowMonitor::FlowEntry*
+FlowMonitor::FindFlowEntry(FlowId flowId)
+{
+    auto entry = m_flowIndex.find(flowId);
+    return entry == m_flowIndex.end() ? nullptr : &entry->second;
+}
+
+void
+FlowMonitor::AddToWheel(uint64_t key, Time lastSeenTime)
+{
+    int64_t slot = lastSeenTime.GetTimeStep() / PERIODIC_CHECK_INTERVAL.GetTimeStep();
+    if (m_wheel.empty())
+    {
+        m_wheelStart = slot;
+    }
+    NS_ASSERT(slot >= m_wheelStart);
+    auto index = static_cast<std::size_t>(slot - m_wheelStart);
+    if (index >= m_wheel.size())
     {
-        return iter->second;
+        m_wheel.resize(index + 1);
     }
+    m_wheel[index].push_back(key);
 }
 
 void
@@ -156,16 +242,25 @@ FlowMonitor::ReportFirstTx(Ptr<FlowProbe> probe,
         return;
     }
     Time now = Simulator::Now();
-    TrackedPacket& tracked = m_trackedPackets[std::make_pair(flowId, packetId)];
+    FlowEntry& entry = GetFlowEntry(flowId);
+    uint64_t key = TrackedPacketKey(flowId, packetId);
+    auto [iter, inserted] = m_trackedPackets.try_emplace(key);
+    TrackedPacket& tracked = iter->second;
     tracked.firstSeenTime = now;
     tracked.lastSeenTime = tracked.firstSeenTime;
     tracked.timesForwarded = 0;
+    if (inserted)
+    {
+        // a packet already tracked is in the wheel, and is moved when its slot is swept
+        AddToWheel(key, now);
+        entry.trackedPackets++;
+    }
     NS_LOG_DEBUG("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId="
                                                                  << packetId << ").");
 
     probe->AddPacketStats(flowId, packetSize, Seconds(0));
 
-    FlowStats& stats = GetStatsForFlow(flowId);
+    FlowStats& stats = entry.stats->second;
     stats.txBytes += packetSize;
     stats.txPackets++;
     if (stats.txPackets == 1)
@@ -187,8 +282,7 @@ FlowMonitor::ReportForwarding(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    std::pair<FlowId, FlowPacketId> key(flowId, packetId);
-    auto tracked = m_trackedPackets.find(key);
+    auto tracked = m_trackedPackets.find(TrackedPacketKey(flowId, packetId));
     if (tracked == m_trackedPackets.end())
     {
         NS_LOG_WARN("Received packet forward report (flowId="
@@ -215,19 +309,23 @@ FlowMonitor::ReportLastRx(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("FlowMonitor not enabled; returning");
         return;
     }
-    auto tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
+    auto tracked = m_trackedPackets.find(TrackedPacketKey(flowId, packetId));
     if (tracked == m_trackedPackets.end())
     {
         NS_LOG_WARN("Received packet last-tx report (flowId="
                     << flowId << ", packetId=" << packetId << ") but not known to be transmitted.");
         return;
     }
+    // the flows with tracked packets are never removed from the flow table
+    FlowEntry* entry = FindFlowEntry(flowId);
+    NS_ASSERT(entry && entry->trackedPackets > 0);
+    entry->trackedPackets--;
 
     Time now = Simulator::Now();
     Time delay = (now - tracked->second.firstSeenTime);
     probe->AddPacketStats(flowId, packetSize, delay);
 
-    FlowStats& stats = GetStatsForFlow(flowId);
+    FlowStats& stats = entry->stats->second;
     stats.delaySum += delay;
     stats.delayHistogram.AddValue(delay.GetSeconds());
     if (stats.rxPackets > 0)
@@ -285,9 +383,18 @@ FlowMonitor::ReportDrop(Ptr<FlowProbe> probe,
         return;
     }
 
+    FlowEntry* entry = FindFlowEntry(flowId);
+    if (!entry)
+    {
+        // the packets are tracked from their first transmission, which adds their flow
+        NS_LOG_WARN("Received packet drop report (flowId="
+                    << flowId << ", packetId=" << packetId << ") but the flow is not known.");
+        return;
+    }
+
     probe->AddPacketDropStats(flowId, packetSize, reasonCode);
 
-    FlowStats& stats = GetStatsForFlow(flowId);
+    FlowStats& stats = entry->stats->second;
     stats.lostPackets++;
     if (stats.packetsDropped.size() < reasonCode + 1)
     {
@@ -299,7 +406,7 @@ FlowMonitor::ReportDrop(Ptr<FlowProbe> probe,
     NS_LOG_DEBUG("++stats.packetsDropped["
                  << reasonCode << "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-    auto tracked = m_trackedPackets.find(std::make_pair(flowId, packetId));
+    auto tracked = m_trackedPackets.find(TrackedPacketKey(flowId, packetId));
     if (tracked != m_trackedPackets.end())
     {
         // we don't need to track this packet anymore
@@ -307,6 +414,8 @@ FlowMonitor::ReportDrop(Ptr<FlowProbe> probe,
         NS_LOG_DEBUG("ReportDrop: removing tracked packet (flowId=" << flowId << ", packetId="
                                                                     << packetId << ").");
         m_trackedPackets.erase(tracked);
+        NS_ASSERT(entry->trackedPackets > 0);
+        entry->trackedPackets--;
     }
 }
 
@@ -317,30 +426,82 @@ FlowMonitor::GetFlowStats() const
 }
 
 void
-FlowMonitor::CheckForLostPackets(Time maxDelay)
+FlowMonitor::SweepLostPackets(Time threshold, bool exact)
 {
-    NS_LOG_FUNCTION(this << maxDelay.As(Time::S));
-    Time now = Simulator::Now();
+    NS_LOG_FUNCTION(this << threshold.As(Time::S) << exact);
+    int64_t width = PERIODIC_CHECK_INTERVAL.GetTimeStep();
 
-    for (auto iter = m_trackedPackets.begin(); iter != m_trackedPackets.end();)
+    // the packets in the slots that ended before the threshold are lost, unless
+    // they were seen again since they were added to the slot
+    while (!m_wheel.empty() && (m_wheelStart + 1) * width <= threshold.GetTimeStep())
     {
-        if (now - iter->second.lastSeenTime >= maxDelay)
+        std::vector<uint64_t> keys;
+        keys.swap(m_wheel.front());
+        for (uint64_t key : keys)
         {
-            // packet is considered lost, add it to the loss statistics
-            auto flow = m_flowStats.find(iter->first.first);
-            NS_ASSERT(flow != m_flowStats.end());
-            flow->second.lostPackets++;
+            auto iter = m_trackedPackets.find(key);
+            if (iter == m_trackedPackets.end())
+            {
+                continue; // received or dropped
+            }
+            if (iter->second.lastSeenTime <= threshold)
+            {
+                // packet is considered lost, add it to the loss statistics
+                // and we won't track it anymore
+                LosePacket(iter);
+            }
+            else
+            {
+                // the slot is still in the wheel, hence the wheel is not reset
+                AddToWheel(key, iter->second.lastSeenTime);
+            }
+        }
+        m_wheel.pop_front();
+        m_wheelStart++;
+    }
 
-            // we won't track it anymore
-            m_trackedPackets.erase(iter++);
+    if (!exact || m_wheel.empty() || m_wheelStart * width > threshold.GetTimeStep())
+    {
+        return;
+    }
+
+    // the first slot contains the threshold: check its packets one by one
+    std::vector<uint64_t>& keys = m_wheel.front();
+    for (std::size_t i = 0; i < keys.size();)
+    {
+        auto iter = m_trackedPackets.find(keys[i]);
+        if (iter != m_trackedPackets.end() && iter->second.lastSeenTime > threshold)
+        {
+            i++;
+            continue;
         }
-        else
+        if (iter != m_trackedPackets.end())
         {
-            iter++;
+            LosePacket(iter);
         }
+        keys[i] = keys.back();
+        keys.pop_back();
     }
 }
 
+void
+FlowMonitor::LosePacket(TrackedPacketMap::iterator tracked)
+{
+    // the flows with tracked packets are never removed from the flow table
+    FlowEntry* entry = FindFlowEntry(static_cast<FlowId>(tracked->first >> 32));
+    NS_ASSERT(entry && entry->trackedPackets > 0);
+    entry->stats->second.lostPackets++;
+    entry->trackedPackets--;
+    m_trackedPackets.erase(tracked);
+}
+
+void
+FlowMonitor::CheckForLostPackets(Time maxDelay)
+{
+    NS_LOG_FUNCTION(this << maxDelay.As(Time::S));
+    SweepLostPackets(Simulator::Now() - maxDelay, true);
+}
+
 void
 FlowMonitor::CheckForLostPackets()
 {
@@ -350,15 +511,127 @@ FlowMonitor::CheckForLostPackets()
 void
 FlowMonitor::PeriodicCheckForLostPackets()
 {
-    CheckForLostPackets();
+    // only sweep the slots that ended: the packets lost in the current slot
+    // are counted at most one interval late
+    SweepLostPackets(Simulator::Now() - m_maxPerHopDelay, false);
     Simulator::Schedule(PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+void
+FlowMonitor::PeriodicWriteSnapshot()
+{
+    WriteSnapshot();
+    m_snapshotEvent =
+        Simulator::Schedule(m_snapshotInterval, &FlowMonitor::PeriodicWriteSnapshot, this);
+}
+
+void
+FlowMonitor::WriteSnapshot()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_snapshotStream.is_open())
+    {
+        m_snapshotStream.open(m_snapshotFile, std::ios::out | std::ios::binary);
+        NS_ABORT_MSG_UNLESS(m_snapshotStream.is_open(),
+                            "Cannot open the snapshot file " << m_snapshotFile);
+        if (m_snapshotFormat == SNAPSHOT_CSV)
+        {
+            m_snapshotStream << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,"
+                                "timesForwarded,delaySum,jitterSum\n";
+        }
+        else
+        {
+            m_snapshotStream.write("FLOWMON1", 8);
+        }
+    }
+
+    Time now = Simulator::Now();
+    uint32_t nEvicted = 0;
+    for (auto flowI = m_flowStats.begin(); flowI != m_flowStats.end();)
+    {
+        const FlowStats& stats = flowI->second;
+        auto entry = m_flowIndex.find(flowI->first);
+        NS_ASSERT(entry != m_flowIndex.end());
+        FlowCounters& exported = entry->second.exported;
+
+        // all the other counters change along with the packet counters
+        if (stats.txPackets != exported.txPackets || stats.rxPackets != exported.rxPackets ||
+            stats.lostPackets != exported.lostPackets)
+        {
+            FlowCounters delta;
+            delta.txPackets = stats.txPackets - exported.txPackets;
+            delta.txBytes = stats.txBytes - exported.txBytes;
+            delta.rxPackets = stats.rxPackets - exported.rxPackets;
+            delta.rxBytes = stats.rxBytes - exported.rxBytes;
+            delta.lostPackets = stats.lostPackets - exported.lostPackets;
+            delta.timesForwarded = stats.timesForwarded - exported.timesForwarded;
+            delta.delaySum = stats.delaySum - exported.delaySum;
+            delta.jitterSum = stats.jitterSum - exported.jitterSum;
+
+            if (m_snapshotFormat == SNAPSHOT_CSV)
+            {
+                m_snapshotStream << now.GetNanoSeconds() << "," << flowI->first << ","
+                                 << delta.txPackets << "," << delta.txBytes << ","
+                                 << delta.rxPackets << "," << delta.rxBytes << ","
+                                 << delta.lostPackets << "," << delta.timesForwarded << ","
+                                 << delta.delaySum.GetNanoSeconds() << ","
+                                 << delta.jitterSum.GetNanoSeconds() << "\n";
+            }
+            else
+            {
+                WriteLittleEndian(m_snapshotStream, now.GetNanoSeconds(), 8);
+                WriteLittleEndian(m_snapshotStream, delta.txBytes, 8);
+                WriteLittleEndian(m_snapshotStream, delta.rxBytes, 8);
+                WriteLittleEndian(m_snapshotStream, delta.delaySum.GetNanoSeconds(), 8);
+                WriteLittleEndian(m_snapshotStream, delta.jitterSum.GetNanoSeconds(), 8);
+                WriteLittleEndian(m_snapshotStream, flowI->first, 4);
+                WriteLittleEndian(m_snapshotStream, delta.txPackets, 4);
+                WriteLittleEndian(m_snapshotStream, delta.rxPackets, 4);
+                WriteLittleEndian(m_snapshotStream, delta.lostPackets, 4);
+                WriteLittleEndian(m_snapshotStream, delta.timesForwarded, 4);
+            }
+
+            exported.txPackets = stats.txPackets;
+            exported.txBytes = stats.txBytes;
+            exported.rxPackets = stats.rxPackets;
+            exported.rxBytes = stats.rxBytes;
+            exported.lostPackets = stats.lostPackets;
+            exported.timesForwarded = stats.timesForwarded;
+            exported.delaySum = stats.delaySum;
+            exported.jitterSum = stats.jitterSum;
+        }
+
+        // a flow whose packets are still in flight is kept until they are
+        // received, dropped or counted as lost
+        Time lastActivity = std::max(stats.timeLastTxPacket, stats.timeLastRxPacket);
+        if (m_idleFlowTimeout.IsStrictlyPositive() && now - lastActivity > m_idleFlowTimeout &&
+            entry->second.trackedPackets == 0)
+        {
+            // the statistics of the flow have been written, forget the flow
+            m_flowIndex.erase(entry);
+            flowI = m_flowStats.erase(flowI);
+            nEvicted++;
+        }
+        else
+        {
+            flowI++;
+        }
+    }
+    m_snapshotStream.flush();
+    NS_LOG_DEBUG("Snapshot written, " << nEvicted << " idle flows removed, "
+                                      << m_flowStats.size() << " flows left");
+}
+
 void
 FlowMonitor::NotifyConstructionCompleted()
 {
     Object::NotifyConstructionCompleted();
     Simulator::Schedule(PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
+    if (m_snapshotInterval.IsStrictlyPositive())
+    {
+        m_snapshotEvent =
+            Simulator::Schedule(m_snapshotInterval, &FlowMonitor::PeriodicWriteSnapshot, this);
+    }
 }
 
 void
@@ -419,6 +692,10 @@ FlowMonitor::StopRightNow()
     }
     m_enabled = false;
     CheckForLostPackets();
+    if (m_snapshotInterval.IsStrictlyPositive())
+    {
+        WriteSnapshot();
+    }
 }
 
 void
@@ -553,6 +830,10 @@ FlowMonitor::ResetAllStats()
         flowStat.packetSizeHistogram.Clear();
         flowStat.flowInterruptionsHistogram.Clear();
     }
+    for (auto& iter : m_flowIndex)
+    {
+        iter.second.exported = FlowCounters();
+    }
 }
 
 } // namespace ns3
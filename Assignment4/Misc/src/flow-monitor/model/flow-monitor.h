@@ -29,7 +29,11 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 
+#include <deque>
+#include <fstream>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -47,10 +51,23 @@ namespace ns3
  * The FlowMonitor class is responsible for coordinating efforts
  * regarding probes, and collects end-to-end flow statistics.
  *
+ * The statistics can also be streamed during the simulation: if the
+ * SnapshotInterval attribute is not zero, the statistics collected in each
+ * interval by each active flow are periodically appended to the SnapshotFile,
+ * in CSV or binary format, and the flows idle for longer than the
+ * IdleFlowTimeout attribute are removed from the flow table, so that the
+ * memory used by the monitor is bounded by the number of active flows.
  */
 class FlowMonitor : public Object
 {
   public:
+    /// Format of the snapshots
+    enum SnapshotFormat
+    {
+        SNAPSHOT_CSV,    //!< one line of comma separated values per flow
+        SNAPSHOT_BINARY, //!< one fixed size little endian record per flow
+    };
+
     /// \brief Structure that represents the measured metrics of an individual packet flow
     struct FlowStats
     {
@@ -277,6 +294,12 @@ class FlowMonitor : public Object
     /// Reset all the statistics
     void ResetAllStats();
 
+    /// Append to the snapshot file the statistics collected by each flow
+    /// since the previous snapshot, then remove the idle flows from the
+    /// flow table.  This method is called every SnapshotInterval, and when
+    /// the monitoring stops.
+    void WriteSnapshot();
+
   protected:
     void NotifyConstructionCompleted() override;
     void DoDispose() override;
@@ -290,15 +313,56 @@ class FlowMonitor : public Object
         uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
     };
 
+    /// Counters of a flow, as they were when the last snapshot was written
+    struct FlowCounters
+    {
+        uint64_t txBytes{0};        //!< transmitted bytes
+        uint64_t rxBytes{0};        //!< received bytes
+        uint32_t txPackets{0};      //!< transmitted packets
+        uint32_t rxPackets{0};      //!< received packets
+        uint32_t lostPackets{0};    //!< lost packets
+        uint32_t timesForwarded{0}; //!< times the received packets were forwarded
+        Time delaySum;              //!< sum of the delays of the received packets
+        Time jitterSum;             //!< sum of the jitters of the received packets
+    };
+
+    /// Entry of the flow table index
+    struct FlowEntry
+    {
+        FlowStatsContainerI stats;  //!< the statistics of the flow in m_flowStats
+        FlowCounters exported;      //!< the counters written by the last snapshot
+        uint32_t trackedPackets{0}; //!< the number of packets of the flow in m_trackedPackets
+    };
+
     /// FlowId --> FlowStats
     FlowStatsContainer m_flowStats;
 
-    /// (FlowId,PacketId) --> TrackedPacket
-    typedef std::map<std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+    /// FlowId --> FlowEntry, the hash index of m_flowStats
+    std::unordered_map<FlowId, FlowEntry> m_flowIndex;
+
+    /// (FlowId << 32 | PacketId) --> TrackedPacket
+    typedef std::unordered_map<uint64_t, TrackedPacket> TrackedPacketMap;
     TrackedPacketMap m_trackedPackets; //!< Tracked packets
     Time m_maxPerHopDelay;             //!< Minimum per-hop delay
     FlowProbeContainer m_flowProbes;   //!< all the FlowProbes
 
+    /**
+     * Timing wheel of the tracked packets, whose slot i holds the keys of the
+     * packets last seen in the interval [(m_wheelStart + i) * w, (m_wheelStart
+     * + i + 1) * w), w being the periodic check interval.  A packet seen again
+     * stays in its slot until the slot is swept, when it is moved to the slot
+     * of the time it was last seen.  Packets no longer tracked are skipped.
+     */
+    std::deque<std::vector<uint64_t>> m_wheel;
+    int64_t m_wheelStart{0}; //!< index of the interval of the first slot of the wheel
+
+    Time m_snapshotInterval;         //!< interval between snapshots (zero to disable them)
+    std::string m_snapshotFile;      //!< name of the snapshot file
+    SnapshotFormat m_snapshotFormat; //!< format of the snapshots
+    Time m_idleFlowTimeout;          //!< time after which an idle flow is removed
+    std::ofstream m_snapshotStream;  //!< the snapshot file, opened by the first snapshot
+    EventId m_snapshotEvent;         //!< next periodic snapshot
+
     // note: this is needed only for serialization
     std::list<Ptr<FlowClassifier>> m_classifiers; //!< the FlowClassifiers
 
@@ -311,13 +375,37 @@ class FlowMonitor : public Object
     double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
     Time m_flowInterruptionsMinTime;    //!< Flow interruptions minimum time
 
-    /// Get the stats for a given flow
+    /// Get the entry of a given flow, adding the flow if it is not in the flow table
+    /// \param flowId the Flow identification
+    /// \returns the entry of the flow
+    FlowEntry& GetFlowEntry(FlowId flowId);
+
+    /// Find the entry of a given flow
     /// \param flowId the Flow identification
-    /// \returns the stats of the flow
-    FlowStats& GetStatsForFlow(FlowId flowId);
+    /// \returns the entry of the flow, or nullptr if the flow is not in the flow table
+    FlowEntry* FindFlowEntry(FlowId flowId);
+
+    /// Add a tracked packet to the slot of the timing wheel of the time it was last seen
+    /// \param key the key of the packet in m_trackedPackets
+    /// \param lastSeenTime the time the packet was last seen
+    void AddToWheel(uint64_t key, Time lastSeenTime);
+
+    /// Count as lost the tracked packets last seen before a given time
+    /// \param threshold the packets last seen at or before this time are lost
+    /// \param exact if false, only sweep the slots of the timing wheel that
+    ///        ended before the threshold, leaving the other lost packets to a
+    ///        later sweep
+    void SweepLostPackets(Time threshold, bool exact);
+
+    /// Count a tracked packet as lost, and stop tracking it
+    /// \param tracked the packet in m_trackedPackets
+    void LosePacket(TrackedPacketMap::iterator tracked);
 
     /// Periodic function to check for lost packets and prune statistics
     void PeriodicCheckForLostPackets();
+
+    /// Periodic function to write the snapshots
+    void PeriodicWriteSnapshot();
 };
 
 } // namespace ns3
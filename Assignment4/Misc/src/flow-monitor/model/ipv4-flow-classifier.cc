@@ -95,6 +95,26 @@ Ipv4FlowClassifier::Ipv4FlowClassifier()
 {
 }
 
+uint32_t
+Ipv4FlowClassifier::Hash(const FiveTuple& tuple)
+{
+    uint64_t addresses = (static_cast<uint64_t>(tuple.sourceAddress.Get()) << 32) |
+                         tuple.destinationAddress.Get();
+    uint64_t ports = (static_cast<uint64_t>(tuple.protocol) << 32) |
+                     (static_cast<uint64_t>(tuple.sourcePort) << 16) | tuple.destinationPort;
+    return static_cast<uint32_t>(FlowIdTable::Combine(FlowIdTable::Combine(0, addresses), ports));
+}
+
+const Ipv4FlowClassifier::Flow&
+Ipv4FlowClassifier::GetFlow(FlowId flowId) const
+{
+    if (flowId == 0 || flowId > m_flows.size())
+    {
+        NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
+    }
+    return m_flows[flowId - 1];
+}
+
 bool
 Ipv4FlowClassifier::Classify(const Ipv4Header& ipHeader,
                              Ptr<const Packet> ipPayload,
@@ -144,35 +164,41 @@ Ipv4FlowClassifier::Classify(const Ipv4Header& ipHeader,
     tuple.sourcePort = srcPort;
     tuple.destinationPort = dstPort;
 
-    // try to insert the tuple, but check if it already exists
-    auto insert = m_flowMap.insert(std::pair<FiveTuple, FlowId>(tuple, 0));
-
-    // if the insertion succeeded, we need to assign this tuple a new flow identifier
-    if (insert.second)
+    // look for the tuple, and assign it a new flow identifier if it is not found
+    uint32_t hash = Hash(tuple);
+    FlowId flowId = m_flowTable.Find(hash, [this, &tuple](FlowId id) {
+        return m_flows[id - 1].tuple == tuple;
+    });
+    if (flowId == 0)
     {
-        FlowId newFlowId = GetNewFlowId();
-        insert.first->second = newFlowId;
-        m_flowPktIdMap[newFlowId] = 0;
-        m_flowDscpMap[newFlowId];
+        flowId = GetNewFlowId();
+        NS_ASSERT(flowId == m_flows.size() + 1);
+        m_flows.push_back(Flow{tuple, 0, {}});
+        m_flowTable.Insert(hash, flowId);
     }
     else
     {
-        m_flowPktIdMap[insert.first->second]++;
+        m_flows[flowId - 1].lastPacketId++;
     }
+    Flow& flow = m_flows[flowId - 1];
 
-    // increment the counter of packets with the same DSCP value
+    // increment the counter of packets with the same DSCP value (flows seldom use
+    // more than one or two DSCP values)
     Ipv4Header::DscpType dscp = ipHeader.GetDscp();
-    auto dscpInserter = m_flowDscpMap[insert.first->second].insert(
-        std::pair<Ipv4Header::DscpType, uint32_t>(dscp, 1));
-
-    // if the insertion did not succeed, we need to increment the counter
-    if (!dscpInserter.second)
+    auto dscpCount = std::find_if(flow.dscpCounts.begin(),
+                                  flow.dscpCounts.end(),
+                                  [dscp](const auto& count) { return count.first == dscp; });
+    if (dscpCount == flow.dscpCounts.end())
+    {
+        flow.dscpCounts.emplace_back(dscp, 1);
+    }
+    else
     {
-        m_flowDscpMap[insert.first->second][dscp]++;
+        dscpCount->second++;
     }
 
-    *out_flowId = insert.first->second;
-    *out_packetId = m_flowPktIdMap[*out_flowId];
+    *out_flowId = flowId;
+    *out_packetId = flow.lastPacketId;
 
     return true;
 }
@@ -180,16 +206,7 @@ Ipv4FlowClassifier::Classify(const Ipv4Header& ipHeader,
 Ipv4FlowClassifier::FiveTuple
 Ipv4FlowClassifier::FindFlow(FlowId flowId) const
 {
-    for (auto iter = m_flowMap.begin(); iter != m_flowMap.end(); iter++)
-    {
-        if (iter->second == flowId)
-        {
-            return iter->first;
-        }
-    }
-    NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
-    FiveTuple retval = {Ipv4Address::GetZero(), Ipv4Address::GetZero(), 0, 0, 0};
-    return retval;
+    return GetFlow(flowId).tuple;
 }
 
 bool
@@ -202,16 +219,10 @@ Ipv4FlowClassifier::SortByCount::operator()(std::pair<Ipv4Header::DscpType, uint
 std::vector<std::pair<Ipv4Header::DscpType, uint32_t>>
 Ipv4FlowClassifier::GetDscpCounts(FlowId flowId) const
 {
-    auto flow = m_flowDscpMap.find(flowId);
-
-    if (flow == m_flowDscpMap.end())
-    {
-        NS_FATAL_ERROR("Could not find the flow with ID " << flowId);
-    }
-
-    std::vector<std::pair<Ipv4Header::DscpType, uint32_t>> v(flow->second.begin(),
-                                                             flow->second.end());
-    std::sort(v.begin(), v.end(), SortByCount());
+    std::vector<std::pair<Ipv4Header::DscpType, uint32_t>> v = GetFlow(flowId).dscpCounts;
+    // the DSCP values with the same count are sorted in increasing order
+    std::sort(v.begin(), v.end());
+    std::stable_sort(v.begin(), v.end(), SortByCount());
     return v;
 }
 
@@ -221,28 +232,36 @@ Ipv4FlowClassifier::SerializeToXmlStream(std::ostream& os, uint16_t indent) cons
     Indent(os, indent);
     os << "<Ipv4FlowClassifier>\n";
 
+    // write the flows in the order of their five-tuples
+    std::vector<FlowId> flowIds(m_flows.size());
+    for (std::size_t i = 0; i < flowIds.size(); i++)
+    {
+        flowIds[i] = i + 1;
+    }
+    std::sort(flowIds.begin(), flowIds.end(), [this](FlowId a, FlowId b) {
+        return m_flows[a - 1].tuple < m_flows[b - 1].tuple;
+    });
+
     indent += 2;
-    for (auto iter = m_flowMap.begin(); iter != m_flowMap.end(); iter++)
+    for (FlowId flowId : flowIds)
     {
+        const Flow& flow = m_flows[flowId - 1];
         Indent(os, indent);
-        os << "<Flow flowId=\"" << iter->second << "\""
-           << " sourceAddress=\"" << iter->first.sourceAddress << "\""
-           << " destinationAddress=\"" << iter->first.destinationAddress << "\""
-           << " protocol=\"" << int(iter->first.protocol) << "\""
-           << " sourcePort=\"" << iter->first.sourcePort << "\""
-           << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
+        os << "<Flow flowId=\"" << flowId << "\""
+           << " sourceAddress=\"" << flow.tuple.sourceAddress << "\""
+           << " destinationAddress=\"" << flow.tuple.destinationAddress << "\""
+           << " protocol=\"" << int(flow.tuple.protocol) << "\""
+           << " sourcePort=\"" << flow.tuple.sourcePort << "\""
+           << " destinationPort=\"" << flow.tuple.destinationPort << "\">\n";
 
         indent += 2;
-        auto flow = m_flowDscpMap.find(iter->second);
-
-        if (flow != m_flowDscpMap.end())
+        auto dscpCounts = flow.dscpCounts;
+        std::sort(dscpCounts.begin(), dscpCounts.end());
+        for (auto i = dscpCounts.begin(); i != dscpCounts.end(); i++)
         {
-            for (auto i = flow->second.begin(); i != flow->second.end(); i++)
-            {
-                Indent(os, indent);
-                os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t>(i->first) << "\""
-                   << " packets=\"" << std::dec << i->second << "\" />\n";
-            }
+            Indent(os, indent);
+            os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t>(i->first) << "\""
+               << " packets=\"" << std::dec << i->second << "\" />\n";
         }
 
         indent -= 2;
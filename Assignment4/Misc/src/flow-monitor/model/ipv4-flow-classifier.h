@@ -24,8 +24,8 @@
 
 #include "ns3/ipv4-header.h"
 
-#include <map>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -93,12 +93,31 @@ class Ipv4FlowClassifier : public FlowClassifier
     void SerializeToXmlStream(std::ostream& os, uint16_t indent) const override;
 
   private:
-    /// Map to Flows Identifiers to FlowIds
-    std::map<FiveTuple, FlowId> m_flowMap;
-    /// Map to FlowIds to FlowPacketId
-    std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-    /// Map FlowIds to (DSCP value, packet count) pairs
-    std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t>> m_flowDscpMap;
+    /// A flow
+    struct Flow
+    {
+        FiveTuple tuple;           //!< the five-tuple of the flow
+        FlowPacketId lastPacketId; //!< the packet identifier of the last packet
+        /// (DSCP value, packet count) pairs, in order of appearance of the DSCP values
+        std::vector<std::pair<Ipv4Header::DscpType, uint32_t>> dscpCounts;
+    };
+
+    /**
+     * \param tuple a five-tuple
+     * \return the hash of the five-tuple
+     */
+    static uint32_t Hash(const FiveTuple& tuple);
+
+    /**
+     * \param flowId a FlowId
+     * \return the flow with the given FlowId
+     */
+    const Flow& GetFlow(FlowId flowId) const;
+
+    /// Index of the flows by the hash of their five-tuple
+    FlowIdTable m_flowTable;
+    /// The flows, the flow with FlowId i being at position i - 1
+    std::vector<Flow> m_flows;
 };
 
 /**
@@ -24,11 +24,15 @@
 
 #include "ns3/config.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/gso-tag.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace ns3
 {
 
@@ -243,6 +247,43 @@ Ipv4FlowProbeTag::IsSrcDstValid(Ipv4Address src, Ipv4Address dst) const
     return ((m_src == src) && (m_dst == dst));
 }
 
+/**
+ * \ingroup flow-monitor
+ *
+ * \brief Get the flow probe tags of a packet
+ *
+ * A packet carries a single tag, but for a GSO batch, which carries one on
+ * the payload of each of its segments.
+ *
+ * \param packet The packet.
+ * \return The tags, one per packet id.
+ */
+static std::vector<Ipv4FlowProbeTag>
+GetFlowProbeTags(Ptr<const Packet> packet)
+{
+    std::vector<Ipv4FlowProbeTag> tags;
+    ByteTagIterator it = packet->GetByteTagIterator();
+    while (it.HasNext())
+    {
+        ByteTagIterator::Item item = it.Next();
+        if (item.GetTypeId() != Ipv4FlowProbeTag::GetTypeId())
+        {
+            continue;
+        }
+        Ipv4FlowProbeTag tag;
+        item.GetTag(tag);
+        // The fragments of a reassembled packet carry the same tag
+        if (std::none_of(tags.begin(), tags.end(), [&tag](const Ipv4FlowProbeTag& other) {
+                return other.GetFlowId() == tag.GetFlowId() &&
+                       other.GetPacketId() == tag.GetPacketId();
+            }))
+        {
+            tags.push_back(tag);
+        }
+    }
+    return tags;
+}
+
 ////////////////////////////////////////
 // Ipv4FlowProbe class implementation //
 ////////////////////////////////////////
@@ -344,6 +385,34 @@ Ipv4FlowProbe::SendOutgoingLogger(const Ipv4Header& ipHeader,
 
     if (m_classifier->Classify(ipHeader, ipPayload, &flowId, &packetId))
     {
+        GsoTag gsoTag;
+        if (ipPayload->PeekPacketTag(gsoTag) && gsoTag.GetSegments() > 1)
+        {
+            // The batch is split into segments further down the stack: report
+            // each segment, and tag the bytes of its payload, which it keeps
+            uint32_t headerSize = gsoTag.GetHeaderSize();
+            uint32_t end = ipPayload->GetSize();
+            for (uint32_t offset = headerSize; offset < end; offset += gsoTag.GetSegmentSize())
+            {
+                if (offset > headerSize)
+                {
+                    m_classifier->Classify(ipHeader, ipPayload, &flowId, &packetId);
+                }
+                uint32_t segmentSize = std::min<uint32_t>(gsoTag.GetSegmentSize(), end - offset);
+                uint32_t size = ipHeader.GetSerializedSize() + headerSize + segmentSize;
+                NS_LOG_DEBUG("ReportFirstTx (" << this << ", " << flowId << ", " << packetId
+                                               << ", " << size << "); segment of " << ipHeader);
+                m_flowMonitor->ReportFirstTx(this, flowId, packetId, size);
+                Ipv4FlowProbeTag fTag(flowId,
+                                      packetId,
+                                      size,
+                                      ipHeader.GetSource(),
+                                      ipHeader.GetDestination());
+                ipPayload->AddByteTag(fTag, offset, offset + segmentSize);
+            }
+            return;
+        }
+
         uint32_t size = (ipPayload->GetSize() + ipHeader.GetSerializedSize());
         NS_LOG_DEBUG("ReportFirstTx (" << this << ", " << flowId << ", " << packetId << ", " << size
                                        << "); " << ipHeader << *ipPayload);
@@ -442,15 +511,15 @@ Ipv4FlowProbe::DropLogger(const Ipv4Header& ipHeader,
     }
 #endif
 
-    Ipv4FlowProbeTag fTag;
-    bool found = ipPayload->FindFirstMatchingByteTag(fTag);
-
-    if (found)
+    std::vector<Ipv4FlowProbeTag> tags = GetFlowProbeTags(ipPayload);
+    for (const auto& fTag : tags)
     {
         FlowId flowId = fTag.GetFlowId();
         FlowPacketId packetId = fTag.GetPacketId();
 
-        uint32_t size = (ipPayload->GetSize() + ipHeader.GetSerializedSize());
+        // The segments of a GSO batch have the sizes in their tags
+        uint32_t size = tags.size() > 1 ? fTag.GetPacketSize()
+                                        : (ipPayload->GetSize() + ipHeader.GetSerializedSize());
         NS_LOG_DEBUG("Drop (" << this << ", " << flowId << ", " << packetId << ", " << size << ", "
                               << reason << ", destIp=" << ipHeader.GetDestination() << "); "
                               << "HDR: " << ipHeader << " PKT: " << *ipPayload);
@@ -496,43 +565,33 @@ Ipv4FlowProbe::DropLogger(const Ipv4Header& ipHeader,
 void
 Ipv4FlowProbe::QueueDropLogger(Ptr<const Packet> ipPayload)
 {
-    Ipv4FlowProbeTag fTag;
-    bool tagFound = ipPayload->FindFirstMatchingByteTag(fTag);
-
-    if (!tagFound)
+    for (const auto& fTag : GetFlowProbeTags(ipPayload))
     {
-        return;
-    }
-
-    FlowId flowId = fTag.GetFlowId();
-    FlowPacketId packetId = fTag.GetPacketId();
-    uint32_t size = fTag.GetPacketSize();
+        FlowId flowId = fTag.GetFlowId();
+        FlowPacketId packetId = fTag.GetPacketId();
+        uint32_t size = fTag.GetPacketSize();
 
-    NS_LOG_DEBUG("Drop (" << this << ", " << flowId << ", " << packetId << ", " << size << ", "
-                          << DROP_QUEUE << "); ");
+        NS_LOG_DEBUG("Drop (" << this << ", " << flowId << ", " << packetId << ", " << size
+                              << ", " << DROP_QUEUE << "); ");
 
-    m_flowMonitor->ReportDrop(this, flowId, packetId, size, DROP_QUEUE);
+        m_flowMonitor->ReportDrop(this, flowId, packetId, size, DROP_QUEUE);
+    }
 }
 
 void
 Ipv4FlowProbe::QueueDiscDropLogger(Ptr<const QueueDiscItem> item)
 {
-    Ipv4FlowProbeTag fTag;
-    bool tagFound = item->GetPacket()->FindFirstMatchingByteTag(fTag);
-
-    if (!tagFound)
+    for (const auto& fTag : GetFlowProbeTags(item->GetPacket()))
     {
-        return;
-    }
-
-    FlowId flowId = fTag.GetFlowId();
-    FlowPacketId packetId = fTag.GetPacketId();
-    uint32_t size = fTag.GetPacketSize();
+        FlowId flowId = fTag.GetFlowId();
+        FlowPacketId packetId = fTag.GetPacketId();
+        uint32_t size = fTag.GetPacketSize();
 
-    NS_LOG_DEBUG("Drop (" << this << ", " << flowId << ", " << packetId << ", " << size << ", "
-                          << DROP_QUEUE_DISC << "); ");
+        NS_LOG_DEBUG("Drop (" << this << ", " << flowId << ", " << packetId << ", " << size
+                              << ", " << DROP_QUEUE_DISC << "); ");
 
-    m_flowMonitor->ReportDrop(this, flowId, packetId, size, DROP_QUEUE_DISC);
+        m_flowMonitor->ReportDrop(this, flowId, packetId, size, DROP_QUEUE_DISC);
+    }
 }
 
 } // namespace ns3
@@ -0,0 +1,702 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-flow-classifier.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup flow-monitor-test
+ * FlowMonitor test suite.
+ */
+
+/**
+ * \ingroup flow-monitor
+ * \defgroup flow-monitor-test FlowMonitor module tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief A probe reporting the packet events scheduled by the tests.
+ */
+class FlowMonitorTestProbe : public FlowProbe
+{
+  public:
+    /**
+     * Constructor.
+     * \param monitor The monitor.
+     */
+    FlowMonitorTestProbe(Ptr<FlowMonitor> monitor)
+        : FlowProbe(monitor)
+    {
+    }
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::FlowMonitorTestProbe").SetParent<FlowProbe>().SetGroupName("Test");
+        return tid;
+    }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief Check the packets counted as lost by CheckForLostPackets() and by
+ * the periodic check.
+ */
+class FlowMonitorLostPacketsTestCase : public TestCase
+{
+  public:
+    FlowMonitorLostPacketsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check the number of packets lost by a flow.
+     * \param flowId The flow.
+     * \param lostPackets The expected number of lost packets.
+     */
+    void CheckLost(FlowId flowId, uint32_t lostPackets);
+
+    Ptr<FlowMonitor> m_monitor; //!< The monitor
+};
+
+FlowMonitorLostPacketsTestCase::FlowMonitorLostPacketsTestCase()
+    : TestCase("Check the packets counted as lost")
+{
+}
+
+void
+FlowMonitorLostPacketsTestCase::CheckLost(FlowId flowId, uint32_t lostPackets)
+{
+    const auto& stats = m_monitor->GetFlowStats();
+    auto flow = stats.find(flowId);
+    NS_TEST_ASSERT_MSG_EQ((flow != stats.end()), true, "Flow " << flowId << " not found");
+    NS_TEST_EXPECT_MSG_EQ(flow->second.lostPackets,
+                          lostPackets,
+                          "Wrong number of packets lost by flow " << flowId << " at "
+                                                                  << Simulator::Now().As(Time::S));
+}
+
+void
+FlowMonitorLostPacketsTestCase::DoRun()
+{
+    m_monitor = CreateObjectWithAttributes<FlowMonitor>("MaxPerHopDelay",
+                                                        TimeValue(Seconds(2)));
+    Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe>(m_monitor);
+    auto schedule = [this, probe](double time, auto report, FlowId flowId, FlowPacketId id) {
+        Simulator::Schedule(Seconds(time), report, m_monitor, probe, flowId, id, 100);
+    };
+
+    // Packets lost when CheckForLostPackets(maxDelay) is called
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 1, 1);
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 1, 2);
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 1, 3);
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 2, 1);
+    schedule(0.6, &FlowMonitor::ReportLastRx, 1, 1);
+    schedule(0.7, &FlowMonitor::ReportForwarding, 1, 2);
+    Simulator::Schedule(Seconds(2.55), [this]() {
+        m_monitor->CheckForLostPackets(Seconds(2));
+        CheckLost(1, 1);
+        CheckLost(2, 1);
+    });
+    Simulator::Schedule(Seconds(2.75), [this]() {
+        m_monitor->CheckForLostPackets(Seconds(2));
+        CheckLost(1, 2);
+    });
+
+    // A packet lost when the periodic check sweeps its second, which ends
+    // at 4 s, MaxPerHopDelay later
+    schedule(3.2, &FlowMonitor::ReportFirstTx, 3, 1);
+    Simulator::Schedule(Seconds(5.5), &FlowMonitorLostPacketsTestCase::CheckLost, this, 3, 0);
+    Simulator::Schedule(Seconds(6.5), &FlowMonitorLostPacketsTestCase::CheckLost, this, 3, 1);
+
+    // The drops of unknown flows are ignored
+    Simulator::Schedule(Seconds(0.5),
+                        &FlowMonitor::ReportDrop,
+                        m_monitor,
+                        probe,
+                        4,
+                        1,
+                        100,
+                        0);
+
+    Simulator::Stop(Seconds(7));
+    Simulator::Run();
+
+    CheckLost(1, 2);
+    CheckLost(2, 1);
+    CheckLost(3, 1);
+    NS_TEST_EXPECT_MSG_EQ(m_monitor->GetFlowStats().size(), 3, "Drop of unknown flow added");
+
+    m_monitor->Dispose();
+    m_monitor = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief Check the snapshots of the flow statistics, and the removal of the
+ * idle flows.
+ */
+class FlowMonitorSnapshotTestCase : public TestCase
+{
+  public:
+    FlowMonitorSnapshotTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check the flows in the flow table.
+     * \param flowIds The expected flows.
+     */
+    void CheckFlows(std::vector<FlowId> flowIds);
+
+    Ptr<FlowMonitor> m_monitor; //!< The monitor
+};
+
+FlowMonitorSnapshotTestCase::FlowMonitorSnapshotTestCase()
+    : TestCase("Check the snapshots and the removal of the idle flows")
+{
+}
+
+void
+FlowMonitorSnapshotTestCase::CheckFlows(std::vector<FlowId> flowIds)
+{
+    std::vector<FlowId> found;
+    for (const auto& flow : m_monitor->GetFlowStats())
+    {
+        found.push_back(flow.first);
+    }
+    NS_TEST_EXPECT_MSG_EQ((found == flowIds),
+                          true,
+                          "Wrong flows in the flow table at " << Simulator::Now().As(Time::S));
+}
+
+void
+FlowMonitorSnapshotTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("flow-monitor-snapshots.csv");
+    m_monitor = CreateObjectWithAttributes<FlowMonitor>("MaxPerHopDelay",
+                                                        TimeValue(Seconds(2)),
+                                                        "SnapshotInterval",
+                                                        TimeValue(Seconds(0.7)),
+                                                        "SnapshotFile",
+                                                        StringValue(fileName),
+                                                        "IdleFlowTimeout",
+                                                        TimeValue(Seconds(1)));
+    Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe>(m_monitor);
+    auto schedule = [this, probe](double time, auto report, FlowId flowId, FlowPacketId id) {
+        Simulator::Schedule(Seconds(time), report, m_monitor, probe, flowId, id, 100);
+    };
+
+    // Flow 1 receives its packets, and is removed once idle
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 1, 1);
+    schedule(0.6, &FlowMonitor::ReportLastRx, 1, 1);
+    schedule(1.5, &FlowMonitor::ReportFirstTx, 1, 2);
+    schedule(1.6, &FlowMonitor::ReportLastRx, 1, 2);
+    // Flow 2 loses its packet, and is kept until the periodic check at 3 s
+    // counts it as lost
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 2, 1);
+    // Flow 3 is idle for longer than the timeout while its packet is in flight
+    schedule(0.5, &FlowMonitor::ReportFirstTx, 3, 1);
+    schedule(2.5, &FlowMonitor::ReportLastRx, 3, 1);
+
+    // Snapshots at 0.7 s, 1.4 s, 2.1 s, 2.8 s, 3.5 s, 4.2 s and 4.9 s
+    Simulator::Schedule(Seconds(2.3),
+                        &FlowMonitorSnapshotTestCase::CheckFlows,
+                        this,
+                        std::vector<FlowId>{1, 2, 3});
+    Simulator::Schedule(Seconds(2.6), [this]() {
+        const auto& flow = m_monitor->GetFlowStats().at(3);
+        NS_TEST_EXPECT_MSG_EQ(flow.txPackets, 1, "Statistics of flow 3 lost");
+        NS_TEST_EXPECT_MSG_EQ(flow.rxPackets, 1, "Packet of flow 3 not received");
+    });
+    Simulator::Schedule(Seconds(3),
+                        &FlowMonitorSnapshotTestCase::CheckFlows,
+                        this,
+                        std::vector<FlowId>{2, 3});
+    Simulator::Schedule(Seconds(3.6),
+                        &FlowMonitorSnapshotTestCase::CheckFlows,
+                        this,
+                        std::vector<FlowId>{3});
+    Simulator::Schedule(Seconds(4.3),
+                        &FlowMonitorSnapshotTestCase::CheckFlows,
+                        this,
+                        std::vector<FlowId>{});
+
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+
+    // Sum the records of each flow: time,flowId,txPackets,txBytes,rxPackets,
+    // rxBytes,lostPackets,timesForwarded,delaySum,jitterSum
+    std::ifstream file(fileName);
+    std::string line;
+    std::getline(file, line);
+    NS_TEST_ASSERT_MSG_EQ(line.substr(0, 12), "time,flowId,", "Wrong header");
+    std::map<FlowId, std::vector<int64_t>> sums;
+    std::map<FlowId, uint32_t> records;
+    while (std::getline(file, line))
+    {
+        std::istringstream record(line);
+        std::vector<int64_t> values;
+        std::string value;
+        while (std::getline(record, value, ','))
+        {
+            values.push_back(std::stoll(value));
+        }
+        NS_TEST_ASSERT_MSG_EQ(values.size(), 10, "Wrong record " << line);
+        auto& sum = sums[values[1]];
+        sum.resize(10, 0);
+        for (std::size_t i = 2; i < values.size(); ++i)
+        {
+            sum[i] += values[i];
+        }
+        records[values[1]]++;
+    }
+
+    // Flow 1 has a record at 0.7 s and at 2.1 s
+    NS_TEST_EXPECT_MSG_EQ(records[1], 2, "Wrong number of records of flow 1");
+    NS_TEST_EXPECT_MSG_EQ(sums[1][2], 2, "Wrong txPackets of flow 1");
+    NS_TEST_EXPECT_MSG_EQ(sums[1][3], 200, "Wrong txBytes of flow 1");
+    NS_TEST_EXPECT_MSG_EQ(sums[1][4], 2, "Wrong rxPackets of flow 1");
+    NS_TEST_EXPECT_MSG_EQ(sums[1][6], 0, "Wrong lostPackets of flow 1");
+    NS_TEST_EXPECT_MSG_EQ(sums[1][8], 200000000, "Wrong delaySum of flow 1");
+    // Flow 2 has a record at 0.7 s, and one at 3.5 s for its lost packet
+    NS_TEST_EXPECT_MSG_EQ(records[2], 2, "Wrong number of records of flow 2");
+    NS_TEST_EXPECT_MSG_EQ(sums[2][2], 1, "Wrong txPackets of flow 2");
+    NS_TEST_EXPECT_MSG_EQ(sums[2][4], 0, "Wrong rxPackets of flow 2");
+    NS_TEST_EXPECT_MSG_EQ(sums[2][6], 1, "Wrong lostPackets of flow 2");
+    // Flow 3 has a record at 0.7 s, and one at 2.8 s for its received packet
+    NS_TEST_EXPECT_MSG_EQ(records[3], 2, "Wrong number of records of flow 3");
+    NS_TEST_EXPECT_MSG_EQ(sums[3][2], 1, "Wrong txPackets of flow 3");
+    NS_TEST_EXPECT_MSG_EQ(sums[3][4], 1, "Wrong rxPackets of flow 3");
+    NS_TEST_EXPECT_MSG_EQ(sums[3][6], 0, "Wrong lostPackets of flow 3");
+    NS_TEST_EXPECT_MSG_EQ(sums[3][8], 2000000000, "Wrong delaySum of flow 3");
+
+    m_monitor->Dispose();
+    m_monitor = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief Check the flow ids, the five-tuples and the DSCP counts of the IPv4
+ * and IPv6 classifiers, with enough flows to grow their table several times.
+ */
+class FlowClassifierTestCase : public TestCase
+{
+  public:
+    FlowClassifierTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Classify the packets of the flows, and check the classifier.
+     * \tparam Classifier The classifier type.
+     * \tparam Header The IP header type.
+     * \param classifier The classifier.
+     */
+    template <typename Classifier, typename Header>
+    void CheckClassifier(Classifier& classifier);
+
+    /**
+     * Set the addresses and the protocol of a packet of a flow.
+     * \param header The IPv4 header.
+     * \param flow The index of the flow.
+     */
+    static void SetHeader(Ipv4Header& header, uint32_t flow);
+    /**
+     * Set the addresses and the protocol of a packet of a flow.
+     * \param header The IPv6 header.
+     * \param flow The index of the flow.
+     */
+    static void SetHeader(Ipv6Header& header, uint32_t flow);
+    /**
+     * \param flow The index of the flow.
+     * \return The source port of the flow.
+     */
+    static uint16_t GetSourcePort(uint32_t flow);
+    /**
+     * \param flow The index of the flow.
+     * \return The protocol of the flow.
+     */
+    static uint8_t GetProtocol(uint32_t flow);
+};
+
+/// Flows classified by the FlowClassifierTestCase, which grow the table of
+/// the classifiers from 64 to 2048 slots
+static const uint32_t CLASSIFIER_TEST_FLOWS = 1000;
+
+FlowClassifierTestCase::FlowClassifierTestCase()
+    : TestCase("Check the flow ids and the DSCP counts of the classifiers")
+{
+}
+
+uint16_t
+FlowClassifierTestCase::GetSourcePort(uint32_t flow)
+{
+    // Groups of four flows only differ by their protocol and source port
+    return 1000 + (flow / 2) % 2;
+}
+
+uint8_t
+FlowClassifierTestCase::GetProtocol(uint32_t flow)
+{
+    return flow % 2 ? 17 : 6;
+}
+
+void
+FlowClassifierTestCase::SetHeader(Ipv4Header& header, uint32_t flow)
+{
+    header.SetSource(Ipv4Address(Ipv4Address("10.0.0.0").Get() + flow / 4));
+    header.SetDestination(Ipv4Address("10.1.0.1"));
+    header.SetProtocol(GetProtocol(flow));
+}
+
+void
+FlowClassifierTestCase::SetHeader(Ipv6Header& header, uint32_t flow)
+{
+    uint8_t source[16] = {0x20, 0x01, 0x0d, 0xb8};
+    source[14] = (flow / 4) >> 8;
+    source[15] = (flow / 4) & 0xff;
+    header.SetSource(Ipv6Address(source));
+    header.SetDestination(Ipv6Address("2001:db8:1::1"));
+    header.SetNextHeader(GetProtocol(flow));
+}
+
+template <typename Classifier, typename Header>
+void
+FlowClassifierTestCase::CheckClassifier(Classifier& classifier)
+{
+    auto classify = [&classifier](uint32_t flow, typename Header::DscpType dscp) {
+        Header header;
+        SetHeader(header, flow);
+        header.SetDscp(dscp);
+        // The ports are read from the first four bytes of the payload
+        uint16_t sourcePort = GetSourcePort(flow);
+        uint8_t ports[4] = {static_cast<uint8_t>(sourcePort >> 8),
+                            static_cast<uint8_t>(sourcePort & 0xff),
+                            0x07,
+                            0xd0};
+        FlowId flowId = 0;
+        FlowPacketId packetId = 0;
+        bool classified = classifier.Classify(header, Create<Packet>(ports, 4), &flowId, &packetId);
+        return std::make_tuple(classified, flowId, packetId);
+    };
+
+    // The new flows get consecutive ids
+    for (uint32_t flow = 0; flow < CLASSIFIER_TEST_FLOWS; flow++)
+    {
+        auto dscp = flow % 2 ? Header::DSCP_CS1 : Header::DscpDefault;
+        NS_TEST_ASSERT_MSG_EQ((classify(flow, dscp) == std::make_tuple(true, flow + 1, 0)),
+                              true,
+                              "Wrong flow id of new flow " << flow);
+    }
+    // The flows keep their id once the table has grown
+    for (uint32_t flow = CLASSIFIER_TEST_FLOWS; flow-- > 0;)
+    {
+        NS_TEST_ASSERT_MSG_EQ((classify(flow, Header::DSCP_AF11) ==
+                               std::make_tuple(true, flow + 1, 1)),
+                              true,
+                              "Wrong flow id of flow " << flow);
+    }
+    for (uint32_t flow = 0; flow < CLASSIFIER_TEST_FLOWS; flow += 3)
+    {
+        auto dscp = flow % 2 ? Header::DSCP_CS1 : Header::DscpDefault;
+        NS_TEST_ASSERT_MSG_EQ((classify(flow, dscp) == std::make_tuple(true, flow + 1, 2)),
+                              true,
+                              "Wrong flow id of flow " << flow);
+    }
+
+    for (uint32_t flow = 0; flow < CLASSIFIER_TEST_FLOWS; flow++)
+    {
+        Header header;
+        SetHeader(header, flow);
+        auto tuple = classifier.FindFlow(flow + 1);
+        NS_TEST_EXPECT_MSG_EQ(tuple.sourceAddress,
+                              header.GetSource(),
+                              "Wrong source address of flow " << flow);
+        NS_TEST_EXPECT_MSG_EQ(tuple.destinationAddress,
+                              header.GetDestination(),
+                              "Wrong destination address of flow " << flow);
+        NS_TEST_EXPECT_MSG_EQ(+tuple.protocol,
+                              +GetProtocol(flow),
+                              "Wrong protocol of flow " << flow);
+        NS_TEST_EXPECT_MSG_EQ(tuple.sourcePort,
+                              GetSourcePort(flow),
+                              "Wrong source port of flow " << flow);
+        NS_TEST_EXPECT_MSG_EQ(tuple.destinationPort,
+                              2000,
+                              "Wrong destination port of flow " << flow);
+
+        // Sorted by decreasing count, then by increasing DSCP value
+        auto dscp = flow % 2 ? Header::DSCP_CS1 : Header::DscpDefault;
+        std::vector<std::pair<typename Header::DscpType, uint32_t>> dscpCounts;
+        if (flow % 3 == 0)
+        {
+            dscpCounts = {{dscp, 2}, {Header::DSCP_AF11, 1}};
+        }
+        else
+        {
+            dscpCounts = {{dscp, 1}, {Header::DSCP_AF11, 1}};
+        }
+        NS_TEST_EXPECT_MSG_EQ((classifier.GetDscpCounts(flow + 1) == dscpCounts),
+                              true,
+                              "Wrong DSCP counts of flow " << flow);
+    }
+
+    // The packets of other protocols are not classified
+    Header header;
+    SetHeader(header, 0);
+    header.SetDscp(Header::DscpDefault);
+    uint8_t payload[4] = {};
+    FlowId flowId;
+    FlowPacketId packetId;
+    if constexpr (std::is_same_v<Header, Ipv4Header>)
+    {
+        header.SetProtocol(1);
+    }
+    else
+    {
+        header.SetNextHeader(58);
+    }
+    bool classified = classifier.Classify(header, Create<Packet>(payload, 4), &flowId, &packetId);
+    NS_TEST_EXPECT_MSG_EQ(classified, false, "ICMP packet classified");
+}
+
+void
+FlowClassifierTestCase::DoRun()
+{
+    Ipv4FlowClassifier ipv4Classifier;
+    CheckClassifier<Ipv4FlowClassifier, Ipv4Header>(ipv4Classifier);
+    Ipv6FlowClassifier ipv6Classifier;
+    CheckClassifier<Ipv6FlowClassifier, Ipv6Header>(ipv6Classifier);
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief Check that the segments of the GSO batches sent by TCP are counted
+ * one by one.
+ */
+class FlowMonitorGsoTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param ipv6 Whether to use IPv6 instead of IPv4.
+     */
+    FlowMonitorGsoTestCase(bool ipv6);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Send data while the socket has room for it.
+     * \param socket The socket.
+     * \param available The available room.
+     */
+    void SourceHandleSend(Ptr<Socket> socket, uint32_t available);
+    /**
+     * Accept a connection.
+     * \param socket The accepted socket.
+     * \param from The address of the peer.
+     */
+    void ServerHandleAccept(Ptr<Socket> socket, const Address& from);
+    /**
+     * Read the received data.
+     * \param socket The socket.
+     */
+    void ServerHandleRecv(Ptr<Socket> socket);
+
+    bool m_ipv6;           //!< Whether IPv6 is used
+    uint32_t m_txBytes{0}; //!< Data passed to the source socket
+};
+
+/// Data sent by the FlowMonitorGsoTestCase
+static const uint32_t GSO_TEST_DATA = 200000;
+
+FlowMonitorGsoTestCase::FlowMonitorGsoTestCase(bool ipv6)
+    : TestCase(std::string("Check the statistics of the GSO segments over ") +
+               (ipv6 ? "IPv6" : "IPv4")),
+      m_ipv6(ipv6)
+{
+}
+
+void
+FlowMonitorGsoTestCase::SourceHandleSend(Ptr<Socket> socket, uint32_t available)
+{
+    while (socket->GetTxAvailable() > 0 && m_txBytes < GSO_TEST_DATA)
+    {
+        uint32_t size = std::min<uint32_t>(GSO_TEST_DATA - m_txBytes, socket->GetTxAvailable());
+        int sent = socket->Send(Create<Packet>(std::min<uint32_t>(size, 3000)));
+        NS_TEST_ASSERT_MSG_GT(sent, 0, "Error during send");
+        m_txBytes += sent;
+    }
+    if (m_txBytes == GSO_TEST_DATA)
+    {
+        socket->Close();
+    }
+}
+
+void
+FlowMonitorGsoTestCase::ServerHandleAccept(Ptr<Socket> socket, const Address& from)
+{
+    socket->SetRecvCallback(MakeCallback(&FlowMonitorGsoTestCase::ServerHandleRecv, this));
+}
+
+void
+FlowMonitorGsoTestCase::ServerHandleRecv(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+    }
+}
+
+void
+FlowMonitorGsoTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+
+    // The simple net devices do not support GSO: the IP layer splits the
+    // batches after the probes saw them
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    simpleHelper.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Mbps")));
+    simpleHelper.SetChannelAttribute("Delay", TimeValue(MilliSeconds(5)));
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+
+    Address serverAddress;
+    if (m_ipv6)
+    {
+        Ipv6AddressHelper ipv6;
+        ipv6.SetBase(Ipv6Address("2001:db8::"), Ipv6Prefix(64));
+        Ipv6InterfaceContainer interfaces = ipv6.Assign(devices);
+        serverAddress = Inet6SocketAddress(interfaces.GetAddress(1, 0), 5000);
+    }
+    else
+    {
+        Ipv4AddressHelper ipv4;
+        ipv4.SetBase("10.1.1.0", "255.255.255.0");
+        Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+        serverAddress = InetSocketAddress(interfaces.GetAddress(1), 5000);
+    }
+
+    FlowMonitorHelper flowHelper;
+    Ptr<FlowMonitor> monitor = flowHelper.Install(nodes);
+
+    Ptr<Socket> server = Socket::CreateSocket(nodes.Get(1), TcpSocketFactory::GetTypeId());
+    server->Bind(m_ipv6 ? Address(Inet6SocketAddress(Ipv6Address::GetAny(), 5000))
+                        : Address(InetSocketAddress(Ipv4Address::GetAny(), 5000)));
+    server->Listen();
+    server->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                              MakeCallback(&FlowMonitorGsoTestCase::ServerHandleAccept, this));
+
+    Ptr<Socket> source = Socket::CreateSocket(nodes.Get(0), TcpSocketFactory::GetTypeId());
+    source->SetAttribute("SegmentSize", UintegerValue(1400));
+    source->SetAttribute("GsoMaxSegments", UintegerValue(8));
+    source->SetSendCallback(MakeCallback(&FlowMonitorGsoTestCase::SourceHandleSend, this));
+
+    // Leave time to the duplicate address detection of IPv6
+    Simulator::Schedule(Seconds(2), [source, serverAddress]() { source->Connect(serverAddress); });
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_txBytes, GSO_TEST_DATA, "Not all the data was sent");
+    const auto& stats = monitor->GetFlowStats();
+    NS_TEST_ASSERT_MSG_EQ(stats.size(), 2, "Wrong number of flows");
+    const FlowMonitor::FlowStats* data = nullptr;
+    for (const auto& [flowId, flow] : stats)
+    {
+        NS_TEST_EXPECT_MSG_EQ(flow.rxPackets, flow.txPackets, "Wrong rxPackets of flow " << flowId);
+        NS_TEST_EXPECT_MSG_EQ(flow.rxBytes, flow.txBytes, "Wrong rxBytes of flow " << flowId);
+        NS_TEST_EXPECT_MSG_EQ(flow.lostPackets, 0, "Packets lost by flow " << flowId);
+        if (!data || flow.txBytes > data->txBytes)
+        {
+            data = &flow;
+        }
+    }
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(data->txPackets, GSO_TEST_DATA / 1400, "Segments not counted");
+
+    monitor->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+  public:
+    FlowMonitorTestSuite()
+        : TestSuite("flow-monitor", Type::UNIT)
+    {
+        AddTestCase(new FlowMonitorLostPacketsTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new FlowMonitorSnapshotTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new FlowClassifierTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new FlowMonitorGsoTestCase(false), TestCase::Duration::QUICK);
+        AddTestCase(new FlowMonitorGsoTestCase(true), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization
+static FlowMonitorTestSuite g_flowMonitorTestSuite;
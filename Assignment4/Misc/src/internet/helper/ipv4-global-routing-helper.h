@@ -89,6 +89,17 @@ class Ipv4GlobalRoutingHelper : public Ipv4RoutingHelper
      *
      */
     static void RecomputeRoutingTables();
+    /**
+     * \brief Update the routes that were previously installed in a prior call
+     * to PopulateRoutingTables(), RecomputeRoutingTables() or
+     * UpdateRoutingTables(), after a change of the topology.
+     *
+     * The routes are the same as with RecomputeRoutingTables(), but when links
+     * only went down or had their metric increased, only the nodes whose
+     * shortest path computations went through these links compute their
+     * routes again.
+     */
+    static void UpdateRoutingTables();
 };
 
 } // namespace ns3
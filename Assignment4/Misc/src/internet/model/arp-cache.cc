@@ -30,6 +30,9 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace ns3
 {
 
@@ -197,12 +200,17 @@ void
 ArpCache::HandleWaitReplyTimeout()
 {
     NS_LOG_FUNCTION(this);
-    ArpCache::Entry* entry;
     bool restartWaitReplyTimer = false;
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    // The entries giving up leave m_waitReplyEntries, so walk a copy of it
+    std::vector<ArpCache::Entry*> waiting;
+    waiting.reserve(m_waitReplyEntries.size());
+    for (const auto& i : m_waitReplyEntries)
+    {
+        waiting.push_back(i.second);
+    }
+    for (auto entry : waiting)
     {
-        entry = (*i).second;
-        if (entry != nullptr && entry->IsWaitReply())
+        if (entry->IsWaitReply())
         {
             if (entry->GetRetries() < m_maxRetries)
             {
@@ -250,6 +258,7 @@ ArpCache::Flush()
         delete (*i).second;
     }
     m_arpCache.erase(m_arpCache.begin(), m_arpCache.end());
+    m_waitReplyEntries.clear();
     if (m_waitReplyTimer.IsPending())
     {
         NS_LOG_LOGIC("Stopping WaitReplyTimer at " << Simulator::Now().GetSeconds()
@@ -264,7 +273,9 @@ ArpCache::PrintArpCache(Ptr<OutputStreamWrapper> stream)
     NS_LOG_FUNCTION(this << stream);
     std::ostream* os = stream->GetStream();
 
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    // Print the entries in address order
+    std::map<Ipv4Address, ArpCache::Entry*> entries(m_arpCache.begin(), m_arpCache.end());
+    for (auto i = entries.begin(); i != entries.end(); i++)
     {
         *os << i->first << " dev ";
         std::string found = Names::FindName(m_device);
@@ -333,6 +344,9 @@ ArpCache::LookupInverse(Address to)
             entryList.push_back(entry);
         }
     }
+    entryList.sort([](const ArpCache::Entry* a, const ArpCache::Entry* b) {
+        return a->GetIpv4Address() < b->GetIpv4Address();
+    });
     return entryList;
 }
 
@@ -365,17 +379,26 @@ ArpCache::Remove(ArpCache::Entry* entry)
 {
     NS_LOG_FUNCTION(this << entry);
 
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    auto it = m_arpCache.find(entry->GetIpv4Address());
+    if (it == m_arpCache.end() || it->second != entry)
     {
-        if ((*i).second == entry)
-        {
-            m_arpCache.erase(i);
-            entry->ClearPendingPacket(); // clear the pending packets for entry's ipaddress
-            delete entry;
-            return;
-        }
+        // The address of the entry has been changed after it was added
+        it = std::find_if(m_arpCache.begin(), m_arpCache.end(), [entry](const auto& i) {
+            return i.second == entry;
+        });
+    }
+    if (it == m_arpCache.end())
+    {
+        NS_LOG_WARN("Entry not found in this ARP Cache");
+        return;
+    }
+    if (entry->IsWaitReply())
+    {
+        m_waitReplyEntries.erase(entry->GetIpv4Address());
     }
-    NS_LOG_WARN("Entry not found in this ARP Cache");
+    m_arpCache.erase(it);
+    entry->ClearPendingPacket(); // clear the pending packets for entry's ipaddress
+    delete entry;
 }
 
 ArpCache::Entry::Entry(ArpCache* arp)
@@ -426,7 +449,7 @@ ArpCache::Entry::MarkDead()
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(m_state == ALIVE || m_state == WAIT_REPLY || m_state == DEAD);
-    m_state = DEAD;
+    SetState(DEAD);
     ClearRetries();
     UpdateSeen();
 }
@@ -437,7 +460,7 @@ ArpCache::Entry::MarkAlive(Address macAddress)
     NS_LOG_FUNCTION(this << macAddress);
     NS_ASSERT(m_state == WAIT_REPLY);
     m_macAddress = macAddress;
-    m_state = ALIVE;
+    SetState(ALIVE);
     ClearRetries();
     UpdateSeen();
 }
@@ -448,7 +471,7 @@ ArpCache::Entry::MarkPermanent()
     NS_LOG_FUNCTION(this << m_macAddress);
     NS_ASSERT(!m_macAddress.IsInvalid());
 
-    m_state = PERMANENT;
+    SetState(PERMANENT);
     ClearRetries();
     UpdateSeen();
 }
@@ -459,7 +482,7 @@ ArpCache::Entry::MarkAutoGenerated()
     NS_LOG_FUNCTION(this << m_macAddress);
     NS_ASSERT(!m_macAddress.IsInvalid());
 
-    m_state = STATIC_AUTOGENERATED;
+    SetState(STATIC_AUTOGENERATED);
     ClearRetries();
     UpdateSeen();
 }
@@ -489,7 +512,7 @@ ArpCache::Entry::MarkWaitReply(Ipv4PayloadHeaderPair waiting)
     NS_ASSERT(m_pending.empty());
     NS_ASSERT_MSG(waiting.first, "Can not add a null packet to the ARP queue");
 
-    m_state = WAIT_REPLY;
+    SetState(WAIT_REPLY);
     m_pending.push_back(waiting);
     UpdateSeen();
     m_arp->StartWaitReplyTimer();
@@ -520,9 +543,29 @@ void
 ArpCache::Entry::SetIpv4Address(Ipv4Address destination)
 {
     NS_LOG_FUNCTION(this << destination);
+    if (m_state == WAIT_REPLY)
+    {
+        m_arp->m_waitReplyEntries.erase(m_ipv4Address);
+        m_arp->m_waitReplyEntries[destination] = this;
+    }
     m_ipv4Address = destination;
 }
 
+void
+ArpCache::Entry::SetState(ArpCacheEntryState_e state)
+{
+    NS_LOG_FUNCTION(this << state);
+    if (m_state == WAIT_REPLY && state != WAIT_REPLY)
+    {
+        m_arp->m_waitReplyEntries.erase(m_ipv4Address);
+    }
+    else if (m_state != WAIT_REPLY && state == WAIT_REPLY)
+    {
+        m_arp->m_waitReplyEntries[m_ipv4Address] = this;
+    }
+    m_state = state;
+}
+
 Time
 ArpCache::Entry::GetTimeout() const
 {
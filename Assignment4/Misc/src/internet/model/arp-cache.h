@@ -34,6 +34,7 @@
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -48,6 +49,10 @@ class Ipv4Header;
  *
  * A cached lookup table for translating layer 3 addresses to layer 2.
  * This implementation does lookups from IPv4 to a MAC address
+ *
+ * The entries are kept in a hash table. The entries waiting for a reply
+ * are also kept in a separate table, sorted by address, so that the
+ * periodic WaitReply timer only visits them, in address order.
  */
 class ArpCache : public Object
 {
@@ -141,7 +146,8 @@ class ArpCache : public Object
      * \brief Do lookup in the ARP cache against a MAC address
      * \param destination The destination MAC address to lookup
      * of
-     * \return A std::list of ArpCache::Entry with info about layer 2
+     * \return A std::list of ArpCache::Entry with info about layer 2,
+     * sorted by IPv4 address
      */
     std::list<ArpCache::Entry*> LookupInverse(Address destination);
     /**
@@ -308,6 +314,13 @@ class ArpCache : public Object
          */
         Time GetTimeout() const;
 
+        /**
+         * \brief Change the state of the entry, and keep track of the
+         * entries waiting for a reply in the ARP cache
+         * \param state the new state
+         */
+        void SetState(ArpCacheEntryState_e state);
+
         ArpCache* m_arp;              //!< pointer to the ARP cache owning the entry
         ArpCacheEntryState_e m_state; //!< state of the entry
         Time m_lastSeen;              //!< last moment a packet from that address has been seen
@@ -321,11 +334,11 @@ class ArpCache : public Object
     /**
      * \brief ARP Cache container
      */
-    typedef std::map<Ipv4Address, ArpCache::Entry*> Cache;
+    typedef std::unordered_map<Ipv4Address, ArpCache::Entry*, Ipv4AddressHash> Cache;
     /**
      * \brief ARP Cache container iterator
      */
-    typedef std::map<Ipv4Address, ArpCache::Entry*>::iterator CacheI;
+    typedef std::unordered_map<Ipv4Address, ArpCache::Entry*, Ipv4AddressHash>::iterator CacheI;
 
     void DoDispose() override;
 
@@ -347,6 +360,7 @@ class ArpCache : public Object
     void HandleWaitReplyTimeout();
     uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
     Cache m_arpCache;            //!< the ARP cache
+    std::map<Ipv4Address, ArpCache::Entry*> m_waitReplyEntries; //!< entries in WaitReply state
     TracedCallback<Ptr<const Packet>>
         m_dropTrace; //!< trace for packets dropped by the ARP cache queue
 };
@@ -58,20 +58,23 @@ operator<<(std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream&
 operator<<(std::ostream& os, const CandidateQueue& q)
 {
-    const CandidateQueue::CandidateList_t& list = q.m_candidates;
+    CandidateQueue::CandidateHeap_t heap = q.m_candidates;
+    std::sort(heap.begin(), heap.end(), &CandidateQueue::CompareCandidate);
 
     os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-    for (auto iter = list.begin(); iter != list.end(); iter++)
+    for (auto iter = heap.begin(); iter != heap.end(); iter++)
     {
-        os << "<" << (*iter)->GetVertexId() << ", " << (*iter)->GetDistanceFromRoot() << ", "
-           << (*iter)->GetVertexType() << ">" << std::endl;
+        os << "<" << iter->vertex->GetVertexId() << ", " << iter->vertex->GetDistanceFromRoot()
+           << ", " << iter->vertex->GetVertexType() << ">" << std::endl;
     }
     os << "*** CandidateQueue End ***";
     return os;
 }
 
 CandidateQueue::CandidateQueue()
-    : m_candidates()
+    : m_candidates(),
+      m_index(),
+      m_order(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -99,11 +102,9 @@ CandidateQueue::Push(SPFVertex* vNew)
 {
     NS_LOG_FUNCTION(this << vNew);
 
-    auto i = std::upper_bound(m_candidates.begin(),
-                              m_candidates.end(),
-                              vNew,
-                              &CandidateQueue::CompareSPFVertex);
-    m_candidates.insert(i, vNew);
+    m_candidates.push_back({vNew, m_order++});
+    m_index[vNew->GetVertexId()] = m_candidates.size() - 1;
+    SiftUp(m_candidates.size() - 1);
 }
 
 SPFVertex*
@@ -115,8 +116,15 @@ CandidateQueue::Pop()
         return nullptr;
     }
 
-    SPFVertex* v = m_candidates.front();
-    m_candidates.pop_front();
+    SPFVertex* v = m_candidates.front().vertex;
+    m_index.erase(v->GetVertexId());
+    Candidate last = m_candidates.back();
+    m_candidates.pop_back();
+    if (!m_candidates.empty())
+    {
+        Place(0, last);
+        SiftDown(0);
+    }
     return v;
 }
 
@@ -129,7 +137,7 @@ CandidateQueue::Top() const
         return nullptr;
     }
 
-    return m_candidates.front();
+    return m_candidates.front().vertex;
 }
 
 bool
@@ -150,18 +158,27 @@ SPFVertex*
 CandidateQueue::Find(const Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this);
-    auto i = m_candidates.begin();
-
-    for (; i != m_candidates.end(); i++)
+    auto i = m_index.find(addr);
+    if (i == m_index.end())
     {
-        SPFVertex* v = *i;
-        if (v->GetVertexId() == addr)
-        {
-            return v;
-        }
+        return nullptr;
     }
 
-    return nullptr;
+    return m_candidates[i->second].vertex;
+}
+
+void
+CandidateQueue::DecreaseKey(SPFVertex* v)
+{
+    NS_LOG_FUNCTION(this << v);
+    auto i = m_index.find(v->GetVertexId());
+    NS_ASSERT_MSG(i != m_index.end() && m_candidates[i->second].vertex == v,
+                  "Vertex " << v->GetVertexId() << " not in the candidate queue");
+
+    // Order the vertex after the ones already at its new distance, as if it
+    // had just been pushed
+    m_candidates[i->second].order = m_order++;
+    SiftUp(i->second);
 }
 
 void
@@ -169,11 +186,81 @@ CandidateQueue::Reorder()
 {
     NS_LOG_FUNCTION(this);
 
-    m_candidates.sort(&CandidateQueue::CompareSPFVertex);
+    std::make_heap(m_candidates.begin(),
+                   m_candidates.end(),
+                   [](const Candidate& c1, const Candidate& c2) { return CompareCandidate(c2, c1); });
+    for (uint32_t i = 0; i < m_candidates.size(); i++)
+    {
+        m_index[m_candidates[i].vertex->GetVertexId()] = i;
+    }
     NS_LOG_LOGIC("After reordering the CandidateQueue");
     NS_LOG_LOGIC(*this);
 }
 
+void
+CandidateQueue::SiftUp(uint32_t i)
+{
+    Candidate c = m_candidates[i];
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (!CompareCandidate(c, m_candidates[parent]))
+        {
+            break;
+        }
+        Place(i, m_candidates[parent]);
+        i = parent;
+    }
+    Place(i, c);
+}
+
+void
+CandidateQueue::SiftDown(uint32_t i)
+{
+    Candidate c = m_candidates[i];
+    uint32_t size = m_candidates.size();
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && CompareCandidate(m_candidates[child + 1], m_candidates[child]))
+        {
+            child++;
+        }
+        if (!CompareCandidate(m_candidates[child], c))
+        {
+            break;
+        }
+        Place(i, m_candidates[child]);
+        i = child;
+    }
+    Place(i, c);
+}
+
+void
+CandidateQueue::Place(uint32_t i, const Candidate& c)
+{
+    m_candidates[i] = c;
+    m_index[c.vertex->GetVertexId()] = i;
+}
+
+bool
+CandidateQueue::CompareCandidate(const Candidate& c1, const Candidate& c2)
+{
+    if (CompareSPFVertex(c1.vertex, c2.vertex))
+    {
+        return true;
+    }
+    if (CompareSPFVertex(c2.vertex, c1.vertex))
+    {
+        return false;
+    }
+    return c1.order < c2.order;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,8 +22,9 @@
 
 #include "ns3/ipv4-address.h"
 
-#include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -46,8 +47,11 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple
- * enhanced priority queue.
+ * requirement for a DecreaseKey () operation led us to implement this
+ * enhanced priority queue.  It is a binary heap indexed by the vertex IDs,
+ * so that Push (), Pop () and DecreaseKey () take a logarithmic time and
+ * Find () a constant time.  The vertices at the same distance are popped
+ * in the order they were pushed, networks before routers.
  */
 class CandidateQueue
 {
@@ -144,6 +148,18 @@ class CandidateQueue
      */
     SPFVertex* Find(const Ipv4Address addr) const;
 
+    /**
+     * @brief Move a Shortest Path First Vertex pointer up the queue after its
+     * distance from the root was decreased.
+     *
+     * The vertex is then ordered as if it had just been pushed with its new
+     * distance.
+     *
+     * @see SPFVertex
+     * @param v The Shortest Path First Vertex, which is in the queue.
+     */
+    void DecreaseKey(SPFVertex* v);
+
     /**
      * @brief Reorders the Candidate Queue according to the priority scheme.
      *
@@ -153,7 +169,8 @@ class CandidateQueue
      * increasing distance.
      *
      * This method is provided in case the values of m_distanceFromRoot change
-     * during the routing calculations.
+     * during the routing calculations.  DecreaseKey () is cheaper when a
+     * single distance was decreased.
      *
      * @see SPFVertex
      */
@@ -173,8 +190,46 @@ class CandidateQueue
      */
     static bool CompareSPFVertex(const SPFVertex* v1, const SPFVertex* v2);
 
-    typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-    CandidateList_t m_candidates;                  //!< SPFVertex candidates
+    /// A candidate in the heap
+    struct Candidate
+    {
+        SPFVertex* vertex; //!< The vertex
+        uint64_t order;    //!< Order of the vertices at the same distance
+    };
+
+    /**
+     * \brief return true if c1 should be popped before c2
+     *
+     * \param c1 first operand
+     * \param c2 second operand
+     * \return True if c1 should be popped before c2; false otherwise
+     */
+    static bool CompareCandidate(const Candidate& c1, const Candidate& c2);
+
+    /**
+     * \brief Move a candidate up the heap until its parent is popped before it.
+     * \param i the index of the candidate
+     */
+    void SiftUp(uint32_t i);
+
+    /**
+     * \brief Move a candidate down the heap until it is popped before its children.
+     * \param i the index of the candidate
+     */
+    void SiftDown(uint32_t i);
+
+    /**
+     * \brief Store a candidate in the heap and index it.
+     * \param i the index of the candidate
+     * \param c the candidate
+     */
+    void Place(uint32_t i, const Candidate& c);
+
+    typedef std::vector<Candidate> CandidateHeap_t; //!< container of SPFVertex candidates
+    CandidateHeap_t m_candidates;                   //!< SPFVertex candidates, as a binary heap
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>
+        m_index;      //!< index of the candidates in the heap, by vertex ID
+    uint64_t m_order; //!< order of the next candidate pushed
 
     /**
      * \brief Stream insertion operator.
@@ -30,13 +30,19 @@
 
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <queue>
+#include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -45,6 +51,17 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * \anchor GlobalValueGlobalRoutingThreads
+ * Number of threads running the SPF calculations of the global routing.
+ */
+static GlobalValue g_globalRoutingThreads =
+    GlobalValue("GlobalRoutingThreads",
+                "The number of threads computing the global routes; 0 uses one thread per core",
+                UintegerValue(1),
+                MakeUintegerChecker<uint32_t>());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -496,12 +513,10 @@ GlobalRouteManagerLSDB::GetLSA(Ipv4Address addr) const
     //
     // Look up an LSA by its address.
     //
-    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    auto i = m_database.find(addr);
+    if (i != m_database.end())
     {
-        if (i->first == addr)
-        {
-            return i->second;
-        }
+        return i->second;
     }
     return nullptr;
 }
@@ -530,6 +545,160 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
     return nullptr;
 }
 
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy() const
+{
+    NS_LOG_FUNCTION(this);
+    auto lsdb = new GlobalRouteManagerLSDB();
+    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    {
+        lsdb->m_database.insert(LSDBPair_t(i->first, new GlobalRoutingLSA(*i->second)));
+    }
+    for (uint32_t j = 0; j < m_extdatabase.size(); j++)
+    {
+        lsdb->m_extdatabase.push_back(new GlobalRoutingLSA(*m_extdatabase[j]));
+    }
+    return lsdb;
+}
+
+namespace
+{
+
+/**
+ * \brief Compare two link records.
+ *
+ * \param l1 first link record
+ * \param l2 second link record
+ * \returns true if the link records are to the same link
+ */
+bool
+IsSameLink(const GlobalRoutingLinkRecord* l1, const GlobalRoutingLinkRecord* l2)
+{
+    return l1->GetLinkType() == l2->GetLinkType() && l1->GetLinkId() == l2->GetLinkId() &&
+           l1->GetLinkData() == l2->GetLinkData();
+}
+
+/**
+ * \brief Compare two LSAs, except for their link records.
+ *
+ * \param lsa1 first LSA
+ * \param lsa2 second LSA
+ * \returns true if the LSAs have the same header, network mask and attached routers
+ */
+bool
+IsSameLSAHeader(const GlobalRoutingLSA* lsa1, const GlobalRoutingLSA* lsa2)
+{
+    if (lsa1->GetLSType() != lsa2->GetLSType() ||
+        lsa1->GetLinkStateId() != lsa2->GetLinkStateId() ||
+        lsa1->GetAdvertisingRouter() != lsa2->GetAdvertisingRouter() ||
+        lsa1->GetNetworkLSANetworkMask() != lsa2->GetNetworkLSANetworkMask() ||
+        lsa1->GetNAttachedRouters() != lsa2->GetNAttachedRouters())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < lsa1->GetNAttachedRouters(); i++)
+    {
+        if (lsa1->GetAttachedRouter(i) != lsa2->GetAttachedRouter(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Compare two LSAs.
+ *
+ * \param lsa1 first LSA
+ * \param lsa2 second LSA
+ * \returns true if the LSAs are the same
+ */
+bool
+IsSameLSA(const GlobalRoutingLSA* lsa1, const GlobalRoutingLSA* lsa2)
+{
+    if (!IsSameLSAHeader(lsa1, lsa2) || lsa1->GetNLinkRecords() != lsa2->GetNLinkRecords())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < lsa1->GetNLinkRecords(); i++)
+    {
+        if (!IsSameLink(lsa1->GetLinkRecord(i), lsa2->GetLinkRecord(i)) ||
+            lsa1->GetLinkRecord(i)->GetMetric() != lsa2->GetLinkRecord(i)->GetMetric())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool
+GlobalRouteManagerLSDB::GetWorsenedLinks(const GlobalRouteManagerLSDB& lsdb,
+                                         LinkList_t& removed,
+                                         LinkList_t& increased) const
+{
+    NS_LOG_FUNCTION(this << &lsdb);
+    if (m_database.size() != lsdb.m_database.size() ||
+        m_extdatabase.size() != lsdb.m_extdatabase.size())
+    {
+        return false;
+    }
+    for (uint32_t j = 0; j < m_extdatabase.size(); j++)
+    {
+        if (!IsSameLSA(m_extdatabase[j], lsdb.m_extdatabase[j]))
+        {
+            return false;
+        }
+    }
+    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    {
+        GlobalRoutingLSA* lsa = i->second;
+        auto newer = lsdb.m_database.find(i->first);
+        if (newer == lsdb.m_database.end() || !IsSameLSAHeader(lsa, newer->second))
+        {
+            return false;
+        }
+        if (lsa->GetLSType() != GlobalRoutingLSA::RouterLSA)
+        {
+            if (!IsSameLSA(lsa, newer->second))
+            {
+                return false;
+            }
+            continue;
+        }
+        //
+        // The records of the newer LSA must be the records of this LSA, in the
+        // same order, less the removed ones.
+        //
+        uint32_t k = 0;
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            GlobalRoutingLinkRecord* l = lsa->GetLinkRecord(j);
+            if (k < newer->second->GetNLinkRecords() &&
+                IsSameLink(l, newer->second->GetLinkRecord(k)))
+            {
+                uint16_t metric = newer->second->GetLinkRecord(k++)->GetMetric();
+                if (metric < l->GetMetric())
+                {
+                    return false;
+                }
+                if (metric > l->GetMetric())
+                {
+                    increased.emplace_back(lsa, l);
+                }
+                continue;
+            }
+            removed.emplace_back(lsa, l);
+        }
+        if (k != newer->second->GetNLinkRecords())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -537,7 +706,8 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 // ---------------------------------------------------------------------------
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_spfrouter(nullptr)
 {
     NS_LOG_FUNCTION(this);
     m_lsdb = new GlobalRouteManagerLSDB();
@@ -575,20 +745,12 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes()
         {
             continue;
         }
-        Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-        uint32_t j = 0;
-        uint32_t nRoutes = gr->GetNRoutes();
-        NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << node->GetId());
-        // Each time we delete route 0, the route index shifts downward
-        // We can delete all routes if we delete the route numbered 0
-        // nRoutes times
-        for (j = 0; j < nRoutes; j++)
-        {
-            NS_LOG_LOGIC("Deleting global route " << j << " from node " << node->GetId());
-            gr->RemoveRoute(0);
-        }
-        NS_LOG_LOGIC("Deleted " << j << " global routes from node " << node->GetId());
+        SPFRouter r;
+        r.node = node;
+        r.routing = router->GetRoutingProtocol();
+        RemoveRoutes(r);
     }
+    m_routers.clear();
     if (m_lsdb)
     {
         NS_LOG_LOGIC("Deleting LSDB, creating new one");
@@ -696,6 +858,7 @@ GlobalRouteManagerImpl::InitializeRoutes()
     // Walk the list of nodes in the system.
     //
     NS_LOG_INFO("About to start SPF calculation");
+    m_routers.clear();
     for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
     {
         Ptr<Node> node = *i;
@@ -718,12 +881,210 @@ GlobalRouteManagerImpl::InitializeRoutes()
         //
         if (rtr && rtr->GetNumLSAs())
         {
-            SPFCalculate(rtr->GetRouterId());
+            SPFRouter router;
+            router.routerId = rtr->GetRouterId();
+            router.node = node;
+            router.ipv4 = node->GetObject<Ipv4>();
+            router.routing = rtr->GetRoutingProtocol();
+            m_routers.push_back(router);
         }
     }
+    std::vector<SPFRouter*> routers;
+    for (auto& router : m_routers)
+    {
+        routers.push_back(&router);
+    }
+    SPFCalculate(routers);
     NS_LOG_INFO("Finished SPF calculation");
 }
 
+uint32_t
+GlobalRouteManagerImpl::UpdateRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    //
+    // Build the new database next to the one the routes were computed from,
+    // and find the links which were removed or whose metric increased.
+    //
+    GlobalRouteManagerLSDB* lsdb = m_lsdb;
+    m_lsdb = new GlobalRouteManagerLSDB();
+    BuildGlobalRoutingDatabase();
+    GlobalRouteManagerLSDB::LinkList_t removed;
+    GlobalRouteManagerLSDB::LinkList_t increased;
+    bool incremental = !m_routers.empty() && lsdb->GetWorsenedLinks(*m_lsdb, removed, increased);
+    //
+    // The routes to the transit networks depend on the network LSAs, which
+    // are not compared link by link.
+    //
+    std::set<uint32_t> changedRouters;
+    std::vector<std::pair<uint32_t, uint32_t>> changedEdges;
+    for (const auto& links : {removed, increased})
+    {
+        for (const auto& link : links)
+        {
+            GlobalRoutingLinkRecord* l = link.second;
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+                incremental = false;
+            }
+            uint32_t u = link.first->GetLinkStateId().Get();
+            changedRouters.insert(u);
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::PointToPoint)
+            {
+                uint32_t w = l->GetLinkId().Get();
+                changedEdges.emplace_back(std::min(u, w), std::max(u, w));
+            }
+        }
+    }
+    if (!incremental)
+    {
+        NS_LOG_LOGIC("Recomputing the routes of all the routers");
+        delete lsdb;
+        lsdb = m_lsdb;
+        m_lsdb = nullptr;
+        DeleteGlobalRoutes();
+        m_lsdb = lsdb;
+        InitializeRoutes();
+        return m_routers.size();
+    }
+    //
+    // Removing links or increasing their metric does not change the tree of a
+    // router, nor the order in which it was built, as long as these links did
+    // not change the candidates of its SPF calculation and are not links of
+    // the router itself: the router only loses the routes to the removed
+    // links, unless it has equal routes which these could be mixed up with.
+    // The other routers compute their tree again.
+    //
+    std::vector<SPFRouter*> routers;
+    for (auto& router : m_routers)
+    {
+        bool affected = changedRouters.count(router.routerId.Get());
+        for (const auto& edge : changedEdges)
+        {
+            affected = affected ||
+                       std::binary_search(router.edges.begin(), router.edges.end(), edge);
+        }
+        for (auto link = removed.begin(); !affected && link != removed.end(); link++)
+        {
+            affected = !RemoveLinkRoutes(router, link->first, link->second);
+        }
+        if (affected)
+        {
+            NS_LOG_LOGIC("Recomputing the routes of router " << router.routerId);
+            RemoveRoutes(router);
+            routers.push_back(&router);
+        }
+    }
+    SPFCalculate(routers);
+    delete lsdb;
+    return routers.size();
+}
+
+void
+GlobalRouteManagerImpl::FindRouter(SPFRouter& router)
+{
+    NS_LOG_FUNCTION(router.routerId);
+    //
+    // Walk the list of nodes looking for the one with the router ID of the
+    // router; its routing protocol is reached through its GlobalRouter
+    // interface.
+    //
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        if (rtr && rtr->GetRouterId() == router.routerId)
+        {
+            router.node = node;
+            router.ipv4 = node->GetObject<Ipv4>();
+            NS_ASSERT_MSG(router.ipv4,
+                          "GlobalRouteManagerImpl::FindRouter (): "
+                          "GetObject for <Ipv4> interface failed");
+            router.routing = rtr->GetRoutingProtocol();
+            return;
+        }
+    }
+    NS_LOG_LOGIC("Can't find router " << router.routerId);
+}
+
+void
+GlobalRouteManagerImpl::RemoveRoutes(SPFRouter& router)
+{
+    NS_LOG_FUNCTION(router.routerId);
+    router.edges.clear();
+    router.exits.clear();
+    Ptr<Ipv4GlobalRouting> gr = router.routing;
+    if (!gr)
+    {
+        return;
+    }
+    uint32_t j = 0;
+    uint32_t nRoutes = gr->GetNRoutes();
+    NS_LOG_LOGIC("Deleting " << gr->GetNRoutes() << " routes from node " << router.node->GetId());
+    // Each time we delete route 0, the route index shifts downward
+    // We can delete all routes if we delete the route numbered 0
+    // nRoutes times
+    for (j = 0; j < nRoutes; j++)
+    {
+        NS_LOG_LOGIC("Deleting global route " << j << " from node " << router.node->GetId());
+        gr->RemoveRoute(0);
+    }
+    NS_LOG_LOGIC("Deleted " << j << " global routes from node " << router.node->GetId());
+}
+
+bool
+GlobalRouteManagerImpl::RemoveLinkRoutes(SPFRouter& router,
+                                         GlobalRoutingLSA* lsa,
+                                         GlobalRoutingLinkRecord* l)
+{
+    NS_LOG_FUNCTION(router.routerId << lsa << l);
+    Ptr<Ipv4GlobalRouting> gr = router.routing;
+    if (!gr)
+    {
+        return true;
+    }
+    //
+    // The routes to the link were installed with the root exit directions of
+    // the vertex, by SPFIntraAddRouter () for a point-to-point link and by
+    // SPFIntraAddStub () for a stub network.
+    //
+    VertexExit key{lsa->GetLinkStateId(), Ipv4Address(), 0};
+    auto range = std::equal_range(router.exits.begin(),
+                                  router.exits.end(),
+                                  key,
+                                  [](const VertexExit& e1, const VertexExit& e2) {
+                                      return e1.vertex < e2.vertex;
+                                  });
+    for (auto exit = range.first; exit != range.second; exit++)
+    {
+        if (exit->outIf < 0)
+        {
+            continue;
+        }
+        if (l->GetLinkType() == GlobalRoutingLinkRecord::PointToPoint)
+        {
+            NS_LOG_LOGIC("Node " << router.node->GetId() << " removing host route to "
+                                 << l->GetLinkData());
+            if (!gr->RemoveHostRouteTo(l->GetLinkData(), exit->nextHop, exit->outIf))
+            {
+                return false;
+            }
+        }
+        else if (l->GetLinkType() == GlobalRoutingLinkRecord::StubNetwork)
+        {
+            Ipv4Mask tempmask(l->GetLinkData().Get());
+            Ipv4Address tempip = l->GetLinkId().CombineMask(tempmask);
+            NS_LOG_LOGIC("Node " << router.node->GetId() << " removing network route to "
+                                 << tempip);
+            if (!gr->RemoveNetworkRouteTo(tempip, tempmask, exit->nextHop, exit->outIf))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section
 // 16.1 (2) for further details.
@@ -748,6 +1109,16 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
     uint32_t distance = 0;
     uint32_t numRecordsInVertex = 0;
     //
+    // Remember the links which change the candidates, for UpdateRoutes ().
+    // Changing the other links changes neither the tree nor the order in which
+    // its vertices are found.
+    //
+    auto addEdge = [this, v](GlobalRoutingLSA* lsa) {
+        uint32_t vId = v->GetVertexId().Get();
+        uint32_t wId = lsa->GetLinkStateId().Get();
+        m_spfrouter->edges.emplace_back(std::min(vId, wId), std::max(vId, wId));
+    };
+    //
     // V points to a Router-LSA or Network-LSA
     // Loop over the links in router LSA or attached routers in Network LSA
     //
@@ -863,6 +1234,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
             w = new SPFVertex(w_lsa);
             if (SPFNexthopCalculation(v, w, l, distance))
             {
+                addEdge(w_lsa);
                 w_lsa->SetStatus(GlobalRoutingLSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
@@ -926,6 +1298,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                 // is very different from quagga (blame ns3::GlobalRouteManagerImpl)
 
                 // prepare vertex w
+                addEdge(w_lsa);
                 w = new SPFVertex(w_lsa);
                 SPFNexthopCalculation(v, w, l, distance);
                 cw->MergeRootExitDirections(w);
@@ -950,9 +1323,10 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                 {
                     //
                     // If we've changed the cost to get to the vertex represented by <w>, we
-                    // must reorder the priority queue keyed to that cost.
+                    // must move it up the priority queue keyed to that cost.
                     //
-                    candidate.Reorder();
+                    addEdge(w_lsa);
+                    candidate.DecreaseKey(cw);
                 }
             } // new lower cost path found
         }     // end W is already on the candidate list
@@ -1303,9 +1677,7 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<GlobalRouter> router = rlsa->GetNode()->GetObject<GlobalRouter>();
-                    NS_ASSERT(router);
-                    Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
+                    Ptr<Ipv4GlobalRouting> gr = m_spfrouter->routing;
                     NS_ASSERT(gr);
                     gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
                                           Ipv4Mask("0.0.0.0"),
@@ -1323,12 +1695,82 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
     return false;
 }
 
-// quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
+    SPFRouter router;
+    router.routerId = root;
+    FindRouter(router);
+    SPFCalculate(router);
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate(const std::vector<SPFRouter*>& routers)
+{
+    NS_LOG_FUNCTION(this << routers.size());
+    UintegerValue value;
+    g_globalRoutingThreads.GetValue(value);
+    uint32_t nThreads = value.Get() ? value.Get() : std::thread::hardware_concurrency();
+    nThreads = std::min<std::size_t>(nThreads, routers.size());
+    //
+    // The logging is not thread-safe: keep to this thread when it is enabled.
+    //
+    LogComponent::ComponentList* components = LogComponent::GetComponentList();
+    for (auto i = components->begin(); nThreads > 1 && i != components->end(); i++)
+    {
+        if (!i->second->IsNoneEnabled())
+        {
+            nThreads = 1;
+        }
+    }
+    if (nThreads <= 1)
+    {
+        for (SPFRouter* router : routers)
+        {
+            SPFCalculate(*router);
+        }
+        return;
+    }
+    NS_LOG_INFO("Running " << routers.size() << " SPF calculations on " << nThreads << " threads");
+    //
+    // The LSAs hold the status of the vertices during a calculation, so that
+    // each thread needs its own copy of the LSDB.  The copies are made and
+    // deleted here, since they hold references to the nodes.
+    //
+    std::vector<std::unique_ptr<GlobalRouteManagerImpl>> workers;
+    for (uint32_t i = 0; i < nThreads; i++)
+    {
+        workers.push_back(std::make_unique<GlobalRouteManagerImpl>());
+        workers.back()->DebugUseLsdb(m_lsdb->Copy());
+    }
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+    {
+        threads.emplace_back([&next, &routers, impl = worker.get()]() {
+            for (std::size_t j = next++; j < routers.size(); j = next++)
+            {
+                impl->SPFCalculate(*routers[j]);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// quagga ospf_spf_calculate
+void
+GlobalRouteManagerImpl::SPFCalculate(SPFRouter& router)
+{
+    NS_LOG_FUNCTION(this << router.routerId);
 
+    Ipv4Address root = router.routerId;
+    m_spfrouter = &router;
+    router.edges.clear();
+    router.exits.clear();
     SPFVertex* v;
     //
     // Initialize the Link State Database.
@@ -1363,10 +1805,25 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (router.routing && CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
+        //
+        // The default route only depends on the link to the next hop router.
+        //
+        GlobalRoutingLSA* rlsa = m_spfroot->GetLSA();
+        for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
+        {
+            GlobalRoutingLinkRecord* l = rlsa->GetLinkRecord(i);
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::PointToPoint)
+            {
+                router.edges.emplace_back(std::min(root.Get(), l->GetLinkId().Get()),
+                                          std::max(root.Get(), l->GetLinkId().Get()));
+            }
+        }
         delete m_spfroot;
+        m_spfroot = nullptr;
+        m_spfrouter = nullptr;
         return;
     }
 
@@ -1424,6 +1881,17 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         //
         SPFVertexAddParent(v);
         //
+        // Remember how the root reaches the vertex, for UpdateRoutes ().
+        //
+        if (v->GetVertexType() == SPFVertex::VertexRouter)
+        {
+            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            {
+                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+                router.exits.push_back({v->GetVertexId(), exit.first, exit.second});
+            }
+        }
+        //
         // Note that when there is a choice of vertices closest to the root, network
         // vertices must be chosen before router vertices in order to necessarily
         // find all equal-cost paths.
@@ -1488,6 +1956,13 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     //
     delete m_spfroot;
     m_spfroot = nullptr;
+    m_spfrouter = nullptr;
+
+    std::sort(router.edges.begin(), router.edges.end());
+    router.edges.erase(std::unique(router.edges.begin(), router.edges.end()), router.edges.end());
+    std::stable_sort(router.exits.begin(),
+                     router.exits.end(),
+                     [](const VertexExit& e1, const VertexExit& e2) { return e1.vertex < e2.vertex; });
 }
 
 void
@@ -1540,107 +2015,53 @@ GlobalRouteManagerImpl::SPFAddASExternal(GlobalRoutingLSA* extlsa, SPFVertex* v)
     NS_LOG_LOGIC("External is on remote host: " << extlsa->GetAdvertisingRouter()
                                                 << "; installing");
 
-    Ipv4Address routerId = m_spfroot->GetVertexId();
-
-    NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The root of the Shortest Path First tree is the router to which we are
+    // going to write the actual routing table entries.  SPFCalculate () found
+    // the node of this router, and its routing protocol, before starting.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    NS_LOG_LOGIC("Vertex ID = " << m_spfroot->GetVertexId());
+    Ptr<Ipv4GlobalRouting> gr = m_spfrouter->routing;
+    if (!gr)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        NS_LOG_LOGIC("Can't find root node " << m_spfroot->GetVertexId());
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_spfrouter->node->GetId());
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = extlsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
 
-        if (!rtr)
+    //
+    // The vertex <v> of the advertising router has the next hop addresses and
+    // the outbound interfaces, precalculated for us, through which the root
+    // node should send the packets to be forwarded to the external network.
+    //
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " add external network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
@@ -1699,190 +2120,85 @@ GlobalRouteManagerImpl::SPFIntraAddStub(GlobalRoutingLinkRecord* l, SPFVertex* v
     NS_LOG_LOGIC("Stub is on remote host: " << v->GetVertexId() << "; installing");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  SPFCalculate () found
+    // the node of this router, and its routing protocol, before starting.
     //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
-
-    NS_LOG_LOGIC("Vertex ID = " << routerId);
+    NS_LOG_LOGIC("Vertex ID = " << m_spfroot->GetVertexId());
+    Ptr<Ipv4GlobalRouting> gr = m_spfrouter->routing;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << m_spfroot->GetVertexId());
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_spfrouter->node->GetId());
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask(l->GetLinkData().Get());
+    Ipv4Address tempip = l->GetLinkId();
+    tempip = tempip.CombineMask(tempmask);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The vertex <v> (corresponding to the node that has the stub network) has
+    // the next hop addresses and the outbound interfaces, precalculated for
+    // us, through which the root node should send the packets to be forwarded
+    // to the stub network.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " add network route to " << tempip << " using next hop "
+                                   << nextHop << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
-//
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is a wrapper around GetInterfaceForPrefix(), on the node of the router
+// at the root of the SPF tree.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
-//
 int32_t
 GlobalRouteManagerImpl::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
 {
     NS_LOG_FUNCTION(this << a << amask);
     //
-    // We have an IP address <a> and a vertex ID of the root of the SPF tree.
-    // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
+    // We have an IP address <a> and the node at the root of the SPF tree, for
+    // which we are building the routing table.  The question is what interface
+    // index does this address correspond to.  Since this node is participating
+    // in routing IP version 4 packets, it has an Ipv4 interface, through which
+    // we iterate the interfaces and find the one corresponding to the address
+    // in question.
     //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
-    //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
-    //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_spfrouter->ipv4)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-        //
-        // If the node doesn't have a GlobalRouter interface it can't be the one
-        // we're interested in.
-        //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
-        }
+        // Couldn't find it.
+        NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node "
+                     << m_spfroot->GetVertexId());
+        return -1;
     }
     //
-    // Couldn't find it.
+    // Look through the interfaces on this node for one that has the IP address
+    // we're looking for.  If we find one, return the corresponding interface
+    // index, or -1 if not found.
     //
-    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
-    return -1;
+    return m_spfrouter->ipv4->GetInterfaceForPrefix(a, amask);
 }
 
-//
 // This method is derived from quagga ospf_intra_add_router ()
 //
 // This is where we are actually going to add the host routes to the routing
@@ -1906,137 +2222,87 @@ GlobalRouteManagerImpl::SPFIntraAddRouter(SPFVertex* v)
     NS_ASSERT_MSG(m_spfroot, "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  SPFCalculate () found
+    // the node of this router, and its routing protocol, before starting.
+    //
+    NS_LOG_LOGIC("Vertex ID = " << m_spfroot->GetVertexId());
+    Ptr<Ipv4GlobalRouting> gr = m_spfrouter->routing;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << m_spfroot->GetVertexId());
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_spfrouter->node->GetId());
     //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
+    //
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
 
-    NS_LOG_LOGIC("Vertex ID = " << routerId);
+    uint32_t nLinkRecords = lsa->GetNLinkRecords();
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Iterate through the link records on the vertex to which we're going to add
+    // routes.  To make sure we're being clear, we're going to add routing table
+    // entries to the tables on the node corresponding to the root of the SPF tree.
+    // These entries will have routes to the IP addresses we find from looking at
+    // the local side of the point-to-point links found on the node described by
+    // the vertex <v>.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    NS_LOG_LOGIC(" Node " << m_spfrouter->node->GetId() << " found " << nLinkRecords
+                          << " link records in LSA " << lsa << "with LinkStateId "
+                          << lsa->GetLinkStateId());
+    for (uint32_t j = 0; j < nLinkRecords; ++j)
     {
-        Ptr<Node> node = *i;
         //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // We are only concerned about point-to-point links
         //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+        if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
             continue;
         }
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
-            //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresponding to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
-            //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
+            SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                //
-                // We are only concerned about point-to-point links
-                //
-                GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                    continue;
-                }
-                //
-                // Here's why we did all of that work.  We're going to add a host route to the
-                // host address found in the m_linkData field of the point-to-point link
-                // record.  In the case of a point-to-point link, this is the local IP address
-                // of the node connected to the link.  Each of these point-to-point links
-                // will correspond to a local interface that has an IP address to which
-                // the node at the root of the SPF tree can send packets.  The vertex <v>
-                // (corresponding to the node that has these links and interfaces) has
-                // an m_nextHop address precalculated for us that is the address to which the
-                // root node should send packets to be forwarded to these IP addresses.
-                // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-                // which the packets should be send for forwarding.
-                //
-                Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-                if (!router)
-                {
-                    continue;
-                }
-                Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-                NS_ASSERT(gr);
-                // walk through all available exit directions due to ECMP,
-                // and add host route for each of the exit direction toward
-                // the vertex 'v'
-                for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-                {
-                    SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                    Ipv4Address nextHop = exit.first;
-                    int32_t outIf = exit.second;
-                    if (outIf >= 0)
-                    {
-                        gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " adding host route to " << lr->GetLinkData()
-                                               << " using next hop " << nextHop
-                                               << " and outgoing interface " << outIf);
-                    }
-                    else
-                    {
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " NOT able to add host route to "
-                                               << lr->GetLinkData() << " using next hop " << nextHop
-                                               << " since outgoing interface id is negative "
-                                               << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+                gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                       << " adding host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " and outgoing interface " << outIf);
             }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
-        }
+            else
+            {
+                NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                       << " NOT able to add host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 
@@ -2048,98 +2314,52 @@ GlobalRouteManagerImpl::SPFIntraAddTransit(SPFVertex* v)
     NS_ASSERT_MSG(m_spfroot, "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
     //
     // The root of the Shortest Path First tree is the router to which we are
-    // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // going to write the actual routing table entries.  SPFCalculate () found
+    // the node of this router, and its routing protocol, before starting.
     //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
-
-    NS_LOG_LOGIC("Vertex ID = " << routerId);
+    NS_LOG_LOGIC("Vertex ID = " << m_spfroot->GetVertexId());
+    Ptr<Ipv4GlobalRouting> gr = m_spfrouter->routing;
+    if (!gr)
+    {
+        NS_LOG_LOGIC("Can't find root node " << m_spfroot->GetVertexId());
+        return;
+    }
+    NS_LOG_LOGIC("setting routes for node " << m_spfrouter->node->GetId());
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = lsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+    // walk through all available exit directions due to ECMP,
+    // and add host route for each of the exit direction toward
+    // the vertex 'v'
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
 
-        if (!rtr)
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " add network route to " << tempip << " using next hop "
+                                   << nextHop << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_spfrouter->node->GetId()
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative " << outIf);
         }
     }
 }
@@ -39,6 +39,7 @@ namespace ns3
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -574,6 +575,9 @@ class SPFVertex
 class GlobalRouteManagerLSDB
 {
   public:
+    typedef std::vector<std::pair<GlobalRoutingLSA*, GlobalRoutingLinkRecord*>>
+        LinkList_t; //!< container of Link Records, with the Link State Advertisement holding them
+
     /**
      * @brief Construct an empty Global Router Manager Link State Database.
      *
@@ -672,6 +676,30 @@ class GlobalRouteManagerLSDB
      */
     uint32_t GetNumExtLSAs() const;
 
+    /**
+     * @brief Copy the database, with copies of its Link State Advertisements.
+     *
+     * @returns The copy, which the caller deletes.
+     */
+    GlobalRouteManagerLSDB* Copy() const;
+
+    /**
+     * @brief Compare the database with a newer one, in which links may have
+     * been removed or had their metric increased.
+     *
+     * @param lsdb The newer database.
+     * @param removed The Link Records of this database which are not in
+     * \a lsdb.
+     * @param increased The Link Records of this database whose metric is
+     * greater in \a lsdb.
+     * @returns False if the databases differ in any other way: a Link State
+     * Advertisement was added or removed, a link was added, a metric decreased,
+     * a network changed, etc.
+     */
+    bool GetWorsenedLinks(const GlobalRouteManagerLSDB& lsdb,
+                          LinkList_t& removed,
+                          LinkList_t& increased) const;
+
   private:
     typedef std::map<Ipv4Address, GlobalRoutingLSA*>
         LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -725,6 +753,23 @@ class GlobalRouteManagerImpl
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Rebuild the routing database and update the per-node forwarding
+     * tables, recomputing only the routes which the changes of the database
+     * can affect.
+     *
+     * When links were only removed or had their metric increased since the
+     * routes were computed, the SPF calculation is run again only for the
+     * routers whose SPF calculation found a path through one of these links,
+     * even one which was not the shortest in the end; the other routers keep
+     * their tree and only lose the routes to the addresses and stub networks
+     * of the removed links, unless they have other, equal routes to them.  Any
+     * other change of the database recomputes the routes of all the routers.
+     *
+     * @returns The number of routers whose routes were recomputed.
+     */
+    virtual uint32_t UpdateRoutes();
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      * @param lsdb the pre-built LSDB
@@ -738,9 +783,83 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /// A root exit direction of a router vertex of a shortest path tree
+    struct VertexExit
+    {
+        Ipv4Address vertex;  //!< the vertex ID
+        Ipv4Address nextHop; //!< the next hop from the root to the vertex
+        int32_t outIf;       //!< the root interface to the vertex
+    };
+
+    /**
+     * @brief A router at the root of SPF calculations, with what UpdateRoutes ()
+     * needs to know of its shortest path tree.
+     */
+    struct SPFRouter
+    {
+        Ipv4Address routerId;           //!< the router ID
+        Ptr<Node> node;                 //!< the node of the router, if any
+        Ptr<Ipv4> ipv4;                 //!< the IPv4 stack of the node
+        Ptr<Ipv4GlobalRouting> routing; //!< the global routing protocol of the node
+        std::vector<std::pair<uint32_t, uint32_t>>
+            edges; //!< the links which changed the candidates, smaller vertex ID first, sorted
+        std::vector<VertexExit> exits; //!< the root exit directions of the vertices, by vertex ID
+    };
+
     SPFVertex* m_spfroot;           //!< the root node
+    SPFRouter* m_spfrouter;         //!< the router at the root of the SPF calculation
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+    std::vector<SPFRouter> m_routers; //!< the routers whose routes were computed, in order
+
+    /**
+     * \brief Find the node of a router and its routing protocol.
+     *
+     * \param router the router, whose ID is set
+     */
+    static void FindRouter(SPFRouter& router);
+
+    /**
+     * \brief Remove all the routes of a router.
+     *
+     * \param router the router
+     */
+    static void RemoveRoutes(SPFRouter& router);
+
+    /**
+     * \brief Remove the routes to a link of a vertex, which the router installed
+     * when the link was in the routing database.
+     *
+     * \param router the router
+     * \param lsa the LSA of the vertex
+     * \param l the link record
+     * \return false if the routes to the link cannot be told apart from other
+     * routes of the router, which must then compute its routes again.
+     */
+    static bool RemoveLinkRoutes(SPFRouter& router,
+                                 GlobalRoutingLSA* lsa,
+                                 GlobalRoutingLinkRecord* l);
+
+    /**
+     * \brief Run the SPF calculations rooted at routers, on the threads set
+     * by the \c GlobalRoutingThreads global value.
+     *
+     * Each thread runs the calculations on its own copy of the LSDB, and each
+     * calculation only writes to the routing tables of its root, so that the
+     * routing tables do not depend on the number of threads.
+     *
+     * \param routers the routers
+     */
+    void SPFCalculate(const std::vector<SPFRouter*>& routers);
+
+    /**
+     * \brief Calculate the shortest path first (SPF) tree of a router and
+     * install its routes
+     *
+     * \param router the router at the root of the tree
+     */
+    void SPFCalculate(SPFRouter& router);
+
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
      *
@@ -910,8 +1029,8 @@ class GlobalRouteManagerImpl
     /**
      * \brief Return the interface number corresponding to a given IP address and mask
      *
-     * This is a wrapper around GetInterfaceForPrefix(), but we first
-     * have to find the right node pointer to pass to that function.
+     * This is a wrapper around GetInterfaceForPrefix(), on the node of the
+     * router at the root of the SPF tree.
      * If no such interface is found, return -1 (note:  unit test framework
      * for routing assumes -1 to be a legal return value)
      *
@@ -57,6 +57,13 @@ GlobalRouteManager::InitializeRoutes()
     SimulationSingleton<GlobalRouteManagerImpl>::Get()->InitializeRoutes();
 }
 
+uint32_t
+GlobalRouteManager::UpdateRoutes()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    return SimulationSingleton<GlobalRouteManagerImpl>::Get()->UpdateRoutes();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId()
 {
@@ -70,6 +70,14 @@ class GlobalRouteManager
      * per-node forwarding tables
      */
     static void InitializeRoutes();
+
+    /**
+     * @brief Rebuild the routing database and update the per-node forwarding
+     * tables, recomputing only the routes which the changes of the topology
+     * can affect
+     * @returns The number of routers whose routes were recomputed.
+     */
+    static uint32_t UpdateRoutes();
 };
 
 } // namespace ns3
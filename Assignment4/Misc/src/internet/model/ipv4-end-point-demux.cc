@@ -24,6 +24,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -43,29 +45,83 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv4EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+void
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
 {
-    NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->GetLocalPort()]++;
+    Index(endPoint);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv4Address::GetAny())
+    {
+        ConnectionKey key{endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort(),
+                          endPoint->GetLocalPort()};
+        m_connections[key].push_back(endPoint);
+    }
+    else
+    {
+        m_listeners[endPoint->GetLocalPort()].push_back(endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv4Address::GetAny())
     {
-        if ((*i)->GetLocalPort() == port)
+        ConnectionKey key{endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort(),
+                          endPoint->GetLocalPort()};
+        auto bucket = m_connections.find(key);
+        NS_ASSERT(bucket != m_connections.end());
+        bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+        if (bucket->second.empty())
         {
-            return true;
+            m_connections.erase(bucket);
         }
     }
-    return false;
+    else
+    {
+        auto bucket = m_listeners.find(endPoint->GetLocalPort());
+        NS_ASSERT(bucket != m_listeners.end());
+        bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+        if (bucket->second.empty())
+        {
+            m_listeners.erase(bucket);
+        }
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
+    if (!LookupPortLocal(port))
+    {
+        return false;
+    }
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
@@ -88,7 +144,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -104,7 +160,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -127,7 +183,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -140,7 +196,27 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // The end points with the same peer and local port are all in the same
+    // bucket of the indexes
+    static const Bucket noEndPoints;
+    const Bucket* bucket = &noEndPoints;
+    if (peerPort != 0 && peerAddress != Ipv4Address::GetAny())
+    {
+        auto i = m_connections.find(ConnectionKey{peerAddress, peerPort, localPort});
+        if (i != m_connections.end())
+        {
+            bucket = &i->second;
+        }
+    }
+    else
+    {
+        auto i = m_listeners.find(localPort);
+        if (i != m_listeners.end())
+        {
+            bucket = &i->second;
+        }
+    }
+    for (auto i = bucket->begin(); i != bucket->end(); i++)
     {
         if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
             (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
@@ -152,7 +228,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     auto endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -167,6 +243,13 @@ Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
+            Unindex(endPoint);
+            auto port = m_ports.find(endPoint->GetLocalPort());
+            if (--port->second == 0)
+            {
+                m_ports.erase(port);
+            }
+            endPoint->m_demux = nullptr;
             delete endPoint;
             m_endPoints.erase(i);
             break;
@@ -211,9 +294,18 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the end points connected to the source of the packet, and the ones
+    // which are not connected, can match it
+    static const Bucket noEndPoints;
+    auto connections = m_connections.find(ConnectionKey{saddr, sport, dport});
+    auto listeners = m_listeners.find(dport);
+    const Bucket& connected =
+        connections != m_connections.end() ? connections->second : noEndPoints;
+    const Bucket& unconnected = listeners != m_listeners.end() ? listeners->second : noEndPoints;
+    for (std::size_t i = 0; i < connected.size() + unconnected.size(); i++)
     {
-        Ipv4EndPoint* endP = *i;
+        Ipv4EndPoint* endP =
+            i < connected.size() ? connected[i] : unconnected[i - connected.size()];
 
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
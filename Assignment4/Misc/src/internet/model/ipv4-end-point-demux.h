@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +44,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints connected to a peer address and port are indexed by their
+ * peer and local port, and the other ones by their local port, so that
+ * finding the endpoint of a packet does not depend on the number of
+ * connections of the node.
  */
 
 class Ipv4EndPointDemux
@@ -171,6 +178,73 @@ class Ipv4EndPointDemux
     void DeAllocate(Ipv4EndPoint* endPoint);
 
   private:
+    friend class Ipv4EndPoint;
+
+    /**
+     * \brief The peer address and port, and the local port, of a connected
+     * end point.
+     */
+    struct ConnectionKey
+    {
+        Ipv4Address peerAddress; //!< The peer address
+        uint16_t peerPort;       //!< The peer port
+        uint16_t localPort;      //!< The local port
+
+        /**
+         * \brief Equality operator.
+         * \param other the other key
+         * \return true if the keys are equal
+         */
+        bool operator==(const ConnectionKey& other) const
+        {
+            return peerAddress == other.peerAddress && peerPort == other.peerPort &&
+                   localPort == other.localPort;
+        }
+    };
+
+    /**
+     * \brief Hash function for ConnectionKey.
+     */
+    struct ConnectionKeyHash
+    {
+        /**
+         * \brief Returns the hash of a key.
+         * \param key the key
+         * \return the hash
+         */
+        size_t operator()(const ConnectionKey& key) const
+        {
+            return std::hash<uint64_t>()(static_cast<uint64_t>(key.peerAddress.Get()) << 32 |
+                                         static_cast<uint64_t>(key.peerPort) << 16 |
+                                         key.localPort);
+        }
+    };
+
+    /**
+     * \brief Container of end points with the same key.
+     */
+    typedef std::vector<Ipv4EndPoint*> Bucket;
+
+    /**
+     * \brief Add an end point to m_endPoints and to the indexes.
+     * \param endPoint the end point
+     */
+    void Insert(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add an end point to the indexes, after its creation or a change
+     * of its peer.
+     * \param endPoint the end point
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an end point from the indexes, before its removal or a
+     * change of its peer.
+     * \param endPoint the end point
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
     /**
      * \brief Allocate an ephemeral port.
      * \returns the ephemeral port
@@ -196,6 +270,22 @@ class Ipv4EndPointDemux
      * \brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The end points with a peer address and port, by peer and local
+     * port.
+     */
+    std::unordered_map<ConnectionKey, Bucket, ConnectionKeyHash> m_connections;
+
+    /**
+     * \brief The other end points, by local port.
+     */
+    std::unordered_map<uint16_t, Bucket> m_listeners;
+
+    /**
+     * \brief The number of end points of each local port.
+     */
+    std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } // namespace ns3
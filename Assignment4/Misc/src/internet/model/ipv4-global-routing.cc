@@ -30,6 +30,8 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+#include <bit>
 #include <iomanip>
 #include <vector>
 
@@ -64,7 +66,10 @@ Ipv4GlobalRouting::GetTypeId()
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_nRoutesAdded(0),
+      m_nLookups(0),
+      m_lookupCost(0)
 {
     NS_LOG_FUNCTION(this);
 
@@ -83,6 +88,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    IndexRoute(m_hostIndex, route);
 }
 
 void
@@ -92,6 +98,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    IndexRoute(m_hostIndex, route);
 }
 
 void
@@ -104,6 +111,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    IndexRoute(m_networkIndex, route);
 }
 
 void
@@ -113,6 +121,29 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    IndexRoute(m_networkIndex, route);
+}
+
+bool
+Ipv4GlobalRouting::RemoveHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << dest << nextHop << interface);
+    return RemoveEqualRoute(m_hostRoutes,
+                            m_hostIndex,
+                            Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface));
+}
+
+bool
+Ipv4GlobalRouting::RemoveNetworkRouteTo(Ipv4Address network,
+                                        Ipv4Mask networkMask,
+                                        Ipv4Address nextHop,
+                                        uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << network << networkMask << nextHop << interface);
+    return RemoveEqualRoute(
+        m_networkRoutes,
+        m_networkIndex,
+        Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface));
 }
 
 void
@@ -125,6 +156,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    IndexRoute(m_ASexternalIndex, route);
 }
 
 Ptr<Ipv4Route>
@@ -134,69 +166,25 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     NS_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = nullptr;
     // store all available routes that bring packets to their destination
-    typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
+    typedef std::vector<IndexedRoute> RouteVec_t;
     RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
-    {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
-        {
-            if (oif)
-            {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
-        }
-    }
+    m_nLookups++;
+    LookupIndex(m_hostIndex, dest, oif, allRoutes);
+    NS_LOG_LOGIC(allRoutes.size() << " global host routes found");
     if (allRoutes.empty()) // if no host route is found
     {
-        NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-        {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
-            }
-        }
+        LookupIndex(m_networkIndex, dest, oif, allRoutes);
+        NS_LOG_LOGIC(allRoutes.size() << " global network routes found");
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        LookupIndex(m_ASexternalIndex, dest, oif, allRoutes);
+        if (!allRoutes.empty())
         {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*k);
-                break;
-            }
+            // Only the first external route is used
+            NS_LOG_LOGIC("Found external route " << allRoutes.front().first);
+            allRoutes.resize(1);
         }
     }
     if (!allRoutes.empty()) // if route(s) is found
@@ -213,7 +201,7 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
         {
             selectIndex = 0;
         }
-        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex);
+        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex).first;
         // create a Ipv4Route object from the selected routing table entry
         rtentry = Create<Ipv4Route>();
         rtentry->SetDestination(route->GetDest());
@@ -230,6 +218,102 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+/**
+ * \param mask a network mask
+ * \return the length of the prefix of the routes with this mask in the index,
+ *         i.e., the number of leading ones of the mask, which is shorter than
+ *         Ipv4Mask::GetPrefixLength() for a non-contiguous mask
+ */
+static uint8_t
+GetIndexLength(Ipv4Mask mask)
+{
+    return std::countl_one(mask.Get());
+}
+
+void
+Ipv4GlobalRouting::IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route)
+{
+    index.Insert(route->GetDestNetwork(),
+                 GetIndexLength(route->GetDestNetworkMask()),
+                 IndexedRoute(route, m_nRoutesAdded++));
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route)
+{
+    bool removed = index.Remove(route->GetDestNetwork(),
+                                GetIndexLength(route->GetDestNetworkMask()),
+                                [route](const IndexedRoute& r) { return r.first == route; });
+    NS_ASSERT_MSG(removed, "Route " << *route << " not indexed");
+}
+
+bool
+Ipv4GlobalRouting::RemoveEqualRoute(std::list<Ipv4RoutingTableEntry*>& routes,
+                                    RouteIndex& index,
+                                    const Ipv4RoutingTableEntry& route)
+{
+    auto isEqual = [&route](Ipv4RoutingTableEntry* r) { return *r == route; };
+    auto i = std::find_if(routes.begin(), routes.end(), isEqual);
+    // Equal routes cannot be told apart, and the caller may not remove the
+    // one it means to
+    if (i == routes.end() || std::find_if(std::next(i), routes.end(), isEqual) != routes.end())
+    {
+        return false;
+    }
+    UnindexRoute(index, *i);
+    delete *i;
+    routes.erase(i);
+    return true;
+}
+
+void
+Ipv4GlobalRouting::LookupIndex(const RouteIndex& index,
+                               Ipv4Address dest,
+                               Ptr<NetDevice> oif,
+                               std::vector<IndexedRoute>& routes)
+{
+    // All the routes matching the destination are candidates, whatever the
+    // length of their prefix: visit all the prefixes matching it
+    uint32_t nPrefixes = 0;
+    auto visit = [&](uint8_t /* length */, const RouteIndex::Values& values) {
+        nPrefixes++;
+        for (const auto& route : values)
+        {
+            // The index only checks the leading ones of the masks
+            if (!route.first->GetDestNetworkMask().IsMatch(dest, route.first->GetDestNetwork()))
+            {
+                continue;
+            }
+            if (oif && oif != m_ipv4->GetNetDevice(route.first->GetInterface()))
+            {
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
+            }
+            routes.push_back(route);
+        }
+    };
+    m_lookupCost += index.Lookup(dest, visit);
+    if (nPrefixes > 1)
+    {
+        // Keep the order of the routing table
+        std::sort(routes.begin(),
+                  routes.end(),
+                  [](const IndexedRoute& a, const IndexedRoute& b) { return a.second < b.second; });
+    }
+}
+
+uint64_t
+Ipv4GlobalRouting::GetNLookups() const
+{
+    return m_nLookups;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetLookupCost() const
+{
+    return m_lookupCost;
+}
+
 uint32_t
 Ipv4GlobalRouting::GetNRoutes() const
 {
@@ -297,6 +381,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             if (tmp == index)
             {
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+                UnindexRoute(m_hostIndex, *i);
                 delete *i;
                 m_hostRoutes.erase(i);
                 NS_LOG_LOGIC("Done removing host route "
@@ -313,6 +398,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
+            UnindexRoute(m_networkIndex, *j);
             delete *j;
             m_networkRoutes.erase(j);
             NS_LOG_LOGIC("Done removing network route "
@@ -328,6 +414,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
+            UnindexRoute(m_ASexternalIndex, *k);
             delete *k;
             m_ASexternalRoutes.erase(k);
             NS_LOG_LOGIC("Done removing network route "
@@ -364,6 +451,9 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_hostIndex.Clear();
+    m_networkIndex.Clear();
+    m_ASexternalIndex.Clear();
 
     Ipv4RoutingProtocol::DoDispose();
 }
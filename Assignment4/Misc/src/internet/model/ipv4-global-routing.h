@@ -20,6 +20,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include "ipv4-header.h"
+#include "ipv4-prefix-trie.h"
 #include "ipv4-routing-protocol.h"
 #include "ipv4.h"
 
@@ -29,6 +30,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -159,6 +162,42 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     void AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask, uint32_t interface);
 
+    /**
+     * \brief Remove a host route from the global routing table.
+     *
+     * The host route with these destination, next hop and interface is
+     * removed if it is the only one; the other routes keep their order.
+     *
+     * \param dest The Ipv4Address destination of the route.
+     * \param nextHop The Ipv4Address of the next hop in the route.
+     * \param interface The network interface index of the route.
+     * \return true if the route was removed, false if there is no such route
+     * or several of them.
+     *
+     * \see AddHostRouteTo
+     */
+    bool RemoveHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_t interface);
+
+    /**
+     * \brief Remove a network route from the global routing table.
+     *
+     * The network route with these destination, next hop and interface is
+     * removed if it is the only one; the other routes keep their order.
+     *
+     * \param network The Ipv4Address network of the route.
+     * \param networkMask The Ipv4Mask of the network.
+     * \param nextHop The next hop in the route.
+     * \param interface The network interface index of the route.
+     * \return true if the route was removed, false if there is no such route
+     * or several of them.
+     *
+     * \see AddNetworkRouteTo
+     */
+    bool RemoveNetworkRouteTo(Ipv4Address network,
+                              Ipv4Mask networkMask,
+                              Ipv4Address nextHop,
+                              uint32_t interface);
+
     /**
      * \brief Add an external route to the global routing table.
      *
@@ -232,6 +271,23 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     int64_t AssignStreams(int64_t stream);
 
+    /**
+     * \brief Get the number of unicast route lookups done by this node.
+     * \return The number of lookups.
+     */
+    uint64_t GetNLookups() const;
+
+    /**
+     * \brief Get the cost of the unicast route lookups done by this node.
+     *
+     * The cost is the number of nodes of the route indexes visited by the
+     * lookups (see Ipv4PrefixTrie): it grows with the length of the
+     * prefixes, not with the number of routes.
+     *
+     * \return The cost of the lookups.
+     */
+    uint64_t GetLookupCost() const;
+
   protected:
     void DoDispose() override;
 
@@ -274,10 +330,60 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ptr<Ipv4Route> LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
+    /// A route, and the number of routes added before it
+    typedef std::pair<Ipv4RoutingTableEntry*, uint64_t> IndexedRoute;
+    /// Index of the routes of a container, by destination prefix
+    typedef Ipv4PrefixTrie<IndexedRoute> RouteIndex;
+
+    /**
+     * \brief Add a route to an index.
+     * \param index the index
+     * \param route the route
+     */
+    void IndexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route);
+
+    /**
+     * \brief Remove a route from an index.
+     * \param index the index
+     * \param route the route
+     */
+    static void UnindexRoute(RouteIndex& index, Ipv4RoutingTableEntry* route);
+
+    /**
+     * \brief Remove the route of a container equal to a route, if it is the
+     * only one.
+     * \param routes the container
+     * \param index the index of the container
+     * \param route the route
+     * \return true if a route was removed
+     */
+    static bool RemoveEqualRoute(std::list<Ipv4RoutingTableEntry*>& routes,
+                                 RouteIndex& index,
+                                 const Ipv4RoutingTableEntry& route);
+
+    /**
+     * \brief Find the routes of an index to a destination.
+     * \param index the index
+     * \param dest destination address
+     * \param oif output interface if any (put 0 otherwise)
+     * \param routes the routes found, in the order they were added
+     */
+    void LookupIndex(const RouteIndex& index,
+                     Ipv4Address dest,
+                     Ptr<NetDevice> oif,
+                     std::vector<IndexedRoute>& routes);
+
     HostRoutes m_hostRoutes;             //!< Routes to hosts
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    RouteIndex m_hostIndex;       //!< Index of the routes to hosts
+    RouteIndex m_networkIndex;    //!< Index of the routes to networks
+    RouteIndex m_ASexternalIndex; //!< Index of the external routes
+    uint64_t m_nRoutesAdded;      //!< Number of routes added, to order the routes of the indexes
+    uint64_t m_nLookups;          //!< Number of unicast route lookups
+    uint64_t m_lookupCost;        //!< Number of index nodes visited by the lookups
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -30,6 +30,7 @@
 
 #include "ns3/boolean.h"
 #include "ns3/callback.h"
+#include "ns3/gso-tag.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
@@ -343,6 +344,7 @@ Ipv4L3Protocol::DoDispose()
         m_cleanDpd.Cancel();
     }
     m_dups.clear();
+    m_dupExpirations.clear();
 
     Object::DoDispose();
 }
@@ -799,6 +801,13 @@ Ipv4L3Protocol::Send(Ptr<Packet> packet,
         // 1b) with a valid gateway
         NS_LOG_LOGIC("Ipv4L3Protocol::Send case 1b:  passed in with route and valid gateway");
         int32_t interface = GetInterfaceForDevice(route->GetOutputDevice());
+        GsoTag gsoTag;
+        if (packet->PeekPacketTag(gsoTag) && gsoTag.GetSegments() > 1)
+        {
+            // Each segment of a GSO batch takes its own identification
+            uint64_t srcDst = destination.Get() | (uint64_t(source.Get()) << 32);
+            m_identification[std::make_pair(srcDst, protocol)] += gsoTag.GetSegments() - 1;
+        }
         m_sendOutgoingTrace(ipHeader, packet, interface);
         if (m_enableDpd && ipHeader.GetDestination().IsMulticast())
         {
@@ -991,6 +1000,33 @@ Ipv4L3Protocol::SendRealOut(Ptr<Ipv4Route> route, Ptr<Packet> packet, const Ipv4
     if (outInterface->IsUp())
     {
         NS_LOG_LOGIC("Send to " << targetLabel << " " << target);
+        GsoTag gsoTag;
+        if (packet->PeekPacketTag(gsoTag))
+        {
+            uint32_t segmentSize =
+                ipHeader.GetSerializedSize() + gsoTag.GetHeaderSize() + gsoTag.GetSegmentSize();
+            if (outDev->SupportsGso() && segmentSize <= outDev->GetMtu())
+            {
+                // The device splits the batch when sending it
+                CallTxTrace(ipHeader, packet, this, interface);
+                outInterface->Send(packet, ipHeader, target);
+                return;
+            }
+            NS_LOG_LOGIC("Split the GSO batch of " << gsoTag.GetSegments() << " segments");
+            Ptr<Packet> batch = packet->Copy();
+            batch->AddHeader(ipHeader);
+            for (const auto& segment : GsoTag::Segment(batch, PROT_NUMBER))
+            {
+                Ipv4Header segmentHeader;
+                segment->RemoveHeader(segmentHeader);
+                if (Node::ChecksumEnabled())
+                {
+                    segmentHeader.EnableChecksum();
+                }
+                SendRealOut(route, segment, segmentHeader);
+            }
+            return;
+        }
         if (packet->GetSize() + ipHeader.GetSerializedSize() > outInterface->GetDevice()->GetMtu())
         {
             std::list<Ipv4PayloadHeaderPair> listFragments;
@@ -1598,14 +1634,11 @@ Ipv4L3Protocol::Fragments::AddFragment(Ptr<Packet> fragment,
 {
     NS_LOG_FUNCTION(this << fragment << fragmentOffset << moreFragment);
 
-    std::list<std::pair<Ptr<Packet>, uint16_t>>::iterator it;
-
-    for (it = m_fragments.begin(); it != m_fragments.end(); it++)
+    // The fragments mostly arrive in order, look for the position from the end
+    auto it = m_fragments.end();
+    while (it != m_fragments.begin() && std::prev(it)->second > fragmentOffset)
     {
-        if (it->second > fragmentOffset)
-        {
-            break;
-        }
+        it--;
     }
 
     if (it == m_fragments.end())
@@ -1614,6 +1647,24 @@ Ipv4L3Protocol::Fragments::AddFragment(Ptr<Packet> fragment,
     }
 
     m_fragments.insert(it, std::pair<Ptr<Packet>, uint16_t>(fragment, fragmentOffset));
+
+    // Merge the fragment with the ranges it overlaps or touches
+    uint32_t start = fragmentOffset;
+    uint32_t end = start + fragment->GetSize();
+    auto range = m_ranges.upper_bound(start);
+    if (range != m_ranges.begin() && std::prev(range)->second >= start)
+    {
+        range--;
+        start = range->first;
+        end = std::max(end, range->second);
+        range = m_ranges.erase(range);
+    }
+    while (range != m_ranges.end() && range->first <= end)
+    {
+        end = std::max(end, range->second);
+        range = m_ranges.erase(range);
+    }
+    m_ranges.emplace_hint(range, start, end);
 }
 
 bool
@@ -1621,29 +1672,8 @@ Ipv4L3Protocol::Fragments::IsEntire() const
 {
     NS_LOG_FUNCTION(this);
 
-    bool ret = !m_moreFragment && !m_fragments.empty();
-
-    if (ret)
-    {
-        uint16_t lastEndOffset = 0;
-
-        for (auto it = m_fragments.begin(); it != m_fragments.end(); it++)
-        {
-            // overlapping fragments do exist
-            NS_LOG_LOGIC("Checking overlaps " << lastEndOffset << " - " << it->second);
-
-            if (lastEndOffset < it->second)
-            {
-                ret = false;
-                break;
-            }
-            // fragments might overlap in strange ways
-            uint16_t fragmentEnd = it->first->GetSize() + it->second;
-            lastEndOffset = std::max(lastEndOffset, fragmentEnd);
-        }
-    }
-
-    return ret;
+    // overlapping fragments do exist, they have been merged in m_ranges
+    return !m_moreFragment && m_ranges.size() == 1 && m_ranges.begin()->first == 0;
 }
 
 Ptr<Packet>
@@ -1817,6 +1847,10 @@ Ipv4L3Protocol::UpdateDuplicate(Ptr<const Packet> p, const Ipv4Header& header)
 
     // set the expiration event
     iter->second = Simulator::Now() + m_expire;
+    if (m_purge.IsStrictlyPositive())
+    {
+        m_dupExpirations.emplace_back(iter->second, key);
+    }
     return isDup;
 }
 
@@ -1825,24 +1859,23 @@ Ipv4L3Protocol::RemoveDuplicates()
 {
     NS_LOG_FUNCTION(this);
 
+    // The expiration times are queued in increasing order, and an entry
+    // refreshed since a time was queued has a later time queued as well
     DupMap_t::size_type n = 0;
     Time expire = Simulator::Now();
-    auto iter = m_dups.cbegin();
-    while (iter != m_dups.cend())
+    while (!m_dupExpirations.empty() && m_dupExpirations.front().first < expire)
     {
-        if (iter->second < expire)
+        auto iter = m_dups.find(m_dupExpirations.front().second);
+        if (iter != m_dups.end() && iter->second < expire)
         {
             NS_LOG_LOGIC("Remove key = (" << std::hex << std::get<0>(iter->first) << ", "
                                           << std::dec << +std::get<1>(iter->first) << ", "
                                           << std::get<2>(iter->first) << ", "
                                           << std::get<3>(iter->first) << ")");
-            iter = m_dups.erase(iter);
+            m_dups.erase(iter);
             ++n;
         }
-        else
-        {
-            ++iter;
-        }
+        m_dupExpirations.pop_front();
     }
 
     NS_LOG_DEBUG("Purged " << n << " expired duplicate entries out of " << (n + m_dups.size()));
@@ -32,9 +32,11 @@
 #include "ns3/simulator.h"
 #include "ns3/traced-callback.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 class Ipv4L3ProtocolTestCase;
@@ -509,6 +511,20 @@ class Ipv4L3Protocol : public Ipv4
     /// Key identifying a fragmented packet
     typedef std::pair<uint64_t, uint32_t> FragmentKey_t;
 
+    /// Hash function for the FragmentKey_t keys
+    struct FragmentKeyHash
+    {
+        /**
+         * \brief Hash a fragmented packet key.
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const FragmentKey_t& key) const
+        {
+            return std::hash<uint64_t>()(key.first ^ (uint64_t(key.second) << 16));
+        }
+    };
+
     /// Container for fragment timeouts.
     typedef std::list<std::tuple<Time, FragmentKey_t, Ipv4Header, uint32_t>>
         FragmentsTimeoutsList_t;
@@ -598,10 +614,17 @@ class Ipv4L3Protocol : public Ipv4
         bool m_moreFragment;
 
         /**
-         * \brief The current fragments.
+         * \brief The current fragments, sorted by offset.
          */
         std::list<std::pair<Ptr<Packet>, uint16_t>> m_fragments;
 
+        /**
+         * \brief The byte ranges received so far, merged when they overlap or
+         * touch, indexed by start offset. The packet has no holes left when a
+         * single range starts at zero.
+         */
+        std::map<uint32_t, uint32_t> m_ranges;
+
         /**
          * \brief Timeout iterator to "event" handler
          */
@@ -609,7 +632,7 @@ class Ipv4L3Protocol : public Ipv4
     };
 
     /// Container of fragments, stored as pairs(src+dst addr, src+dst port) / fragment
-    typedef std::map<FragmentKey_t, Ptr<Fragments>> MapFragments_t;
+    typedef std::unordered_map<FragmentKey_t, Ptr<Fragments>, FragmentKeyHash> MapFragments_t;
 
     MapFragments_t m_fragments;       //!< Fragmented packets.
     Time m_fragmentExpirationTimeout; //!< Expiration timeout
@@ -618,8 +641,24 @@ class Ipv4L3Protocol : public Ipv4
     /// RFC 6621 recommended duplicate packet tuple: {IPV hash, IP protocol, IP source address, IP
     /// destination address}
     typedef std::tuple<uint64_t, uint8_t, Ipv4Address, Ipv4Address> DupTuple_t;
+
+    /// Hash function for the DupTuple_t keys
+    struct DupTupleHash
+    {
+        /**
+         * \brief Hash a duplicate packet tuple.
+         * \param key the tuple
+         * \return the hash of the tuple
+         */
+        std::size_t operator()(const DupTuple_t& key) const
+        {
+            uint64_t addresses = uint64_t(std::get<2>(key).Get()) << 32 | std::get<3>(key).Get();
+            return std::hash<uint64_t>()(std::get<0>(key) ^ addresses ^ std::get<1>(key));
+        }
+    };
+
     /// Maps packet duplicate tuple to expiration time
-    typedef std::map<DupTuple_t, Time> DupMap_t;
+    typedef std::unordered_map<DupTuple_t, Time, DupTupleHash> DupMap_t;
 
     /**
      * Registers duplicate entry, return false if new
@@ -633,8 +672,10 @@ class Ipv4L3Protocol : public Ipv4
      */
     void RemoveDuplicates();
 
-    bool m_enableDpd;   //!< Enable multicast duplicate packet detection
-    DupMap_t m_dups;    //!< map of packet duplicate tuples to expiry event
+    bool m_enableDpd; //!< Enable multicast duplicate packet detection
+    DupMap_t m_dups;  //!< map of packet duplicate tuples to expiry event
+    /// Expiration times set in m_dups, in the order they were set
+    std::deque<std::pair<Time, DupTuple_t>> m_dupExpirations;
     Time m_expire;      //!< duplicate entry expiration delay
     Time m_purge;       //!< time between purging expired duplicate entries
     EventId m_cleanDpd; //!< event to cleanup expired duplicate entries
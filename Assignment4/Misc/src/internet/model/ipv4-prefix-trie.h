@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of IPv4 prefixes.
+ *
+ * Each prefix holds the values (e.g., the routes) added to it, in the order
+ * they were added, so that the equal-cost routes to a prefix are found
+ * together.  The trie only has nodes for the prefixes which hold values and
+ * for the prefixes where two branches fork, so that a lookup visits at most
+ * 33 nodes and usually much less than that, whatever the number of
+ * prefixes.
+ *
+ * The trie is an index: it does not own the values, and the routing
+ * protocols keep their routes in their own containers as well.
+ *
+ * \tparam T \explicit The type of the values.
+ */
+template <typename T>
+class Ipv4PrefixTrie
+{
+  public:
+    /// The values of a prefix
+    typedef std::vector<T> Values;
+
+    Ipv4PrefixTrie();
+
+    /**
+     * Add a value to a prefix.
+     *
+     * \param [in] prefix The prefix; the bits after its length are ignored.
+     * \param [in] length The length of the prefix.
+     * \param [in] value The value, added after the values of the prefix.
+     */
+    void Insert(Ipv4Address prefix, uint8_t length, const T& value);
+
+    /**
+     * Remove a value from a prefix.
+     *
+     * \param [in] prefix The prefix; the bits after its length are ignored.
+     * \param [in] length The length of the prefix.
+     * \param [in] match A predicate selecting the value to remove.
+     * \return \c true if a value was removed.
+     *
+     * \tparam P \deduced The type of the predicate.
+     */
+    template <typename P>
+    bool Remove(Ipv4Address prefix, uint8_t length, P match);
+
+    /**
+     * \param [in] prefix The prefix; the bits after its length are ignored.
+     * \param [in] length The length of the prefix.
+     * \return The values of the prefix, or \c nullptr if it has none.
+     */
+    const Values* Find(Ipv4Address prefix, uint8_t length) const;
+
+    /**
+     * Visit the prefixes matching an address.
+     *
+     * The prefixes with values are visited from the shortest to the
+     * longest, by calling <tt>visit(length, values)</tt>.
+     *
+     * \param [in] address The address.
+     * \param [in] visit The visitor.
+     * \return The number of nodes visited, as a measure of the cost of the
+     *         lookup.
+     *
+     * \tparam F \deduced The type of the visitor.
+     */
+    template <typename F>
+    uint32_t Lookup(Ipv4Address address, F visit) const;
+
+    /** Remove all the values. */
+    void Clear();
+
+  private:
+    /** A node of the trie. */
+    struct Node
+    {
+        uint32_t prefix{0};                //!< The prefix, with the bits after length cleared
+        uint8_t length{0};                 //!< The length of the prefix
+        Values values;                     //!< The values of the prefix
+        std::unique_ptr<Node> children[2]; //!< The subtries, by the bit after the prefix
+    };
+
+    /**
+     * \param [in] length A prefix length.
+     * \return The mask of the prefixes of this length.
+     */
+    static uint32_t GetMask(uint8_t length);
+    /**
+     * \param [in] address An address.
+     * \param [in] index The index of a bit, from the most significant one.
+     * \return The bit.
+     */
+    static uint32_t GetBit(uint32_t address, uint8_t index);
+
+    std::unique_ptr<Node> m_root; //!< The root, for the empty prefix
+};
+
+/*************************************************
+ *  Implementation of the templates declared above.
+ *************************************************/
+
+template <typename T>
+Ipv4PrefixTrie<T>::Ipv4PrefixTrie()
+    : m_root(std::make_unique<Node>())
+{
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetMask(uint8_t length)
+{
+    return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetBit(uint32_t address, uint8_t index)
+{
+    return (address >> (31 - index)) & 1;
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Insert(Ipv4Address prefix, uint8_t length, const T& value)
+{
+    NS_ASSERT(length <= 32);
+    uint32_t key = prefix.Get() & GetMask(length);
+    Node* node = m_root.get();
+    while (node->length < length)
+    {
+        std::unique_ptr<Node>& child = node->children[GetBit(key, node->length)];
+        if (!child)
+        {
+            child = std::make_unique<Node>();
+            child->prefix = key;
+            child->length = length;
+            child->values.push_back(value);
+            return;
+        }
+        uint8_t common = node->length;
+        uint8_t maxCommon = std::min(length, child->length);
+        while (common < maxCommon && GetBit(key, common) == GetBit(child->prefix, common))
+        {
+            common++;
+        }
+        if (common < child->length)
+        {
+            // The prefix forks from the child, or is a prefix of it: insert
+            // a node for the common prefix between them
+            auto fork = std::make_unique<Node>();
+            fork->prefix = key & GetMask(common);
+            fork->length = common;
+            fork->children[GetBit(child->prefix, common)] = std::move(child);
+            child = std::move(fork);
+        }
+        node = child.get();
+    }
+    node->values.push_back(value);
+}
+
+template <typename T>
+template <typename P>
+bool
+Ipv4PrefixTrie<T>::Remove(Ipv4Address prefix, uint8_t length, P match)
+{
+    NS_ASSERT(length <= 32);
+    uint32_t key = prefix.Get() & GetMask(length);
+    std::vector<std::unique_ptr<Node>*> path{&m_root};
+    Node* node = m_root.get();
+    while (node->length < length)
+    {
+        std::unique_ptr<Node>& child = node->children[GetBit(key, node->length)];
+        if (!child || child->length > length || (key & GetMask(child->length)) != child->prefix)
+        {
+            return false;
+        }
+        path.push_back(&child);
+        node = child.get();
+    }
+    auto it = std::find_if(node->values.begin(), node->values.end(), match);
+    if (it == node->values.end())
+    {
+        return false;
+    }
+    node->values.erase(it);
+
+    // Remove the nodes left without values and with a single subtrie, up to
+    // the first node which is still needed
+    while (path.size() > 1)
+    {
+        std::unique_ptr<Node>& slot = *path.back();
+        path.pop_back();
+        if (!slot->values.empty() || (slot->children[0] && slot->children[1]))
+        {
+            break;
+        }
+        if (slot->children[0] || slot->children[1])
+        {
+            // Splice the subtrie: the parent keeps the same number of children
+            slot = std::move(slot->children[slot->children[0] ? 0 : 1]);
+            break;
+        }
+        slot.reset();
+    }
+    return true;
+}
+
+template <typename T>
+const typename Ipv4PrefixTrie<T>::Values*
+Ipv4PrefixTrie<T>::Find(Ipv4Address prefix, uint8_t length) const
+{
+    NS_ASSERT(length <= 32);
+    uint32_t key = prefix.Get() & GetMask(length);
+    const Node* node = m_root.get();
+    while (node && node->length < length)
+    {
+        node = node->children[GetBit(key, node->length)].get();
+        if (node && (key & GetMask(node->length)) != node->prefix)
+        {
+            return nullptr;
+        }
+    }
+    if (!node || node->length != length || node->values.empty())
+    {
+        return nullptr;
+    }
+    return &node->values;
+}
+
+template <typename T>
+template <typename F>
+uint32_t
+Ipv4PrefixTrie<T>::Lookup(Ipv4Address address, F visit) const
+{
+    uint32_t key = address.Get();
+    uint32_t cost = 0;
+    const Node* node = m_root.get();
+    while (node && (key & GetMask(node->length)) == node->prefix)
+    {
+        cost++;
+        if (!node->values.empty())
+        {
+            visit(node->length, node->values);
+        }
+        if (node->length == 32)
+        {
+            break;
+        }
+        node = node->children[GetBit(key, node->length)].get();
+    }
+    return cost;
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Clear()
+{
+    m_root = std::make_unique<Node>();
+}
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
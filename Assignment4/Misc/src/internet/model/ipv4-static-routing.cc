@@ -36,6 +36,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <bit>
 #include <iomanip>
 
 using std::make_pair;
@@ -58,7 +59,9 @@ Ipv4StaticRouting::GetTypeId()
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting()
-    : m_ipv4(nullptr)
+    : m_nLookups(0),
+      m_lookupCost(0),
+      m_ipv4(nullptr)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -79,7 +82,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     if (!LookupRoute(route, metric))
     {
         auto routePtr = new Ipv4RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertRoute(routePtr, metric);
     }
 }
 
@@ -97,7 +100,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     {
         auto routePtr = new Ipv4RoutingTableEntry(route);
 
-        m_networkRoutes.emplace_back(routePtr, metric);
+        InsertRoute(routePtr, metric);
     }
 }
 
@@ -152,7 +155,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Address network("224.0.0.0");
     Ipv4Mask networkMask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    InsertRoute(route, 0);
 }
 
 uint32_t
@@ -221,17 +224,35 @@ Ipv4StaticRouting::RemoveMulticastRoute(uint32_t index)
     }
 }
 
+/**
+ * \param mask a network mask
+ * \return the length of the prefix of the routes with this mask in the index,
+ *         i.e., the number of leading ones of the mask, which is shorter than
+ *         Ipv4Mask::GetPrefixLength() for a non-contiguous mask
+ */
+static uint8_t
+GetIndexLength(Ipv4Mask mask)
+{
+    return std::countl_one(mask.Get());
+}
+
 bool
 Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric)
 {
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    const NetworkRouteIndex::Values* routes =
+        m_networkIndex.Find(route.GetDestNetwork(), GetIndexLength(route.GetDestNetworkMask()));
+    if (!routes)
     {
-        Ipv4RoutingTableEntry* rtentry = j->first;
+        return false;
+    }
+    for (const auto& j : *routes)
+    {
+        Ipv4RoutingTableEntry* rtentry = j.first;
 
         if (rtentry->GetDest() == route.GetDest() &&
             rtentry->GetDestNetworkMask() == route.GetDestNetworkMask() &&
             rtentry->GetGateway() == route.GetGateway() &&
-            rtentry->GetInterface() == route.GetInterface() && j->second == metric)
+            rtentry->GetInterface() == route.GetInterface() && j.second == metric)
         {
             return true;
         }
@@ -239,13 +260,33 @@ Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metr
     return false;
 }
 
+void
+Ipv4StaticRouting::InsertRoute(Ipv4RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    m_networkIndex.Insert(route->GetDestNetwork(),
+                          GetIndexLength(route->GetDestNetworkMask()),
+                          std::make_pair(route, metric));
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseRoute(NetworkRoutesI it)
+{
+    Ipv4RoutingTableEntry* route = it->first;
+    bool removed = m_networkIndex.Remove(
+        route->GetDestNetwork(),
+        GetIndexLength(route->GetDestNetworkMask()),
+        [route](const std::pair<Ipv4RoutingTableEntry*, uint32_t>& r) { return r.first == route; });
+    NS_ASSERT_MSG(removed, "Route " << *route << " not indexed");
+    delete route;
+    return m_networkRoutes.erase(it);
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
 {
     NS_LOG_FUNCTION(this << dest << " " << oif);
     Ptr<Ipv4Route> rtentry = nullptr;
-    uint16_t longest_mask = 0;
-    uint32_t shortest_metric = 0xffffffff;
     /* when sending on local multicast, there have to be interface specified */
     if (dest.IsLocalMulticast())
     {
@@ -261,17 +302,39 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (auto i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+    // The routes to the prefixes matching the destination, from the
+    // shortest prefix to the longest one
+    const NetworkRouteIndex::Values* matches[33];
+    uint32_t nMatches = 0;
+    auto visit = [&](uint8_t /* length */, const NetworkRouteIndex::Values& values) {
+        matches[nMatches++] = &values;
+    };
+    m_nLookups++;
+    m_lookupCost += m_networkIndex.Lookup(dest, visit);
+
+    // Use the route with the longest mask, and then the lowest metric.  A
+    // non-contiguous mask is indexed by its leading ones only, hence its
+    // length may be longer than that of a longer prefix: check all the
+    // prefixes matching the destination.
+    Ipv4RoutingTableEntry* route = nullptr;
+    uint16_t longest_mask = 0;
+    uint32_t shortest_metric = 0xffffffff;
+    for (uint32_t k = 0; k < nMatches; k++)
     {
-        Ipv4RoutingTableEntry* j = i->first;
-        uint32_t metric = i->second;
-        Ipv4Mask mask = (j)->GetDestNetworkMask();
-        uint16_t masklen = mask.GetPrefixLength();
-        Ipv4Address entry = (j)->GetDestNetwork();
-        NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to " << entry
-                                               << "/" << masklen);
-        if (mask.IsMatch(dest, entry))
+        for (const auto& i : *matches[k])
         {
+            Ipv4RoutingTableEntry* j = i.first;
+            uint32_t metric = i.second;
+            Ipv4Mask mask = j->GetDestNetworkMask();
+            uint16_t masklen = mask.GetPrefixLength();
+            Ipv4Address entry = j->GetDestNetwork();
+            NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to "
+                                                   << entry << "/" << masklen);
+            // The index only checks the leading ones of the masks
+            if (!mask.IsMatch(dest, entry))
+            {
+                continue;
+            }
             NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
                                                        << ", metric " << metric);
             if (oif)
@@ -298,18 +361,25 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
                 continue;
             }
             shortest_metric = metric;
-            Ipv4RoutingTableEntry* route = (j);
-            uint32_t interfaceIdx = route->GetInterface();
-            rtentry = Create<Ipv4Route>();
-            rtentry->SetDestination(route->GetDest());
-            rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
-            rtentry->SetGateway(route->GetGateway());
-            rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+            route = j;
             if (masklen == 32)
             {
                 break;
             }
         }
+        if (longest_mask == 32)
+        {
+            break;
+        }
+    }
+    if (route)
+    {
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
     }
     if (rtentry)
     {
@@ -457,8 +527,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
-            delete j->first;
-            m_networkRoutes.erase(j);
+            EraseRoute(j);
             return;
         }
         tmp++;
@@ -466,6 +535,18 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     NS_ASSERT(false);
 }
 
+uint64_t
+Ipv4StaticRouting::GetNLookups() const
+{
+    return m_nLookups;
+}
+
+uint64_t
+Ipv4StaticRouting::GetLookupCost() const
+{
+    return m_lookupCost;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::RouteOutput(Ptr<Packet> p,
                                const Ipv4Header& header,
@@ -592,6 +673,7 @@ Ipv4StaticRouting::DoDispose()
     {
         delete (j->first);
     }
+    m_networkIndex.Clear();
     for (auto i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
     {
@@ -631,8 +713,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseRoute(it);
         }
         else
         {
@@ -676,8 +757,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkMask() == networkMask)
         {
-            delete it->first;
-            it = m_networkRoutes.erase(it);
+            it = EraseRoute(it);
         }
         else
         {
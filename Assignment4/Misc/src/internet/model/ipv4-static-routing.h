@@ -22,6 +22,7 @@
 #define IPV4_STATIC_ROUTING_H
 
 #include "ipv4-header.h"
+#include "ipv4-prefix-trie.h"
 #include "ipv4-routing-protocol.h"
 #include "ipv4.h"
 
@@ -359,6 +360,23 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     void RemoveMulticastRoute(uint32_t index);
 
+    /**
+     * \brief Get the number of unicast route lookups done by this node.
+     * \return The number of lookups.
+     */
+    uint64_t GetNLookups() const;
+
+    /**
+     * \brief Get the cost of the unicast route lookups done by this node.
+     *
+     * The cost is the number of nodes of the route index visited by the
+     * lookups (see Ipv4PrefixTrie): it grows with the length of the
+     * prefixes, not with the number of routes.
+     *
+     * \return The cost of the lookups.
+     */
+    uint64_t GetLookupCost() const;
+
   protected:
     void DoDispose() override;
 
@@ -372,6 +390,9 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
     /// Iterator for container for the network routes
     typedef std::list<std::pair<Ipv4RoutingTableEntry*, uint32_t>>::iterator NetworkRoutesI;
 
+    /// Index of the network routes, by destination prefix
+    typedef Ipv4PrefixTrie<std::pair<Ipv4RoutingTableEntry*, uint32_t>> NetworkRouteIndex;
+
     /// Container for the multicast routes
     typedef std::list<Ipv4MulticastRoutingTableEntry*> MulticastRoutes;
 
@@ -389,6 +410,21 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     bool LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric);
 
+    /**
+     * \brief Add a network route to the forwarding table and to its index.
+     * \param route route
+     * \param metric metric of route
+     */
+    void InsertRoute(Ipv4RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * \brief Remove a network route from the forwarding table and from its
+     * index, and delete it.
+     * \param it the route
+     * \return the route following the removed one
+     */
+    NetworkRoutesI EraseRoute(NetworkRoutesI it);
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -411,6 +447,14 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the index of the forwarding table for network.
+     */
+    NetworkRouteIndex m_networkIndex;
+
+    uint64_t m_nLookups;   //!< Number of unicast route lookups
+    uint64_t m_lookupCost; //!< Number of index nodes visited by the lookups
+
     /**
      * \brief the forwarding table for multicast.
      */
@@ -23,6 +23,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -42,29 +44,83 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv6EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
 }
 
-bool
-Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+void
+Ipv6EndPointDemux::Insert(Ipv6EndPoint* endPoint)
 {
-    NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->GetLocalPort()]++;
+    Index(endPoint);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv6EndPointDemux::Index(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv6Address::GetAny())
+    {
+        ConnectionKey key{endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort(),
+                          endPoint->GetLocalPort()};
+        m_connections[key].push_back(endPoint);
+    }
+    else
+    {
+        m_listeners[endPoint->GetLocalPort()].push_back(endPoint);
+    }
+}
+
+void
+Ipv6EndPointDemux::Unindex(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (endPoint->GetPeerPort() != 0 && endPoint->GetPeerAddress() != Ipv6Address::GetAny())
     {
-        if ((*i)->GetLocalPort() == port)
+        ConnectionKey key{endPoint->GetPeerAddress(),
+                          endPoint->GetPeerPort(),
+                          endPoint->GetLocalPort()};
+        auto bucket = m_connections.find(key);
+        NS_ASSERT(bucket != m_connections.end());
+        bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+        if (bucket->second.empty())
         {
-            return true;
+            m_connections.erase(bucket);
         }
     }
-    return false;
+    else
+    {
+        auto bucket = m_listeners.find(endPoint->GetLocalPort());
+        NS_ASSERT(bucket != m_listeners.end());
+        bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+        if (bucket->second.empty())
+        {
+            m_listeners.erase(bucket);
+        }
+    }
+}
+
+bool
+Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
+    if (!LookupPortLocal(port))
+    {
+        return false;
+    }
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
@@ -87,7 +143,7 @@ Ipv6EndPointDemux::Allocate()
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -103,7 +159,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -126,7 +182,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         return nullptr;
     }
     auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -139,7 +195,27 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // The end points with the same peer and local port are all in the same
+    // bucket of the indexes
+    static const Bucket noEndPoints;
+    const Bucket* bucket = &noEndPoints;
+    if (peerPort != 0 && peerAddress != Ipv6Address::GetAny())
+    {
+        auto i = m_connections.find(ConnectionKey{peerAddress, peerPort, localPort});
+        if (i != m_connections.end())
+        {
+            bucket = &i->second;
+        }
+    }
+    else
+    {
+        auto i = m_listeners.find(localPort);
+        if (i != m_listeners.end())
+        {
+            bucket = &i->second;
+        }
+    }
+    for (auto i = bucket->begin(); i != bucket->end(); i++)
     {
         if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
             (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
@@ -151,7 +227,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     auto endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -166,6 +242,13 @@ Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
+            Unindex(endPoint);
+            auto port = m_ports.find(endPoint->GetLocalPort());
+            if (--port->second == 0)
+            {
+                m_ports.erase(port);
+            }
+            endPoint->m_demux = nullptr;
             delete endPoint;
             m_endPoints.erase(i);
             break;
@@ -193,9 +276,18 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval4; /* Exact match on all 4 */
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // Only the end points connected to the source of the packet, and the ones
+    // which are not connected, can match it
+    static const Bucket noEndPoints;
+    auto connections = m_connections.find(ConnectionKey{saddr, sport, dport});
+    auto listeners = m_listeners.find(dport);
+    const Bucket& connected =
+        connections != m_connections.end() ? connections->second : noEndPoints;
+    const Bucket& unconnected = listeners != m_listeners.end() ? listeners->second : noEndPoints;
+    for (std::size_t i = 0; i < connected.size() + unconnected.size(); i++)
     {
-        Ipv6EndPoint* endP = *i;
+        Ipv6EndPoint* endP =
+            i < connected.size() ? connected[i] : unconnected[i - connected.size()];
 
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
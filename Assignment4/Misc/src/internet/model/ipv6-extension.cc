@@ -720,7 +720,8 @@ Ipv6ExtensionFragment::HandleTimeout()
 }
 
 Ipv6ExtensionFragment::Fragments::Fragments()
-    : m_moreFragment(false)
+    : m_moreFragment(false),
+      m_holes(0)
 {
 }
 
@@ -734,14 +735,12 @@ Ipv6ExtensionFragment::Fragments::AddFragment(Ptr<Packet> fragment,
                                               bool moreFragment)
 {
     NS_LOG_FUNCTION(this << fragment << fragmentOffset << moreFragment);
-    std::list<std::pair<Ptr<Packet>, uint16_t>>::iterator it;
 
-    for (it = m_packetFragments.begin(); it != m_packetFragments.end(); it++)
+    // The fragments mostly arrive in order, look for the position from the end
+    auto it = m_packetFragments.end();
+    while (it != m_packetFragments.begin() && std::prev(it)->second > fragmentOffset)
     {
-        if (it->second > fragmentOffset)
-        {
-            break;
-        }
+        it--;
     }
 
     if (it == m_packetFragments.end())
@@ -749,7 +748,27 @@ Ipv6ExtensionFragment::Fragments::AddFragment(Ptr<Packet> fragment,
         m_moreFragment = moreFragment;
     }
 
-    m_packetFragments.insert(it, std::pair<Ptr<Packet>, uint16_t>(fragment, fragmentOffset));
+    // A hole is a fragment not starting where the previous one ends
+    auto isHole = [this](std::list<std::pair<Ptr<Packet>, uint16_t>>::iterator next) {
+        if (next == m_packetFragments.begin())
+        {
+            return next->second != 0;
+        }
+        auto previous = std::prev(next);
+        return uint16_t(previous->second + previous->first->GetSize()) != next->second;
+    };
+
+    if (it != m_packetFragments.end())
+    {
+        m_holes -= isHole(it);
+    }
+    auto inserted =
+        m_packetFragments.insert(it, std::pair<Ptr<Packet>, uint16_t>(fragment, fragmentOffset));
+    m_holes += isHole(inserted);
+    if (it != m_packetFragments.end())
+    {
+        m_holes += isHole(it);
+    }
 }
 
 void
@@ -762,25 +781,7 @@ Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart(Ptr<Packet> unfragmentab
 bool
 Ipv6ExtensionFragment::Fragments::IsEntire() const
 {
-    bool ret = !m_moreFragment && !m_packetFragments.empty();
-
-    if (ret)
-    {
-        uint16_t lastEndOffset = 0;
-
-        for (auto it = m_packetFragments.begin(); it != m_packetFragments.end(); it++)
-        {
-            if (lastEndOffset != it->second)
-            {
-                ret = false;
-                break;
-            }
-
-            lastEndOffset += it->first->GetSize();
-        }
-    }
-
-    return ret;
+    return !m_moreFragment && !m_packetFragments.empty() && m_holes == 0;
 }
 
 Ptr<Packet>
@@ -37,6 +37,7 @@
 #include <list>
 #include <map>
 #include <tuple>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -326,6 +327,22 @@ class Ipv6ExtensionFragment : public Ipv6Extension
      */
     typedef std::pair<Ipv6Address, uint32_t> FragmentKey_t;
 
+    /**
+     * Hash function for the FragmentKey_t keys
+     */
+    struct FragmentKeyHash
+    {
+        /**
+         * \brief Hash a fragmented packet key.
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const FragmentKey_t& key) const
+        {
+            return Ipv6AddressHash()(key.first) ^ std::hash<uint32_t>()(key.second);
+        }
+    };
+
     /**
      * Container for fragment timeouts.
      */
@@ -405,10 +422,16 @@ class Ipv6ExtensionFragment : public Ipv6Extension
         bool m_moreFragment;
 
         /**
-         * \brief The current fragments.
+         * \brief The current fragments, sorted by offset.
          */
         std::list<std::pair<Ptr<Packet>, uint16_t>> m_packetFragments;
 
+        /**
+         * \brief Number of places where a fragment does not start where the
+         * previous one ends, counting a first fragment not starting at zero.
+         */
+        uint32_t m_holes;
+
         /**
          * \brief The unfragmentable part.
          */
@@ -447,7 +470,7 @@ class Ipv6ExtensionFragment : public Ipv6Extension
     /**
      * \brief Container for the packet fragments.
      */
-    typedef std::map<FragmentKey_t, Ptr<Fragments>> MapFragments_t;
+    typedef std::unordered_map<FragmentKey_t, Ptr<Fragments>, FragmentKeyHash> MapFragments_t;
 
     /**
      * \brief The hash of fragmented packets.
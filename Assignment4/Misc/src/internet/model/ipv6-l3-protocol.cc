@@ -35,6 +35,7 @@
 
 #include "ns3/boolean.h"
 #include "ns3/callback.h"
+#include "ns3/gso-tag.h"
 #include "ns3/log.h"
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
@@ -1230,7 +1231,28 @@ Ipv6L3Protocol::SendRealOut(Ptr<Ipv6Route> route, Ptr<Packet> packet, const Ipv6
         targetMtu = dev->GetMtu();
     }
 
-    if (packet->GetSize() + ipHeader.GetSerializedSize() > targetMtu)
+    GsoTag gsoTag;
+    bool isGsoBatch = packet->PeekPacketTag(gsoTag);
+    if (isGsoBatch &&
+        (!dev->SupportsGso() ||
+         ipHeader.GetSerializedSize() + gsoTag.GetHeaderSize() + gsoTag.GetSegmentSize() >
+             targetMtu))
+    {
+        // Split the batch here, and send the segments (fragmenting them if needed).
+        // Otherwise the device splits the batch when sending it.
+        NS_LOG_LOGIC("Split the GSO batch of " << gsoTag.GetSegments() << " segments");
+        Ptr<Packet> batch = packet->Copy();
+        batch->AddHeader(ipHeader);
+        for (const auto& segment : GsoTag::Segment(batch, PROT_NUMBER))
+        {
+            Ipv6Header segmentHeader;
+            segment->RemoveHeader(segmentHeader);
+            SendRealOut(route, segment, segmentHeader);
+        }
+        return;
+    }
+
+    if (!isGsoBatch && packet->GetSize() + ipHeader.GetSerializedSize() > targetMtu)
     {
         // Router => drop
         if (!fromMe)
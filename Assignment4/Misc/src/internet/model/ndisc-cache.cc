@@ -28,6 +28,8 @@
 #include "ns3/node.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -101,9 +103,10 @@ NdiscCache::Lookup(Ipv6Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
 
-    if (m_ndCache.find(dst) != m_ndCache.end())
+    auto it = m_ndCache.find(dst);
+    if (it != m_ndCache.end())
     {
-        NdiscCache::Entry* entry = m_ndCache[dst];
+        NdiscCache::Entry* entry = it->second;
         NS_LOG_LOGIC("Found an entry: " << *entry);
 
         return entry;
@@ -127,6 +130,9 @@ NdiscCache::LookupInverse(Address dst)
             entryList.push_back(entry);
         }
     }
+    entryList.sort([](const NdiscCache::Entry* a, const NdiscCache::Entry* b) {
+        return a->GetIpv6Address() < b->GetIpv6Address();
+    });
     return entryList;
 }
 
@@ -147,15 +153,19 @@ NdiscCache::Remove(NdiscCache::Entry* entry)
 {
     NS_LOG_FUNCTION(this << entry);
 
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
+    auto it = m_ndCache.find(entry->GetIpv6Address());
+    if (it == m_ndCache.end() || it->second != entry)
     {
-        if ((*i).second == entry)
-        {
-            m_ndCache.erase(i);
-            entry->ClearWaitingPacket();
-            delete entry;
-            return;
-        }
+        // The address of the entry has been changed after it was added
+        it = std::find_if(m_ndCache.begin(), m_ndCache.end(), [entry](const auto& i) {
+            return i.second == entry;
+        });
+    }
+    if (it != m_ndCache.end())
+    {
+        m_ndCache.erase(it);
+        entry->ClearWaitingPacket();
+        delete entry;
     }
 }
 
@@ -192,7 +202,9 @@ NdiscCache::PrintNdiscCache(Ptr<OutputStreamWrapper> stream)
     NS_LOG_FUNCTION(this << stream);
     std::ostream* os = stream->GetStream();
 
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
+    // Print the entries in address order
+    std::map<Ipv6Address, NdiscCache::Entry*> entries(m_ndCache.begin(), m_ndCache.end());
+    for (auto i = entries.begin(); i != entries.end(); i++)
     {
         *os << i->first << " dev ";
         std::string found = Names::FindName(m_device);
@@ -248,6 +260,7 @@ NdiscCache::Entry::Entry(NdiscCache* nd)
       m_waiting(),
       m_router(false),
       m_nudTimer(Timer::CANCEL_ON_DESTROY),
+      m_nudTimerReachable(false),
       m_lastReachabilityConfirmation(Seconds(0.0)),
       m_nsRetransmit(0)
 {
@@ -294,6 +307,14 @@ void
 NdiscCache::Entry::FunctionReachableTimeout()
 {
     NS_LOG_FUNCTION(this);
+
+    /* the confirmations received since the timer was armed postpone it */
+    Time expiry = m_lastReachabilityConfirmation + m_nudTimer.GetDelay();
+    if (expiry > Simulator::Now())
+    {
+        m_nudTimer.Schedule(expiry - Simulator::Now());
+        return;
+    }
     this->MarkStale();
 }
 
@@ -475,6 +496,7 @@ NdiscCache::Entry::StartReachableTimer()
     }
 
     m_lastReachabilityConfirmation = Simulator::Now();
+    m_nudTimerReachable = true;
     m_nudTimer.SetFunction(&NdiscCache::Entry::FunctionReachableTimeout, this);
     m_nudTimer.SetDelay(m_ndCache->m_icmpv6->GetReachableTime());
     m_nudTimer.Schedule();
@@ -488,6 +510,11 @@ NdiscCache::Entry::UpdateReachableTimer()
     if (m_state == REACHABLE)
     {
         m_lastReachabilityConfirmation = Simulator::Now();
+        if (m_nudTimerReachable && m_nudTimer.IsRunning())
+        {
+            /* FunctionReachableTimeout will rearm the timer */
+            return;
+        }
         if (m_nudTimer.IsRunning())
         {
             m_nudTimer.Cancel();
@@ -505,6 +532,7 @@ NdiscCache::Entry::StartProbeTimer()
         m_nudTimer.Cancel();
     }
 
+    m_nudTimerReachable = false;
     m_nudTimer.SetFunction(&NdiscCache::Entry::FunctionProbeTimeout, this);
     m_nudTimer.SetDelay(m_ndCache->m_icmpv6->GetRetransmissionTime());
     m_nudTimer.Schedule();
@@ -519,6 +547,7 @@ NdiscCache::Entry::StartDelayTimer()
         m_nudTimer.Cancel();
     }
 
+    m_nudTimerReachable = false;
     m_nudTimer.SetFunction(&NdiscCache::Entry::FunctionDelayTimeout, this);
     m_nudTimer.SetDelay(m_ndCache->m_icmpv6->GetDelayFirstProbe());
     m_nudTimer.Schedule();
@@ -533,6 +562,7 @@ NdiscCache::Entry::StartRetransmitTimer()
         m_nudTimer.Cancel();
     }
 
+    m_nudTimerReachable = false;
     m_nudTimer.SetFunction(&NdiscCache::Entry::FunctionRetransmitTimeout, this);
     m_nudTimer.SetDelay(m_ndCache->m_icmpv6->GetRetransmissionTime());
     m_nudTimer.Schedule();
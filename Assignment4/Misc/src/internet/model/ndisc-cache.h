@@ -31,6 +31,7 @@
 #include <list>
 #include <map>
 #include <stdint.h>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -44,6 +45,10 @@ class Icmpv6L4Protocol;
  * \ingroup ipv6
  *
  * \brief IPv6 Neighbor Discovery cache.
+ *
+ * The entries are kept in a hash table. A reachability confirmation does
+ * not reschedule the reachable timer of an entry: the timer checks the last
+ * confirmation when it expires, and is rearmed for the remaining time.
  */
 class NdiscCache : public Object
 {
@@ -97,7 +102,7 @@ class NdiscCache : public Object
     /**
      * \brief Lookup in the cache for a MAC address.
      * \param dst destination MAC address.
-     * \return a list of matching entries.
+     * \return a list of matching entries, sorted by IPv6 address.
      */
     std::list<NdiscCache::Entry*> LookupInverse(Address dst);
 
@@ -437,6 +442,11 @@ class NdiscCache : public Object
          */
         Timer m_nudTimer;
 
+        /**
+         * \brief True if the NUD timer is set to the reachable timeout.
+         */
+        bool m_nudTimerReachable;
+
         /**
          * \brief Last time we see a reachability confirmation.
          */
@@ -457,11 +467,11 @@ class NdiscCache : public Object
     /**
      * \brief Neighbor Discovery Cache container
      */
-    typedef std::map<Ipv6Address, NdiscCache::Entry*> Cache;
+    typedef std::unordered_map<Ipv6Address, NdiscCache::Entry*, Ipv6AddressHash> Cache;
     /**
      * \brief Neighbor Discovery Cache container iterator
      */
-    typedef std::map<Ipv6Address, NdiscCache::Entry*>::iterator CacheI;
+    typedef std::unordered_map<Ipv6Address, NdiscCache::Entry*, Ipv6AddressHash>::iterator CacheI;
 
     /**
      * \brief A list of Entry.
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-congestion-engine.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TcpCongestionEngine");
+
+void
+TcpAckBatch::Add(TcpCongestionOps* cong,
+                 TcpSocketState* tcb,
+                 uint32_t segmentsAcked,
+                 const Time& rtt)
+{
+    NS_ASSERT_MSG(std::find(m_tcb.begin(), m_tcb.begin() + m_size, tcb) == m_tcb.begin() + m_size,
+                  "The connection already has an event in the batch");
+    if (m_size == m_cong.size())
+    {
+        Reserve(std::max<std::size_t>(2 * m_size, 64));
+    }
+    std::size_t i = m_size++;
+    m_cong[i] = cong;
+    m_tcb[i] = tcb;
+    m_cWnd[i] = tcb->m_cWnd;
+    m_ssThresh[i] = tcb->m_ssThresh;
+    m_segmentSize[i] = tcb->m_segmentSize;
+    m_segmentsAcked[i] = segmentsAcked;
+    m_rtt[i] = rtt;
+    m_lastAckedSeq[i] = tcb->m_lastAckedSeq;
+    m_highTxMark[i] = tcb->m_highTxMark;
+    m_cWndLimited[i] = tcb->m_isCwndLimited;
+}
+
+void
+TcpAckBatch::Clear()
+{
+    m_size = 0;
+}
+
+std::size_t
+TcpAckBatch::GetSize() const
+{
+    return m_size;
+}
+
+void
+TcpAckBatch::Reserve(std::size_t capacity)
+{
+    m_cong.resize(capacity);
+    m_tcb.resize(capacity);
+    m_cWnd.resize(capacity);
+    m_ssThresh.resize(capacity);
+    m_segmentSize.resize(capacity);
+    m_segmentsAcked.resize(capacity);
+    m_rtt.resize(capacity);
+    m_lastAckedSeq.resize(capacity);
+    m_highTxMark.resize(capacity);
+    m_cWndLimited.resize(capacity);
+}
+
+void
+TcpAckBatch::WriteBack(std::size_t i)
+{
+    m_tcb[i]->m_cWnd = m_cWnd[i];
+    m_tcb[i]->m_ssThresh = m_ssThresh[i];
+}
+
+void
+TcpAckBatch::Reload(std::size_t i)
+{
+    m_cWnd[i] = m_tcb[i]->m_cWnd;
+    m_ssThresh[i] = m_tcb[i]->m_ssThresh;
+}
+
+TcpCongestionEngine::TcpCongestionEngine()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TcpCongestionEngine::~TcpCongestionEngine()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+TcpCongestionEngine::Add(Ptr<TcpCongestionOps> cong,
+                         Ptr<TcpSocketState> tcb,
+                         uint32_t segmentsAcked,
+                         const Time& rtt)
+{
+    NS_LOG_FUNCTION(this << cong << tcb << segmentsAcked << rtt);
+    NS_ASSERT(cong && tcb);
+    // Only the pointers: the connection is read when its block is run
+    m_events.push_back({PeekPointer(cong), PeekPointer(tcb), segmentsAcked, rtt});
+}
+
+void
+TcpCongestionEngine::Process()
+{
+    NS_LOG_FUNCTION(this << m_events.size());
+    std::size_t last = 0;
+    for (const auto& event : m_events)
+    {
+        // The events of a block are run from the state of their connections
+        // at the start of the block: a connection with several events gets
+        // the next one in the next block, once the previous one is written back
+        if (m_blockTcbs.size() == BLOCK_SIZE ||
+            std::find(m_blockTcbs.begin(), m_blockTcbs.end(), event.tcb) != m_blockTcbs.end())
+        {
+            ProcessGroups();
+        }
+        m_blockTcbs.push_back(event.tcb);
+
+        // Most events come from connections with the same congestion control
+        const std::type_info& type = typeid(*event.cong);
+        if (last >= m_groups.size() || *m_groups[last].type != type)
+        {
+            last = 0;
+            while (last < m_groups.size() && *m_groups[last].type != type)
+            {
+                last++;
+            }
+            if (last == m_groups.size())
+            {
+                m_groups.push_back({&type, event.cong->HasBatch(), TcpAckBatch()});
+            }
+        }
+        Group& group = m_groups[last];
+        if (group.batched)
+        {
+            group.batch.Add(event.cong, event.tcb, event.segmentsAcked, event.rtt);
+        }
+        else
+        {
+            // Nothing to gain from gathering the state of the connection
+            Ptr<TcpSocketState> tcb(event.tcb);
+            event.cong->PktsAcked(tcb, event.segmentsAcked, event.rtt);
+            event.cong->IncreaseWindow(tcb, event.segmentsAcked);
+        }
+    }
+    ProcessGroups();
+    m_events.clear();
+}
+
+void
+TcpCongestionEngine::ProcessGroups()
+{
+    for (auto& group : m_groups)
+    {
+        TcpAckBatch& batch = group.batch;
+        if (batch.GetSize() == 0)
+        {
+            continue;
+        }
+        // Any congestion control of the batch runs it for all the others
+        TcpCongestionOps* cong = batch.m_cong[0];
+        cong->PktsAckedBatch(batch);
+        cong->IncreaseWindowBatch(batch);
+        for (std::size_t i = 0; i < batch.GetSize(); i++)
+        {
+            batch.WriteBack(i);
+        }
+        batch.Clear();
+    }
+    m_blockTcbs.clear();
+}
+
+std::size_t
+TcpCongestionEngine::GetPending() const
+{
+    return m_events.size();
+}
+
+} // namespace ns3
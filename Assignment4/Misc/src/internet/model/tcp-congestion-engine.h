@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_CONGESTION_ENGINE_H
+#define TCP_CONGESTION_ENGINE_H
+
+#include "tcp-congestion-ops.h"
+#include "tcp-socket-state.h"
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/sequence-number.h"
+
+#include <typeinfo>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief ACK events of several connections, in structure-of-arrays form
+ *
+ * Event i gives the state of a connection which got new ACKs: its
+ * congestion window, slow start threshold, RTT sample, ... each field in
+ * its own array, so that a batched congestion control walks contiguous
+ * memory instead of a TcpSocketState per connection.
+ *
+ * The batched methods of TcpCongestionOps update m_cWnd and m_ssThresh in
+ * place; WriteBack copies them to the connection. A connection appears at
+ * most once in a batch. The batch does not hold references: the congestion
+ * controls and states of its events must outlive it.
+ *
+ * The arrays are only grown, never shrunk, so that refilling a batch does
+ * not allocate: only their first GetSize() entries are events.
+ */
+struct TcpAckBatch
+{
+    /**
+     * \brief Append an event
+     * \param cong the congestion control of the connection
+     * \param tcb the congestion state of the connection
+     * \param segmentsAcked count of segments acked
+     * \param rtt last rtt
+     */
+    void Add(TcpCongestionOps* cong,
+             TcpSocketState* tcb,
+             uint32_t segmentsAcked,
+             const Time& rtt);
+
+    /**
+     * \brief Remove all the events, keeping the allocated memory
+     */
+    void Clear();
+
+    /**
+     * \brief Get the number of events
+     * \return the number of events
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * \brief Copy the window and threshold of an event to its connection
+     * \param i the index of the event
+     */
+    void WriteBack(std::size_t i);
+
+    /**
+     * \brief Copy the window and threshold of a connection to its event
+     * \param i the index of the event
+     */
+    void Reload(std::size_t i);
+
+    /**
+     * \brief Grow the arrays
+     * \param capacity the new number of entries of the arrays
+     */
+    void Reserve(std::size_t capacity);
+
+    std::vector<TcpCongestionOps*> m_cong;        //!< Congestion controls of the connections
+    std::vector<TcpSocketState*> m_tcb;           //!< Congestion states of the connections
+    std::vector<uint32_t> m_cWnd;                 //!< Congestion windows
+    std::vector<uint32_t> m_ssThresh;             //!< Slow start thresholds
+    std::vector<uint32_t> m_segmentSize;          //!< Segment sizes
+    std::vector<uint32_t> m_segmentsAcked;        //!< Segments acked by the events
+    std::vector<Time> m_rtt;                      //!< RTT samples
+    std::vector<SequenceNumber32> m_lastAckedSeq; //!< Last sequences ACKed
+    std::vector<SequenceNumber32> m_highTxMark;   //!< Highest sequences sent
+    std::vector<uint8_t> m_cWndLimited;           //!< Whether the connections are cWnd limited
+    std::size_t m_size{0};                        //!< Number of events
+};
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief Run the congestion controls of many connections on batches of ACKs
+ *
+ * The per-ACK interface of TcpCongestionOps costs two virtual calls, a few
+ * reference counts and reads of the simulation time per ACK and per
+ * connection. The engine instead queues the ACK events of any number of
+ * connections, e.g. all those of a node. Process then takes the events by
+ * blocks of at most BLOCK_SIZE, sorts each block in one TcpAckBatch per type of
+ * congestion control, runs PktsAckedBatch and IncreaseWindowBatch once per
+ * batch, and writes the new windows and thresholds back to the connections
+ * while they are still in the cache.
+ *
+ * TcpCubic and TcpOjus implement the batched methods. The congestion
+ * controls without them (see TcpCongestionOps::HasBatch) get one call of
+ * PktsAcked and IncreaseWindow per event, on the state of the connection, so
+ * the results match those of the per-ACK interface in any case.
+ */
+class TcpCongestionEngine
+{
+  public:
+    TcpCongestionEngine();
+    ~TcpCongestionEngine();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    TcpCongestionEngine(const TcpCongestionEngine&) = delete;
+    TcpCongestionEngine& operator=(const TcpCongestionEngine&) = delete;
+
+    /**
+     * \brief Queue an ACK event until the next Process
+     *
+     * The connection must not change its congestion state until the next
+     * Process. It may have several events queued: they are run in order,
+     * each one on the state left by the previous one.
+     *
+     * \param cong the congestion control of the connection
+     * \param tcb the congestion state of the connection
+     * \param segmentsAcked count of segments acked
+     * \param rtt last rtt
+     */
+    void Add(Ptr<TcpCongestionOps> cong,
+             Ptr<TcpSocketState> tcb,
+             uint32_t segmentsAcked,
+             const Time& rtt);
+
+    /**
+     * \brief Run the congestion controls on the queued events
+     *
+     * For each event, the congestion control gets PktsAcked and then
+     * IncreaseWindow, and the connection gets its new cWnd and ssThresh.
+     */
+    void Process();
+
+    /**
+     * \brief Get the number of queued events
+     * \return the number of events
+     */
+    std::size_t GetPending() const;
+
+    /// Number of events sorted and run together by Process
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+  private:
+    /// Queued ACK event
+    struct Event
+    {
+        TcpCongestionOps* cong; //!< Congestion control of the connection
+        TcpSocketState* tcb;    //!< Congestion state of the connection
+        uint32_t segmentsAcked; //!< Count of segments acked
+        Time rtt;               //!< Last rtt
+    };
+
+    /// Events of a block for the congestion controls of one type
+    struct Group
+    {
+        const std::type_info* type; //!< Type of the congestion controls
+        bool batched;               //!< Whether they implement the batched methods
+        TcpAckBatch batch;          //!< Events
+    };
+
+    /**
+     * \brief Run the congestion controls on the events of the groups
+     */
+    void ProcessGroups();
+
+    std::vector<Event> m_events; //!< Queued events
+    std::vector<Group> m_groups; //!< Events of the block, by type of congestion control
+    std::vector<TcpSocketState*> m_blockTcbs; //!< Connections with an event in the block
+};
+
+} // namespace ns3
+
+#endif /* TCP_CONGESTION_ENGINE_H */
@@ -17,6 +17,8 @@
  */
 #include "tcp-congestion-ops.h"
 
+#include "tcp-congestion-engine.h"
+
 #include "ns3/log.h"
 
 namespace ns3
@@ -87,6 +89,36 @@ TcpCongestionOps::CongControl(Ptr<TcpSocketState> tcb,
     NS_LOG_FUNCTION(this << tcb);
 }
 
+bool
+TcpCongestionOps::HasBatch() const
+{
+    return false;
+}
+
+void
+TcpCongestionOps::PktsAckedBatch(TcpAckBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetSize());
+    for (std::size_t i = 0; i < batch.GetSize(); i++)
+    {
+        batch.WriteBack(i);
+        batch.m_cong[i]->PktsAcked(batch.m_tcb[i], batch.m_segmentsAcked[i], batch.m_rtt[i]);
+        batch.Reload(i);
+    }
+}
+
+void
+TcpCongestionOps::IncreaseWindowBatch(TcpAckBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetSize());
+    for (std::size_t i = 0; i < batch.GetSize(); i++)
+    {
+        batch.WriteBack(i);
+        batch.m_cong[i]->IncreaseWindow(batch.m_tcb[i], batch.m_segmentsAcked[i]);
+        batch.Reload(i);
+    }
+}
+
 // RENO
 
 NS_OBJECT_ENSURE_REGISTERED(TcpNewReno);
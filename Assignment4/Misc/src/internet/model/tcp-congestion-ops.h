@@ -24,6 +24,8 @@
 namespace ns3
 {
 
+struct TcpAckBatch;
+
 /**
  * \ingroup tcp
  * \defgroup congestionOps Congestion Control Algorithms.
@@ -184,6 +186,41 @@ class TcpCongestionOps : public Object
                              const TcpRateOps::TcpRateConnection& rc,
                              const TcpRateOps::TcpRateSample& rs);
 
+    /**
+     * \brief Returns true when Congestion Control Algorithm implements the batched methods
+     *
+     * \return true if CC implements PktsAckedBatch and IncreaseWindowBatch
+     *
+     * TcpCongestionEngine runs the congestion controls without them directly
+     * on the state of the connections, rather than gathering it in a batch
+     * for the default implementations.
+     */
+    virtual bool HasBatch() const;
+
+    /**
+     * \brief Timing information on the ACKs of several connections
+     *
+     * Batched form of PktsAcked, called by TcpCongestionEngine. The
+     * congestion controls of all the events are of the type of this one,
+     * which is one of them. The default implementation calls PktsAcked for
+     * each event.
+     *
+     * \param batch the ACK events, whose m_cWnd and m_ssThresh are updated
+     */
+    virtual void PktsAckedBatch(TcpAckBatch& batch);
+
+    /**
+     * \brief Congestion avoidance for several connections
+     *
+     * Batched form of IncreaseWindow, called by TcpCongestionEngine after
+     * PktsAckedBatch. The congestion controls of all the events are of the
+     * type of this one, which is one of them. The default implementation
+     * calls IncreaseWindow for each event.
+     *
+     * \param batch the ACK events, whose m_cWnd and m_ssThresh are updated
+     */
+    virtual void IncreaseWindowBatch(TcpAckBatch& batch);
+
     // Present in Linux but not in ns-3 yet:
     /* call when ack arrives (optional) */
     //     void (*in_ack_event)(struct sock *sk, u32 flags);
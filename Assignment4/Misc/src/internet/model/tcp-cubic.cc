@@ -23,6 +23,8 @@
 
 #include "tcp-cubic.h"
 
+#include "tcp-congestion-engine.h"
+
 #include "ns3/log.h"
 
 NS_LOG_COMPONENT_DEFINE("TcpCubic");
@@ -125,6 +127,7 @@ TcpCubic::TcpCubic()
       m_bicK(0.0),
       m_delayMin(Time::Min()),
       m_epochStart(Time::Min()),
+      m_epochOrigin(0.0),
       m_found(false),
       m_roundStart(Time::Min()),
       m_endSeq(0),
@@ -156,6 +159,7 @@ TcpCubic::TcpCubic(const TcpCubic& sock)
       m_bicK(sock.m_bicK),
       m_delayMin(sock.m_delayMin),
       m_epochStart(sock.m_epochStart),
+      m_epochOrigin(sock.m_epochOrigin),
       m_found(sock.m_found),
       m_roundStart(sock.m_roundStart),
       m_endSeq(sock.m_endSeq),
@@ -173,13 +177,19 @@ TcpCubic::GetName() const
     return "TcpCubic";
 }
 
+bool
+TcpCubic::HasBatch() const
+{
+    return true;
+}
+
 void
-TcpCubic::HystartReset(Ptr<const TcpSocketState> tcb)
+TcpCubic::HystartReset(const Time& now, SequenceNumber32 highTxMark)
 {
     NS_LOG_FUNCTION(this);
 
-    m_roundStart = m_lastAck = Simulator::Now();
-    m_endSeq = tcb->m_highTxMark;
+    m_roundStart = m_lastAck = now;
+    m_endSeq = highTxMark;
     m_currRtt = Time::Min();
     m_sampleCnt = 0;
 }
@@ -196,11 +206,61 @@ TcpCubic::IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
         return;
     }
 
-    if (tcb->m_cWnd < tcb->m_ssThresh)
+    uint32_t cWnd = tcb->m_cWnd;
+    Time now = Simulator::Now();
+    // Update needs the time in seconds only in congestion avoidance
+    double nowSeconds = cWnd >= tcb->m_ssThresh ? now.GetSeconds() : 0.0;
+    DoIncreaseWindow(now,
+                     nowSeconds,
+                     cWnd,
+                     tcb->m_ssThresh,
+                     tcb->m_segmentSize,
+                     tcb->m_lastAckedSeq,
+                     tcb->m_highTxMark,
+                     segmentsAcked);
+    tcb->m_cWnd = cWnd;
+}
+
+void
+TcpCubic::IncreaseWindowBatch(TcpAckBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetSize());
+
+    // One conversion of the time to seconds for all the connections
+    Time now = Simulator::Now();
+    double nowSeconds = now.GetSeconds();
+    for (std::size_t i = 0; i < batch.GetSize(); i++)
+    {
+        if (batch.m_cWndLimited[i])
+        {
+            // The engine batches congestion controls of the same type
+            static_cast<TcpCubic*>(batch.m_cong[i])->DoIncreaseWindow(now,
+                                                                      nowSeconds,
+                                                                      batch.m_cWnd[i],
+                                                                      batch.m_ssThresh[i],
+                                                                      batch.m_segmentSize[i],
+                                                                      batch.m_lastAckedSeq[i],
+                                                                      batch.m_highTxMark[i],
+                                                                      batch.m_segmentsAcked[i]);
+        }
+    }
+}
+
+void
+TcpCubic::DoIncreaseWindow(const Time& now,
+                           double nowSeconds,
+                           uint32_t& cWnd,
+                           uint32_t ssThresh,
+                           uint32_t segmentSize,
+                           SequenceNumber32 lastAckedSeq,
+                           SequenceNumber32 highTxMark,
+                           uint32_t segmentsAcked)
+{
+    if (cWnd < ssThresh)
     {
-        if (m_hystart && tcb->m_lastAckedSeq > m_endSeq)
+        if (m_hystart && lastAckedSeq > m_endSeq)
         {
-            HystartReset(tcb);
+            HystartReset(now, highTxMark);
         }
 
         // In Linux, the QUICKACK socket option enables the receiver to send
@@ -211,17 +271,16 @@ TcpCubic::IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
         // not reach as large of an initial window as in Linux.  Therefore,
         // we can approximate the effect of QUICKACK by making this slow
         // start phase perform Appropriate Byte Counting (RFC 3465)
-        tcb->m_cWnd += segmentsAcked * tcb->m_segmentSize;
+        cWnd += segmentsAcked * segmentSize;
         segmentsAcked = 0;
 
-        NS_LOG_INFO("In SlowStart, updated to cwnd " << tcb->m_cWnd << " ssthresh "
-                                                     << tcb->m_ssThresh);
+        NS_LOG_INFO("In SlowStart, updated to cwnd " << cWnd << " ssthresh " << ssThresh);
     }
 
-    if (tcb->m_cWnd >= tcb->m_ssThresh && segmentsAcked > 0)
+    if (cWnd >= ssThresh && segmentsAcked > 0)
     {
         m_cWndCnt += segmentsAcked;
-        uint32_t cnt = Update(tcb, segmentsAcked);
+        uint32_t cnt = Update(now, nowSeconds, cWnd / segmentSize, segmentsAcked);
 
         /* According to RFC 6356 even once the new cwnd is
          * calculated you must compare this to the number of ACKs received since
@@ -230,9 +289,9 @@ TcpCubic::IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
          */
         if (m_cWndCnt >= cnt)
         {
-            tcb->m_cWnd += tcb->m_segmentSize;
+            cWnd += segmentSize;
             m_cWndCnt -= cnt;
-            NS_LOG_INFO("In CongAvoid, updated to cwnd " << tcb->m_cWnd);
+            NS_LOG_INFO("In CongAvoid, updated to cwnd " << cWnd);
         }
         else
         {
@@ -244,22 +303,21 @@ TcpCubic::IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 }
 
 uint32_t
-TcpCubic::Update(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+TcpCubic::Update(const Time& now, double nowSeconds, uint32_t segCwnd, uint32_t segmentsAcked)
 {
     NS_LOG_FUNCTION(this);
-    Time t;
     uint32_t delta;
     uint32_t bicTarget;
     uint32_t cnt = 0;
     uint32_t maxCnt;
     double offs;
-    uint32_t segCwnd = tcb->GetCwndInSegments();
 
     m_ackCnt += segmentsAcked;
 
     if (m_epochStart == Time::Min())
     {
-        m_epochStart = Simulator::Now(); // record the beginning of an epoch
+        m_epochStart = now; // record the beginning of an epoch
+        UpdateEpochOrigin();
         m_ackCnt = segmentsAcked;
         m_tcpCwnd = segCwnd;
 
@@ -277,17 +335,19 @@ TcpCubic::Update(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
         }
     }
 
-    t = Simulator::Now() + m_delayMin - m_epochStart;
+    // t = now + m_delayMin - m_epochStart, without converting a Time to
+    // seconds per ACK
+    double tSeconds = nowSeconds - m_epochOrigin;
 
-    if (t.GetSeconds() < m_bicK) /* t - K */
+    if (tSeconds < m_bicK) /* t - K */
     {
-        offs = m_bicK - t.GetSeconds();
-        NS_LOG_DEBUG("t=" << t.GetSeconds() << " <k: offs=" << offs);
+        offs = m_bicK - tSeconds;
+        NS_LOG_DEBUG("t=" << tSeconds << " <k: offs=" << offs);
     }
     else
     {
-        offs = t.GetSeconds() - m_bicK;
-        NS_LOG_DEBUG("t=" << t.GetSeconds() << " >= k: offs=" << offs);
+        offs = tSeconds - m_bicK;
+        NS_LOG_DEBUG("t=" << tSeconds << " >= k: offs=" << offs);
     }
 
     /* Constant value taken from Experimental Evaluation of Cubic Tcp, available at
@@ -296,7 +356,7 @@ TcpCubic::Update(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 
     NS_LOG_DEBUG("delta: " << delta);
 
-    if (t.GetSeconds() < m_bicK)
+    if (tSeconds < m_bicK)
     {
         // below origin
         bicTarget = m_bicOriginPoint - delta;
@@ -358,8 +418,37 @@ TcpCubic::PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time&
 {
     NS_LOG_FUNCTION(this << tcb << segmentsAcked << rtt);
 
+    uint32_t ssThresh = tcb->m_ssThresh;
+    DoPktsAcked(Simulator::Now(), tcb->m_cWnd, ssThresh, tcb->m_segmentSize, rtt);
+    tcb->m_ssThresh = ssThresh;
+}
+
+void
+TcpCubic::PktsAckedBatch(TcpAckBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetSize());
+
+    Time now = Simulator::Now();
+    for (std::size_t i = 0; i < batch.GetSize(); i++)
+    {
+        // The engine batches congestion controls of the same type
+        static_cast<TcpCubic*>(batch.m_cong[i])->DoPktsAcked(now,
+                                                             batch.m_cWnd[i],
+                                                             batch.m_ssThresh[i],
+                                                             batch.m_segmentSize[i],
+                                                             batch.m_rtt[i]);
+    }
+}
+
+void
+TcpCubic::DoPktsAcked(const Time& now,
+                      uint32_t cWnd,
+                      uint32_t& ssThresh,
+                      uint32_t segmentSize,
+                      const Time& rtt)
+{
     /* Discard delay samples right after fast recovery */
-    if (m_epochStart != Time::Min() && (Simulator::Now() - m_epochStart) < m_cubicDelta)
+    if (m_epochStart != Time::Min() && (now - m_epochStart) < m_cubicDelta)
     {
         return;
     }
@@ -368,25 +457,23 @@ TcpCubic::PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time&
     if (m_delayMin == Time::Min() || m_delayMin > rtt)
     {
         m_delayMin = rtt;
+        UpdateEpochOrigin();
     }
 
     /* hystart triggers when cwnd is larger than some threshold */
-    if (m_hystart && tcb->m_cWnd <= tcb->m_ssThresh &&
-        tcb->m_cWnd >= m_hystartLowWindow * tcb->m_segmentSize)
+    if (m_hystart && cWnd <= ssThresh && cWnd >= m_hystartLowWindow * segmentSize)
     {
-        HystartUpdate(tcb, rtt);
+        HystartUpdate(now, cWnd, ssThresh, rtt);
     }
 }
 
 void
-TcpCubic::HystartUpdate(Ptr<TcpSocketState> tcb, const Time& delay)
+TcpCubic::HystartUpdate(const Time& now, uint32_t cWnd, uint32_t& ssThresh, const Time& delay)
 {
     NS_LOG_FUNCTION(this << delay);
 
     if (!m_found)
     {
-        Time now = Simulator::Now();
-
         /* first detection parameter - ack-train detection */
         if ((now - m_lastAck) <= m_hystartAckDelta)
         {
@@ -428,7 +515,7 @@ TcpCubic::HystartUpdate(Ptr<TcpSocketState> tcb, const Time& delay)
         if (m_found)
         {
             NS_LOG_DEBUG("Exit from SS, immediately :-)");
-            tcb->m_ssThresh = tcb->m_cWnd;
+            ssThresh = cWnd;
         }
     }
 }
@@ -488,7 +575,7 @@ TcpCubic::CongestionStateSet(Ptr<TcpSocketState> tcb, const TcpSocketState::TcpC
     if (newState == TcpSocketState::CA_LOSS)
     {
         CubicReset(tcb);
-        HystartReset(tcb);
+        HystartReset(Simulator::Now(), tcb->m_highTxMark);
     }
 }
 
@@ -502,9 +589,16 @@ TcpCubic::CubicReset(Ptr<const TcpSocketState> tcb)
     m_ackCnt = 0;
     m_tcpCwnd = 0;
     m_delayMin = Time::Min();
+    UpdateEpochOrigin();
     m_found = false;
 }
 
+void
+TcpCubic::UpdateEpochOrigin()
+{
+    m_epochOrigin = m_epochStart.GetSeconds() - m_delayMin.GetSeconds();
+}
+
 Ptr<TcpCongestionOps>
 TcpCubic::Fork()
 {
@@ -96,6 +96,9 @@ class TcpCubic : public TcpCongestionOps
     std::string GetName() const override;
     void PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt) override;
     void IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked) override;
+    bool HasBatch() const override;
+    void PktsAckedBatch(TcpAckBatch& batch) override;
+    void IncreaseWindowBatch(TcpAckBatch& batch) override;
     uint32_t GetSsThresh(Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight) override;
     void CongestionStateSet(Ptr<TcpSocketState> tcb,
                             const TcpSocketState::TcpCongState_t newState) override;
@@ -128,6 +131,7 @@ class TcpCubic : public TcpCongestionOps
                                //    of the current epoch (in s)
     Time m_delayMin;           //!<  Min delay
     Time m_epochStart;         //!<  Beginning of an epoch
+    double m_epochOrigin;      //!<  Beginning of an epoch minus min delay (in s)
     bool m_found;              //!<  The exit point is found?
     Time m_roundStart;         //!<  Beginning of each round
     SequenceNumber32 m_endSeq; //!<  End sequence of the round
@@ -141,9 +145,10 @@ class TcpCubic : public TcpCongestionOps
   private:
     /**
      * \brief Reset HyStart parameters
-     * \param tcb Transmission Control Block of the connection
+     * \param now the current time
+     * \param highTxMark the highest sequence number sent
      */
-    void HystartReset(Ptr<const TcpSocketState> tcb);
+    void HystartReset(const Time& now, SequenceNumber32 highTxMark);
 
     /**
      * \brief Reset Cubic parameters
@@ -153,19 +158,68 @@ class TcpCubic : public TcpCongestionOps
 
     /**
      * \brief Cubic window update after a new ack received
-     * \param tcb Transmission Control Block of the connection
+     * \param now the current time
+     * \param nowSeconds the current time, in seconds
+     * \param segCwnd the congestion window, in segments
      * \param segmentsAcked Segments acked
      * \returns the congestion window update counter
      */
-    uint32_t Update(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+    uint32_t Update(const Time& now, double nowSeconds, uint32_t segCwnd, uint32_t segmentsAcked);
+
+    /**
+     * \brief Convert the beginning of the epoch and the min delay to m_epochOrigin
+     */
+    void UpdateEpochOrigin();
 
     /**
      * \brief Update HyStart parameters
      *
-     * \param tcb Transmission Control Block of the connection
+     * \param now the current time
+     * \param cWnd the congestion window
+     * \param ssThresh the slow start threshold, set to cWnd on slow start exit
      * \param delay Delay for HyStart algorithm
      */
-    void HystartUpdate(Ptr<TcpSocketState> tcb, const Time& delay);
+    void HystartUpdate(const Time& now, uint32_t cWnd, uint32_t& ssThresh, const Time& delay);
+
+    /**
+     * \brief Take the timing information of an ACK
+     *
+     * Shared by PktsAcked and PktsAckedBatch.
+     *
+     * \param now the current time
+     * \param cWnd the congestion window
+     * \param ssThresh the slow start threshold, may be updated
+     * \param segmentSize the segment size
+     * \param rtt last rtt
+     */
+    void DoPktsAcked(const Time& now,
+                     uint32_t cWnd,
+                     uint32_t& ssThresh,
+                     uint32_t segmentSize,
+                     const Time& rtt);
+
+    /**
+     * \brief Increase the window of a cWnd limited connection
+     *
+     * Shared by IncreaseWindow and IncreaseWindowBatch.
+     *
+     * \param now the current time
+     * \param nowSeconds the current time, in seconds
+     * \param cWnd the congestion window, updated
+     * \param ssThresh the slow start threshold
+     * \param segmentSize the segment size
+     * \param lastAckedSeq the last sequence number ACKed
+     * \param highTxMark the highest sequence number sent
+     * \param segmentsAcked Segments acked
+     */
+    void DoIncreaseWindow(const Time& now,
+                          double nowSeconds,
+                          uint32_t& cWnd,
+                          uint32_t ssThresh,
+                          uint32_t segmentSize,
+                          SequenceNumber32 lastAckedSeq,
+                          SequenceNumber32 highTxMark,
+                          uint32_t segmentsAcked);
 
     /**
      * \brief Clamp time value in a range
@@ -21,6 +21,7 @@
 
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
+#include "ipv4-l3-protocol.h"
 #include "ipv4-route.h"
 #include "ipv4-routing-protocol.h"
 #include "ipv6-end-point-demux.h"
@@ -32,6 +33,7 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-cubic.h"
 #include "tcp-header.h"
+#include "tcp-option-ts.h"
 #include "tcp-prr-recovery.h"
 #include "tcp-recovery-ops.h"
 #include "tcp-socket-base.h"
@@ -39,12 +41,14 @@
 
 #include "ns3/assert.h"
 #include "ns3/boolean.h"
+#include "ns3/gso-tag.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
 #include "ns3/object-map.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <iomanip>
 #include <sstream>
@@ -99,7 +103,28 @@ TcpL4Protocol::GetTypeId()
                           "is kept for backward compatibility.",
                           ObjectMapValue(),
                           MakeObjectMapAccessor(&TcpL4Protocol::m_sockets),
-                          MakeObjectMapChecker<TcpSocketBase>());
+                          MakeObjectMapChecker<TcpSocketBase>())
+            .AddAttribute("GroMaxSegments",
+                          "Maximum number of in-order data segments of a connection merged "
+                          "into a single chunk before being delivered to the socket "
+                          "(generic receive offload). 1 disables the offload.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&TcpL4Protocol::m_groMaxSegments),
+                          MakeUintegerChecker<uint32_t>(1, 65535))
+            .AddAttribute("GroTimeout",
+                          "Maximum time a data segment is held by the generic receive "
+                          "offload, waiting for the next segments of the connection.",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&TcpL4Protocol::m_groTimeout),
+                          MakeTimeChecker(Time(0)))
+            .AddAttribute("PacingSlot",
+                          "Duration of the slots of the timing wheel releasing the paced "
+                          "sockets of the node, which are released at most a slot late. "
+                          "Zero gives each socket its own pacing timer.",
+                          TimeValue(Time(0)),
+                          MakeTimeAccessor(&TcpL4Protocol::SetPacingSlot,
+                                           &TcpL4Protocol::GetPacingSlot),
+                          MakeTimeChecker(Time(0)));
     return tid;
 }
 
@@ -108,6 +133,10 @@ TcpL4Protocol::TcpL4Protocol()
       m_endPoints6(new Ipv6EndPointDemux())
 {
     NS_LOG_FUNCTION(this);
+    GsoTag::RegisterSegmenter(Ipv4L3Protocol::PROT_NUMBER,
+                              MakeCallback(&TcpL4Protocol::SegmentIpv4));
+    GsoTag::RegisterSegmenter(Ipv6L3Protocol::PROT_NUMBER,
+                              MakeCallback(&TcpL4Protocol::SegmentIpv6));
 }
 
 TcpL4Protocol::~TcpL4Protocol()
@@ -171,6 +200,13 @@ TcpL4Protocol::DoDispose()
     NS_LOG_FUNCTION(this);
     m_sockets.clear();
 
+    for (auto& [endPoint, batch] : m_groBatches)
+    {
+        batch.flushEvent.Cancel();
+    }
+    m_groBatches.clear();
+    m_pacingWheel.Clear();
+
     if (m_endPoints != nullptr)
     {
         delete m_endPoints;
@@ -270,6 +306,7 @@ void
 TcpL4Protocol::DeAllocate(Ipv4EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
+    GroRemove(endPoint);
     m_endPoints->DeAllocate(endPoint);
 }
 
@@ -316,9 +353,54 @@ void
 TcpL4Protocol::DeAllocate(Ipv6EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
+    GroRemove(endPoint);
     m_endPoints6->DeAllocate(endPoint);
 }
 
+uint64_t
+TcpL4Protocol::GetGroSegments() const
+{
+    return m_groSegments;
+}
+
+uint64_t
+TcpL4Protocol::GetGroChunks() const
+{
+    return m_groChunks;
+}
+
+void
+TcpL4Protocol::SetPacingSlot(Time slot)
+{
+    NS_LOG_FUNCTION(this << slot);
+    m_pacingWheel.SetSlot(slot);
+}
+
+Time
+TcpL4Protocol::GetPacingSlot() const
+{
+    return m_pacingWheel.GetSlot();
+}
+
+void
+TcpL4Protocol::SchedulePacing(Ptr<TcpSocketBase> socket, Time release, uint64_t generation)
+{
+    NS_LOG_FUNCTION(this << socket << release << generation);
+    m_pacingWheel.Schedule(socket, release, generation);
+}
+
+uint64_t
+TcpL4Protocol::GetPacingEvents() const
+{
+    return m_pacingWheel.GetEvents();
+}
+
+uint64_t
+TcpL4Protocol::GetPacingReleases() const
+{
+    return m_pacingWheel.GetReleases();
+}
+
 void
 TcpL4Protocol::ReceiveIcmp(Ipv4Address icmpSource,
                            uint8_t icmpTtl,
@@ -517,8 +599,28 @@ TcpL4Protocol::Receive(Ptr<Packet> packet,
                                   << " received a packet and"
                                      " now forwarding it up to endpoint/socket");
 
-    (*endPoints.begin())
-        ->ForwardUp(packet, incomingIpHeader, incomingTcpHeader.GetSourcePort(), incomingInterface);
+    Ipv4EndPoint* endPoint = *endPoints.begin();
+    if (m_groMaxSegments > 1 && endPoint->GetPeerPort() != 0)
+    {
+        uint16_t sourcePort = incomingTcpHeader.GetSourcePort();
+        Callback<void, Ptr<Packet>> forwardUp(
+            [endPoint, incomingIpHeader, sourcePort, incomingInterface](Ptr<Packet> p) {
+                endPoint->ForwardUp(p, incomingIpHeader, sourcePort, incomingInterface);
+            });
+        if (!GroReceive(endPoint, packet, incomingTcpHeader, incomingIpHeader.GetTos(), forwardUp))
+        {
+            NoEndPointsFound(incomingTcpHeader,
+                             incomingIpHeader.GetSource(),
+                             incomingIpHeader.GetDestination());
+            return IpL4Protocol::RX_ENDPOINT_CLOSED;
+        }
+        return IpL4Protocol::RX_OK;
+    }
+
+    endPoint->ForwardUp(packet,
+                        incomingIpHeader,
+                        incomingTcpHeader.GetSourcePort(),
+                        incomingInterface);
 
     return IpL4Protocol::RX_OK;
 }
@@ -577,12 +679,194 @@ TcpL4Protocol::Receive(Ptr<Packet> packet,
                                   << " received a packet and"
                                      " now forwarding it up to endpoint/socket");
 
-    (*endPoints.begin())
-        ->ForwardUp(packet, incomingIpHeader, incomingTcpHeader.GetSourcePort(), interface);
+    Ipv6EndPoint* endPoint = *endPoints.begin();
+    if (m_groMaxSegments > 1 && endPoint->GetPeerPort() != 0)
+    {
+        uint16_t sourcePort = incomingTcpHeader.GetSourcePort();
+        Callback<void, Ptr<Packet>> forwardUp(
+            [endPoint, incomingIpHeader, sourcePort, interface](Ptr<Packet> p) {
+                endPoint->ForwardUp(p, incomingIpHeader, sourcePort, interface);
+            });
+        if (!GroReceive(endPoint,
+                        packet,
+                        incomingTcpHeader,
+                        incomingIpHeader.GetTrafficClass(),
+                        forwardUp))
+        {
+            NoEndPointsFound(incomingTcpHeader,
+                             incomingIpHeader.GetSource(),
+                             incomingIpHeader.GetDestination());
+            return IpL4Protocol::RX_ENDPOINT_CLOSED;
+        }
+        return IpL4Protocol::RX_OK;
+    }
+
+    endPoint->ForwardUp(packet, incomingIpHeader, incomingTcpHeader.GetSourcePort(), interface);
 
     return IpL4Protocol::RX_OK;
 }
 
+/**
+ * \brief Check whether a segment can be merged by the receive offload
+ *
+ * Only the data segments with no other flag than ACK (and PSH), and no other
+ * option than the timestamps (and the padding), are merged.
+ *
+ * \param packet the segment, with its TCP header
+ * \param tcpHeader the TCP header of the segment
+ * \return true if the segment can be merged
+ */
+static bool
+IsGroMergeable(Ptr<const Packet> packet, const TcpHeader& tcpHeader)
+{
+    if ((tcpHeader.GetFlags() & ~TcpHeader::PSH) != TcpHeader::ACK ||
+        packet->GetSize() <= tcpHeader.GetSerializedSize())
+    {
+        return false;
+    }
+    for (const auto& option : tcpHeader.GetOptionList())
+    {
+        if (option->GetKind() != TcpOption::TS && option->GetKind() != TcpOption::NOP &&
+            option->GetKind() != TcpOption::END)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * \brief Check whether two mergeable segments carry the same timestamps
+ * \param lhs the TCP header of a segment
+ * \param rhs the TCP header of another segment
+ * \return true if both have no timestamps, or the same ones
+ */
+static bool
+HaveSameTimestamps(const TcpHeader& lhs, const TcpHeader& rhs)
+{
+    auto lhsTs = DynamicCast<const TcpOptionTS>(lhs.GetOption(TcpOption::TS));
+    auto rhsTs = DynamicCast<const TcpOptionTS>(rhs.GetOption(TcpOption::TS));
+    if (!lhsTs || !rhsTs)
+    {
+        return !lhsTs && !rhsTs;
+    }
+    return lhsTs->GetTimestamp() == rhsTs->GetTimestamp() && lhsTs->GetEcho() == rhsTs->GetEcho();
+}
+
+bool
+TcpL4Protocol::GroReceive(const void* endPoint,
+                          Ptr<Packet> packet,
+                          const TcpHeader& tcpHeader,
+                          uint8_t tos,
+                          Callback<void, Ptr<Packet>> forwardUp)
+{
+    NS_LOG_FUNCTION(this << endPoint << packet << tcpHeader << +tos);
+
+    m_groSegments++;
+    bool mergeable = IsGroMergeable(packet, tcpHeader);
+    bool push = tcpHeader.GetFlags() & TcpHeader::PSH;
+    uint32_t headerSize = tcpHeader.GetSerializedSize();
+    uint32_t payloadSize = packet->GetSize() - headerSize;
+
+    auto it = m_groBatches.find(endPoint);
+    if (it != m_groBatches.end())
+    {
+        GroBatch& batch = it->second;
+        if (mergeable && tcpHeader.GetSequenceNumber() == batch.nextSeq &&
+            tcpHeader.GetAckNumber() == batch.header.GetAckNumber() &&
+            tcpHeader.GetWindowSize() == batch.header.GetWindowSize() && tos == batch.tos &&
+            HaveSameTimestamps(tcpHeader, batch.header) &&
+            headerSize + batch.payload->GetSize() + payloadSize <= 65535)
+        {
+            NS_LOG_LOGIC("Merge segment " << tcpHeader.GetSequenceNumber() << " into chunk "
+                                          << batch.header.GetSequenceNumber());
+            batch.payload->AddAtEnd(packet->CreateFragment(headerSize, payloadSize));
+            batch.nextSeq += payloadSize;
+            batch.segments++;
+            if (push)
+            {
+                batch.header.SetFlags(batch.header.GetFlags() | TcpHeader::PSH);
+            }
+            if (push || batch.segments >= m_groMaxSegments)
+            {
+                GroFlush(endPoint);
+            }
+            return true;
+        }
+
+        // Deliver the pending chunk first, to keep the order of the segments
+        m_groReceiving = endPoint;
+        GroFlush(endPoint);
+        if (!m_groReceiving)
+        {
+            NS_LOG_LOGIC("End point " << endPoint << " deallocated by the pending chunk");
+            return false;
+        }
+        m_groReceiving = nullptr;
+    }
+
+    if (!mergeable || push)
+    {
+        m_groChunks++;
+        forwardUp(packet);
+        return true;
+    }
+
+    NS_LOG_LOGIC("Hold segment " << tcpHeader.GetSequenceNumber() << " for " << m_groTimeout);
+    GroBatch& batch = m_groBatches[endPoint];
+    batch.payload = packet->CreateFragment(headerSize, payloadSize);
+    batch.header = tcpHeader;
+    batch.nextSeq = tcpHeader.GetSequenceNumber() + payloadSize;
+    batch.tos = tos;
+    batch.segmentSize = payloadSize;
+    batch.segments = 1;
+    batch.forwardUp = forwardUp;
+    batch.flushEvent = Simulator::Schedule(m_groTimeout, &TcpL4Protocol::GroFlush, this, endPoint);
+    return true;
+}
+
+void
+TcpL4Protocol::GroFlush(const void* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+
+    auto it = m_groBatches.find(endPoint);
+    NS_ASSERT_MSG(it != m_groBatches.end(), "No pending chunk for end point " << endPoint);
+    GroBatch batch = std::move(it->second);
+    m_groBatches.erase(it);
+    batch.flushEvent.Cancel();
+
+    NS_LOG_LOGIC("Deliver chunk " << batch.header.GetSequenceNumber() << " of " << batch.segments
+                                  << " segments, " << batch.payload->GetSize() << " bytes");
+    if (batch.segments > 1)
+    {
+        // Let the socket count the segments of the chunk
+        batch.payload->AddPacketTag(
+            GsoTag(batch.segmentSize, batch.header.GetSerializedSize(), batch.segments));
+    }
+    batch.payload->AddHeader(batch.header);
+    m_groChunks++;
+    batch.forwardUp(batch.payload);
+}
+
+void
+TcpL4Protocol::GroRemove(const void* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+
+    if (m_groReceiving == endPoint)
+    {
+        m_groReceiving = nullptr;
+    }
+    auto it = m_groBatches.find(endPoint);
+    if (it != m_groBatches.end())
+    {
+        NS_LOG_LOGIC("Discard chunk " << it->second.header.GetSequenceNumber());
+        it->second.flushEvent.Cancel();
+        m_groBatches.erase(it);
+    }
+}
+
 void
 TcpL4Protocol::SendPacketV4(Ptr<Packet> packet,
                             const TcpHeader& outgoing,
@@ -693,6 +977,96 @@ TcpL4Protocol::SendPacketV6(Ptr<Packet> packet,
     }
 }
 
+/**
+ * \brief Split the payload of a GSO batch into TCP segments
+ *
+ * \tparam A \deduced The type of the network addresses
+ * \param packet The TCP header and the payload of the batch
+ * \param segmentSize The size of the payload of the segments
+ * \param source The source address of the batch
+ * \param destination The destination address of the batch
+ * \returns The segments, with their TCP header
+ */
+template <typename A>
+static std::list<Ptr<Packet>>
+SegmentTcpPayload(Ptr<Packet> packet, uint16_t segmentSize, const A& source, const A& destination)
+{
+    NS_ASSERT(segmentSize > 0);
+    TcpHeader batchHeader;
+    packet->RemoveHeader(batchHeader);
+
+    // The batches only carry the ACK flag (see TcpSocketBase::SendSegment), so
+    // that the segments all get the header of the batch
+    std::list<Ptr<Packet>> segments;
+    uint32_t size = packet->GetSize();
+    for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+        Ptr<Packet> segment =
+            packet->CreateFragment(offset, std::min<uint32_t>(segmentSize, size - offset));
+        TcpHeader header = batchHeader;
+        header.SetSequenceNumber(batchHeader.GetSequenceNumber() + SequenceNumber32(offset));
+        if (Node::ChecksumEnabled())
+        {
+            header.EnableChecksums();
+        }
+        header.InitializeChecksum(source, destination, TcpL4Protocol::PROT_NUMBER);
+        segment->AddHeader(header);
+        segments.push_back(segment);
+    }
+    return segments;
+}
+
+std::list<Ptr<Packet>>
+TcpL4Protocol::SegmentIpv4(Ptr<const Packet> batch)
+{
+    Ptr<Packet> packet = batch->Copy();
+    GsoTag gsoTag;
+    packet->RemovePacketTag(gsoTag);
+    Ipv4Header ipHeader;
+    packet->RemoveHeader(ipHeader);
+    NS_ASSERT(ipHeader.GetProtocol() == PROT_NUMBER);
+
+    std::list<Ptr<Packet>> segments = SegmentTcpPayload(packet,
+                                                        gsoTag.GetSegmentSize(),
+                                                        ipHeader.GetSource(),
+                                                        ipHeader.GetDestination());
+    uint16_t identification = ipHeader.GetIdentification();
+    for (auto& segment : segments)
+    {
+        ipHeader.SetPayloadSize(segment->GetSize());
+        ipHeader.SetIdentification(identification++);
+        if (Node::ChecksumEnabled())
+        {
+            ipHeader.EnableChecksum();
+        }
+        segment->AddHeader(ipHeader);
+    }
+    return segments;
+}
+
+std::list<Ptr<Packet>>
+TcpL4Protocol::SegmentIpv6(Ptr<const Packet> batch)
+{
+    Ptr<Packet> packet = batch->Copy();
+    GsoTag gsoTag;
+    packet->RemovePacketTag(gsoTag);
+    Ipv6Header ipHeader;
+    packet->RemoveHeader(ipHeader);
+    NS_ASSERT_MSG(ipHeader.GetNextHeader() == PROT_NUMBER,
+                  "GSO batches with IPv6 extension headers are not supported");
+
+    std::list<Ptr<Packet>> segments = SegmentTcpPayload(packet,
+                                                        gsoTag.GetSegmentSize(),
+                                                        ipHeader.GetSource(),
+                                                        ipHeader.GetDestination());
+    for (auto& segment : segments)
+    {
+        ipHeader.SetPayloadLength(segment->GetSize());
+        segment->AddHeader(ipHeader);
+    }
+    return segments;
+}
+
 void
 TcpL4Protocol::SendPacket(Ptr<Packet> pkt,
                           const TcpHeader& outgoing,
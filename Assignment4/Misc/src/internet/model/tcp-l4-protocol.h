@@ -21,11 +21,16 @@
 #define TCP_L4_PROTOCOL_H
 
 #include "ip-l4-protocol.h"
+#include "tcp-header.h"
+#include "tcp-pacing-wheel.h"
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
 #include "ns3/sequence-number.h"
 
+#include <list>
 #include <stdint.h>
 #include <unordered_map>
 
@@ -34,7 +39,6 @@ namespace ns3
 
 class Node;
 class Socket;
-class TcpHeader;
 class Ipv4EndPointDemux;
 class Ipv6EndPointDemux;
 class Ipv4Interface;
@@ -257,6 +261,57 @@ class TcpL4Protocol : public IpL4Protocol
      */
     void DeAllocate(Ipv6EndPoint* endPoint);
 
+    /**
+     * \brief Get the number of segments received by the connected sockets
+     * while the receive offload is enabled
+     * \return the number of segments
+     */
+    uint64_t GetGroSegments() const;
+    /**
+     * \brief Get the number of chunks delivered to the connected sockets by
+     * the receive offload
+     *
+     * A chunk is either a segment which was not merged, or the merge of
+     * several segments. The ratio of GetGroSegments() to this number is the
+     * average number of segments merged in a chunk.
+     *
+     * \return the number of chunks
+     */
+    uint64_t GetGroChunks() const;
+
+    /**
+     * \brief Set the duration of the slots of the pacing wheel
+     *
+     * The paced sockets of the node are released by the pacing wheel,
+     * at the end of the slot of their release time, instead of their own
+     * pacing timer. Must be set before any socket is paced.
+     *
+     * \param slot the duration of the slots; zero disables the pacing wheel
+     */
+    void SetPacingSlot(Time slot);
+    /**
+     * \brief Get the duration of the slots of the pacing wheel
+     * \return the duration of the slots; zero if the pacing wheel is disabled
+     */
+    Time GetPacingSlot() const;
+    /**
+     * \brief Schedule the release of a paced socket by the pacing wheel
+     * \param socket the socket
+     * \param release the time the socket can send again
+     * \param generation the pacing generation of the socket
+     */
+    void SchedulePacing(Ptr<TcpSocketBase> socket, Time release, uint64_t generation);
+    /**
+     * \brief Get the number of events run by the pacing wheel
+     * \return the number of events
+     */
+    uint64_t GetPacingEvents() const;
+    /**
+     * \brief Get the number of sockets released by the pacing wheel
+     * \return the number of releases
+     */
+    uint64_t GetPacingReleases() const;
+
     // From IpL4Protocol
     IpL4Protocol::RxStatus Receive(Ptr<Packet> p,
                                    const Ipv4Header& incomingIpHeader,
@@ -347,6 +402,66 @@ class TcpL4Protocol : public IpL4Protocol
     IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
     IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
 
+    /**
+     * \brief In-order data segments of a connection merged by the receive
+     * offload, waiting to be delivered to the socket as a single chunk
+     */
+    struct GroBatch
+    {
+        Ptr<Packet> payload;                   //!< Merged payload of the segments
+        TcpHeader header;                      //!< TCP header of the first segment
+        SequenceNumber32 nextSeq;              //!< Sequence number of the next segment
+        uint8_t tos{0};                        //!< IP TOS (or traffic class) of the segments
+        uint16_t segmentSize{0};               //!< Payload size of the first segment
+        uint16_t segments{0};                  //!< Number of merged segments
+        Callback<void, Ptr<Packet>> forwardUp; //!< Forwards the chunk to the end point
+        EventId flushEvent;                    //!< Delivers the chunk at the end of the window
+    };
+
+    uint32_t m_groMaxSegments;           //!< Maximum number of segments merged in a chunk
+    Time m_groTimeout;                   //!< Maximum time a segment is held to be merged
+    std::unordered_map<const void*, GroBatch>
+        m_groBatches;                    //!< Pending chunks, indexed by end point
+    const void* m_groReceiving{nullptr}; //!< End point receiving a segment
+    uint64_t m_groSegments{0};           //!< Number of segments received through GRO
+    uint64_t m_groChunks{0};             //!< Number of chunks delivered by GRO
+    TcpPacingWheel m_pacingWheel;        //!< Releases the paced sockets
+
+    /**
+     * \brief Deliver a segment to a connected end point through the receive
+     * offload (GRO)
+     *
+     * The segment is merged with the pending chunk of the end point if it
+     * follows it in sequence and carries the same header, and held until the
+     * chunk is full or the end of the window. Otherwise, the pending chunk is
+     * delivered first.
+     *
+     * \param endPoint the end point (an Ipv4EndPoint or an Ipv6EndPoint)
+     * \param packet the segment, with its TCP header
+     * \param tcpHeader the TCP header of the segment
+     * \param tos the IP TOS (or traffic class) of the segment
+     * \param forwardUp the callback forwarding a packet to the end point
+     * \return false if the end point was deallocated while its pending chunk
+     * was delivered, so that the segment could not be delivered
+     */
+    bool GroReceive(const void* endPoint,
+                    Ptr<Packet> packet,
+                    const TcpHeader& tcpHeader,
+                    uint8_t tos,
+                    Callback<void, Ptr<Packet>> forwardUp);
+
+    /**
+     * \brief Deliver the pending chunk of an end point
+     * \param endPoint the end point
+     */
+    void GroFlush(const void* endPoint);
+
+    /**
+     * \brief Discard the pending chunk of an end point being deallocated
+     * \param endPoint the end point
+     */
+    void GroRemove(const void* endPoint);
+
     /**
      * \brief Send a packet via TCP (IPv4)
      *
@@ -376,6 +491,25 @@ class TcpL4Protocol : public IpL4Protocol
                       const Ipv6Address& saddr,
                       const Ipv6Address& daddr,
                       Ptr<NetDevice> oif = nullptr) const;
+
+    /**
+     * \brief Split a GSO batch sent over IPv4 into segments
+     *
+     * The segments of the batch get consecutive IPv4 identifications,
+     * starting from the one of the batch.
+     *
+     * \param batch The batch, with its IPv4 header and its GsoTag
+     * \returns The segments, with their IPv4 header
+     */
+    static std::list<Ptr<Packet>> SegmentIpv4(Ptr<const Packet> batch);
+
+    /**
+     * \brief Split a GSO batch sent over IPv6 into segments
+     *
+     * \param batch The batch, with its IPv6 header and its GsoTag
+     * \returns The segments, with their IPv6 header
+     */
+    static std::list<Ptr<Packet>> SegmentIpv6(Ptr<const Packet> batch);
 };
 
 } // namespace ns3
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-pacing-wheel.h"
+
+#include "tcp-socket-base.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <bit>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TcpPacingWheel");
+
+TcpPacingWheel::TcpPacingWheel()
+    : m_slotDuration(Time(0))
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TcpPacingWheel::~TcpPacingWheel()
+{
+    NS_LOG_FUNCTION(this);
+    Clear();
+}
+
+void
+TcpPacingWheel::SetSlot(Time slot)
+{
+    NS_LOG_FUNCTION(this << slot);
+    NS_ASSERT_MSG(m_size == 0, "Cannot change the slot of a pacing wheel in use");
+    NS_ASSERT_MSG(!slot.IsStrictlyNegative(), "Negative pacing slot");
+    m_slotDuration = slot;
+    m_slot = 0;
+}
+
+Time
+TcpPacingWheel::GetSlot() const
+{
+    return m_slotDuration;
+}
+
+void
+TcpPacingWheel::Schedule(Ptr<TcpSocketBase> socket, Time release, uint64_t generation)
+{
+    NS_LOG_FUNCTION(this << socket << release << generation);
+    NS_ASSERT_MSG(m_slotDuration.IsStrictlyPositive(), "Pacing wheel disabled");
+
+    // A slot is processed at its end, so the slots ending before now are over
+    int64_t duration = m_slotDuration.GetTimeStep();
+    m_slot = std::max<uint64_t>(m_slot, (Simulator::Now().GetTimeStep() + duration - 1) / duration);
+
+    uint64_t slot = std::max<int64_t>(release.GetTimeStep() + duration - 1, 0) / duration;
+    Insert({std::max(slot, m_slot), socket, generation});
+    m_size++;
+    if (!m_expiring)
+    {
+        Reschedule();
+    }
+}
+
+void
+TcpPacingWheel::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_event.Cancel();
+    for (auto& level : m_levels)
+    {
+        for (auto& bucket : level)
+        {
+            bucket.clear();
+        }
+    }
+    m_occupied.fill(0);
+    m_overflow.clear();
+    m_size = 0;
+}
+
+uint64_t
+TcpPacingWheel::GetEvents() const
+{
+    return m_events;
+}
+
+uint64_t
+TcpPacingWheel::GetReleases() const
+{
+    return m_releases;
+}
+
+void
+TcpPacingWheel::Insert(Entry&& entry)
+{
+    NS_ASSERT(entry.slot >= m_slot);
+    for (uint32_t level = 0; level < LEVELS; level++)
+    {
+        // The lowest level whose current rotation includes the slot
+        uint32_t rotationShift = LEVEL_BITS * (level + 1);
+        if ((entry.slot >> rotationShift) == (m_slot >> rotationShift))
+        {
+            uint32_t index = (entry.slot >> (LEVEL_BITS * level)) & (LEVEL_SIZE - 1);
+            m_levels[level][index].push_back(std::move(entry));
+            m_occupied[level] |= uint64_t(1) << index;
+            return;
+        }
+    }
+    m_overflow.push_back(std::move(entry));
+}
+
+void
+TcpPacingWheel::Cascade(uint32_t level, uint32_t index)
+{
+    if (!(m_occupied[level] & (uint64_t(1) << index)))
+    {
+        return;
+    }
+    NS_LOG_LOGIC("Cascade bucket " << index << " of level " << level);
+    Bucket entries;
+    entries.swap(m_levels[level][index]);
+    m_occupied[level] &= ~(uint64_t(1) << index);
+    for (auto& entry : entries)
+    {
+        Insert(std::move(entry));
+    }
+}
+
+uint64_t
+TcpPacingWheel::GetNextSlot() const
+{
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+    for (uint32_t level = 0; level < LEVELS; level++)
+    {
+        if (!m_occupied[level])
+        {
+            continue;
+        }
+        // The entries of a level are in the buckets of its current rotation,
+        // not before the one of m_slot
+        uint32_t shift = LEVEL_BITS * level;
+        uint32_t current = (m_slot >> shift) & (LEVEL_SIZE - 1);
+        uint64_t buckets = m_occupied[level] & (~uint64_t(0) << current);
+        NS_ASSERT_MSG(buckets, "Entries of level " << level << " left behind");
+        uint64_t rotation = m_slot >> (shift + LEVEL_BITS);
+        uint64_t slot = ((rotation << LEVEL_BITS) | std::countr_zero(buckets)) << shift;
+        next = std::min(next, std::max(slot, m_slot));
+    }
+    if (!m_overflow.empty())
+    {
+        uint32_t shift = LEVEL_BITS * LEVELS;
+        next = std::min(next, ((m_slot >> shift) + 1) << shift);
+    }
+    return next;
+}
+
+void
+TcpPacingWheel::Reschedule()
+{
+    if (m_size == 0)
+    {
+        m_event.Cancel();
+        return;
+    }
+    uint64_t next = GetNextSlot();
+    if (m_event.IsPending() && m_eventSlot == next)
+    {
+        return;
+    }
+    m_event.Cancel();
+    m_eventSlot = next;
+    Time at = TimeStep(next * m_slotDuration.GetTimeStep());
+    m_event = Simulator::Schedule(at - Simulator::Now(), &TcpPacingWheel::Expire, this);
+}
+
+void
+TcpPacingWheel::Expire()
+{
+    NS_LOG_FUNCTION(this << m_eventSlot);
+    NS_ASSERT(m_eventSlot >= m_slot);
+    m_events++;
+
+    // Bring down the entries of the higher levels starting at this slot
+    uint64_t slot = m_eventSlot;
+    m_slot = slot;
+    uint32_t shift = LEVEL_BITS * LEVELS;
+    if ((slot & ((uint64_t(1) << shift) - 1)) == 0 && !m_overflow.empty())
+    {
+        Bucket entries;
+        entries.swap(m_overflow);
+        for (auto& entry : entries)
+        {
+            Insert(std::move(entry));
+        }
+    }
+    for (uint32_t level = LEVELS - 1; level > 0; level--)
+    {
+        shift = LEVEL_BITS * level;
+        if ((slot & ((uint64_t(1) << shift) - 1)) == 0)
+        {
+            Cascade(level, (slot >> shift) & (LEVEL_SIZE - 1));
+        }
+    }
+
+    // Release the sockets of the slot; they may schedule their next release
+    uint32_t index = slot & (LEVEL_SIZE - 1);
+    Bucket entries;
+    entries.swap(m_levels[0][index]);
+    m_occupied[0] &= ~(uint64_t(1) << index);
+    m_slot = slot + 1;
+    m_size -= entries.size();
+    NS_LOG_LOGIC("Release " << entries.size() << " sockets");
+    m_expiring = true;
+    for (auto& entry : entries)
+    {
+        m_releases++;
+        entry.socket->NotifyPacingReleased(entry.generation);
+    }
+    m_expiring = false;
+    Reschedule();
+}
+
+} // namespace ns3
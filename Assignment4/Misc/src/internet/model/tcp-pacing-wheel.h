@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_PACING_WHEEL_H
+#define TCP_PACING_WHEEL_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <array>
+#include <vector>
+
+namespace ns3
+{
+
+class TcpSocketBase;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Hierarchical timing wheel releasing the paced sockets of a node
+ *
+ * Instead of arming its own pacing timer for each segment, a paced socket
+ * may register its next release time in the pacing wheel of its node. The
+ * time is divided into slots; the sockets whose release time falls in the
+ * same slot are all released by a single event, at the end of the slot, so
+ * that they are released at most one slot late.
+ *
+ * The wheel has LEVELS levels of LEVEL_SIZE buckets: a bucket of level k
+ * spans LEVEL_SIZE^k slots. A socket is inserted in the lowest level whose
+ * current rotation includes its release slot, and moved down (cascaded) to
+ * the lower levels when the wheel reaches its bucket. Bitmaps of the
+ * non-empty buckets give the next slot to process, so the event is only
+ * scheduled for the slots releasing or cascading some sockets.
+ */
+class TcpPacingWheel
+{
+  public:
+    TcpPacingWheel();
+    ~TcpPacingWheel();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    TcpPacingWheel(const TcpPacingWheel&) = delete;
+    TcpPacingWheel& operator=(const TcpPacingWheel&) = delete;
+
+    /**
+     * \brief Set the duration of the slots
+     *
+     * The wheel must be empty.
+     *
+     * \param slot the duration of the slots; zero disables the wheel
+     */
+    void SetSlot(Time slot);
+
+    /**
+     * \brief Get the duration of the slots
+     * \return the duration of the slots; zero if the wheel is disabled
+     */
+    Time GetSlot() const;
+
+    /**
+     * \brief Register the release of a socket
+     *
+     * The socket is released (see TcpSocketBase::NotifyPacingReleased) at the
+     * end of the slot of the release time, with the given generation.
+     *
+     * \param socket the socket
+     * \param release the release time
+     * \param generation the pacing generation of the socket
+     */
+    void Schedule(Ptr<TcpSocketBase> socket, Time release, uint64_t generation);
+
+    /**
+     * \brief Drop all the registered releases
+     */
+    void Clear();
+
+    /**
+     * \brief Get the number of events run by the wheel
+     * \return the number of events
+     */
+    uint64_t GetEvents() const;
+
+    /**
+     * \brief Get the number of sockets released by the wheel
+     * \return the number of releases
+     */
+    uint64_t GetReleases() const;
+
+  private:
+    /// Number of bits of the bucket index in a level
+    static constexpr uint32_t LEVEL_BITS = 6;
+    /// Number of buckets in a level
+    static constexpr uint32_t LEVEL_SIZE = 1 << LEVEL_BITS;
+    /// Number of levels
+    static constexpr uint32_t LEVELS = 4;
+
+    /// Release of a socket
+    struct Entry
+    {
+        uint64_t slot;             //!< Release slot
+        Ptr<TcpSocketBase> socket; //!< Socket to release
+        uint64_t generation;       //!< Pacing generation of the socket
+    };
+
+    /// Bucket of the entries to release, or to cascade, at the same slot
+    using Bucket = std::vector<Entry>;
+
+    /**
+     * \brief Put an entry in its bucket, or in the overflow list
+     * \param entry the entry, with a slot not before m_slot
+     */
+    void Insert(Entry&& entry);
+
+    /**
+     * \brief Move the entries of a bucket to the lower levels
+     * \param level the level of the bucket
+     * \param index the index of the bucket
+     */
+    void Cascade(uint32_t level, uint32_t index);
+
+    /**
+     * \brief Get the next slot to process
+     * \return the first slot, not before m_slot, whose processing releases
+     * or cascades some entries
+     */
+    uint64_t GetNextSlot() const;
+
+    /**
+     * \brief Schedule the event of the wheel for its next slot, if needed
+     */
+    void Reschedule();
+
+    /**
+     * \brief Process the slot of the event: cascade and release the entries
+     */
+    void Expire();
+
+    Time m_slotDuration;                                         //!< Duration of the slots
+    std::array<std::array<Bucket, LEVEL_SIZE>, LEVELS> m_levels; //!< Buckets of the levels
+    std::array<uint64_t, LEVELS> m_occupied{};                   //!< Non-empty buckets
+    Bucket m_overflow;                                           //!< Entries beyond the top level
+    uint64_t m_slot{0};                                          //!< Next slot to process
+    uint64_t m_size{0};                                          //!< Number of entries
+    EventId m_event;                                             //!< Event of the next slot
+    uint64_t m_eventSlot{0};                                     //!< Slot of the event
+    bool m_expiring{false};                                      //!< Whether a slot is released
+    uint64_t m_events{0};                                        //!< Number of events run
+    uint64_t m_releases{0};                                      //!< Number of sockets released
+};
+
+} // namespace ns3
+
+#endif /* TCP_PACING_WHEEL_H */
@@ -171,29 +171,29 @@ TcpRxBuffer::Add(Ptr<Packet> p, const TcpHeader& tcph)
             headSeq = tailSeq;
         }
     }
-    // Remove overlapped bytes from packet
-    auto i = m_data.begin();
-    while (i != m_data.end() && i->first <= tailSeq)
+    // Remove overlapped bytes from packet. The ranges are neither overlapping
+    // nor adjacent, so only the range before headSeq can overlap the head
+    auto i = m_data.upper_bound(headSeq);
+    if (i != m_data.begin())
     {
-        SequenceNumber32 lastByteSeq = i->first + SequenceNumber32(i->second->GetSize());
+        auto prev = std::prev(i);
+        SequenceNumber32 lastByteSeq = prev->first + SequenceNumber32(prev->second.size);
         if (lastByteSeq > headSeq)
-        {
-            if (i->first > headSeq && lastByteSeq < tailSeq)
-            { // Rare case: Existing packet is embedded fully in the new packet
-                m_size -= i->second->GetSize();
-                m_data.erase(i++);
-                continue;
-            }
-            if (i->first <= headSeq)
-            { // Incoming head is overlapped
-                headSeq = lastByteSeq;
-            }
-            if (lastByteSeq >= tailSeq)
-            { // Incoming tail is overlapped
-                tailSeq = i->first;
-            }
+        { // Incoming head is overlapped
+            headSeq = lastByteSeq;
+        }
+    }
+    while (i != m_data.end() && i->first < tailSeq && headSeq < tailSeq)
+    {
+        SequenceNumber32 lastByteSeq = i->first + SequenceNumber32(i->second.size);
+        if (lastByteSeq < tailSeq)
+        { // Rare case: Existing range is embedded fully in the new packet
+            m_size -= i->second.size;
+            i = m_data.erase(i);
+            continue;
         }
-        ++i;
+        // Incoming tail is overlapped
+        tailSeq = i->first;
     }
     // We now know how much we are going to store, trim the packet
     if (headSeq >= tailSeq)
@@ -205,34 +205,50 @@ TcpRxBuffer::Add(Ptr<Packet> p, const TcpHeader& tcph)
     {
         uint32_t start = static_cast<uint32_t>(headSeq - tcph.GetSequenceNumber());
         auto length = static_cast<uint32_t>(tailSeq - headSeq);
-        p = p->CreateFragment(start, length);
+        if (start != 0 || length != pktSize)
+        {
+            p = p->CreateFragment(start, length);
+        }
         NS_ASSERT(length == p->GetSize());
     }
-    // Insert packet into buffer
-    NS_ASSERT(m_data.find(headSeq) == m_data.end()); // Shouldn't be there yet
-    m_data[headSeq] = p;
+
+    // Insert packet into buffer: append it to the range which ends at headSeq,
+    // or start a new one, and merge it with the range which starts at tailSeq
+    BufIterator range = m_data.end();
+    if (i != m_data.begin())
+    {
+        auto prev = std::prev(i);
+        if (prev->first + SequenceNumber32(prev->second.size) == headSeq)
+        {
+            range = prev;
+        }
+    }
+    if (range == m_data.end())
+    {
+        range = m_data.emplace_hint(i, headSeq, DataRange());
+    }
+    range->second.packets.push_back(p);
+    range->second.size += p->GetSize();
+    if (i != m_data.end() && i->first == tailSeq)
+    {
+        MergeRanges(range, i);
+    }
+    SequenceNumber32 rangeEnd = range->first + SequenceNumber32(range->second.size);
 
     if (headSeq > m_nextRxSeq)
     {
         // Generate a new SACK block
-        UpdateSackList(headSeq, tailSeq);
+        UpdateSackList(range->first, rangeEnd);
     }
 
     NS_LOG_LOGIC("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize());
     // Update variables
     m_size += p->GetSize(); // Occupancy
-    for (i = m_data.begin(); i != m_data.end(); ++i)
+    if (range->first <= m_nextRxSeq && rangeEnd > m_nextRxSeq)
     {
-        if (i->first < m_nextRxSeq)
-        {
-            continue;
-        }
-        else if (i->first > m_nextRxSeq)
-        {
-            break;
-        };
-        m_nextRxSeq = i->first + SequenceNumber32(i->second->GetSize());
-        m_availBytes += i->second->GetSize();
+        // The range at the head grew: it is delivered up to its end
+        m_availBytes += rangeEnd - m_nextRxSeq;
+        m_nextRxSeq = rangeEnd;
         ClearSackList(m_nextRxSeq);
     }
     NS_LOG_LOGIC("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -243,6 +259,49 @@ TcpRxBuffer::Add(Ptr<Packet> p, const TcpHeader& tcph)
     return true;
 }
 
+void
+TcpRxBuffer::MergeRanges(BufIterator left, BufIterator right)
+{
+    NS_LOG_FUNCTION(this << left->first << right->first);
+    NS_ASSERT(left->first + SequenceNumber32(left->second.size) == right->first);
+
+    std::deque<Ptr<Packet>>& leftPackets = left->second.packets;
+    std::deque<Ptr<Packet>>& rightPackets = right->second.packets;
+    if (leftPackets.size() < rightPackets.size())
+    {
+        rightPackets.insert(rightPackets.begin(), leftPackets.begin(), leftPackets.end());
+        leftPackets.swap(rightPackets);
+    }
+    else
+    {
+        leftPackets.insert(leftPackets.end(), rightPackets.begin(), rightPackets.end());
+    }
+    left->second.size += right->second.size;
+    m_data.erase(right);
+}
+
+uint32_t
+TcpRxBuffer::GetOutOfOrderSize() const
+{
+    return m_size - m_availBytes;
+}
+
+uint32_t
+TcpRxBuffer::GetReorderDepth() const
+{
+    if (m_data.empty())
+    {
+        return 0;
+    }
+    auto last = std::prev(m_data.end());
+    SequenceNumber32 lastByteSeq = last->first + SequenceNumber32(last->second.size);
+    if (lastByteSeq <= m_nextRxSeq)
+    {
+        return 0;
+    }
+    return lastByteSeq - m_nextRxSeq;
+}
+
 uint32_t
 TcpRxBuffer::GetSackListSize() const
 {
@@ -287,53 +346,20 @@ TcpRxBuffer::UpdateSackList(const SequenceNumber32& head, const SequenceNumber32
     //     following SACK blocks in the SACK option may be listed in
     //     arbitrary order.
 
-    m_sackList.push_front(current);
-
-    // We have inserted the block at the beginning of the list. Now, we should
-    // check if any existing blocks overlap with that.
-    bool updated = false;
-    auto it = m_sackList.begin();
-    TcpOptionSack::SackBlock begin = *it;
-    TcpOptionSack::SackBlock merged;
-    ++it;
-
-    // Iterates until we examined all blocks in the list (maximum 4)
-    while (it != m_sackList.end())
+    // The block is the whole range holding the segment: remove the blocks
+    // which are part of it, and insert it at the beginning
+    for (auto it = m_sackList.begin(); it != m_sackList.end();)
     {
-        current = *it;
-
-        // This is a left merge:
-        // [current_first; current_second] [beg_first; beg_second]
-        if (begin.first == current.second)
-        {
-            NS_ASSERT(current.first < begin.second);
-            merged = TcpOptionSack::SackBlock(current.first, begin.second);
-            updated = true;
-        }
-        // while this is a right merge
-        // [begin_first; begin_second] [current_first; current_second]
-        else if (begin.second == current.first)
+        if (it->first >= current.first && it->second <= current.second)
         {
-            NS_ASSERT(begin.first < current.second);
-            merged = TcpOptionSack::SackBlock(begin.first, current.second);
-            updated = true;
+            it = m_sackList.erase(it);
         }
-
-        // If we have merged the blocks (and the result is in merged) we should
-        // delete the current block (it), the first block, and insert the merged
-        // one at the beginning.
-        if (updated)
+        else
         {
-            m_sackList.erase(it);
-            m_sackList.pop_front();
-            m_sackList.push_front(merged);
-            it = m_sackList.begin();
-            begin = *it;
-            updated = false;
+            ++it;
         }
-
-        ++it;
     }
+    m_sackList.push_front(current);
 
     // Since the maximum blocks that fits into a TCP header are 4, there's no
     // point on maintaining the others.
@@ -341,11 +367,6 @@ TcpRxBuffer::UpdateSackList(const SequenceNumber32& head, const SequenceNumber32
     {
         m_sackList.pop_back();
     }
-
-    // Please note that, if a block b is discarded and then a block contiguous
-    // to b is received, only that new block (without the b part) is reported.
-    // This is perfectly fine for the RFC point (a), given that we do not report any
-    // overlapping blocks shortly after.
 }
 
 void
@@ -389,39 +410,51 @@ TcpRxBuffer::Extract(uint32_t maxSize)
     }
     NS_ASSERT(!m_data.empty());            // At least we have something to extract
     Ptr<Packet> outPkt = Create<Packet>(); // The packet that contains all the data to return
-    BufIterator i;
+    BufIterator i = m_data.begin();
+    NS_ASSERT(i->first <= m_nextRxSeq); // in-sequence data expected
+    DataRange& range = i->second;
+    uint32_t extracted = 0;
     while (extractSize)
     { // Check the buffered data for delivery
-        i = m_data.begin();
-        NS_ASSERT(i->first <= m_nextRxSeq); // in-sequence data expected
         // Check if we send the whole pkt or just a partial
-        uint32_t pktSize = i->second->GetSize();
+        Ptr<Packet> p = range.packets.front();
+        uint32_t pktSize = p->GetSize();
         if (pktSize <= extractSize)
         { // Whole packet is extracted
-            outPkt->AddAtEnd(i->second);
-            m_data.erase(i);
-            m_size -= pktSize;
-            m_availBytes -= pktSize;
+            outPkt->AddAtEnd(p);
+            range.packets.pop_front();
+            extracted += pktSize;
             extractSize -= pktSize;
         }
         else
         { // Partial is extracted and done
-            outPkt->AddAtEnd(i->second->CreateFragment(0, extractSize));
-            m_data[i->first + SequenceNumber32(extractSize)] =
-                i->second->CreateFragment(extractSize, pktSize - extractSize);
-            m_data.erase(i);
-            m_size -= extractSize;
-            m_availBytes -= extractSize;
+            outPkt->AddAtEnd(p->CreateFragment(0, extractSize));
+            range.packets.front() = p->CreateFragment(extractSize, pktSize - extractSize);
+            extracted += extractSize;
             extractSize = 0;
         }
     }
+    m_size -= extracted;
+    m_availBytes -= extracted;
+    range.size -= extracted;
+    if (range.size == 0)
+    {
+        m_data.erase(i);
+    }
+    else
+    {
+        // The range now starts after the extracted data
+        auto node = m_data.extract(i);
+        node.key() += extracted;
+        m_data.insert(std::move(node));
+    }
     if (outPkt->GetSize() == 0)
     {
         NS_LOG_LOGIC("Nothing extracted.");
         return nullptr;
     }
     NS_LOG_LOGIC("Extracted " << outPkt->GetSize() << " bytes, bufsize=" << m_size
-                              << ", num pkts in buffer=" << m_data.size());
+                              << ", num ranges in buffer=" << m_data.size());
     return outPkt;
 }
 
@@ -28,6 +28,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/traced-value.h"
 
+#include <deque>
 #include <map>
 
 namespace ns3
@@ -55,6 +56,13 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The data is stored as ranges of contiguous bytes, indexed by the sequence
+ * number of their first byte. A segment which is adjacent to a range (or
+ * which fills the hole between two ranges) is merged into it, by appending
+ * the packet to the chain of fragments of the range: there are as many
+ * ranges as there are holes in the received data, and the packets are only
+ * concatenated once, when extracted.
+ *
  * SACK list
  * ---------
  *
@@ -177,6 +185,21 @@ class TcpRxBuffer : public Object
      */
     uint32_t GetSackListSize() const;
 
+    /**
+     * \brief Get the number of bytes buffered out of order
+     *
+     * \return the number of bytes received beyond the first hole
+     */
+    uint32_t GetOutOfOrderSize() const;
+
+    /**
+     * \brief Get the reordering depth
+     *
+     * \return the number of bytes from the first missing byte (RCV.NXT) to
+     * the end of the data received out of order, or 0 if there is none
+     */
+    uint32_t GetReorderDepth() const;
+
     /**
      * \brief Says if a FIN bit has been received
      * \return true if we received a FIN bit
@@ -190,6 +213,10 @@ class TcpRxBuffer : public Object
     /**
      * \brief Update the sack list, with the block seq starting at the beginning
      *
+     * The block is the whole range of contiguous data which contains the
+     * segment just received; the blocks of the list which are part of it are
+     * removed.
+     *
      * Note: the maximum size of the block list is 4. Caller is free to
      * drop blocks at the end to accommodate header size; from RFC 2018:
      *
@@ -222,8 +249,29 @@ class TcpRxBuffer : public Object
 
     TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+    /**
+     * \brief A range of contiguous bytes stored in the buffer
+     */
+    struct DataRange
+    {
+        std::deque<Ptr<Packet>> packets; //!< Fragments of the range, in sequence order
+        uint32_t size{0};                //!< Number of bytes in the range
+    };
+
     /// container for data stored in the buffer
-    typedef std::map<SequenceNumber32, Ptr<Packet>>::iterator BufIterator;
+    typedef std::map<SequenceNumber32, DataRange>::iterator BufIterator;
+
+    /**
+     * \brief Merge two adjacent ranges of data
+     *
+     * The fragments of the shorter chain are moved into the longer one.
+     *
+     * \param left the first range
+     * \param right the range which starts right after the end of left; it is
+     * removed from the buffer
+     */
+    void MergeRanges(BufIterator left, BufIterator right);
+
     TracedValue<SequenceNumber32>
         m_nextRxSeq;           //!< Seqnum of the first missing byte in data (RCV.NXT)
     SequenceNumber32 m_finSeq; //!< Seqnum of the FIN packet
@@ -231,7 +279,7 @@ class TcpRxBuffer : public Object
     uint32_t m_size;       //!< Number of total data bytes in the buffer, not necessarily contiguous
     uint32_t m_maxBuffer;  //!< Upper bound of the number of data bytes in buffer (RCV.WND)
     uint32_t m_availBytes; //!< Number of bytes available to read, i.e. contiguous block at head
-    std::map<SequenceNumber32, Ptr<Packet>> m_data; //!< Corresponding data (may be null)
+    std::map<SequenceNumber32, DataRange> m_data; //!< Ranges of data, by first sequence number
 };
 
 } // namespace ns3
@@ -50,6 +50,7 @@
 #include "ns3/abort.h"
 #include "ns3/data-rate.h"
 #include "ns3/double.h"
+#include "ns3/gso-tag.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/log.h"
@@ -161,6 +162,13 @@ TcpSocketBase::GetTypeId()
                           BooleanValue(true),
                           MakeBooleanAccessor(&TcpSocketBase::m_limitedTx),
                           MakeBooleanChecker())
+            .AddAttribute("GsoMaxSegments",
+                          "Maximum number of consecutive segments sent down the stack as a "
+                          "single packet, split by the device (generic segmentation offload). "
+                          "1 disables the offload.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&TcpSocketBase::m_gsoMaxSegments),
+                          MakeUintegerChecker<uint32_t>(1, 65535))
             .AddAttribute("UseEcn",
                           "Parameter to set ECN functionality",
                           EnumValue(TcpSocketState::Off),
@@ -372,6 +380,7 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase& sock)
       m_txTrace(sock.m_txTrace),
       m_rxTrace(sock.m_rxTrace),
       m_pacingTimer(Timer::CANCEL_ON_DESTROY),
+      m_gsoMaxSegments(sock.m_gsoMaxSegments),
       m_ecnEchoSeq(sock.m_ecnEchoSeq),
       m_ecnCESeq(sock.m_ecnCESeq),
       m_ecnCWRSeq(sock.m_ecnCWRSeq)
@@ -2738,6 +2747,9 @@ TcpSocketBase::SendEmptyPacket(uint8_t flags)
         return;
     }
 
+    // Keep the segments in order
+    FlushGsoBatch();
+
     Ptr<Packet> p = Create<Packet>();
     TcpHeader header;
     SequenceNumber32 s = m_tcb->m_nextTxSequence;
@@ -3137,12 +3149,12 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
     if (IsPacingEnabled())
     {
         NS_LOG_INFO("Pacing is enabled");
-        if (m_pacingTimer.IsExpired())
+        if (!IsPacingPending())
         {
             NS_LOG_DEBUG("Current Pacing Rate " << m_tcb->m_pacingRate);
             NS_LOG_DEBUG("Timer is in expired state, activate it "
                          << m_tcb->m_pacingRate.Get().CalculateBytesTxTime(sz));
-            m_pacingTimer.Schedule(m_tcb->m_pacingRate.Get().CalculateBytesTxTime(sz));
+            SchedulePacing(sz);
         }
         else
         {
@@ -3215,28 +3227,9 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
 
     m_txTrace(p, header, this);
 
-    if (m_endPoint)
-    {
-        m_tcp->SendPacket(p,
-                          header,
-                          m_endPoint->GetLocalAddress(),
-                          m_endPoint->GetPeerAddress(),
-                          m_boundnetdevice);
-        NS_LOG_DEBUG("Send segment of size "
-                     << sz << " with remaining data " << remainingData << " via TcpL4Protocol to "
-                     << m_endPoint->GetPeerAddress() << ". Header " << header);
-    }
-    else
-    {
-        m_tcp->SendPacket(p,
-                          header,
-                          m_endPoint6->GetLocalAddress(),
-                          m_endPoint6->GetPeerAddress(),
-                          m_boundnetdevice);
-        NS_LOG_DEBUG("Send segment of size "
-                     << sz << " with remaining data " << remainingData << " via TcpL4Protocol to "
-                     << m_endPoint6->GetPeerAddress() << ". Header " << header);
-    }
+    SendSegment(p, header);
+    NS_LOG_DEBUG("Send segment of size " << sz << " with remaining data " << remainingData
+                                         << " via TcpL4Protocol. Header " << header);
 
     // Signal to congestion control whether the cwnd is fully used
     // This is a simple version of Linux tcp_cwnd_validate() but following
@@ -3265,6 +3258,95 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
     return sz;
 }
 
+void
+TcpSocketBase::SendSegment(Ptr<Packet> p, const TcpHeader& header)
+{
+    NS_LOG_FUNCTION(this << p << header);
+
+    // Retransmissions, e.g., those of the RFC 6675 recovery, are never batched
+    if (!m_gsoBatching || header.GetSequenceNumber() < m_tcb->m_highTxMark)
+    {
+        FlushGsoBatch();
+        SendToL4(p, header);
+        return;
+    }
+
+    if (m_gsoPacket)
+    {
+        // Only full-sized segments can be followed by another one in a batch, and
+        // the headers of the segments may differ only by their sequence number
+        TcpHeader unsequenced = header;
+        unsequenced.SetSequenceNumber(m_gsoHeader.GetSequenceNumber());
+        if (m_gsoSegments < m_gsoMaxSegments &&
+            m_gsoPacket->GetSize() == m_gsoSegments * m_gsoSegmentSize &&
+            p->GetSize() <= m_gsoSegmentSize &&
+            header.GetSequenceNumber() ==
+                m_gsoHeader.GetSequenceNumber() + m_gsoPacket->GetSize() &&
+            unsequenced == m_gsoHeader &&
+            header.GetSerializedSize() == m_gsoHeader.GetSerializedSize() &&
+            // The batch must fit in the 16-bit payload length of the IP header
+            header.GetSerializedSize() + m_gsoPacket->GetSize() + p->GetSize() <= 65515)
+        {
+            m_gsoPacket->AddAtEnd(p);
+            ++m_gsoSegments;
+            return;
+        }
+        FlushGsoBatch();
+    }
+
+    if (header.GetFlags() == TcpHeader::ACK)
+    {
+        // p may still be referenced by the listeners of the Tx trace
+        m_gsoPacket = p->Copy();
+        m_gsoHeader = header;
+        m_gsoSegments = 1;
+        m_gsoSegmentSize = p->GetSize();
+        return;
+    }
+    SendToL4(p, header);
+}
+
+void
+TcpSocketBase::FlushGsoBatch()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_gsoPacket)
+    {
+        return;
+    }
+    Ptr<Packet> p = m_gsoPacket;
+    m_gsoPacket = nullptr;
+    if (m_gsoSegments > 1)
+    {
+        NS_LOG_LOGIC("Send a GSO batch of " << m_gsoSegments << " segments");
+        GsoTag gsoTag(m_gsoSegmentSize, m_gsoHeader.GetSerializedSize(), m_gsoSegments);
+        p->AddPacketTag(gsoTag);
+    }
+    SendToL4(p, m_gsoHeader);
+}
+
+void
+TcpSocketBase::SendToL4(Ptr<Packet> p, const TcpHeader& header)
+{
+    if (m_endPoint)
+    {
+        m_tcp->SendPacket(p,
+                          header,
+                          m_endPoint->GetLocalAddress(),
+                          m_endPoint->GetPeerAddress(),
+                          m_boundnetdevice);
+    }
+    else
+    {
+        m_tcp->SendPacket(p,
+                          header,
+                          m_endPoint6->GetLocalAddress(),
+                          m_endPoint6->GetPeerAddress(),
+                          m_boundnetdevice);
+    }
+}
+
 void
 TcpSocketBase::UpdateRttHistory(const SequenceNumber32& seq, uint32_t sz, bool isRetransmission)
 {
@@ -3308,6 +3390,13 @@ TcpSocketBase::SendPendingData(bool withAck)
     uint32_t nPacketsSent = 0;
     uint32_t availableWindow = AvailableWindow();
 
+    // Gather the segments sent below into GSO batches (see SendSegment)
+    bool gsoBatching = m_gsoMaxSegments > 1 && !m_gsoBatching;
+    if (gsoBatching)
+    {
+        m_gsoBatching = true;
+    }
+
     // RFC 6675, Section (C)
     // If cwnd - pipe >= 1 SMSS, the sender SHOULD transmit one or more
     // segments as follows:
@@ -3318,9 +3407,9 @@ TcpSocketBase::SendPendingData(bool withAck)
         if (IsPacingEnabled())
         {
             NS_LOG_INFO("Pacing is enabled");
-            if (m_pacingTimer.IsRunning())
+            if (IsPacingPending())
             {
-                NS_LOG_INFO("Skipping Packet due to pacing" << m_pacingTimer.GetDelayLeft());
+                NS_LOG_INFO("Skipping Packet due to pacing");
                 break;
             }
             NS_LOG_INFO("Timer is not running");
@@ -3395,6 +3484,7 @@ TcpSocketBase::SendPendingData(bool withAck)
             {
                 m_congestionControl->CwndEvent(m_tcb, TcpSocketState::CA_EVENT_TX_START);
             }
+            bool paced = IsPacingEnabled();
             uint32_t sz = SendDataPacket(m_tcb->m_nextTxSequence, s, withAck);
 
             NS_LOG_LOGIC(" rxwin " << m_rWnd << " segsize " << m_tcb->m_segmentSize
@@ -3406,16 +3496,20 @@ TcpSocketBase::SendPendingData(bool withAck)
                                   << " sent seq " << m_tcb->m_nextTxSequence << " size " << sz);
             m_tcb->m_nextTxSequence += sz;
             ++nPacketsSent;
-            if (IsPacingEnabled())
+            // SendDataPacket paces the segment, unless the pacing starts with it
+            if (!paced && IsPacingEnabled())
             {
                 NS_LOG_INFO("Pacing is enabled");
-                if (m_pacingTimer.IsExpired())
+                if (!IsPacingPending())
                 {
                     NS_LOG_DEBUG("Current Pacing Rate " << m_tcb->m_pacingRate);
                     NS_LOG_DEBUG("Timer is in expired state, activate it "
                                  << m_tcb->m_pacingRate.Get().CalculateBytesTxTime(sz));
-                    m_pacingTimer.Schedule(m_tcb->m_pacingRate.Get().CalculateBytesTxTime(sz));
-                    break;
+                    SchedulePacing(sz);
+                    if (IsPacingPending())
+                    {
+                        break;
+                    }
                 }
             }
         }
@@ -3431,6 +3525,12 @@ TcpSocketBase::SendPendingData(bool withAck)
         // loop again!
     }
 
+    if (gsoBatching)
+    {
+        m_gsoBatching = false;
+        FlushGsoBatch();
+    }
+
     if (nPacketsSent > 0)
     {
         if (!m_sackEnabled)
@@ -3531,6 +3631,15 @@ TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader& tcpHeader)
     NS_LOG_DEBUG("Data segment, seq=" << tcpHeader.GetSequenceNumber()
                                       << " pkt size=" << p->GetSize());
 
+    // A chunk merged by the receive offload of TcpL4Protocol counts as all
+    // the segments it carries for the delayed ACKs
+    uint32_t segments = 1;
+    GsoTag gsoTag;
+    if (p->RemovePacketTag(gsoTag))
+    {
+        segments = gsoTag.GetSegments();
+    }
+
     // Put into Rx buffer
     SequenceNumber32 expectedSeq = m_tcb->m_rxBuffer->NextRxSequence();
     if (!m_tcb->m_rxBuffer->Add(p, tcpHeader))
@@ -3587,7 +3696,8 @@ TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
     else
     { // In-sequence packet: ACK if delayed ack count allows
-        if (++m_delAckCount >= m_delAckMaxCount)
+        m_delAckCount += segments;
+        if (m_delAckCount >= m_delAckMaxCount)
         {
             m_delAckEvent.Cancel();
             m_delAckCount = 0;
@@ -3842,7 +3952,7 @@ TcpSocketBase::ReTxTimeout()
     m_tcb->m_cWnd = m_tcb->m_segmentSize;
     m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
-    m_pacingTimer.Cancel();
+    CancelPacing();
 
     NS_LOG_DEBUG("RTO. Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " << m_tcb->m_ssThresh
                                        << ", restart from seqnum " << m_txBuffer->HeadSequence()
@@ -4004,7 +4114,7 @@ TcpSocketBase::CancelAllTimers()
     m_lastAckEvent.Cancel();
     m_timewaitEvent.Cancel();
     m_sendPendingDataEvent.Cancel();
-    m_pacingTimer.Cancel();
+    CancelPacing();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -4569,6 +4679,56 @@ TcpSocketBase::NotifyPacingPerformed()
     SendPendingData(m_connected);
 }
 
+void
+TcpSocketBase::NotifyPacingReleased(uint64_t generation)
+{
+    NS_LOG_FUNCTION(this << generation);
+    if (generation != m_pacingGeneration)
+    {
+        NS_LOG_LOGIC("Stale release, the pacing was cancelled");
+        return;
+    }
+    NotifyPacingPerformed();
+}
+
+bool
+TcpSocketBase::IsPacingPending() const
+{
+    return m_pacingTimer.IsRunning() || m_pacingRelease > Simulator::Now();
+}
+
+void
+TcpSocketBase::SchedulePacing(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    Time txTime = m_tcb->m_pacingRate.Get().CalculateBytesTxTime(size);
+    Time slot = m_tcp ? m_tcp->GetPacingSlot() : Time(0);
+    if (slot.IsZero())
+    {
+        m_pacingTimer.Schedule(txTime);
+        return;
+    }
+
+    // Keep the credit of a late release, but not of an idle period
+    Time now = Simulator::Now();
+    Time start = m_pacingRelease + slot > now ? m_pacingRelease : now;
+    m_pacingRelease = start + txTime;
+    if (m_pacingRelease > now)
+    {
+        NS_LOG_LOGIC("Paced until " << m_pacingRelease);
+        m_tcp->SchedulePacing(this, m_pacingRelease, m_pacingGeneration);
+    }
+}
+
+void
+TcpSocketBase::CancelPacing()
+{
+    NS_LOG_FUNCTION(this);
+    m_pacingTimer.Cancel();
+    m_pacingRelease = Seconds(0);
+    m_pacingGeneration++;
+}
+
 bool
 TcpSocketBase::IsPacingEnabled() const
 {
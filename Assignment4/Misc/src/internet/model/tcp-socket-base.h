@@ -22,6 +22,7 @@
 
 #include "ipv4-header.h"
 #include "ipv6-header.h"
+#include "tcp-header.h"
 #include "tcp-socket-state.h"
 #include "tcp-socket.h"
 
@@ -238,6 +239,11 @@ class TcpSocketBase : public TcpSocket
      */
     friend class TcpGeneralTest;
 
+    /**
+     * \brief TcpPacingWheel friend class (to release the socket).
+     */
+    friend class TcpPacingWheel;
+
     /**
      * Create an unbound TCP socket
      */
@@ -810,6 +816,34 @@ class TcpSocketBase : public TcpSocket
      */
     virtual uint32_t SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withAck);
 
+    /**
+     * \brief Send a data segment to TcpL4Protocol, or add it to the GSO batch
+     *        being built
+     *
+     * While SendPendingData is running and GsoMaxSegments is greater than one,
+     * the consecutive full-sized segments carrying the same header (apart from
+     * the sequence number) are gathered into a single packet, which is sent down
+     * the stack with a GsoTag by FlushGsoBatch. The retransmissions, i.e. the
+     * segments below HighTxMark, are sent on their own.
+     *
+     * \param p the payload of the segment
+     * \param header the TCP header of the segment
+     */
+    void SendSegment(Ptr<Packet> p, const TcpHeader& header);
+
+    /**
+     * \brief Send the GSO batch being built, if any, to TcpL4Protocol
+     */
+    void FlushGsoBatch();
+
+    /**
+     * \brief Send a segment to TcpL4Protocol, through the connected end point
+     *
+     * \param p the payload of the segment
+     * \param header the TCP header of the segment
+     */
+    void SendToL4(Ptr<Packet> p, const TcpHeader& header);
+
     /**
      * \brief Send a empty packet that carries a flag, e.g., ACK
      *
@@ -1243,6 +1277,38 @@ class TcpSocketBase : public TcpSocket
      */
     void NotifyPacingPerformed();
 
+    /**
+     * \brief Notify the release of the socket by the pacing wheel of the node
+     * \param generation the pacing generation of the release, which is stale
+     * if the pacing was cancelled since it was scheduled
+     */
+    void NotifyPacingReleased(uint64_t generation);
+
+    /**
+     * \brief Check whether the pacing holds the next segments
+     * \return true if the socket waits for its pacing timer, or its release by
+     * the pacing wheel
+     */
+    bool IsPacingPending() const;
+
+    /**
+     * \brief Hold the next segments for the transmission time of a segment at
+     * the pacing rate
+     *
+     * With the pacing wheel of the node, the release time is counted from the
+     * previous one rather than from now, since the wheel releases the socket
+     * up to a slot late: the segments may then go out in small bursts, but
+     * at the pacing rate on average.
+     *
+     * \param size the size of the segment
+     */
+    void SchedulePacing(uint32_t size);
+
+    /**
+     * \brief Cancel the pacing timer, or the release by the pacing wheel
+     */
+    void CancelPacing();
+
     /**
      * \brief Return true if packets in the current window should be paced
      * \return true if pacing is currently enabled
@@ -1384,6 +1450,16 @@ class TcpSocketBase : public TcpSocket
 
     // Pacing related variable
     Timer m_pacingTimer{Timer::CANCEL_ON_DESTROY}; //!< Pacing Event
+    Time m_pacingRelease{Seconds(0)};              //!< Release time with the pacing wheel
+    uint64_t m_pacingGeneration{0};                //!< Pacing generation, to ignore stale releases
+
+    // Generic segmentation offload
+    uint32_t m_gsoMaxSegments{1}; //!< Maximum number of segments in a GSO batch
+    bool m_gsoBatching{false};    //!< Whether the data segments are being batched
+    Ptr<Packet> m_gsoPacket;      //!< Payload of the GSO batch being built
+    TcpHeader m_gsoHeader;        //!< TCP header of the GSO batch being built
+    uint16_t m_gsoSegments{0};    //!< Number of segments in the GSO batch being built
+    uint32_t m_gsoSegmentSize{0}; //!< Payload size of the segments of the GSO batch
 
     // Parameters related to Explicit Congestion Notification
     TracedValue<SequenceNumber32> m_ecnEchoSeq{
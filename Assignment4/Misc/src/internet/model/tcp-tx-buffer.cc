@@ -61,7 +61,8 @@ TcpTxBuffer::TcpTxBuffer(uint32_t n)
     : m_maxBuffer(32768),
       m_size(0),
       m_sentSize(0),
-      m_firstByteSeq(n)
+      m_firstByteSeq(n),
+      m_lostThrough(n)
 {
     m_rWndCallback = MakeNullCallback<uint32_t>();
 }
@@ -174,7 +175,9 @@ TcpTxBuffer::SetHeadSequence(const SequenceNumber32& seq)
 
     // if you change the head with data already sent, something bad will happen
     NS_ASSERT(m_sentList.empty());
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = SequenceNumber32(0);
+    m_highestSackValid = false;
+    m_lostThrough = seq;
 }
 
 bool
@@ -309,37 +312,33 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
     NS_ASSERT(numBytes <= m_sentSize);
     NS_ASSERT(!m_sentList.empty());
 
-    auto it = m_sentList.begin();
+    auto it = FindSentItem(seq);
     bool listEdited = false;
     uint32_t s = numBytes;
 
     // Avoid to merge different packet for this retransmission if flags are
     // different.
-    for (; it != m_sentList.end(); ++it)
+    if ((*it)->m_startSeq == seq)
     {
-        if ((*it)->m_startSeq == seq)
+        auto next = it;
+        next++;
+        if (next != m_sentList.end())
         {
-            auto next = it;
-            next++;
-            if (next != m_sentList.end())
+            // Next is not sacked and have the same value for m_lost ... there is the
+            // possibility to merge
+            if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-                // Next is not sacked and have the same value for m_lost ... there is the
-                // possibility to merge
-                if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                    s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
-                }
-                else
-                {
-                    // Next is sacked... better to retransmit only the first segment
-                    s = std::min(s, (*it)->m_packet->GetSize());
-                }
+                s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
             }
             else
             {
+                // Next is sacked... better to retransmit only the first segment
                 s = std::min(s, (*it)->m_packet->GetSize());
             }
-            break;
+        }
+        else
+        {
+            s = std::min(s, (*it)->m_packet->GetSize());
         }
     }
 
@@ -376,6 +375,23 @@ TcpTxBuffer::FindHighestSacked() const
     return ret;
 }
 
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem(const SequenceNumber32& seq) const
+{
+    NS_ASSERT_MSG(!m_sentList.empty() && seq >= m_firstByteSeq &&
+                      seq < m_firstByteSeq + m_sentSize,
+                  "Sequence " << seq << " is not in the sent list " << *this);
+
+    // The segments are contiguous and ordered by their first sequence number
+    auto it = std::upper_bound(m_sentList.begin(),
+                               m_sentList.end(),
+                               seq,
+                               [](const SequenceNumber32& s, const TcpTxItem* item) {
+                                   return s < item->m_startSeq;
+                               });
+    return --it;
+}
+
 void
 TcpTxBuffer::SplitItems(TcpTxItem* t1, TcpTxItem* t2, uint32_t size) const
 {
@@ -438,6 +454,13 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
     auto it = list.begin();
     SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+    if (&list == &m_sentList && seq > listStartFrom)
+    {
+        // Skip the segments before seq, instead of walking through them
+        it += FindSentItem(seq) - m_sentList.begin();
+        beginOfCurrentPacket = (*it)->m_startSeq;
+    }
+
     while (it != list.end())
     {
         currentItem = *it;
@@ -650,16 +673,14 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked(const SequenceNumber32& ack) const
 {
     NS_LOG_FUNCTION(this);
-    for (const auto& it : m_sentList)
+    if (ack <= m_firstByteSeq || ack > m_firstByteSeq + m_sentSize)
     {
-        TcpTxItem* item = it;
-        Ptr<Packet> p = item->m_packet;
-        if (item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    // The only candidate is the segment which ends right before ack
+    TcpTxItem* item = *FindSentItem(ack - 1);
+    Ptr<Packet> p = item->m_packet;
+    return item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -765,9 +786,14 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
                                               << " this is the result: " << *this);
     }
 
-    if (m_highestSack.second <= m_firstByteSeq)
+    if (m_highestSack <= m_firstByteSeq)
     {
-        m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+        m_highestSack = SequenceNumber32(0);
+        m_highestSackValid = false;
+    }
+    if (m_lostThrough < m_firstByteSeq)
+    {
+        m_lostThrough = m_firstByteSeq;
     }
 
     NS_LOG_DEBUG("Discarded up to " << seq << " lost: " << m_lostOut << " retrans: " << m_retrans
@@ -788,8 +814,7 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
 
     for (auto option_it = list.begin(); option_it != list.end(); ++option_it)
     {
-        auto item_it = m_sentList.begin();
-        SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+        auto item_it = m_sentList.cbegin();
 
         if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
@@ -797,9 +822,21 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
             return bytesSacked;
         }
 
+        // The segments before the one holding the block start cannot be
+        // covered by the block
+        if ((*option_it).first == m_firstByteSeq + m_sentSize)
+        {
+            item_it = m_sentList.cend();
+        }
+        else if ((*option_it).first > m_firstByteSeq)
+        {
+            item_it = FindSentItem((*option_it).first);
+        }
+
         while (item_it != m_sentList.end())
         {
             uint32_t pktSize = (*item_it)->m_packet->GetSize();
+            SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
 
             // Check the boundary of this packet ... only mark as sacked if
             // it is precisely mapped over the option. It means that if the receiver
@@ -828,16 +865,16 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
                     m_sackedOut += (*item_it)->m_packet->GetSize();
                     bytesSacked += (*item_it)->m_packet->GetSize();
 
-                    if (m_highestSack.first == m_sentList.end() ||
-                        m_highestSack.second <= beginOfCurrentPacket + pktSize)
+                    if (!m_highestSackValid || m_highestSack <= beginOfCurrentPacket + pktSize)
                     {
-                        m_highestSack = std::make_pair(item_it, beginOfCurrentPacket);
+                        m_highestSack = beginOfCurrentPacket;
+                        m_highestSackValid = true;
                     }
 
                     NS_LOG_INFO("Received block "
                                 << *option_it << ", checking sentList for block " << *(*item_it)
                                 << ", found in the sackboard, sacking, current highSack: "
-                                << m_highestSack.second);
+                                << m_highestSack);
 
                     if (!sackedCb.IsNull())
                     {
@@ -853,14 +890,13 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
                 break;
             }
 
-            beginOfCurrentPacket += pktSize;
             ++item_it;
         }
     }
 
     if (bytesSacked > 0)
     {
-        NS_ASSERT_MSG(m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+        NS_ASSERT_MSG(m_highestSackValid, "Buffer status: " << *this);
         UpdateLostCount();
     }
 
@@ -876,25 +912,27 @@ void
 TcpTxBuffer::UpdateLostCount()
 {
     NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_highestSackValid);
+    NS_LOG_INFO("Status before the update: " << *this << ", will start from the item at "
+                                             << m_highestSack);
+
     uint32_t sacked = 0;
-    SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-    if (m_highestSack.first == m_sentList.end())
-    {
-        NS_LOG_INFO("Status before the update: " << *this
-                                                 << ", will start from the latest sent item");
-    }
-    else
-    {
-        NS_LOG_INFO("Status before the update: " << *this << ", will start from item "
-                                                 << *(*m_highestSack.first));
-    }
+    uint32_t sackedBytes = 0;
+    SequenceNumber32 lostThrough = m_lostThrough;
 
-    for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+    for (auto it = FindSentItem(m_highestSack); it != m_sentList.begin(); --it)
     {
         TcpTxItem* item = *it;
+        if (sacked >= m_dupAckThresh && item->m_startSeq < m_lostThrough)
+        {
+            // The items from here to the head are already sacked or lost
+            break;
+        }
+
         if (item->m_sacked)
         {
             sacked++;
+            sackedBytes += item->m_packet->GetSize();
         }
 
         if (sacked >= m_dupAckThresh)
@@ -904,8 +942,16 @@ TcpTxBuffer::UpdateLostCount()
                 item->m_lost = true;
                 m_lostOut += item->m_packet->GetSize();
             }
+            if (lostThrough < item->m_startSeq + item->m_packet->GetSize())
+            {
+                lostThrough = item->m_startSeq + item->m_packet->GetSize();
+            }
+        }
+        else if (sackedBytes >= m_sackedOut)
+        {
+            // No sacked item is left below, the threshold cannot be reached
+            break;
         }
-        beginOfCurrentPacket -= item->m_packet->GetSize();
     }
 
     if (sacked >= m_dupAckThresh)
@@ -916,6 +962,7 @@ TcpTxBuffer::UpdateLostCount()
             item->m_lost = true;
             m_lostOut += item->m_packet->GetSize();
         }
+        m_lostThrough = lostThrough;
     }
     NS_LOG_INFO("Status after the update: " << *this);
     ConsistencyCheck();
@@ -926,32 +973,27 @@ TcpTxBuffer::IsLost(const SequenceNumber32& seq) const
 {
     NS_LOG_FUNCTION(this << seq);
 
-    if (seq >= m_highestSack.second)
+    if (seq >= m_highestSack)
     {
         return false;
     }
 
-    // In theory, using a map and hints when inserting elements can improve
-    // performance
-    for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    if (seq < m_firstByteSeq || seq >= m_firstByteSeq + m_sentSize)
     {
-        // Search for the right iterator before calling IsLost()
-        if ((*it)->m_startSeq <= seq && seq < (*it)->m_startSeq + (*it)->m_packet->GetSize())
-        {
-            if ((*it)->m_lost)
-            {
-                NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
-                return true;
-            }
+        return false;
+    }
 
-            if ((*it)->m_sacked)
-            {
-                NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
-                return false;
-            }
-        }
+    const TcpTxItem* item = *FindSentItem(seq);
+    if (item->m_lost)
+    {
+        NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
+        return true;
     }
 
+    if (item->m_sacked)
+    {
+        NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
+    }
     return false;
 }
 
@@ -977,10 +1019,15 @@ TcpTxBuffer::NextSeg(SequenceNumber32* seq, SequenceNumber32* seqHigh, bool isRe
     SequenceNumber32 seqPerRule3;
     bool isSeqPerRule3Valid = false;
     SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+    uint32_t lostBytes = 0;
 
     for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
     {
         item = *it;
+        if (item->m_lost)
+        {
+            lostBytes += item->m_packet->GetSize();
+        }
 
         // Condition 1.a , 1.b , and 1.c
         if (!item->m_retrans && !item->m_sacked)
@@ -1000,6 +1047,12 @@ TcpTxBuffer::NextSeg(SequenceNumber32* seq, SequenceNumber32* seqHigh, bool isRe
             }
         }
 
+        if (lostBytes >= m_lostOut && (!isRecovery || seqPerRule3.GetValue() != 0))
+        {
+            // No lost item is left, and rule 3 needs no other item
+            break;
+        }
+
         // Nothing found, iterate
         beginOfCurrentPkt += item->m_packet->GetSize();
     }
@@ -1180,7 +1233,7 @@ TcpTxBuffer::IsLostRFC(const SequenceNumber32& seq, const PacketList::const_iter
             }
         }
 
-        if (beginOfCurrentPacket >= m_highestSack.second)
+        if (beginOfCurrentPacket >= m_highestSack)
         {
             if (item->m_lost && !item->m_retrans)
             {
@@ -1193,10 +1246,10 @@ TcpTxBuffer::IsLostRFC(const SequenceNumber32& seq, const PacketList::const_iter
 
         beginOfCurrentPacket += current->GetSize();
     }
-    if (it == m_highestSack.first)
+    if (!m_highestSackValid)
     {
         NS_LOG_INFO("seq=" << seq << " is not lost because there are no sacked segment ahead "
-                           << m_highestSack.second);
+                           << m_highestSack);
     }
     return false;
 }
@@ -1212,7 +1265,9 @@ TcpTxBuffer::ResetRenoSack()
         (*it)->m_sacked = false;
     }
 
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = SequenceNumber32(0);
+    m_highestSackValid = false;
+    m_lostThrough = m_firstByteSeq;
 }
 
 void
@@ -1241,7 +1296,9 @@ TcpTxBuffer::ResetSentList()
     m_lostOut = 0;
     m_retrans = 0;
     m_sackedOut = 0;
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = SequenceNumber32(0);
+    m_highestSackValid = false;
+    m_lostThrough = m_firstByteSeq;
 }
 
 void
@@ -1259,6 +1316,10 @@ TcpTxBuffer::ResetLastSegmentSent()
             m_retrans -= item->m_packet->GetSize();
         }
         m_appList.insert(m_appList.begin(), item);
+        if (m_lostThrough > m_firstByteSeq + m_sentSize)
+        {
+            m_lostThrough = m_firstByteSeq + m_sentSize;
+        }
     }
     ConsistencyCheck();
 }
@@ -1273,7 +1334,8 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
     {
         m_sackedOut = 0;
         m_lostOut = m_sentSize;
-        m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+        m_highestSack = SequenceNumber32(0);
+        m_highestSackValid = false;
     }
     else
     {
@@ -1304,6 +1366,7 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
 
         (*it)->m_retrans = false;
     }
+    m_lostThrough = m_firstByteSeq + m_sentSize;
 
     NS_LOG_INFO("Set sent list lost, status: " << *this);
     NS_ASSERT_MSG(m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1400,7 +1463,8 @@ TcpTxBuffer::AddRenoSack()
     {
         (*it)->m_sacked = true;
         m_sackedOut += (*it)->m_packet->GetSize();
-        m_highestSack = std::make_pair(it, (*it)->m_startSeq);
+        m_highestSack = (*it)->m_startSeq;
+        m_highestSackValid = true;
         NS_LOG_INFO("Added a Reno SACK, status: " << *this);
     }
     else
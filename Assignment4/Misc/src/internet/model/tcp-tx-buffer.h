@@ -28,6 +28,8 @@
 #include "ns3/sequence-number.h"
 #include "ns3/traced-value.h"
 
+#include <deque>
+
 namespace ns3
 {
 class Packet;
@@ -71,8 +73,15 @@ class Packet;
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * segments covered by a SACK block and setting their SACK flag.
+ *
+ * The segments sent are kept in an array (a std::deque), ordered by
+ * sequence number: segments are appended when sent and removed from the
+ * front when acknowledged, and the segment holding a given sequence number
+ * is found with a binary search. Therefore, each SACK block is applied in
+ * O(log n) plus the number of segments it covers, and IsLost() does not
+ * walk the list.
  *
  * Item properties
  * ---------------
@@ -411,7 +420,7 @@ class TcpTxBuffer : public Object
   private:
     friend std::ostream& operator<<(std::ostream& os, const TcpTxBuffer& tcpTxBuf);
 
-    typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+    typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
     /**
      * \brief Update the lost count
@@ -428,12 +437,21 @@ class TcpTxBuffer : public Object
      * The {New}Reno cases, for now, are managed in TcpSocketBase through the
      * call to MarkHeadAsLost.
      * This function is, therefore, called after a SACK option has been received,
-     * and updates the lost count. It can be probably optimized by not walking
-     * the entire list, but a subset.
+     * and updates the lost count. The walk starts from the highest SACKed
+     * segment, and stops at m_lostThrough (the segments before are already
+     * marked), or when all the SACKed segments have been counted without
+     * reaching the threshold.
      *
      */
     void UpdateLostCount();
 
+    /**
+     * \brief Find the segment of the sent list which contains a sequence number
+     * \param seq The sequence number, which must be in [SND.UNA, SND.NXT)
+     * \return an iterator to the segment
+     */
+    PacketList::const_iterator FindSentItem(const SequenceNumber32& seq) const;
+
     /**
      * \brief Remove the size specified from the lostOut, retrans, sacked count
      *
@@ -611,7 +629,9 @@ class TcpTxBuffer : public Object
 
     TracedValue<SequenceNumber32>
         m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-    std::pair<PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+    SequenceNumber32 m_highestSack{0}; //!< Start of the highest SACKed segment (0 if none)
+    bool m_highestSackValid{false};    //!< Whether a segment has been SACKed
+    SequenceNumber32 m_lostThrough;    //!< Segments before it are SACKed or marked lost
 
     uint32_t m_lostOut{0};   //!< Number of lost bytes
     uint32_t m_sackedOut{0}; //!< Number of sacked bytes
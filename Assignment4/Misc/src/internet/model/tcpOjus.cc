@@ -1,5 +1,6 @@
 // tcpOjus.cc
 #include "tcpOjus.h"
+#include "tcp-congestion-engine.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-socket-base.h"
 #include "ns3/log.h"
@@ -76,6 +77,12 @@ TcpOjus::GetName () const
   return "TcpOjus";
 }
 
+bool
+TcpOjus::HasBatch () const
+{
+  return true;
+}
+
 Ptr<TcpCongestionOps>
 TcpOjus::Fork ()
 {
@@ -83,10 +90,10 @@ TcpOjus::Fork ()
 }
 
 void
-TcpOjus::HystartReset (Ptr<const TcpSocketState> tcb)
+TcpOjus::HystartReset (SequenceNumber32 highTxMark)
 {
   m_roundStart = m_lastAck = Simulator::Now ();
-  m_endSeq = tcb->m_highTxMark;
+  m_endSeq = highTxMark;
   m_currRtt = Time::Min ();
   m_sampleCnt = 0;
   m_found = false;
@@ -109,7 +116,7 @@ TcpOjus::HystartDelayThresh (const Time& t) const
 }
 
 void
-TcpOjus::HystartUpdate (Ptr<TcpSocketState> tcb, const Time& delay)
+TcpOjus::HystartUpdate (uint32_t cWnd, uint32_t& ssThresh, const Time& delay)
 {
   if (!m_found)
   {
@@ -135,7 +142,7 @@ TcpOjus::HystartUpdate (Ptr<TcpSocketState> tcb, const Time& delay)
 
     if (m_found)
     {
-      tcb->m_ssThresh = tcb->m_cWnd;
+      ssThresh = cWnd;
       NS_LOG_DEBUG ("Exiting Slow Start due to Hystart");
     }
   }
@@ -147,6 +154,32 @@ TcpOjus::PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time&
 {
     NS_LOG_FUNCTION(this << tcb << segmentsAcked << rtt);
 
+    uint32_t ssThresh = tcb->m_ssThresh;
+    DoPktsAcked(tcb->m_cWnd, ssThresh, tcb->m_segmentSize, rtt);
+    tcb->m_ssThresh = ssThresh;
+}
+
+void
+TcpOjus::PktsAckedBatch(TcpAckBatch& batch)
+{
+    NS_LOG_FUNCTION(this << batch.GetSize());
+
+    for (std::size_t i = 0; i < batch.GetSize(); i++)
+    {
+        // The engine batches congestion controls of the same type
+        static_cast<TcpOjus*>(batch.m_cong[i])->DoPktsAcked(batch.m_cWnd[i],
+                                                            batch.m_ssThresh[i],
+                                                            batch.m_segmentSize[i],
+                                                            batch.m_rtt[i]);
+    }
+}
+
+void
+TcpOjus::DoPktsAcked(uint32_t cWnd,
+                     uint32_t& ssThresh,
+                     uint32_t segmentSize,
+                     const Time& rtt)
+{
     /* Discard delay samples right after fast recovery */
     // if (m_epochStart != Time::Min() && (Simulator::Now() - m_epochStart) < m_cubicDelta)
     // {
@@ -160,10 +193,9 @@ TcpOjus::PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time&
     }
 
     /* hystart triggers when cwnd is larger than some threshold */
-    if (m_hystart && tcb->m_cWnd <= tcb->m_ssThresh &&
-        tcb->m_cWnd >= m_hystartLowWindow * tcb->m_segmentSize)
+    if (m_hystart && cWnd <= ssThresh && cWnd >= m_hystartLowWindow * segmentSize)
     {
-        HystartUpdate(tcb, rtt);
+        HystartUpdate(cWnd, ssThresh, rtt);
     }
 }
 
@@ -175,7 +207,7 @@ TcpOjus::CongestionStateSet(Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCo
     if (newState == TcpSocketState::CA_LOSS)
     {
         m_found = false;
-        HystartReset(tcb);
+        HystartReset(tcb->m_highTxMark);
         m_delayMin = Time::Min();
     }
 }
@@ -192,33 +224,58 @@ TcpOjus::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
 void
 TcpOjus::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 {
-  if (tcb->m_cWnd < tcb->m_ssThresh)
+  uint32_t cWnd = tcb->m_cWnd;
+  DoIncreaseWindow (cWnd, tcb->m_ssThresh, tcb->m_segmentSize, tcb->m_lastAckedSeq,
+                    tcb->m_highTxMark, segmentsAcked);
+  tcb->m_cWnd = cWnd;
+}
+
+void
+TcpOjus::IncreaseWindowBatch (TcpAckBatch& batch)
+{
+  NS_LOG_FUNCTION (this << batch.GetSize ());
+
+  for (std::size_t i = 0; i < batch.GetSize (); i++)
+  {
+    // The engine batches congestion controls of the same type
+    static_cast<TcpOjus*> (batch.m_cong[i])
+        ->DoIncreaseWindow (batch.m_cWnd[i], batch.m_ssThresh[i], batch.m_segmentSize[i],
+                            batch.m_lastAckedSeq[i], batch.m_highTxMark[i],
+                            batch.m_segmentsAcked[i]);
+  }
+}
+
+void
+TcpOjus::DoIncreaseWindow (uint32_t& cWnd, uint32_t ssThresh, uint32_t segmentSize,
+                           SequenceNumber32 lastAckedSeq, SequenceNumber32 highTxMark,
+                           uint32_t segmentsAcked)
+{
+  if (cWnd < ssThresh)
   {
-    if (m_hystart && tcb->m_lastAckedSeq > m_endSeq)
+    if (m_hystart && lastAckedSeq > m_endSeq)
     {
-      HystartReset (tcb);
+      HystartReset (highTxMark);
     }
-    tcb->m_cWnd += 1.2 *segmentsAcked * tcb->m_segmentSize;
+    cWnd += 1.2 *segmentsAcked * segmentSize;
     segmentsAcked = 0;
   }
   else
   {
-    CongestionAvoidance (tcb, segmentsAcked);
+    CongestionAvoidance (cWnd, segmentSize, segmentsAcked);
   }
 }
 
 
-void TcpOjus::CongestionAvoidance(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked) {
-  NS_LOG_FUNCTION(this << tcb << segmentsAcked);
+void TcpOjus::CongestionAvoidance(uint32_t& cWnd, uint32_t segmentSize, uint32_t segmentsAcked) {
+  NS_LOG_FUNCTION(this << cWnd << segmentsAcked);
 
     if (segmentsAcked > 0)
     {
         double adder =
-            static_cast<double>(tcb->m_segmentSize * tcb->m_segmentSize) / tcb->m_cWnd.Get();
+            static_cast<double>(segmentSize * segmentSize) / cWnd;
         adder = std::max(1.0, adder);
-        tcb->m_cWnd += static_cast<uint32_t>(adder);
-        NS_LOG_INFO("In CongAvoid, updated to cwnd " << tcb->m_cWnd << " ssthresh "
-                                                     << tcb->m_ssThresh);
+        cWnd += static_cast<uint32_t>(adder);
+        NS_LOG_INFO("In CongAvoid, updated to cwnd " << cWnd);
     }
 }
 
@@ -16,12 +16,22 @@ public:
   virtual std::string GetName () const override;
   virtual Ptr<TcpCongestionOps> Fork () override;
 
+  bool HasBatch () const override;
+  void PktsAckedBatch (TcpAckBatch& batch) override;
+  void IncreaseWindowBatch (TcpAckBatch& batch) override;
+
 private:
   void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked) override;
-  void CongestionAvoidance(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
-  void HystartReset (Ptr<const TcpSocketState> tcb);
-  void HystartUpdate (Ptr<TcpSocketState> tcb, const Time& delay);
+  // Window update shared by IncreaseWindow and IncreaseWindowBatch
+  void DoIncreaseWindow (uint32_t& cWnd, uint32_t ssThresh, uint32_t segmentSize,
+                         SequenceNumber32 lastAckedSeq, SequenceNumber32 highTxMark,
+                         uint32_t segmentsAcked);
+  void CongestionAvoidance (uint32_t& cWnd, uint32_t segmentSize, uint32_t segmentsAcked);
+  void HystartReset (SequenceNumber32 highTxMark);
+  void HystartUpdate (uint32_t cWnd, uint32_t& ssThresh, const Time& delay);
   void PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt) override;
+  // Delay sample shared by PktsAcked and PktsAckedBatch
+  void DoPktsAcked (uint32_t cWnd, uint32_t& ssThresh, uint32_t segmentSize, const Time& rtt);
   void CongestionStateSet(Ptr<TcpSocketState> tcb,const TcpSocketState::TcpCongState_t newState) override;
   Time HystartDelayThresh (const Time& t) const;
   uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight) override;
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check that the end point demuxes find the end points of the
+ * packets, while the end points are allocated, connected, moved to other
+ * peers and removed.
+ *
+ * \tparam Demux \explicit The type of the demux.
+ * \tparam Address \explicit The type of the addresses.
+ * \tparam Interface \explicit The type of the interfaces.
+ */
+template <typename Demux, typename Address, typename Interface>
+class EndPointDemuxTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param name The test name.
+     * \param makeAddress The function making an address from a number.
+     */
+    EndPointDemuxTestCase(std::string name, Address (*makeAddress)(uint32_t));
+
+  private:
+    void DoRun() override;
+
+    Address (*m_makeAddress)(uint32_t); //!< The function making the addresses
+};
+
+template <typename Demux, typename Address, typename Interface>
+EndPointDemuxTestCase<Demux, Address, Interface>::EndPointDemuxTestCase(
+    std::string name,
+    Address (*makeAddress)(uint32_t))
+    : TestCase(name),
+      m_makeAddress(makeAddress)
+{
+}
+
+template <typename Demux, typename Address, typename Interface>
+void
+EndPointDemuxTestCase<Demux, Address, Interface>::DoRun()
+{
+    Demux demux;
+    Ptr<Interface> interface = CreateObject<Interface>();
+    Address local = m_makeAddress(1);
+    auto lookup = [&demux, &interface, &local](Address peer, uint16_t peerPort, uint16_t port) {
+        auto endPoints = demux.Lookup(local, port, peer, peerPort, interface);
+        return endPoints.empty() ? nullptr : endPoints.front();
+    };
+
+    // A server listening on a port, and one bound to its address
+    auto listener = demux.Allocate(nullptr, 80);
+    NS_TEST_ASSERT_MSG_NE(listener, nullptr, "Listener not allocated");
+    auto bound = demux.Allocate(nullptr, local, 8080);
+    NS_TEST_ASSERT_MSG_NE(bound, nullptr, "Bound end point not allocated");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, 80), nullptr, "Duplicated listener allocated");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(80), true, "Port 80 not found");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(81), false, "Port 81 found");
+
+    // Many connections accepted by the listener, and a few opened by the node
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+    struct Connection
+    {
+        typename Demux::EndPoints::value_type endPoint;
+        Address peer;
+        uint16_t peerPort;
+        uint16_t port;
+    };
+
+    // The peer ports are all different, so that no two connections match
+    uint16_t peerPort = 1024;
+    std::vector<Connection> connections;
+    for (uint32_t i = 0; i < 2000; i++, peerPort++)
+    {
+        Address peer = m_makeAddress(rng->GetInteger(2, 200));
+        if (i % 10 == 0)
+        {
+            // Connect an end point on an ephemeral port
+            auto endPoint = demux.Allocate(local);
+            NS_TEST_ASSERT_MSG_NE(endPoint, nullptr, "End point not allocated");
+            NS_TEST_EXPECT_MSG_EQ(lookup(peer, peerPort, endPoint->GetLocalPort()),
+                                  endPoint,
+                                  "Unconnected end point not found");
+            endPoint->SetPeer(peer, peerPort);
+            NS_TEST_EXPECT_MSG_EQ(lookup(peer, peerPort + 1, endPoint->GetLocalPort()),
+                                  nullptr,
+                                  "Connected end point found for a packet of another peer");
+            connections.push_back({endPoint, peer, peerPort, endPoint->GetLocalPort()});
+            continue;
+        }
+        auto endPoint = demux.Allocate(nullptr, local, 80, peer, peerPort);
+        NS_TEST_ASSERT_MSG_NE(endPoint, nullptr, "Connection not allocated");
+        NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 80, peer, peerPort),
+                              nullptr,
+                              "Duplicated connection allocated");
+        connections.push_back({endPoint, peer, peerPort, 80});
+    }
+
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (const auto& connection : connections)
+        {
+            if (connection.endPoint)
+            {
+                NS_TEST_ASSERT_MSG_EQ(
+                    lookup(connection.peer, connection.peerPort, connection.port),
+                    connection.endPoint,
+                    "Connection not found for a packet of its peer");
+            }
+            else if (connection.port == 80)
+            {
+                NS_TEST_ASSERT_MSG_EQ(
+                    lookup(connection.peer, connection.peerPort, connection.port),
+                    listener,
+                    "Listener not found for a packet of a closed connection");
+            }
+        }
+        NS_TEST_EXPECT_MSG_EQ(lookup(m_makeAddress(201), 1000, 80),
+                              listener,
+                              "Listener not found for a packet of a new peer");
+        NS_TEST_EXPECT_MSG_EQ(lookup(m_makeAddress(201), 1000, 8080),
+                              bound,
+                              "Bound end point not found for a packet of a new peer");
+        NS_TEST_EXPECT_MSG_EQ(lookup(m_makeAddress(201), 1000, 81),
+                              nullptr,
+                              "End point found for a packet to a closed port");
+
+        // Close some connections, and move some to other peers
+        for (auto& connection : connections)
+        {
+            if (!connection.endPoint)
+            {
+                continue;
+            }
+            uint32_t action = rng->GetInteger(0, 3);
+            if (action == 0)
+            {
+                demux.DeAllocate(connection.endPoint);
+                connection.endPoint = nullptr;
+            }
+            else if (action == 1)
+            {
+                connection.peer = m_makeAddress(rng->GetInteger(202, 255));
+                connection.peerPort = peerPort++;
+                connection.endPoint->SetPeer(connection.peer, connection.peerPort);
+            }
+        }
+    }
+
+    demux.DeAllocate(listener);
+    NS_TEST_EXPECT_MSG_EQ(lookup(m_makeAddress(201), 1000, 80),
+                          nullptr,
+                          "End point found after the listener was removed");
+}
+
+/**
+ * \param n A number.
+ * \return An IPv4 address made of the number.
+ */
+static Ipv4Address
+MakeIpv4Address(uint32_t n)
+{
+    return Ipv4Address(0x0a000000 + n);
+}
+
+/**
+ * \param n A number.
+ * \return An IPv6 address made of the number.
+ */
+static Ipv6Address
+MakeIpv6Address(uint32_t n)
+{
+    uint8_t bytes[16] = {0x20, 0x01, 0x0d, 0xb8};
+    bytes[12] = n >> 24;
+    bytes[13] = n >> 16;
+    bytes[14] = n >> 8;
+    bytes[15] = n;
+    return Ipv6Address(bytes);
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite()
+        : TestSuite("end-point-demux", Type::UNIT)
+    {
+        AddTestCase(new EndPointDemuxTestCase<Ipv4EndPointDemux, Ipv4Address, Ipv4Interface>(
+                        "Check the IPv4 end point demux",
+                        &MakeIpv4Address),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new EndPointDemuxTestCase<Ipv6EndPointDemux, Ipv6Address, Ipv6Interface>(
+                        "Check the IPv6 end point demux",
+                        &MakeIpv6Address),
+                    TestCase::Duration::QUICK);
+    }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -26,7 +26,10 @@
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <algorithm>
 #include <cstdlib> // for rand()
+#include <tuple>
+#include <vector>
 
 using namespace ns3;
 
@@ -215,6 +218,72 @@ GlobalRouteManagerImplTestCase::DoRun()
     // does not crash
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check the order in which the vertices leave the CandidateQueue.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+  public:
+    CandidateQueueTestCase();
+    void DoRun() override;
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase()
+    : TestCase("Check the order of the CandidateQueue")
+{
+}
+
+void
+CandidateQueueTestCase::DoRun()
+{
+    // The vertices leave by increasing distance, the networks before the
+    // routers, and in the order they were pushed, or last decreased, otherwise
+    typedef std::tuple<uint32_t, int, uint32_t, SPFVertex*> Key;
+    std::vector<Key> expected;
+    CandidateQueue candidate;
+    uint32_t order = 0;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        auto v = new SPFVertex;
+        v->SetVertexId(Ipv4Address(i + 1));
+        v->SetVertexType(std::rand() % 2 ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+        v->SetDistanceFromRoot(std::rand() % 20);
+        candidate.Push(v);
+        expected.emplace_back(v->GetDistanceFromRoot(),
+                              v->GetVertexType() == SPFVertex::VertexNetwork ? 0 : 1,
+                              order++,
+                              v);
+    }
+    for (uint32_t i = 0; i < 200; i += 3)
+    {
+        Key& key = expected[i];
+        SPFVertex* v = std::get<3>(key);
+        NS_TEST_ASSERT_MSG_EQ(candidate.Find(v->GetVertexId()), v, "Vertex not found");
+        if (v->GetDistanceFromRoot() < 2)
+        {
+            continue;
+        }
+        v->SetDistanceFromRoot(v->GetDistanceFromRoot() / 2);
+        candidate.DecreaseKey(v);
+        std::get<0>(key) = v->GetDistanceFromRoot();
+        std::get<2>(key) = order++;
+    }
+    std::sort(expected.begin(), expected.end());
+
+    for (const auto& key : expected)
+    {
+        SPFVertex* v = candidate.Pop();
+        NS_TEST_ASSERT_MSG_EQ(v, std::get<3>(key), "Wrong vertex popped");
+        NS_TEST_EXPECT_MSG_EQ(candidate.Find(v->GetVertexId()),
+                              nullptr,
+                              "Vertex found after it was popped");
+        delete v;
+    }
+    NS_TEST_EXPECT_MSG_EQ(candidate.Empty(), true, "CandidateQueue not empty");
+}
+
 /**
  * \ingroup internet-test
  *
@@ -232,6 +301,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite()
     : TestSuite("global-route-manager-impl", Type::UNIT)
 {
     AddTestCase(new GlobalRouteManagerImplTestCase(), TestCase::Duration::QUICK);
+    AddTestCase(new CandidateQueueTestCase(), TestCase::Duration::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite
@@ -39,6 +39,7 @@
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
 #include "ns3/test.h"
+#include "ns3/udp-header.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/udp-socket.h"
@@ -52,6 +53,7 @@
 
 #include <limits>
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -575,6 +577,166 @@ Ipv4FragmentationTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 reassembly Test
+ *
+ * Feeds the fragments of a datagram out of order, with overlapping and
+ * duplicated fragments, and checks that the datagram is delivered once,
+ * when its last hole is filled. Another datagram missing a fragment must
+ * be dropped when the reassembly times out.
+ */
+class Ipv4ReassemblyTest : public TestCase
+{
+    uint32_t m_received;          //!< Number of datagrams received by the server
+    Ptr<Packet> m_receivedPacket; //!< Last datagram received by the server
+    uint32_t m_timeouts;          //!< Number of reassembly timeouts
+
+    /**
+     * \brief Receive the datagrams.
+     * \param socket The receiving socket.
+     */
+    void HandleRead(Ptr<Socket> socket);
+
+    /**
+     * \brief Count the reassembly timeouts.
+     * \param header The IPv4 header.
+     * \param packet The dropped packet.
+     * \param reason The drop reason.
+     * \param ipv4 The IPv4 protocol.
+     * \param interface The interface.
+     */
+    void HandleDrop(const Ipv4Header& header,
+                    Ptr<const Packet> packet,
+                    Ipv4L3Protocol::DropReason reason,
+                    Ptr<Ipv4> ipv4,
+                    uint32_t interface);
+
+  public:
+    void DoRun() override;
+    Ipv4ReassemblyTest();
+};
+
+Ipv4ReassemblyTest::Ipv4ReassemblyTest()
+    : TestCase("Verify the IPv4 reassembly of out of order, overlapping and duplicated fragments"),
+      m_received(0),
+      m_timeouts(0)
+{
+}
+
+void
+Ipv4ReassemblyTest::HandleRead(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv()))
+    {
+        m_received++;
+        m_receivedPacket = packet;
+    }
+}
+
+void
+Ipv4ReassemblyTest::HandleDrop(const Ipv4Header& header,
+                               Ptr<const Packet> packet,
+                               Ipv4L3Protocol::DropReason reason,
+                               Ptr<Ipv4> ipv4,
+                               uint32_t interface)
+{
+    if (reason == Ipv4L3Protocol::DROP_FRAGMENT_TIMEOUT)
+    {
+        m_timeouts++;
+    }
+}
+
+void
+Ipv4ReassemblyTest::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    SimpleNetDeviceHelper helper;
+    Ptr<NetDevice> device = helper.Install(node).Get(0);
+    InternetStackHelper internet;
+    internet.Install(node);
+
+    Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+    uint32_t interface = ipv4->AddInterface(device);
+    ipv4->AddAddress(interface, Ipv4InterfaceAddress("10.0.0.1", "255.255.255.0"));
+    ipv4->SetUp(interface);
+    ipv4->TraceConnectWithoutContext("Drop", MakeCallback(&Ipv4ReassemblyTest::HandleDrop, this));
+
+    Ptr<Socket> socket = Socket::CreateSocket(node, UdpSocketFactory::GetTypeId());
+    socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    socket->SetRecvCallback(MakeCallback(&Ipv4ReassemblyTest::HandleRead, this));
+
+    std::vector<uint8_t> data(1000);
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = i % 251;
+    }
+    Ptr<Packet> datagram = Create<Packet>(data.data(), data.size());
+    UdpHeader udpHeader;
+    udpHeader.SetSourcePort(1000);
+    udpHeader.SetDestinationPort(9);
+    datagram->AddHeader(udpHeader);
+
+    auto receive = [ipv4, device, datagram](uint16_t id, uint32_t start, uint32_t end) {
+        Ipv4Header header;
+        header.SetSource("10.0.0.2");
+        header.SetDestination("10.0.0.1");
+        header.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+        header.SetIdentification(id);
+        header.SetTtl(64);
+        header.SetFragmentOffset(start);
+        if (end < datagram->GetSize())
+        {
+            header.SetMoreFragments();
+        }
+        else
+        {
+            header.SetLastFragment();
+        }
+        header.SetPayloadSize(end - start);
+        Ptr<Packet> fragment = datagram->CreateFragment(start, end - start);
+        fragment->AddHeader(header);
+        ipv4->Receive(device,
+                      fragment,
+                      Ipv4L3Protocol::PROT_NUMBER,
+                      device->GetBroadcast(),
+                      device->GetAddress(),
+                      NetDevice::PACKET_HOST);
+    };
+
+    // Offsets are multiple of 8, the datagram has 1008 bytes
+    std::vector<std::pair<uint32_t, uint32_t>> fragments = {
+        {800, 1008},
+        {200, 600},
+        {400, 800},
+        {400, 800},
+        {0, 400},
+    };
+    for (const auto& fragment : fragments)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_received, 0, "Datagram delivered before all the fragments");
+        receive(1, fragment.first, fragment.second);
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_received, 1, "Datagram not delivered");
+    NS_TEST_EXPECT_MSG_EQ(m_receivedPacket->GetSize(), data.size(), "Datagram size not correct");
+    std::vector<uint8_t> received(data.size());
+    m_receivedPacket->CopyData(received.data(), received.size());
+    NS_TEST_EXPECT_MSG_EQ((received == data), true, "Datagram content differs");
+
+    // A fragment of the same datagram arriving late starts a new reassembly
+    receive(1, 400, 800);
+    receive(2, 0, 400);
+    receive(2, 600, 1008);
+
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_received, 1, "Incomplete datagram delivered");
+    NS_TEST_EXPECT_MSG_EQ(m_timeouts, 2, "Incomplete datagrams not timed out");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -591,6 +753,7 @@ Ipv4FragmentationTestSuite::Ipv4FragmentationTestSuite()
 {
     AddTestCase(new Ipv4FragmentationTest(false), TestCase::Duration::QUICK);
     AddTestCase(new Ipv4FragmentationTest(true), TestCase::Duration::QUICK);
+    AddTestCase(new Ipv4ReassemblyTest, TestCase::Duration::QUICK);
 }
 
 static Ipv4FragmentationTestSuite
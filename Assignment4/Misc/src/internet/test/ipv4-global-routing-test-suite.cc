@@ -16,6 +16,7 @@
 #include "ns3/boolean.h"
 #include "ns3/bridge-helper.h"
 #include "ns3/config.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -31,6 +32,7 @@
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simple-channel.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/simple-net-device.h"
@@ -41,6 +43,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <sstream>
+#include <string>
 #include <vector>
 
 using namespace ns3;
@@ -1311,6 +1315,158 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check that the routes computed on several threads, and the routes
+ * updated after links went down or had their metric increased, are the
+ * routes computed from scratch.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingUpdateTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Get the routes of all the nodes.
+     * \param nodes the nodes
+     * \return the routes, printed
+     */
+    static std::string GetRoutes(const NodeContainer& nodes);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase()
+    : TestCase("Update the global routes after link changes, on several threads")
+{
+}
+
+std::string
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes(const NodeContainer& nodes)
+{
+    std::ostringstream routes;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Ipv4GlobalRouting> routing = nodes.Get(i)
+                                             ->GetObject<Ipv4L3Protocol>()
+                                             ->GetRoutingProtocol()
+                                             ->GetObject<Ipv4GlobalRouting>();
+        routes << "node " << i << std::endl;
+        for (uint32_t j = 0; j < routing->GetNRoutes(); j++)
+        {
+            routes << *routing->GetRoute(j) << std::endl;
+        }
+    }
+    return routes.str();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun()
+{
+    // A ring of routers with chords, and a few hosts attached to them, with
+    // random metrics so that there are equal-cost paths
+    const uint32_t nRouters = 16;
+    const uint32_t nHosts = 4;
+    NodeContainer nodes;
+    nodes.Create(nRouters + nHosts);
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(nodes);
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    for (uint32_t i = 0; i < nRouters; i++)
+    {
+        links.emplace_back(i, (i + 1) % nRouters);
+    }
+    for (uint32_t i = 0; i < nRouters; i++)
+    {
+        links.emplace_back(rng->GetInteger(0, nRouters - 1), rng->GetInteger(0, nRouters - 1));
+        if (links.back().first == links.back().second)
+        {
+            links.pop_back();
+        }
+    }
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        links.emplace_back(nRouters + i, rng->GetInteger(0, nRouters - 1));
+    }
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", "255.255.255.252");
+    std::vector<Ipv4InterfaceContainer> interfaces;
+    for (const auto& link : links)
+    {
+        NetDeviceContainer devices = simpleHelper.Install(
+            NodeContainer(nodes.Get(link.first), nodes.Get(link.second)),
+            CreateObject<SimpleChannel>());
+        interfaces.push_back(ipv4.Assign(devices));
+        ipv4.NewNetwork();
+        uint16_t metric = rng->GetInteger(1, 3);
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            interfaces.back().Get(j).first->SetMetric(interfaces.back().Get(j).second, metric);
+        }
+    }
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    std::string routes = GetRoutes(nodes);
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(3));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    NS_TEST_EXPECT_MSG_EQ(GetRoutes(nodes), routes, "Routes differ when computed on threads");
+    NS_TEST_EXPECT_MSG_EQ(GlobalRouteManager::UpdateRoutes(), 0, "Routes recomputed without change");
+    NS_TEST_EXPECT_MSG_EQ(GetRoutes(nodes), routes, "Routes changed without change");
+
+    // Take links down, or increase their metric, one at a time
+    uint32_t nRecomputed = 0;
+    const uint32_t nChanges = 12;
+    for (uint32_t i = 0; i < nChanges; i++)
+    {
+        Ipv4InterfaceContainer& link = interfaces[rng->GetInteger(0, interfaces.size() - 1)];
+        auto end = link.Get(rng->GetInteger(0, 1));
+        if (i % 3 == 0)
+        {
+            end.first->SetDown(end.second);
+        }
+        else
+        {
+            for (uint32_t j = 0; j < 2; j++)
+            {
+                uint16_t metric = link.Get(j).first->GetMetric(link.Get(j).second);
+                link.Get(j).first->SetMetric(link.Get(j).second, metric + 2);
+            }
+        }
+        nRecomputed += GlobalRouteManager::UpdateRoutes();
+        routes = GetRoutes(nodes);
+        Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+        NS_TEST_EXPECT_MSG_EQ(GetRoutes(nodes), routes, "Updated routes differ after change " << i);
+    }
+    NS_TEST_EXPECT_MSG_LT(nRecomputed,
+                          nChanges * nodes.GetN(),
+                          "The routes of all the nodes were recomputed at each change");
+
+    // Adding a link back recomputes all the routes
+    interfaces[0].Get(0).first->SetDown(interfaces[0].Get(0).second);
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    interfaces[0].Get(0).first->SetUp(interfaces[0].Get(0).second);
+    NS_TEST_EXPECT_MSG_EQ(GlobalRouteManager::UpdateRoutes(),
+                          nodes.GetN(),
+                          "Not all the routes recomputed after a link went up");
+    routes = GetRoutes(nodes);
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    NS_TEST_EXPECT_MSG_EQ(GetRoutes(nodes), routes, "Updated routes differ after a link went up");
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1333,6 +1489,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::Duration::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::Duration::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::Duration::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingUpdateTestCase, TestCase::Duration::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check the insertion, lookup and removal of prefixes in Ipv4PrefixTrie.
+ */
+class Ipv4PrefixTrieTestCase : public TestCase
+{
+  public:
+    Ipv4PrefixTrieTestCase();
+
+  private:
+    void DoRun() override;
+
+    /// Trie of integers
+    typedef Ipv4PrefixTrie<int> Trie;
+
+    /**
+     * \param trie The trie.
+     * \param address The address.
+     * \return The values of the prefixes matching the address, from the shortest prefix.
+     */
+    static std::vector<int> Lookup(const Trie& trie, const char* address);
+};
+
+Ipv4PrefixTrieTestCase::Ipv4PrefixTrieTestCase()
+    : TestCase("Check the insertion, lookup and removal of prefixes")
+{
+}
+
+std::vector<int>
+Ipv4PrefixTrieTestCase::Lookup(const Trie& trie, const char* address)
+{
+    std::vector<int> values;
+    trie.Lookup(Ipv4Address(address), [&values](uint8_t, const Trie::Values& v) {
+        values.insert(values.end(), v.begin(), v.end());
+    });
+    return values;
+}
+
+void
+Ipv4PrefixTrieTestCase::DoRun()
+{
+    Trie trie;
+    trie.Insert(Ipv4Address("0.0.0.0"), 0, 0);
+    trie.Insert(Ipv4Address("10.0.0.0"), 8, 8);
+    trie.Insert(Ipv4Address("10.1.2.0"), 24, 24);
+    trie.Insert(Ipv4Address("10.1.2.3"), 32, 32);
+    trie.Insert(Ipv4Address("10.1.0.0"), 16, 16);
+    trie.Insert(Ipv4Address("10.1.3.0"), 24, 25);
+    // Equal-cost routes are kept together, in order
+    trie.Insert(Ipv4Address("10.1.2.99"), 24, 26);
+
+    NS_TEST_EXPECT_MSG_EQ((Lookup(trie, "10.1.2.3") == std::vector<int>{0, 8, 16, 24, 26, 32}),
+                          true,
+                          "Wrong prefixes matching 10.1.2.3");
+    NS_TEST_EXPECT_MSG_EQ((Lookup(trie, "10.1.3.7") == std::vector<int>{0, 8, 16, 25}),
+                          true,
+                          "Wrong prefixes matching 10.1.3.7");
+    NS_TEST_EXPECT_MSG_EQ((Lookup(trie, "10.2.0.1") == std::vector<int>{0, 8}),
+                          true,
+                          "Wrong prefixes matching 10.2.0.1");
+    NS_TEST_EXPECT_MSG_EQ((Lookup(trie, "11.0.0.1") == std::vector<int>{0}),
+                          true,
+                          "Wrong prefixes matching 11.0.0.1");
+
+    NS_TEST_EXPECT_MSG_EQ(trie.Find(Ipv4Address("10.1.2.0"), 24)->size(), 2, "Prefix not found");
+    NS_TEST_EXPECT_MSG_EQ(trie.Find(Ipv4Address("10.1.2.0"), 23), nullptr, "Wrong prefix found");
+    NS_TEST_EXPECT_MSG_EQ(trie.Find(Ipv4Address("10.1.0.0"), 22), nullptr, "Wrong prefix found");
+
+    // Removing values removes the prefixes without values
+    auto is = [](int value) { return [value](int v) { return v == value; }; };
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.1.2.0"), 24, is(25)),
+                          false,
+                          "Value removed from the wrong prefix");
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.1.2.0"), 24, is(24)),
+                          true,
+                          "Value not removed");
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.1.0.0"), 16, is(16)),
+                          true,
+                          "Value not removed");
+    NS_TEST_EXPECT_MSG_EQ((Lookup(trie, "10.1.2.3") == std::vector<int>{0, 8, 26, 32}),
+                          true,
+                          "Wrong prefixes matching 10.1.2.3");
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.1.2.0"), 24, is(26)),
+                          true,
+                          "Value not removed");
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.1.3.0"), 24, is(25)),
+                          true,
+                          "Value not removed");
+    NS_TEST_EXPECT_MSG_EQ(trie.Remove(Ipv4Address("10.0.0.0"), 8, is(8)),
+                          true,
+                          "Value not removed");
+    // Only the root and the host route are left
+    uint32_t cost = trie.Lookup(Ipv4Address("10.1.2.3"), [](uint8_t, const Trie::Values&) {});
+    NS_TEST_EXPECT_MSG_EQ(cost, 2, "Nodes without values left in the trie");
+
+    // Compare lookups with a linear search, on random prefixes
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+    trie.Clear();
+    std::vector<std::pair<uint32_t, uint8_t>> prefixes;
+    for (int i = 0; i < 2000; ++i)
+    {
+        // Draw the addresses in a small space, so that the prefixes nest
+        uint32_t prefix = rng->GetInteger(0, 255) << 24 | rng->GetInteger(0, 3) << 16 |
+                          rng->GetInteger(0, 255);
+        auto length = static_cast<uint8_t>(rng->GetInteger(0, 32));
+        prefixes.emplace_back(prefix, length);
+        trie.Insert(Ipv4Address(prefix), length, i);
+    }
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int n = 0; n < 1000; ++n)
+        {
+            uint32_t address = rng->GetInteger(0, 255) << 24 | rng->GetInteger(0, 3) << 16 |
+                               rng->GetInteger(0, 255);
+            std::vector<std::pair<uint8_t, int>> matches;
+            for (std::size_t i = 0; i < prefixes.size(); ++i)
+            {
+                uint8_t length = prefixes[i].second;
+                if (length > 32)
+                {
+                    continue;
+                }
+                Ipv4Mask mask(length == 0 ? 0 : 0xffffffff << (32 - length));
+                if (mask.IsMatch(Ipv4Address(address), Ipv4Address(prefixes[i].first)))
+                {
+                    matches.emplace_back(length, i);
+                }
+            }
+            std::sort(matches.begin(), matches.end());
+            std::vector<int> expected;
+            for (const auto& match : matches)
+            {
+                expected.push_back(match.second);
+            }
+            std::vector<int> found;
+            trie.Lookup(Ipv4Address(address), [&found](uint8_t, const Trie::Values& v) {
+                found.insert(found.end(), v.begin(), v.end());
+            });
+            NS_TEST_ASSERT_MSG_EQ((found == expected),
+                                  true,
+                                  "Wrong prefixes matching " << Ipv4Address(address));
+        }
+        // Remove every other prefix, and check again
+        for (std::size_t i = round; i < prefixes.size(); i += 2)
+        {
+            NS_TEST_ASSERT_MSG_EQ(
+                trie.Remove(Ipv4Address(prefixes[i].first), prefixes[i].second, is(i)),
+                true,
+                "Value not removed");
+            prefixes[i].second = 33; // Removed
+        }
+    }
+    cost = trie.Lookup(Ipv4Address("10.1.2.3"), [](uint8_t, const Trie::Values&) {});
+    NS_TEST_EXPECT_MSG_EQ(cost, 1, "Nodes without values left in the trie");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv4PrefixTrie TestSuite
+ */
+class Ipv4PrefixTrieTestSuite : public TestSuite
+{
+  public:
+    Ipv4PrefixTrieTestSuite()
+        : TestSuite("ipv4-prefix-trie", Type::UNIT)
+    {
+        AddTestCase(new Ipv4PrefixTrieTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+static Ipv4PrefixTrieTestSuite
+    g_ipv4PrefixTrieTestSuite; //!< Static variable for test initialization
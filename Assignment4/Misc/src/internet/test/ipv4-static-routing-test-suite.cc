@@ -20,6 +20,8 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
@@ -35,6 +37,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <sstream>
+
 using namespace ns3;
 
 /**
@@ -207,6 +211,115 @@ Ipv4StaticRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 StaticRouting with non-contiguous network masks.
+ *
+ * The routes are indexed by the leading ones of their masks, while the
+ * longest match is that of the routes with the longest
+ * Ipv4Mask::GetPrefixLength(), as with a linear search of the routing table.
+ */
+class Ipv4StaticRoutingNonContiguousMaskTestCase : public TestCase
+{
+  public:
+    Ipv4StaticRoutingNonContiguousMaskTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param routing The static routing protocol.
+     * \param dest The destination.
+     * \return The index of the output interface of the route to the
+     *         destination, or -1 if there is no route.
+     */
+    static int32_t RouteTo(Ptr<Ipv4StaticRouting> routing, const char* dest);
+};
+
+Ipv4StaticRoutingNonContiguousMaskTestCase::Ipv4StaticRoutingNonContiguousMaskTestCase()
+    : TestCase("Static routing with non-contiguous network masks")
+{
+}
+
+int32_t
+Ipv4StaticRoutingNonContiguousMaskTestCase::RouteTo(Ptr<Ipv4StaticRouting> routing,
+                                                    const char* dest)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(dest));
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, nullptr, sockerr);
+    if (!route)
+    {
+        return -1;
+    }
+    Ptr<Ipv4> ipv4 = route->GetOutputDevice()->GetNode()->GetObject<Ipv4>();
+    return ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+}
+
+void
+Ipv4StaticRoutingNonContiguousMaskTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+
+    SimpleNetDeviceHelper devHelper;
+    int32_t ifIndex[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Ptr<NetDevice> device = devHelper.Install(node).Get(0);
+        ifIndex[i] = ipv4->AddInterface(device);
+        std::ostringstream address;
+        address << "172.16." << i + 1 << ".1";
+        ipv4->AddAddress(ifIndex[i],
+                         Ipv4InterfaceAddress(Ipv4Address(address.str().c_str()),
+                                              Ipv4Mask("255.255.255.0")));
+        ipv4->SetUp(ifIndex[i]);
+    }
+
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting(ipv4);
+    routing->AddNetworkRouteTo(Ipv4Address("10.0.0.0"),
+                               Ipv4Mask("255.255.0.0"),
+                               Ipv4Address("172.16.2.2"),
+                               ifIndex[1]);
+    // A non-contiguous mask, whose prefix length is 24 and which has 8 leading ones
+    routing->AddNetworkRouteTo(Ipv4Address("10.0.5.0"),
+                               Ipv4Mask("255.0.255.0"),
+                               Ipv4Address("172.16.1.2"),
+                               ifIndex[0]);
+    routing->SetDefaultRoute(Ipv4Address("172.16.3.2"), ifIndex[2]);
+
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "10.1.5.7"),
+                          ifIndex[0],
+                          "Route with a non-contiguous mask not found");
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "10.0.5.7"),
+                          ifIndex[0],
+                          "The mask of length 24 must be preferred to that of length 16");
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "10.0.6.7"), ifIndex[1], "Wrong route to 10.0.6.7");
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "11.0.5.7"), ifIndex[2], "Wrong route to 11.0.5.7");
+
+    // Remove the route with the non-contiguous mask
+    bool removed = false;
+    for (uint32_t i = 0; i < routing->GetNRoutes(); i++)
+    {
+        if (routing->GetRoute(i).GetDestNetworkMask() == Ipv4Mask("255.0.255.0"))
+        {
+            routing->RemoveRoute(i);
+            removed = true;
+            break;
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(removed, true, "Route with a non-contiguous mask not in the table");
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "10.0.5.7"), ifIndex[1], "Wrong route to 10.0.5.7");
+    NS_TEST_EXPECT_MSG_EQ(RouteTo(routing, "10.1.5.7"), ifIndex[2], "Wrong route to 10.1.5.7");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -222,6 +335,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite()
     : TestSuite("ipv4-static-routing", Type::UNIT)
 {
     AddTestCase(new Ipv4StaticRoutingSlash32TestCase, TestCase::Duration::QUICK);
+    AddTestCase(new Ipv4StaticRoutingNonContiguousMaskTestCase, TestCase::Duration::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite
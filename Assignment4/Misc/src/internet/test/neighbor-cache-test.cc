@@ -17,15 +17,18 @@
  * Author: Zhiheng Dong <dzh2077@gmail.com>
  */
 
+#include "ns3/arp-cache.h"
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-routing-helper.h"
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/ipv6-routing-helper.h"
+#include "ns3/ndisc-cache.h"
 #include "ns3/neighbor-cache-helper.h"
 #include "ns3/simple-channel.h"
 #include "ns3/simple-net-device-helper.h"
@@ -37,6 +40,8 @@
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/udp-socket-factory.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -1221,6 +1226,139 @@ DynamicPartialTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief Neighbor cache timers Test
+ *
+ * Check the ARP retransmissions of the entries waiting for a reply, and
+ * the expiry of the NDISC reachable timer refreshed by confirmations.
+ */
+class TimerTest : public TestCase
+{
+    std::vector<std::pair<Time, Ipv4Address>> m_requests; //!< ARP requests sent
+    uint32_t m_drops;                                      //!< Packets dropped by the ARP cache
+
+    /**
+     * \brief Record an ARP request.
+     * \param cache The ARP cache.
+     * \param address The address to resolve.
+     */
+    void ArpRequest(Ptr<const ArpCache> cache, Ipv4Address address);
+
+    /**
+     * \brief Count a packet dropped by the ARP cache.
+     * \param packet The dropped packet.
+     */
+    void ArpDrop(Ptr<const Packet> packet);
+
+    /**
+     * \brief Check the state of an NDISC entry.
+     * \param entry The entry.
+     * \param reachable True if the entry is expected to be reachable.
+     */
+    void CheckReachable(NdiscCache::Entry* entry, bool reachable);
+
+  public:
+    void DoRun() override;
+
+    TimerTest();
+};
+
+TimerTest::TimerTest()
+    : TestCase("The ARP retransmissions and the NDISC reachable timer are on time"),
+      m_drops(0)
+{
+}
+
+void
+TimerTest::ArpRequest(Ptr<const ArpCache> cache, Ipv4Address address)
+{
+    m_requests.emplace_back(Simulator::Now(), address);
+}
+
+void
+TimerTest::ArpDrop(Ptr<const Packet> packet)
+{
+    m_drops++;
+}
+
+void
+TimerTest::CheckReachable(NdiscCache::Entry* entry, bool reachable)
+{
+    NS_TEST_EXPECT_MSG_EQ(entry->IsReachable(),
+                          reachable,
+                          "Wrong state of " << entry->GetIpv6Address() << " at "
+                                            << Simulator::Now().As(Time::S));
+}
+
+void
+TimerTest::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    node->AddDevice(device);
+
+    // Three addresses waiting for a reply, one of them answering after 1.5 s
+    Ptr<ArpCache> arpCache = CreateObject<ArpCache>();
+    arpCache->SetDevice(device, nullptr);
+    arpCache->SetArpRequestCallback(MakeCallback(&TimerTest::ArpRequest, this));
+    arpCache->TraceConnectWithoutContext("Drop", MakeCallback(&TimerTest::ArpDrop, this));
+    std::vector<Ipv4Address> addresses = {"10.0.0.3", "10.0.0.1", "10.0.0.2"};
+    for (const auto& address : addresses)
+    {
+        arpCache->Add(address)->MarkWaitReply(
+            ArpCache::Ipv4PayloadHeaderPair(Create<Packet>(), Ipv4Header()));
+    }
+    Simulator::Schedule(Seconds(1.5), [arpCache]() {
+        arpCache->Lookup("10.0.0.2")->MarkAlive(Mac48Address("00:00:00:00:00:02"));
+    });
+
+    // Two reachable neighbors, one of them confirmed twice
+    Ptr<Icmpv6L4Protocol> icmpv6 = CreateObject<Icmpv6L4Protocol>();
+    Ptr<NdiscCache> ndiscCache = CreateObject<NdiscCache>();
+    ndiscCache->SetDevice(device, nullptr, icmpv6);
+    NdiscCache::Entry* idle = ndiscCache->Add("2001::1");
+    NdiscCache::Entry* confirmed = ndiscCache->Add("2001::2");
+    for (auto entry : {idle, confirmed})
+    {
+        entry->SetMacAddress(Mac48Address("00:00:00:00:00:01"));
+        entry->MarkReachable();
+        entry->StartReachableTimer();
+    }
+    Simulator::Schedule(Seconds(10), &NdiscCache::Entry::UpdateReachableTimer, confirmed);
+    Simulator::Schedule(Seconds(20), &NdiscCache::Entry::UpdateReachableTimer, confirmed);
+    Simulator::Schedule(Seconds(29.9), &TimerTest::CheckReachable, this, idle, true);
+    Simulator::Schedule(Seconds(30.1), &TimerTest::CheckReachable, this, idle, false);
+    Simulator::Schedule(Seconds(49.9), &TimerTest::CheckReachable, this, confirmed, true);
+    Simulator::Schedule(Seconds(50.1), &TimerTest::CheckReachable, this, confirmed, false);
+
+    Simulator::Run();
+
+    std::vector<std::pair<Time, Ipv4Address>> requests = {
+        {Seconds(1), "10.0.0.1"},
+        {Seconds(1), "10.0.0.2"},
+        {Seconds(1), "10.0.0.3"},
+        {Seconds(2), "10.0.0.1"},
+        {Seconds(2), "10.0.0.3"},
+        {Seconds(3), "10.0.0.1"},
+        {Seconds(3), "10.0.0.3"},
+    };
+    NS_TEST_ASSERT_MSG_EQ(m_requests.size(), requests.size(), "Wrong number of ARP requests");
+    for (std::size_t i = 0; i < requests.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_requests[i].first, requests[i].first, "Wrong ARP request time");
+        NS_TEST_EXPECT_MSG_EQ(m_requests[i].second, requests[i].second, "Wrong ARP request");
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_drops, 2, "Wrong number of packets dropped");
+    NS_TEST_EXPECT_MSG_EQ(arpCache->Lookup("10.0.0.1")->IsDead(), true, "Entry not dead");
+    NS_TEST_EXPECT_MSG_EQ(arpCache->Lookup("10.0.0.2")->IsAlive(), true, "Entry not alive");
+
+    arpCache->Dispose();
+    ndiscCache->Dispose();
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1239,6 +1377,7 @@ class NeighborCacheTestSuite : public TestSuite
         AddTestCase(new FlushTest, TestCase::Duration::QUICK);
         AddTestCase(new DuplicateTest, TestCase::Duration::QUICK);
         AddTestCase(new DynamicPartialTest, TestCase::Duration::QUICK);
+        AddTestCase(new TimerTest, TestCase::Duration::QUICK);
     }
 };
 
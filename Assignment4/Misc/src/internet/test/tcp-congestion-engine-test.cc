@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/tcp-congestion-engine.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-cubic.h"
+#include "ns3/tcp-socket-state.h"
+#include "ns3/tcpOjus.h"
+#include "ns3/test.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check that the congestion engine matches the per-ACK interface.
+ *
+ * Two identical sets of connections get the same ACKs and losses, every
+ * millisecond for a few seconds: the first set through PktsAcked and
+ * IncreaseWindow, the second through a TcpCongestionEngine. Their windows
+ * and thresholds must be equal after every round. A connection may get
+ * several ACKs per round, and then has several events queued in the engine.
+ */
+class TcpCongestionEngineTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param name The name of the congestion controls, or "mixed" for all of them.
+     * \param acksPerRound The number of ACKs of each connection per round.
+     */
+    TcpCongestionEngineTestCase(const std::string& name, uint32_t acksPerRound = 1);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create a congestion control.
+     * \param i The index of the connection.
+     * \return The congestion control.
+     */
+    Ptr<TcpCongestionOps> CreateCongestionOps(uint32_t i) const;
+
+    /**
+     * Run a round of ACKs and check the results.
+     * \param round The index of the round.
+     */
+    void Round(uint32_t round);
+
+    /// A connection, with a congestion control and its state
+    struct Connection
+    {
+        Ptr<TcpCongestionOps> cong; //!< Congestion control
+        Ptr<TcpSocketState> tcb;    //!< Congestion state
+    };
+
+    std::string m_name;                //!< Name of the congestion controls
+    uint32_t m_acksPerRound;           //!< Number of ACKs of each connection per round
+    std::vector<Connection> m_perAck;  //!< Connections updated per ACK
+    std::vector<Connection> m_batched; //!< Connections updated by the engine
+    TcpCongestionEngine m_engine;      //!< The engine
+    uint32_t m_maxCwnd{0};             //!< Largest window reached
+};
+
+/// Number of connections
+static const uint32_t CONNECTIONS = 24;
+/// Number of rounds of ACKs
+static const uint32_t ROUNDS = 3000;
+/// Segment size of the connections
+static const uint32_t SEGMENT_SIZE = 1000;
+
+TcpCongestionEngineTestCase::TcpCongestionEngineTestCase(const std::string& name,
+                                                         uint32_t acksPerRound)
+    : TestCase("Check the congestion engine with " + name +
+               (acksPerRound > 1 ? ", " + std::to_string(acksPerRound) + " ACKs per round" : "")),
+      m_name(name),
+      m_acksPerRound(acksPerRound)
+{
+}
+
+Ptr<TcpCongestionOps>
+TcpCongestionEngineTestCase::CreateCongestionOps(uint32_t i) const
+{
+    std::string name = m_name;
+    if (name == "mixed")
+    {
+        const char* names[] = {"TcpCubic", "TcpOjus", "TcpNewReno"};
+        name = names[i % 3];
+    }
+    if (name == "TcpCubic")
+    {
+        return CreateObject<TcpCubic>();
+    }
+    if (name == "TcpOjus")
+    {
+        return CreateObject<TcpOjus>();
+    }
+    return CreateObject<TcpNewReno>();
+}
+
+void
+TcpCongestionEngineTestCase::Round(uint32_t round)
+{
+    for (uint32_t i = 0; i < CONNECTIONS; i++)
+    {
+        uint32_t segmentsAcked = 1 + (i + round) % 3;
+        Time rtt = MilliSeconds(10 + i % 7) + MicroSeconds((round * 37 + i * 101) % 2000);
+        for (auto connections : {&m_perAck, &m_batched})
+        {
+            Ptr<TcpSocketState> tcb = (*connections)[i].tcb;
+            tcb->m_lastAckedSeq += segmentsAcked * SEGMENT_SIZE;
+            tcb->m_highTxMark = tcb->m_lastAckedSeq + tcb->m_cWnd;
+            tcb->m_isCwndLimited = (i + round / 100) % 5 != 0;
+        }
+
+        Connection& connection = m_perAck[i];
+        for (uint32_t ack = 0; ack < m_acksPerRound; ack++)
+        {
+            connection.cong->PktsAcked(connection.tcb, segmentsAcked, rtt);
+            connection.cong->IncreaseWindow(connection.tcb, segmentsAcked);
+            m_engine.Add(m_batched[i].cong, m_batched[i].tcb, segmentsAcked, rtt);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_engine.GetPending(),
+                          CONNECTIONS * m_acksPerRound,
+                          "Events not queued");
+    m_engine.Process();
+    NS_TEST_ASSERT_MSG_EQ(m_engine.GetPending(), 0, "Events left queued");
+
+    for (uint32_t i = 0; i < CONNECTIONS; i++)
+    {
+        Ptr<TcpSocketState> perAck = m_perAck[i].tcb;
+        Ptr<TcpSocketState> batched = m_batched[i].tcb;
+        NS_TEST_ASSERT_MSG_EQ(batched->m_cWnd.Get(),
+                              perAck->m_cWnd.Get(),
+                              "Different cWnd for connection " << i << " at round " << round);
+        NS_TEST_ASSERT_MSG_EQ(batched->m_ssThresh.Get(),
+                              perAck->m_ssThresh.Get(),
+                              "Different ssThresh for connection " << i << " at round " << round);
+        m_maxCwnd = std::max(m_maxCwnd, perAck->m_cWnd.Get());
+
+        // A loss now and then, on a window large enough
+        if ((round + 97 * i) % 700 == 0 && perAck->m_cWnd > 4 * SEGMENT_SIZE)
+        {
+            for (auto connections : {&m_perAck, &m_batched})
+            {
+                Connection& connection = (*connections)[i];
+                Ptr<TcpSocketState> tcb = connection.tcb;
+                connection.cong->CongestionStateSet(tcb, TcpSocketState::CA_LOSS);
+                tcb->m_ssThresh = connection.cong->GetSsThresh(tcb, tcb->m_cWnd);
+                tcb->m_cWnd = tcb->m_ssThresh;
+            }
+        }
+    }
+
+    if (round + 1 < ROUNDS)
+    {
+        Simulator::Schedule(MilliSeconds(1), &TcpCongestionEngineTestCase::Round, this, round + 1);
+    }
+}
+
+void
+TcpCongestionEngineTestCase::DoRun()
+{
+    for (uint32_t i = 0; i < CONNECTIONS; i++)
+    {
+        for (auto connections : {&m_perAck, &m_batched})
+        {
+            Connection connection{CreateCongestionOps(i), CreateObject<TcpSocketState>()};
+            connection.tcb->m_segmentSize = SEGMENT_SIZE;
+            connection.tcb->m_cWnd = (2 + i % 5) * SEGMENT_SIZE;
+            // Half of the connections start in congestion avoidance
+            connection.tcb->m_ssThresh =
+                i % 2 ? 20 * SEGMENT_SIZE : std::numeric_limits<uint32_t>::max();
+            connection.cong->Init(connection.tcb);
+            connections->push_back(connection);
+        }
+    }
+
+    Simulator::Schedule(MilliSeconds(1), &TcpCongestionEngineTestCase::Round, this, 0);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_GT(m_maxCwnd, 50 * SEGMENT_SIZE, "The windows did not grow");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TCP congestion engine TestSuite
+ */
+class TcpCongestionEngineTestSuite : public TestSuite
+{
+  public:
+    TcpCongestionEngineTestSuite()
+        : TestSuite("tcp-congestion-engine", Type::UNIT)
+    {
+        AddTestCase(new TcpCongestionEngineTestCase("TcpCubic"), TestCase::Duration::QUICK);
+        AddTestCase(new TcpCongestionEngineTestCase("TcpOjus"), TestCase::Duration::QUICK);
+        // Congestion controls without the batched methods
+        AddTestCase(new TcpCongestionEngineTestCase("TcpNewReno"), TestCase::Duration::QUICK);
+        AddTestCase(new TcpCongestionEngineTestCase("mixed"), TestCase::Duration::QUICK);
+        // Connections with several events in a block
+        AddTestCase(new TcpCongestionEngineTestCase("TcpCubic", 2), TestCase::Duration::QUICK);
+        AddTestCase(new TcpCongestionEngineTestCase("mixed", 3), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization
+static TcpCongestionEngineTestSuite g_tcpCongestionEngineTest;
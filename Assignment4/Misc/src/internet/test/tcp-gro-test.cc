@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check a bulk transfer with the TCP generic receive offload.
+ *
+ * The receiver merges the segments arriving back-to-back into larger chunks.
+ * It must get all the data, and acknowledge the chunks soon enough for the
+ * sender not to retransmit anything.
+ */
+class TcpGroTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param ipv6 Whether to use IPv6 instead of IPv4.
+     * \param groMaxSegments The GroMaxSegments attribute of the receiver.
+     */
+    TcpGroTestCase(bool ipv6, uint32_t groMaxSegments);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Write data into the sender socket.
+     * \param socket The sender socket.
+     * \param available The available space in the socket buffer.
+     */
+    void SourceHandleSend(Ptr<Socket> socket, uint32_t available);
+    /**
+     * Accept a connection.
+     * \param socket The accepted socket.
+     * \param from The address of the peer.
+     */
+    void ServerHandleAccept(Ptr<Socket> socket, const Address& from);
+    /**
+     * Read data from the receiver socket.
+     * \param socket The receiver socket.
+     */
+    void ServerHandleRecv(Ptr<Socket> socket);
+    /**
+     * Count the data sent by the sender socket.
+     * \param packet The payload of the segment.
+     * \param header The TCP header of the segment.
+     * \param socket The socket.
+     */
+    void SourceTx(Ptr<const Packet> packet,
+                  const TcpHeader& header,
+                  Ptr<const TcpSocketBase> socket);
+    /**
+     * Count the ACKs sent by the receiver socket.
+     * \param packet The payload of the segment.
+     * \param header The TCP header of the segment.
+     * \param socket The socket.
+     */
+    void ServerTx(Ptr<const Packet> packet,
+                  const TcpHeader& header,
+                  Ptr<const TcpSocketBase> socket);
+    /**
+     * Check the chunks received by the receiver socket.
+     * \param packet The payload of the chunk.
+     * \param header The TCP header of the chunk.
+     * \param socket The socket.
+     */
+    void ServerRx(Ptr<const Packet> packet,
+                  const TcpHeader& header,
+                  Ptr<const TcpSocketBase> socket);
+
+    bool m_ipv6;                   //!< Whether to use IPv6
+    uint32_t m_groMaxSegments;     //!< GroMaxSegments of the receiver
+    std::vector<uint8_t> m_txData; //!< The data to send
+    std::vector<uint8_t> m_rxData; //!< The data received
+    uint32_t m_txBytes{0};         //!< Number of bytes written
+    uint32_t m_sentBytes{0};       //!< Number of bytes sent, including retransmissions
+    uint32_t m_sentSegments{0};    //!< Number of data segments sent
+    uint32_t m_acks{0};            //!< Number of ACKs sent by the receiver
+    uint32_t m_maxChunk{0};        //!< Size of the largest chunk received
+};
+
+TcpGroTestCase::TcpGroTestCase(bool ipv6, uint32_t groMaxSegments)
+    : TestCase(std::string("Check TCP GRO over ") + (ipv6 ? "IPv6" : "IPv4") + " with " +
+               std::to_string(groMaxSegments) + " segments per chunk"),
+      m_ipv6(ipv6),
+      m_groMaxSegments(groMaxSegments)
+{
+}
+
+void
+TcpGroTestCase::SourceHandleSend(Ptr<Socket> socket, uint32_t available)
+{
+    while (socket->GetTxAvailable() > 0 && m_txBytes < m_txData.size())
+    {
+        uint32_t size = std::min<uint32_t>(m_txData.size() - m_txBytes, socket->GetTxAvailable());
+        size = std::min<uint32_t>(size, 3000);
+        int sent = socket->Send(Create<Packet>(&m_txData[m_txBytes], size));
+        NS_TEST_ASSERT_MSG_EQ(sent, static_cast<int>(size), "Error during send");
+        m_txBytes += sent;
+    }
+    if (m_txBytes == m_txData.size())
+    {
+        socket->Close();
+    }
+}
+
+void
+TcpGroTestCase::ServerHandleAccept(Ptr<Socket> socket, const Address& from)
+{
+    socket->SetRecvCallback(MakeCallback(&TcpGroTestCase::ServerHandleRecv, this));
+    socket->TraceConnectWithoutContext("Tx", MakeCallback(&TcpGroTestCase::ServerTx, this));
+    socket->TraceConnectWithoutContext("Rx", MakeCallback(&TcpGroTestCase::ServerRx, this));
+}
+
+void
+TcpGroTestCase::ServerHandleRecv(Ptr<Socket> socket)
+{
+    while (Ptr<Packet> packet = socket->Recv())
+    {
+        uint32_t size = m_rxData.size();
+        m_rxData.resize(size + packet->GetSize());
+        packet->CopyData(&m_rxData[size], packet->GetSize());
+    }
+}
+
+void
+TcpGroTestCase::SourceTx(Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    if (packet->GetSize() > 0)
+    {
+        m_sentBytes += packet->GetSize();
+        m_sentSegments++;
+    }
+}
+
+void
+TcpGroTestCase::ServerTx(Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    if (packet->GetSize() == 0 && header.GetFlags() == TcpHeader::ACK)
+    {
+        m_acks++;
+    }
+}
+
+void
+TcpGroTestCase::ServerRx(Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(packet->GetSize(), 1400 * m_groMaxSegments, "Chunk too large");
+    m_maxChunk = std::max(m_maxChunk, packet->GetSize());
+}
+
+void
+TcpGroTestCase::DoRun()
+{
+    m_txData.resize(500000);
+    for (uint32_t i = 0; i < m_txData.size(); i++)
+    {
+        m_txData[i] = (i * 7 + i / 251) % 256;
+    }
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ptr<TcpL4Protocol> serverTcp = nodes.Get(1)->GetObject<TcpL4Protocol>();
+    serverTcp->SetAttribute("GroMaxSegments", UintegerValue(m_groMaxSegments));
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    simpleHelper.SetDeviceAttribute("DataRate", DataRateValue(DataRate("1Gbps")));
+    simpleHelper.SetChannelAttribute("Delay", TimeValue(MilliSeconds(1)));
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+
+    Address serverAddress;
+    if (m_ipv6)
+    {
+        Ipv6AddressHelper ipv6;
+        ipv6.SetBase(Ipv6Address("2001:db8::"), Ipv6Prefix(64));
+        Ipv6InterfaceContainer interfaces = ipv6.Assign(devices);
+        serverAddress = Inet6SocketAddress(interfaces.GetAddress(1, 0), 5000);
+    }
+    else
+    {
+        Ipv4AddressHelper ipv4;
+        ipv4.SetBase("10.1.1.0", "255.255.255.0");
+        Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+        serverAddress = InetSocketAddress(interfaces.GetAddress(1), 5000);
+    }
+
+    Ptr<Socket> server = Socket::CreateSocket(nodes.Get(1), TcpSocketFactory::GetTypeId());
+    server->Bind(m_ipv6 ? Address(Inet6SocketAddress(Ipv6Address::GetAny(), 5000))
+                        : Address(InetSocketAddress(Ipv4Address::GetAny(), 5000)));
+    server->Listen();
+    server->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                              MakeCallback(&TcpGroTestCase::ServerHandleAccept, this));
+
+    Ptr<Socket> source = Socket::CreateSocket(nodes.Get(0), TcpSocketFactory::GetTypeId());
+    source->SetAttribute("SegmentSize", UintegerValue(1400));
+    source->SetSendCallback(MakeCallback(&TcpGroTestCase::SourceHandleSend, this));
+    source->TraceConnectWithoutContext("Tx", MakeCallback(&TcpGroTestCase::SourceTx, this));
+
+    // Leave time to the duplicate address detection of IPv6
+    Simulator::Schedule(Seconds(2), [source, serverAddress]() { source->Connect(serverAddress); });
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_rxData.size(), m_txData.size(), "Not all the data was received");
+    NS_TEST_EXPECT_MSG_EQ((m_rxData == m_txData), true, "Corrupted data received");
+    NS_TEST_EXPECT_MSG_EQ(m_sentBytes, m_txData.size(), "Data retransmitted");
+    if (m_groMaxSegments > 1)
+    {
+        NS_TEST_EXPECT_MSG_GT(m_maxChunk, 1400, "No segments merged");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(serverTcp->GetGroSegments(),
+                                    m_sentSegments,
+                                    "Segments not counted");
+        NS_TEST_EXPECT_MSG_LT(serverTcp->GetGroChunks(),
+                              serverTcp->GetGroSegments() / 2,
+                              "Too few segments merged");
+        // One ACK per chunk, instead of one every other segment
+        NS_TEST_EXPECT_MSG_LT(m_acks, m_sentSegments / 2, "Chunks not acknowledged at once");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_maxChunk, 1400, "Segments merged while disabled");
+        NS_TEST_EXPECT_MSG_EQ(serverTcp->GetGroSegments(), 0, "Segments counted while disabled");
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TCP generic receive offload TestSuite
+ */
+class TcpGroTestSuite : public TestSuite
+{
+  public:
+    TcpGroTestSuite()
+        : TestSuite("tcp-gro", Type::UNIT)
+    {
+        AddTestCase(new TcpGroTestCase(false, 1), TestCase::Duration::QUICK);
+        AddTestCase(new TcpGroTestCase(false, 16), TestCase::Duration::QUICK);
+        AddTestCase(new TcpGroTestCase(true, 16), TestCase::Duration::QUICK);
+    }
+};
+
+static TcpGroTestSuite g_tcpGroTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/global-value.h"
+#include "ns3/gso-tag.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/pointer.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check a bulk transfer with TCP generic segmentation offload.
+ *
+ * The sender gathers its segments into GSO batches, which are split by the
+ * network layer since the SimpleNetDevice does not support GSO. The receiver
+ * must get all the data, in segments (or fragments) fitting in the MTU. When
+ * the receiver device drops some packets, the retransmissions must not be
+ * batched.
+ */
+class TcpGsoTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param ipv6 Whether to use IPv6 instead of IPv4.
+     * \param gsoMaxSegments The GsoMaxSegments attribute of the sender.
+     * \param mtu The MTU of the devices.
+     * \param losses Whether the receiver device drops some packets.
+     */
+    TcpGsoTestCase(bool ipv6, uint32_t gsoMaxSegments, uint16_t mtu, bool losses = false);
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /**
+     * Write data into the sender socket.
+     * \param socket The sender socket.
+     * \param available The available space in the socket buffer.
+     */
+    void SourceHandleSend(Ptr<Socket> socket, uint32_t available);
+    /**
+     * Accept a connection.
+     * \param socket The accepted socket.
+     * \param from The address of the peer.
+     */
+    void ServerHandleAccept(Ptr<Socket> socket, const Address& from);
+    /**
+     * Read data from the receiver socket.
+     * \param socket The receiver socket.
+     */
+    void ServerHandleRecv(Ptr<Socket> socket);
+    /**
+     * Count the data sent by the sender socket.
+     * \param packet The payload of the segment.
+     * \param header The TCP header of the segment.
+     * \param socket The socket.
+     */
+    void SourceTx(Ptr<const Packet> packet,
+                  const TcpHeader& header,
+                  Ptr<const TcpSocketBase> socket);
+    /**
+     * Count the GSO batches sent by the transport protocols.
+     * \param packet The TCP segment or batch sent.
+     */
+    void CountBatch(Ptr<const Packet> packet);
+    /**
+     * Trace sink of the IPv4 SendOutgoing trace of the sender.
+     * \param header The IPv4 header.
+     * \param packet The packet sent.
+     * \param interface The output interface.
+     */
+    void Ipv4SendOutgoing(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+    /**
+     * Trace sink of the IPv6 SendOutgoing trace of the sender.
+     * \param header The IPv6 header.
+     * \param packet The packet sent.
+     * \param interface The output interface.
+     */
+    void Ipv6SendOutgoing(const Ipv6Header& header, Ptr<const Packet> packet, uint32_t interface);
+    /**
+     * Check a packet received by the receiver device.
+     * \param device The device.
+     * \param packet The packet.
+     * \param protocol The network protocol number.
+     * \param from The sender address.
+     * \param to The receiver address.
+     * \param packetType The packet type.
+     */
+    void DeviceReceive(Ptr<NetDevice> device,
+                       Ptr<const Packet> packet,
+                       uint16_t protocol,
+                       const Address& from,
+                       const Address& to,
+                       NetDevice::PacketType packetType);
+
+    bool m_ipv6;                   //!< Whether to use IPv6
+    uint32_t m_gsoMaxSegments;     //!< GsoMaxSegments of the sender
+    uint16_t m_mtu;                //!< MTU of the devices
+    bool m_losses;                 //!< Whether the receiver device drops some packets
+    std::vector<uint8_t> m_txData; //!< The data to send
+    std::vector<uint8_t> m_rxData; //!< The data received
+    uint32_t m_txBytes{0};         //!< Number of bytes written
+    uint32_t m_sentBytes{0};       //!< Number of bytes sent, including retransmissions
+    uint32_t m_batches{0};         //!< Number of GSO batches sent
+    uint32_t m_retxBatches{0};     //!< Number of GSO batches of retransmitted data
+    SequenceNumber32 m_highTx;     //!< Highest sequence number sent down the stack
+    uint32_t m_wirePackets{0};     //!< Number of packets received by the device
+};
+
+TcpGsoTestCase::TcpGsoTestCase(bool ipv6, uint32_t gsoMaxSegments, uint16_t mtu, bool losses)
+    : TestCase(std::string("Check TCP GSO over ") + (ipv6 ? "IPv6" : "IPv4") + " with " +
+               std::to_string(gsoMaxSegments) + " segments per batch and MTU " +
+               std::to_string(mtu) + (losses ? " and losses" : "")),
+      m_ipv6(ipv6),
+      m_gsoMaxSegments(gsoMaxSegments),
+      m_mtu(mtu),
+      m_losses(losses)
+{
+}
+
+void
+TcpGsoTestCase::SourceHandleSend(Ptr<Socket> socket, uint32_t available)
+{
+    while (socket->GetTxAvailable() > 0 && m_txBytes < m_txData.size())
+    {
+        uint32_t size = std::min<uint32_t>(m_txData.size() - m_txBytes, socket->GetTxAvailable());
+        size = std::min<uint32_t>(size, 3000);
+        int sent = socket->Send(Create<Packet>(&m_txData[m_txBytes], size));
+        NS_TEST_ASSERT_MSG_EQ(sent, static_cast<int>(size), "Error during send");
+        m_txBytes += sent;
+    }
+    if (m_txBytes == m_txData.size())
+    {
+        socket->Close();
+    }
+}
+
+void
+TcpGsoTestCase::ServerHandleAccept(Ptr<Socket> socket, const Address& from)
+{
+    socket->SetRecvCallback(MakeCallback(&TcpGsoTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpGsoTestCase::ServerHandleRecv(Ptr<Socket> socket)
+{
+    while (Ptr<Packet> packet = socket->Recv())
+    {
+        uint32_t size = m_rxData.size();
+        m_rxData.resize(size + packet->GetSize());
+        packet->CopyData(&m_rxData[size], packet->GetSize());
+    }
+}
+
+void
+TcpGsoTestCase::SourceTx(Ptr<const Packet> packet,
+                         const TcpHeader& header,
+                         Ptr<const TcpSocketBase> socket)
+{
+    m_sentBytes += packet->GetSize();
+}
+
+void
+TcpGsoTestCase::CountBatch(Ptr<const Packet> packet)
+{
+    TcpHeader header;
+    packet->PeekHeader(header);
+    GsoTag gsoTag;
+    if (packet->PeekPacketTag(gsoTag))
+    {
+        NS_TEST_EXPECT_MSG_GT(gsoTag.GetSegments(), 1, "Batch of a single segment");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(gsoTag.GetSegments(), m_gsoMaxSegments, "Batch too large");
+        m_batches++;
+        if (header.GetSequenceNumber() < m_highTx)
+        {
+            m_retxBatches++;
+        }
+    }
+    uint32_t payload = packet->GetSize() - header.GetSerializedSize();
+    if (payload > 0)
+    {
+        m_highTx = std::max(m_highTx, header.GetSequenceNumber() + payload);
+    }
+}
+
+void
+TcpGsoTestCase::Ipv4SendOutgoing(const Ipv4Header& header,
+                                 Ptr<const Packet> packet,
+                                 uint32_t interface)
+{
+    if (header.GetProtocol() == TcpL4Protocol::PROT_NUMBER)
+    {
+        CountBatch(packet);
+    }
+}
+
+void
+TcpGsoTestCase::Ipv6SendOutgoing(const Ipv6Header& header,
+                                 Ptr<const Packet> packet,
+                                 uint32_t interface)
+{
+    if (header.GetNextHeader() == TcpL4Protocol::PROT_NUMBER)
+    {
+        CountBatch(packet);
+    }
+}
+
+void
+TcpGsoTestCase::DeviceReceive(Ptr<NetDevice> device,
+                              Ptr<const Packet> packet,
+                              uint16_t protocol,
+                              const Address& from,
+                              const Address& to,
+                              NetDevice::PacketType packetType)
+{
+    GsoTag gsoTag;
+    NS_TEST_EXPECT_MSG_EQ(packet->PeekPacketTag(gsoTag), false, "GSO batch on the wire");
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(packet->GetSize(), m_mtu, "Packet larger than the MTU");
+    m_wirePackets++;
+}
+
+void
+TcpGsoTestCase::DoRun()
+{
+    // Check the TCP and IPv4 checksums of the segments
+    GlobalValue::Bind("ChecksumEnabled", BooleanValue(true));
+
+    m_txData.resize(200000);
+    for (uint32_t i = 0; i < m_txData.size(); i++)
+    {
+        m_txData[i] = (i * 7 + i / 251) % 256;
+    }
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    simpleHelper.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Mbps")));
+    simpleHelper.SetChannelAttribute("Delay", TimeValue(MilliSeconds(5)));
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+    {
+        devices.Get(i)->SetMtu(m_mtu);
+    }
+
+    Address serverAddress;
+    if (m_ipv6)
+    {
+        Ipv6AddressHelper ipv6;
+        ipv6.SetBase(Ipv6Address("2001:db8::"), Ipv6Prefix(64));
+        Ipv6InterfaceContainer interfaces = ipv6.Assign(devices);
+        serverAddress = Inet6SocketAddress(interfaces.GetAddress(1, 0), 5000);
+        nodes.Get(0)->GetObject<Ipv6L3Protocol>()->TraceConnectWithoutContext(
+            "SendOutgoing",
+            MakeCallback(&TcpGsoTestCase::Ipv6SendOutgoing, this));
+    }
+    else
+    {
+        Ipv4AddressHelper ipv4;
+        ipv4.SetBase("10.1.1.0", "255.255.255.0");
+        Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+        serverAddress = InetSocketAddress(interfaces.GetAddress(1), 5000);
+        nodes.Get(0)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+            "SendOutgoing",
+            MakeCallback(&TcpGsoTestCase::Ipv4SendOutgoing, this));
+    }
+    if (m_losses)
+    {
+        // Drop all the packets for a while, so that the sender times out and
+        // retransmits the lost segments in a row in slow start
+        Ptr<RateErrorModel> errorModel = CreateObject<RateErrorModel>();
+        errorModel->SetRate(1);
+        errorModel->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
+        errorModel->Disable();
+        devices.Get(1)->SetAttribute("ReceiveErrorModel", PointerValue(errorModel));
+        Simulator::Schedule(MilliSeconds(2040), &ErrorModel::Enable, errorModel);
+        Simulator::Schedule(MilliSeconds(2060), &ErrorModel::Disable, errorModel);
+    }
+    nodes.Get(1)->RegisterProtocolHandler(MakeCallback(&TcpGsoTestCase::DeviceReceive, this),
+                                          0,
+                                          devices.Get(1),
+                                          true);
+
+    Ptr<Socket> server = Socket::CreateSocket(nodes.Get(1), TcpSocketFactory::GetTypeId());
+    server->Bind(m_ipv6 ? Address(Inet6SocketAddress(Ipv6Address::GetAny(), 5000))
+                        : Address(InetSocketAddress(Ipv4Address::GetAny(), 5000)));
+    server->Listen();
+    server->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                              MakeCallback(&TcpGsoTestCase::ServerHandleAccept, this));
+
+    Ptr<Socket> source = Socket::CreateSocket(nodes.Get(0), TcpSocketFactory::GetTypeId());
+    source->SetAttribute("SegmentSize", UintegerValue(1400));
+    source->SetAttribute("GsoMaxSegments", UintegerValue(m_gsoMaxSegments));
+    source->SetSendCallback(MakeCallback(&TcpGsoTestCase::SourceHandleSend, this));
+    source->TraceConnectWithoutContext("Tx", MakeCallback(&TcpGsoTestCase::SourceTx, this));
+
+    // Leave time to the duplicate address detection of IPv6
+    Simulator::Schedule(Seconds(2), [source, serverAddress]() { source->Connect(serverAddress); });
+    Simulator::Stop(Seconds(20));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_rxData.size(), m_txData.size(), "Not all the data was received");
+    NS_TEST_EXPECT_MSG_EQ((m_rxData == m_txData), true, "Corrupted data received");
+    if (m_losses)
+    {
+        NS_TEST_EXPECT_MSG_GT(m_sentBytes, m_txData.size(), "No data retransmitted");
+        NS_TEST_EXPECT_MSG_EQ(m_retxBatches, 0, "Retransmissions batched");
+    }
+    else
+    {
+        // A segment with a wrong checksum would be dropped, and retransmitted
+        NS_TEST_EXPECT_MSG_EQ(m_sentBytes, m_txData.size(), "Data retransmitted");
+    }
+    if (m_gsoMaxSegments > 1)
+    {
+        NS_TEST_EXPECT_MSG_GT(m_batches, 0, "No GSO batch sent");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_batches, 0, "GSO batch sent while disabled");
+    }
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(m_wirePackets,
+                                m_txData.size() / 1400,
+                                "Fewer packets than segments received");
+}
+
+void
+TcpGsoTestCase::DoTeardown()
+{
+    GlobalValue::Bind("ChecksumEnabled", BooleanValue(false));
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TCP generic segmentation offload TestSuite
+ */
+class TcpGsoTestSuite : public TestSuite
+{
+  public:
+    TcpGsoTestSuite()
+        : TestSuite("tcp-gso", Type::UNIT)
+    {
+        AddTestCase(new TcpGsoTestCase(false, 1, 1500), TestCase::Duration::QUICK);
+        AddTestCase(new TcpGsoTestCase(false, 16, 1500), TestCase::Duration::QUICK);
+        AddTestCase(new TcpGsoTestCase(true, 16, 1500), TestCase::Duration::QUICK);
+        // The segments are fragmented after the batches are split
+        AddTestCase(new TcpGsoTestCase(false, 16, 600), TestCase::Duration::QUICK);
+        AddTestCase(new TcpGsoTestCase(true, 16, 1280), TestCase::Duration::QUICK);
+        // Retransmissions in a row, after a retransmission timeout
+        AddTestCase(new TcpGsoTestCase(false, 16, 1500, true), TestCase::Duration::QUICK);
+    }
+};
+
+static TcpGsoTestSuite g_tcpGsoTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/data-rate.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check the pacing of bulk transfers by the pacing wheel of the node.
+ *
+ * Several flows are paced at a fixed rate (the MaxPacingRate) from the same
+ * node. Each flow must never send more than its rate allows, plus the burst
+ * of a slot, and must still send at its rate on average. With a slot longer
+ * than the transmission time of a segment, the pacing wheel must release the
+ * sockets with fewer events than the segments they send.
+ */
+class TcpPacingWheelTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param flows The number of flows.
+     * \param rate The pacing rate of the flows.
+     * \param slot The PacingSlot of the sender; zero for the pacing timers.
+     */
+    TcpPacingWheelTestCase(uint32_t flows, DataRate rate, Time slot);
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /**
+     * Write data into a sender socket.
+     * \param flow The index of the flow.
+     * \param socket The sender socket.
+     */
+    void SourceHandleSend(uint32_t flow, Ptr<Socket> socket);
+    /**
+     * Accept a connection.
+     * \param socket The accepted socket.
+     * \param from The address of the peer.
+     */
+    void ServerHandleAccept(Ptr<Socket> socket, const Address& from);
+    /**
+     * Read data from a receiver socket.
+     * \param socket The receiver socket.
+     */
+    void ServerHandleRecv(Ptr<Socket> socket);
+    /**
+     * Check the pacing of the data sent by a sender socket.
+     * \param flow The index of the flow.
+     * \param packet The payload of the segment.
+     */
+    void SourceTx(uint32_t flow, Ptr<const Packet> packet);
+
+    /// State of a flow
+    struct Flow
+    {
+        uint32_t written{0}; //!< Number of bytes written by the application
+        uint32_t sent{0};    //!< Number of bytes sent
+        Time firstTx;        //!< Time of the first data segment
+        Time lastTx;         //!< Time of the last data segment
+    };
+
+    uint32_t m_flowCount;      //!< Number of flows
+    DataRate m_rate;           //!< Pacing rate of the flows
+    Time m_slot;               //!< PacingSlot of the sender
+    uint32_t m_flowSize;       //!< Number of bytes sent by each flow
+    std::vector<Flow> m_flows; //!< State of the flows
+    uint32_t m_received{0};    //!< Number of bytes received by all the flows
+    uint32_t m_segments{0};    //!< Number of data segments sent by all the flows
+};
+
+TcpPacingWheelTestCase::TcpPacingWheelTestCase(uint32_t flows, DataRate rate, Time slot)
+    : TestCase("Check " + std::to_string(flows) + " flows paced at " +
+               std::to_string(rate.GetBitRate()) + " bps with a pacing slot of " +
+               std::to_string(slot.GetMicroSeconds()) + " us"),
+      m_flowCount(flows),
+      m_rate(rate),
+      m_slot(slot),
+      // Two seconds of transfer
+      m_flowSize(rate.GetBitRate() / 4)
+{
+}
+
+void
+TcpPacingWheelTestCase::SourceHandleSend(uint32_t flow, Ptr<Socket> socket)
+{
+    Flow& state = m_flows[flow];
+    while (socket->GetTxAvailable() > 0 && state.written < m_flowSize)
+    {
+        uint32_t size = std::min<uint32_t>(m_flowSize - state.written, socket->GetTxAvailable());
+        int sent = socket->Send(Create<Packet>(size));
+        NS_TEST_ASSERT_MSG_EQ(sent, static_cast<int>(size), "Error during send");
+        state.written += sent;
+    }
+    if (state.written == m_flowSize)
+    {
+        socket->Close();
+    }
+}
+
+void
+TcpPacingWheelTestCase::ServerHandleAccept(Ptr<Socket> socket, const Address& from)
+{
+    socket->SetRecvCallback(MakeCallback(&TcpPacingWheelTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpPacingWheelTestCase::ServerHandleRecv(Ptr<Socket> socket)
+{
+    while (Ptr<Packet> packet = socket->Recv())
+    {
+        m_received += packet->GetSize();
+    }
+}
+
+void
+TcpPacingWheelTestCase::SourceTx(uint32_t flow, Ptr<const Packet> packet)
+{
+    if (packet->GetSize() == 0)
+    {
+        return;
+    }
+    Flow& state = m_flows[flow];
+    Time now = Simulator::Now();
+    if (state.sent == 0)
+    {
+        state.firstTx = now;
+    }
+    // The data sent before this segment must have left at the pacing rate,
+    // apart from the burst of a late release by the wheel
+    uint64_t allowed = (now - state.firstTx + m_slot).GetSeconds() * m_rate.GetBitRate() / 8;
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(state.sent,
+                                allowed + packet->GetSize(),
+                                "Flow " << flow << " sent faster than its pacing rate at " << now);
+    state.sent += packet->GetSize();
+    state.lastTx = now;
+    m_segments++;
+}
+
+void
+TcpPacingWheelTestCase::DoRun()
+{
+    Config::SetDefault("ns3::TcpSocketState::EnablePacing", BooleanValue(true));
+    Config::SetDefault("ns3::TcpSocketState::PaceInitialWindow", BooleanValue(true));
+    Config::SetDefault("ns3::TcpSocketState::MaxPacingRate", DataRateValue(m_rate));
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ptr<TcpL4Protocol> sourceTcp = nodes.Get(0)->GetObject<TcpL4Protocol>();
+    sourceTcp->SetAttribute("PacingSlot", TimeValue(m_slot));
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    simpleHelper.SetDeviceAttribute("DataRate", DataRateValue(DataRate("1Gbps")));
+    simpleHelper.SetChannelAttribute("Delay", TimeValue(MilliSeconds(1)));
+    NetDeviceContainer devices = simpleHelper.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+    Address serverAddress = InetSocketAddress(interfaces.GetAddress(1), 5000);
+
+    Ptr<Socket> server = Socket::CreateSocket(nodes.Get(1), TcpSocketFactory::GetTypeId());
+    server->Bind(InetSocketAddress(Ipv4Address::GetAny(), 5000));
+    server->Listen();
+    server->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                              MakeCallback(&TcpPacingWheelTestCase::ServerHandleAccept, this));
+
+    m_flows.resize(m_flowCount);
+    for (uint32_t i = 0; i < m_flowCount; i++)
+    {
+        Ptr<Socket> source = Socket::CreateSocket(nodes.Get(0), TcpSocketFactory::GetTypeId());
+        source->SetAttribute("SegmentSize", UintegerValue(1400));
+        source->SetSendCallback(Callback<void, Ptr<Socket>, uint32_t>(
+            [this, i](Ptr<Socket> socket, uint32_t) { SourceHandleSend(i, socket); }));
+        source->TraceConnectWithoutContext(
+            "Tx",
+            Callback<void, Ptr<const Packet>, const TcpHeader&, Ptr<const TcpSocketBase>>(
+                [this, i](Ptr<const Packet> packet, const TcpHeader&, Ptr<const TcpSocketBase>) {
+                    SourceTx(i, packet);
+                }));
+        // Spread the starts of the flows over a millisecond
+        Simulator::Schedule(MilliSeconds(10) + MicroSeconds(1000 * i / m_flowCount),
+                            [source, serverAddress]() { source->Connect(serverAddress); });
+    }
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_received, m_flowSize * m_flowCount, "Not all the data was received");
+    for (uint32_t i = 0; i < m_flowCount; i++)
+    {
+        // The rounding of the release times must not slow the flows down
+        Time duration = m_flows[i].lastTx - m_flows[i].firstTx;
+        NS_TEST_EXPECT_MSG_LT(duration.GetSeconds(),
+                              1.05 * m_rate.CalculateBytesTxTime(m_flowSize).GetSeconds(),
+                              "Flow " << i << " slower than its pacing rate");
+    }
+    if (m_slot.IsZero())
+    {
+        NS_TEST_EXPECT_MSG_EQ(sourceTcp->GetPacingEvents(), 0, "Pacing wheel used while disabled");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(sourceTcp->GetPacingReleases(),
+                                    m_segments / 2,
+                                    "Sockets not released by the pacing wheel");
+        if (m_slot > m_rate.CalculateBytesTxTime(2 * 1400))
+        {
+            NS_TEST_EXPECT_MSG_LT(sourceTcp->GetPacingEvents(),
+                                  m_segments / 2,
+                                  "Too many events for the segments sent");
+        }
+    }
+}
+
+void
+TcpPacingWheelTestCase::DoTeardown()
+{
+    Config::SetDefault("ns3::TcpSocketState::EnablePacing", BooleanValue(false));
+    Config::SetDefault("ns3::TcpSocketState::PaceInitialWindow", BooleanValue(false));
+    Config::SetDefault("ns3::TcpSocketState::MaxPacingRate", DataRateValue(DataRate("4Gb/s")));
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TCP pacing wheel TestSuite
+ */
+class TcpPacingWheelTestSuite : public TestSuite
+{
+  public:
+    TcpPacingWheelTestSuite()
+        : TestSuite("tcp-pacing-wheel", Type::UNIT)
+    {
+        // The pacing timers of the sockets
+        AddTestCase(new TcpPacingWheelTestCase(1, DataRate("10Mbps"), Time(0)),
+                    TestCase::Duration::QUICK);
+        // A slot shorter than, and longer than, the transmission of a segment
+        AddTestCase(new TcpPacingWheelTestCase(1, DataRate("10Mbps"), MicroSeconds(100)),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpPacingWheelTestCase(1, DataRate("10Mbps"), MilliSeconds(5)),
+                    TestCase::Duration::QUICK);
+        // Releases a thousand slots ahead, through the higher levels of the wheel
+        AddTestCase(new TcpPacingWheelTestCase(1, DataRate("100kbps"), MicroSeconds(100)),
+                    TestCase::Duration::QUICK);
+        // Many flows released together
+        AddTestCase(new TcpPacingWheelTestCase(50, DataRate("2Mbps"), Time(0)),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpPacingWheelTestCase(50, DataRate("2Mbps"), MilliSeconds(1)),
+                    TestCase::Duration::QUICK);
+    }
+};
+
+static TcpPacingWheelTestSuite g_tcpPacingWheelTest; //!< Static variable for test initialization
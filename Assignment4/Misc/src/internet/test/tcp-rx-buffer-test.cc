@@ -19,6 +19,8 @@
 #include "ns3/tcp-rx-buffer.h"
 #include "ns3/test.h"
 
+#include <vector>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("TcpRxBufferTestSuite");
@@ -42,6 +44,19 @@ class TcpRxBufferTestCase : public TestCase
      * \brief Test the SACK list update.
      */
     void TestUpdateSACKList();
+
+    /**
+     * \brief Test the coalescing of out-of-order data, and its extraction.
+     */
+    void TestOutOfOrderRanges();
+
+    /**
+     * \brief Build a packet whose bytes are the low bytes of their sequence numbers.
+     * \param seq The sequence number of the first byte.
+     * \param size The size of the packet.
+     * \return The packet.
+     */
+    static Ptr<Packet> MakePacket(uint32_t seq, uint32_t size);
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase()
@@ -53,6 +68,18 @@ void
 TcpRxBufferTestCase::DoRun()
 {
     TestUpdateSACKList();
+    TestOutOfOrderRanges();
+}
+
+Ptr<Packet>
+TcpRxBufferTestCase::MakePacket(uint32_t seq, uint32_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        data[i] = static_cast<uint8_t>(seq + i);
+    }
+    return Create<Packet>(data.data(), size);
 }
 
 void
@@ -288,6 +315,101 @@ TcpRxBufferTestCase::TestUpdateSACKList()
     NS_TEST_ASSERT_MSG_EQ(sackList.size(), 0, "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestOutOfOrderRanges()
+{
+    TcpRxBuffer rxBuf;
+    TcpHeader h;
+    rxBuf.SetNextRxSequence(SequenceNumber32(1));
+
+    // Ten out-of-order segments, in reverse order, make a single range
+    for (uint32_t seq = 1001; seq >= 101; seq -= 100)
+    {
+        h.SetSequenceNumber(SequenceNumber32(seq));
+        rxBuf.Add(MakePacket(seq, 100), h);
+    }
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.NextRxSequence(),
+                          SequenceNumber32(1),
+                          "Sequence number differs from expected");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.GetOutOfOrderSize(), 1000, "Wrong out-of-order size");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.GetReorderDepth(), 1100, "Wrong reorder depth");
+    TcpOptionSack::SackList sackList = rxBuf.GetSackList();
+    NS_TEST_ASSERT_MSG_EQ(sackList.size(), 1, "SACK list should contain one element");
+    NS_TEST_ASSERT_MSG_EQ(sackList.front().first,
+                          SequenceNumber32(101),
+                          "SACK block different than expected");
+    NS_TEST_ASSERT_MSG_EQ(sackList.front().second,
+                          SequenceNumber32(1101),
+                          "SACK block different than expected");
+
+    // A segment overlapping the range on both sides is trimmed
+    h.SetSequenceNumber(SequenceNumber32(1051));
+    rxBuf.Add(MakePacket(1051, 100), h);
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Size(), 1050, "Overlapped bytes buffered twice");
+    // A segment embedding a range replaces it
+    h.SetSequenceNumber(SequenceNumber32(1301));
+    rxBuf.Add(MakePacket(1301, 50), h);
+    h.SetSequenceNumber(SequenceNumber32(1251));
+    rxBuf.Add(MakePacket(1251, 200), h);
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Size(), 1250, "Embedded range not replaced");
+    sackList = rxBuf.GetSackList();
+    NS_TEST_ASSERT_MSG_EQ(sackList.size(), 2, "SACK list should contain two elements");
+    NS_TEST_ASSERT_MSG_EQ(sackList.front().first,
+                          SequenceNumber32(1251),
+                          "SACK block different than expected");
+    NS_TEST_ASSERT_MSG_EQ(sackList.front().second,
+                          SequenceNumber32(1451),
+                          "SACK block different than expected");
+
+    // Filling the hole delivers the first range at once
+    h.SetSequenceNumber(SequenceNumber32(1));
+    rxBuf.Add(MakePacket(1, 100), h);
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.NextRxSequence(),
+                          SequenceNumber32(1151),
+                          "Sequence number differs from expected");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Available(), 1150, "Wrong available bytes");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.GetOutOfOrderSize(), 200, "Wrong out-of-order size");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.GetReorderDepth(), 300, "Wrong reorder depth");
+
+    // The data is extracted in order, across the segment boundaries
+    uint32_t seq = 1;
+    for (uint32_t size : {30, 170, 950})
+    {
+        Ptr<Packet> p = rxBuf.Extract(size);
+        NS_TEST_ASSERT_MSG_EQ(p->GetSize(), size, "Wrong extracted size");
+        std::vector<uint8_t> data(size);
+        p->CopyData(data.data(), size);
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(data[i]),
+                                  static_cast<uint8_t>(seq + i),
+                                  "Wrong byte at sequence number " << seq + i);
+        }
+        seq += size;
+    }
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Available(), 0, "Wrong available bytes");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Size(), 200, "Wrong buffer size");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Extract(100), nullptr, "Out-of-order data extracted");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Extract(0), nullptr, "Out-of-order data extracted");
+
+    // The rest is delivered when the last hole is filled
+    h.SetSequenceNumber(SequenceNumber32(1151));
+    rxBuf.Add(MakePacket(1151, 100), h);
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Available(), 300, "Wrong available bytes");
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.GetSackList().size(), 0, "SACK list should be empty");
+    Ptr<Packet> p = rxBuf.Extract(1000);
+    NS_TEST_ASSERT_MSG_EQ(p->GetSize(), 300, "Wrong extracted size");
+    std::vector<uint8_t> data(300);
+    p->CopyData(data.data(), 300);
+    for (uint32_t i = 0; i < 300; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(data[i]),
+                              static_cast<uint8_t>(1151 + i),
+                              "Wrong byte at sequence number " << 1151 + i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(rxBuf.Size(), 0, "Buffer should be empty");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown()
 {
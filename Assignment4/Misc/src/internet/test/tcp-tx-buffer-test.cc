@@ -20,6 +20,8 @@
 #include "ns3/tcp-tx-buffer.h"
 #include "ns3/test.h"
 
+#include <algorithm>
+#include <deque>
 #include <limits>
 
 using namespace ns3;
@@ -430,6 +432,276 @@ TcpTxBufferTestCase::DoTeardown()
 {
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the scoreboard of the TcpTxBuffer against a full scan of the
+ * segments, while they are SACKed out of order, marked lost and retransmitted
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+  public:
+    /** \brief Constructor */
+    TcpTxBufferScoreboardTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** \brief A segment of the reference scoreboard */
+    struct Segment
+    {
+        SequenceNumber32 start; //!< First sequence number
+        bool sacked{false};     //!< Whether the segment is SACKed
+        bool lost{false};       //!< Whether the segment is marked lost
+        bool retrans{false};    //!< Whether the segment is retransmitted
+    };
+
+    /**
+     * \brief SACK a segment, with the block of the SACKed segments around it
+     * \param index The index of the segment in the reference scoreboard
+     */
+    void Sack(uint32_t index);
+    /**
+     * \brief Mark the segments lost, scanning all the segments from the
+     * highest SACKed one down to the head
+     */
+    void MarkLost();
+    /**
+     * \brief Acknowledge the head segment, and the SACKed segments after it
+     */
+    void AckHead();
+    /**
+     * \brief Check the lost segments, the next segment and the bytes in flight
+     * \param step The step of the test
+     */
+    void Check(uint32_t step);
+    /**
+     * \brief Callback to provide a value of receiver window
+     * \returns the receiver window size
+     */
+    uint32_t GetRWnd() const;
+
+    Ptr<TcpTxBuffer> m_txBuf;       //!< The buffer under test
+    std::deque<Segment> m_segments; //!< The reference scoreboard
+    SequenceNumber32 m_highestSack; //!< First sequence of the highest SACKed segment
+    bool m_highestSackValid{false}; //!< Whether a segment is SACKed
+    uint32_t m_segmentSize{100};    //!< Segment size
+    uint32_t m_dupAckThresh{3};     //!< DupAck threshold
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase()
+    : TestCase("TcpTxBuffer scoreboard against a full scan")
+{
+}
+
+uint32_t
+TcpTxBufferScoreboardTestCase::GetRWnd() const
+{
+    // Assume unlimited receiver window
+    return std::numeric_limits<uint32_t>::max();
+}
+
+void
+TcpTxBufferScoreboardTestCase::Sack(uint32_t index)
+{
+    m_segments[index].sacked = true;
+    m_segments[index].lost = false;
+    // As in Update(), the highest SACK also moves to a segment just below it
+    if (!m_highestSackValid || m_highestSack <= m_segments[index].start + m_segmentSize)
+    {
+        m_highestSack = m_segments[index].start;
+        m_highestSackValid = true;
+    }
+    MarkLost();
+
+    // The receiver reports the block holding the segment
+    uint32_t first = index;
+    while (first > 0 && m_segments[first - 1].sacked)
+    {
+        first--;
+    }
+    uint32_t last = index + 1;
+    while (last < m_segments.size() && m_segments[last].sacked)
+    {
+        last++;
+    }
+    Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack>();
+    sack->AddSackBlock(
+        TcpOptionSack::SackBlock(m_segments[first].start,
+                                 m_segments[last - 1].start + m_segmentSize));
+    m_txBuf->Update(sack->GetSackList());
+}
+
+void
+TcpTxBufferScoreboardTestCase::MarkLost()
+{
+    uint32_t sacked = 0;
+    for (uint32_t i = (m_highestSack - m_segments.front().start) / m_segmentSize; i > 0; i--)
+    {
+        Segment& segment = m_segments[i];
+        if (segment.sacked)
+        {
+            sacked++;
+        }
+        if (sacked >= m_dupAckThresh && !segment.sacked)
+        {
+            segment.lost = true;
+        }
+    }
+    if (sacked >= m_dupAckThresh)
+    {
+        m_segments.front().lost = true;
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::AckHead()
+{
+    SequenceNumber32 ack;
+    do
+    {
+        ack = m_segments.front().start + m_segmentSize;
+        m_segments.pop_front();
+    } while (!m_segments.empty() && m_segments.front().sacked);
+
+    if (m_highestSack < ack)
+    {
+        m_highestSackValid = false;
+    }
+    m_txBuf->DiscardUpTo(ack);
+}
+
+void
+TcpTxBufferScoreboardTestCase::Check(uint32_t step)
+{
+    // Bytes sent, less those SACKed or lost, plus those retransmitted
+    uint32_t inFlight = 0;
+    for (const auto& segment : m_segments)
+    {
+        // A lost segment is only reported below the highest SACK
+        bool lost = segment.lost && m_highestSackValid && segment.start < m_highestSack;
+        NS_TEST_ASSERT_MSG_EQ(m_txBuf->IsLost(segment.start),
+                              lost,
+                              "Wrong IsLost(" << segment.start << ") at step " << step);
+        NS_TEST_ASSERT_MSG_EQ(m_txBuf->IsLost(segment.start + m_segmentSize / 2),
+                              lost,
+                              "Wrong IsLost inside " << segment.start << " at step " << step);
+        if (!segment.sacked && !segment.lost)
+        {
+            inFlight += m_segmentSize;
+        }
+        if (segment.retrans)
+        {
+            inFlight += m_segmentSize;
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_txBuf->BytesInFlight(),
+                          inFlight,
+                          "Wrong BytesInFlight at step " << step);
+
+    // NextSeg returns the first lost segment not retransmitted yet or, in
+    // recovery, the first segment neither SACKed nor retransmitted
+    for (bool isRecovery : {false, true})
+    {
+        auto segment = std::find_if(m_segments.begin(), m_segments.end(), [](const Segment& s) {
+            return !s.retrans && !s.sacked && s.lost;
+        });
+        if (segment == m_segments.end() && isRecovery)
+        {
+            segment = std::find_if(m_segments.begin(), m_segments.end(), [](const Segment& s) {
+                return !s.retrans && !s.sacked;
+            });
+        }
+        SequenceNumber32 seq;
+        SequenceNumber32 seqHigh;
+        bool found = m_txBuf->NextSeg(&seq, &seqHigh, isRecovery);
+        NS_TEST_ASSERT_MSG_EQ(found,
+                              (segment != m_segments.end()),
+                              "Wrong NextSeg result at step " << step << " in recovery "
+                                                              << isRecovery);
+        if (found)
+        {
+            NS_TEST_ASSERT_MSG_EQ(seq,
+                                  segment->start,
+                                  "Wrong NextSeg at step " << step << " in recovery "
+                                                           << isRecovery);
+        }
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun()
+{
+    const uint32_t nSegments = 200;
+    m_txBuf = CreateObject<TcpTxBuffer>();
+    m_txBuf->SetRWndCallback(MakeCallback(&TcpTxBufferScoreboardTestCase::GetRWnd, this));
+    m_txBuf->SetHeadSequence(SequenceNumber32(1));
+    m_txBuf->SetSegmentSize(m_segmentSize);
+    m_txBuf->SetDupAckThresh(m_dupAckThresh);
+    m_txBuf->Add(Create<Packet>(nSegments * m_segmentSize));
+    for (uint32_t i = 0; i < nSegments; i++)
+    {
+        SequenceNumber32 seq(1 + i * m_segmentSize);
+        m_txBuf->CopyFromSequence(m_segmentSize, seq);
+        m_segments.push_back(Segment{seq});
+    }
+
+    // The head, a burst and every tenth segment are dropped; the others
+    // arrive reordered by groups of eight, and the retransmissions arrive
+    // after five other segments
+    std::deque<SequenceNumber32> arrivals;
+    for (uint32_t group = 0; group < nSegments; group += 8)
+    {
+        for (uint32_t i = std::min(group + 8, nSegments); i-- > group;)
+        {
+            if (i != 0 && i % 10 != 3 && (i < 50 || i >= 55))
+            {
+                arrivals.push_back(SequenceNumber32(1 + i * m_segmentSize));
+            }
+        }
+    }
+
+    uint32_t step = 0;
+    Check(step);
+    while (!arrivals.empty() && !m_segments.empty())
+    {
+        SequenceNumber32 seq = arrivals.front();
+        arrivals.pop_front();
+        if (seq >= m_segments.front().start)
+        {
+            uint32_t index = (seq - m_segments.front().start) / m_segmentSize;
+            if (index == 0)
+            {
+                AckHead();
+            }
+            else if (!m_segments[index].sacked)
+            {
+                Sack(index);
+            }
+        }
+        Check(++step);
+
+        // Retransmit the next lost segment
+        SequenceNumber32 next;
+        SequenceNumber32 nextHigh;
+        if (!m_segments.empty() && m_txBuf->NextSeg(&next, &nextHigh, false))
+        {
+            m_txBuf->CopyFromSequence(m_segmentSize, next);
+            m_segments[(next - m_segments.front().start) / m_segmentSize].retrans = true;
+            arrivals.insert(arrivals.begin() + std::min<std::size_t>(5, arrivals.size()), next);
+            Check(++step);
+        }
+    }
+
+    // Too few segments are SACKed above the last hole to mark it lost: the
+    // retransmission timeout would recover it
+    NS_TEST_EXPECT_MSG_EQ(m_segments.size(), 7, "Wrong segments left after the last hole");
+    m_txBuf->DiscardUpTo(SequenceNumber32(1 + nSegments * m_segmentSize));
+    NS_TEST_EXPECT_MSG_EQ(m_txBuf->Size(), 0, "Data inside the buffer");
+    m_txBuf = nullptr;
+}
+
 /**
  * \ingroup internet-test
  *
@@ -442,6 +714,7 @@ class TcpTxBufferTestSuite : public TestSuite
         : TestSuite("tcp-tx-buffer", Type::UNIT)
     {
         AddTestCase(new TcpTxBufferTestCase, TestCase::Duration::QUICK);
+        AddTestCase(new TcpTxBufferScoreboardTestCase, TestCase::Duration::QUICK);
     }
 };
 
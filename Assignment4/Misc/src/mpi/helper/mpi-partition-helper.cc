@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mpi-partition-helper.h"
+
+#include "ns3/assert.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <set>
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::MpiPartitionHelper.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MpiPartitionHelper");
+
+namespace
+{
+
+/**
+ * Find the representative of a node in a union-find forest.
+ * \param [in,out] parent The forest.
+ * \param [in] node The node.
+ * \return The representative.
+ */
+uint32_t
+FindGroup(std::vector<uint32_t>& parent, uint32_t node)
+{
+    while (parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+/**
+ * Merge the groups of two nodes.
+ * \param [in,out] parent The forest.
+ * \param [in] a The first node.
+ * \param [in] b The second node.
+ */
+void
+MergeGroups(std::vector<uint32_t>& parent, uint32_t a, uint32_t b)
+{
+    a = FindGroup(parent, a);
+    b = FindGroup(parent, b);
+    if (a != b)
+    {
+        parent[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+} // namespace
+
+MpiPartitionHelper::MpiPartitionHelper()
+    : m_tolerance(0.1),
+      m_lookAhead(Time::Max()),
+      m_cutCount(0),
+      m_cutWeight(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+std::map<TypeId, MpiPartitionHelper::RemoteChannelCallback>&
+MpiPartitionHelper::GetRemoteChannels()
+{
+    static std::map<TypeId, RemoteChannelCallback> remoteChannels;
+    return remoteChannels;
+}
+
+void
+MpiPartitionHelper::RegisterRemoteChannel(TypeId type, RemoteChannelCallback callback)
+{
+    GetRemoteChannels()[type] = callback;
+}
+
+void
+MpiPartitionHelper::UnregisterRemoteChannel(TypeId type)
+{
+    GetRemoteChannels().erase(type);
+}
+
+void
+MpiPartitionHelper::SetNodeWeight(Ptr<Node> node, double weight)
+{
+    NS_LOG_FUNCTION(this << node << weight);
+    NS_ASSERT_MSG(weight >= 0, "Negative node weight");
+    m_nodeWeights[node] = weight;
+}
+
+void
+MpiPartitionHelper::SetChannelWeight(Ptr<Channel> channel, double weight)
+{
+    NS_LOG_FUNCTION(this << channel << weight);
+    NS_ASSERT_MSG(weight >= 0, "Negative link weight");
+    m_channelWeights[channel] = weight;
+}
+
+void
+MpiPartitionHelper::SetImbalanceTolerance(double tolerance)
+{
+    NS_LOG_FUNCTION(this << tolerance);
+    NS_ASSERT_MSG(tolerance >= 0, "Negative imbalance tolerance");
+    m_tolerance = tolerance;
+}
+
+void
+MpiPartitionHelper::Partition(NodeContainer nodes, uint32_t nRanks)
+{
+    NS_LOG_FUNCTION(this << nRanks);
+    NS_ASSERT_MSG(nRanks > 0, "At least one rank is needed");
+
+    uint32_t nNodes = nodes.GetN();
+    std::map<uint32_t, uint32_t> index;
+    std::vector<double> nodeWeights(nNodes);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        index[node->GetId()] = i;
+        auto weight = m_nodeWeights.find(node);
+        nodeWeights[i] =
+            weight != m_nodeWeights.end() ? weight->second : 1.0 + node->GetNDevices();
+    }
+
+    // Glue the nodes sharing a channel which cannot be cut, and list the
+    // links which can
+    std::vector<uint32_t> glued(nNodes);
+    std::iota(glued.begin(), glued.end(), 0);
+    std::vector<Link> links;
+    std::set<Ptr<Channel>> visited;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); ++j)
+        {
+            Ptr<Channel> channel = node->GetDevice(j)->GetChannel();
+            if (!channel || !visited.insert(channel).second)
+            {
+                continue;
+            }
+            std::vector<uint32_t> members;
+            for (std::size_t k = 0; k < channel->GetNDevices(); ++k)
+            {
+                Ptr<NetDevice> device = channel->GetDevice(k);
+                auto member = device && device->GetNode() ? index.find(device->GetNode()->GetId())
+                                                            : index.end();
+                if (member != index.end())
+                {
+                    members.push_back(member->second);
+                }
+            }
+            if (members.size() < 2)
+            {
+                continue;
+            }
+            TimeValue delay;
+            if (members.size() == 2 && channel->GetNDevices() == 2 &&
+                channel->GetAttributeFailSafe("Delay", delay) &&
+                delay.Get().IsStrictlyPositive() &&
+                GetRemoteChannels().count(channel->GetInstanceTypeId()) > 0)
+            {
+                auto weight = m_channelWeights.find(channel);
+                links.push_back({channel,
+                                 members[0],
+                                 members[1],
+                                 delay.Get(),
+                                 weight != m_channelWeights.end() ? weight->second : 1.0});
+                continue;
+            }
+            for (auto member : members)
+            {
+                MergeGroups(glued, members[0], member);
+            }
+        }
+    }
+
+    // Choose the largest lookahead for which the groups of nodes left can
+    // be balanced: only the links at least this long are cut
+    double total = std::accumulate(nodeWeights.begin(), nodeWeights.end(), 0.0);
+    double maxLoad = (1 + m_tolerance) * total / nRanks;
+    std::vector<Time> delays;
+    for (const auto& link : links)
+    {
+        delays.push_back(link.delay);
+    }
+    std::sort(delays.begin(), delays.end(), std::greater<>());
+    delays.erase(std::unique(delays.begin(), delays.end()), delays.end());
+    Time threshold = delays.empty() ? Time(0) : delays.back();
+    for (const auto& candidate : delays)
+    {
+        if (nRanks == 1)
+        {
+            break;
+        }
+        std::vector<uint32_t> parent = glued;
+        for (const auto& link : links)
+        {
+            if (link.delay < candidate)
+            {
+                MergeGroups(parent, link.a, link.b);
+            }
+        }
+        std::vector<double> weights(nNodes, 0);
+        uint32_t nGroups = 0;
+        for (uint32_t i = 0; i < nNodes; ++i)
+        {
+            weights[FindGroup(parent, i)] += nodeWeights[i];
+            nGroups += parent[i] == i ? 1 : 0;
+        }
+        if (nGroups >= nRanks && *std::max_element(weights.begin(), weights.end()) <= maxLoad)
+        {
+            threshold = candidate;
+            break;
+        }
+    }
+    NS_LOG_INFO("cutting links with a delay of at least " << threshold.As(Time::S));
+
+    // Build the graph of the groups of nodes
+    std::vector<uint32_t> parent = glued;
+    for (const auto& link : links)
+    {
+        if (link.delay < threshold)
+        {
+            MergeGroups(parent, link.a, link.b);
+        }
+    }
+    std::vector<uint32_t> group(nNodes);
+    std::map<uint32_t, uint32_t> groupIndex;
+    std::vector<double> groupWeights;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        auto inserted = groupIndex.insert({FindGroup(parent, i), groupWeights.size()});
+        if (inserted.second)
+        {
+            groupWeights.push_back(0);
+        }
+        group[i] = inserted.first->second;
+        groupWeights[group[i]] += nodeWeights[i];
+    }
+    std::vector<std::map<uint32_t, double>> adjacency(groupWeights.size());
+    for (const auto& link : links)
+    {
+        uint32_t a = group[link.a];
+        uint32_t b = group[link.b];
+        if (a != b)
+        {
+            adjacency[a][b] += link.weight;
+            adjacency[b][a] += link.weight;
+        }
+    }
+    std::vector<std::vector<std::pair<uint32_t, double>>> groupLinks(groupWeights.size());
+    for (std::size_t i = 0; i < adjacency.size(); ++i)
+    {
+        groupLinks[i].assign(adjacency[i].begin(), adjacency[i].end());
+    }
+
+    std::vector<uint32_t> part = Split(groupWeights, groupLinks, nRanks);
+
+    // Apply the partition
+    m_loads.assign(nRanks, 0);
+    m_nodeCounts.assign(nRanks, 0);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        uint32_t rank = part[group[i]];
+        nodes.Get(i)->SetAttribute("SystemId", UintegerValue(rank));
+        m_loads[rank] += nodeWeights[i];
+        m_nodeCounts[rank]++;
+    }
+    m_lookAhead = Time::Max();
+    m_cutCount = 0;
+    m_cutWeight = 0;
+    for (const auto& link : links)
+    {
+        if (part[group[link.a]] == part[group[link.b]])
+        {
+            continue;
+        }
+        m_lookAhead = Min(m_lookAhead, link.delay);
+        m_cutCount++;
+        m_cutWeight += link.weight;
+        RemoteChannelCallback replace = GetRemoteChannels()[link.channel->GetInstanceTypeId()];
+        if (!replace.IsNull())
+        {
+            replace(link.channel);
+        }
+    }
+}
+
+std::vector<uint32_t>
+MpiPartitionHelper::Split(const std::vector<double>& weights,
+                          const std::vector<std::vector<std::pair<uint32_t, double>>>& links,
+                          uint32_t nParts) const
+{
+    NS_LOG_FUNCTION(this << nParts);
+    uint32_t nGroups = weights.size();
+    std::vector<uint32_t> part(nGroups, 0);
+    nParts = std::min(nParts, nGroups);
+    if (nParts <= 1)
+    {
+        return part;
+    }
+
+    // Walk the groups breadth first and cut the walk into parts of similar
+    // weight, so that each part starts as a connected region
+    std::vector<uint32_t> order;
+    std::vector<bool> visited(nGroups, false);
+    for (uint32_t start = 0; start < nGroups; ++start)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+        std::queue<uint32_t> pending;
+        pending.push(start);
+        visited[start] = true;
+        while (!pending.empty())
+        {
+            uint32_t current = pending.front();
+            pending.pop();
+            order.push_back(current);
+            for (const auto& [next, weight] : links[current])
+            {
+                if (!visited[next])
+                {
+                    visited[next] = true;
+                    pending.push(next);
+                }
+            }
+        }
+    }
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    std::vector<double> loads(nParts, 0);
+    std::vector<uint32_t> counts(nParts, 0);
+    uint32_t current = 0;
+    double cumulated = 0;
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        // Leave at least one group for each of the next parts
+        if (current + 1 < nParts && counts[current] > 0 &&
+            (cumulated + weights[order[i]] / 2 > total * (current + 1) / nParts ||
+             order.size() - i == nParts - current - 1))
+        {
+            current++;
+        }
+        part[order[i]] = current;
+        loads[current] += weights[order[i]];
+        counts[current]++;
+        cumulated += weights[order[i]];
+    }
+
+    // Move the groups on the boundary to the neighbour part they are most
+    // connected to, when this reduces the cut without breaking the balance,
+    // or improves the balance without increasing the cut
+    double maxLoad = (1 + m_tolerance) * total / nParts;
+    for (uint32_t pass = 0; pass < 16; ++pass)
+    {
+        bool moved = false;
+        for (uint32_t v = 0; v < nGroups; ++v)
+        {
+            uint32_t from = part[v];
+            if (counts[from] == 1)
+            {
+                continue;
+            }
+            std::map<uint32_t, double> connection;
+            for (const auto& [next, weight] : links[v])
+            {
+                connection[part[next]] += weight;
+            }
+            uint32_t best = from;
+            double bestGain = 0;
+            for (const auto& [to, weight] : connection)
+            {
+                if (to == from)
+                {
+                    continue;
+                }
+                double gain = weight - connection[from];
+                double load = loads[to] + weights[v];
+                bool balanced = load <= maxLoad || load < loads[from];
+                if (!balanced || gain < bestGain || (gain == 0 && load >= loads[from]))
+                {
+                    continue;
+                }
+                if (best == from || gain > bestGain)
+                {
+                    best = to;
+                    bestGain = gain;
+                }
+            }
+            if (best != from)
+            {
+                part[v] = best;
+                loads[from] -= weights[v];
+                loads[best] += weights[v];
+                counts[from]--;
+                counts[best]++;
+                moved = true;
+            }
+        }
+        if (!moved)
+        {
+            break;
+        }
+    }
+    return part;
+}
+
+Time
+MpiPartitionHelper::GetLookAhead() const
+{
+    return m_lookAhead;
+}
+
+uint32_t
+MpiPartitionHelper::GetCutCount() const
+{
+    return m_cutCount;
+}
+
+double
+MpiPartitionHelper::GetLoad(uint32_t rank) const
+{
+    NS_ASSERT(rank < m_loads.size());
+    return m_loads[rank];
+}
+
+double
+MpiPartitionHelper::GetImbalance() const
+{
+    if (m_loads.empty())
+    {
+        return 0;
+    }
+    double total = std::accumulate(m_loads.begin(), m_loads.end(), 0.0);
+    if (total == 0)
+    {
+        return 0;
+    }
+    return *std::max_element(m_loads.begin(), m_loads.end()) * m_loads.size() / total - 1;
+}
+
+void
+MpiPartitionHelper::Report(std::ostream& os) const
+{
+    os << m_loads.size() << " ranks, " << m_cutCount << " links cut (weight " << m_cutWeight
+       << "), lookahead ";
+    if (m_cutCount > 0)
+    {
+        os << m_lookAhead.As(Time::S);
+    }
+    else
+    {
+        os << "unbounded";
+    }
+    os << ", imbalance " << GetImbalance() * 100 << "%" << std::endl;
+    for (std::size_t rank = 0; rank < m_loads.size(); ++rank)
+    {
+        os << "  rank " << rank << ": " << m_nodeCounts[rank] << " nodes, load " << m_loads[rank]
+           << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MPI_PARTITION_HELPER_H
+#define NS3_MPI_PARTITION_HELPER_H
+
+#include "ns3/callback.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/type-id.h"
+
+#include <map>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::MpiPartitionHelper.
+ */
+
+namespace ns3
+{
+
+class Channel;
+class Node;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Split a built topology between the MPI ranks.
+ *
+ * Instead of creating each node with its system id and letting
+ * PointToPointHelper create remote channels, a script can build the whole
+ * topology as for a sequential simulation, then call Partition() before
+ * installing the applications:
+ *
+ * \code
+ *   MpiPartitionHelper partitioner;
+ *   partitioner.Partition(NodeContainer::GetGlobal(), MpiInterface::GetSize());
+ *   partitioner.Report(std::cout);
+ * \endcode
+ *
+ * Only the channels joining two devices, with a positive \c Delay
+ * attribute, and a remote counterpart registered with
+ * RegisterRemoteChannel() can be cut; the point to point module registers
+ * ns3::PointToPointChannel.  The nodes sharing any other channel stay on the
+ * same rank.
+ *
+ * The partitioner first chooses the largest lookahead for which the
+ * topology can still be balanced: links with a smaller delay are never
+ * cut.  It then splits the remaining groups of nodes into balanced
+ * partitions with a breadth first walk, and refines them by moving the
+ * nodes on the boundary to reduce the weight of the cut links.  Nodes are
+ * weighted by their expected event rate, one plus their number of devices
+ * by default, and links by their expected packet rate, one by default.
+ *
+ * Finally, the \c SystemId of each node is set, and the cut channels are
+ * replaced by their remote counterpart.
+ *
+ * The result only depends on the topology and the weights, so every rank
+ * computes the same partition.
+ */
+class MpiPartitionHelper
+{
+  public:
+    /**
+     * Replace a local channel by its remote counterpart, attaching the
+     * same devices.
+     */
+    typedef Callback<void, Ptr<Channel>> RemoteChannelCallback;
+
+    /** Constructor. */
+    MpiPartitionHelper();
+
+    /**
+     * Register how to replace the channels of a type cut between ranks.
+     * \param [in] type The channel type.
+     * \param [in] callback The callback replacing a channel, or a null
+     *             callback if the channel is already remote.
+     */
+    static void RegisterRemoteChannel(TypeId type, RemoteChannelCallback callback);
+    /**
+     * Unregister a channel type: its channels are no longer cut.
+     * \param [in] type The channel type.
+     */
+    static void UnregisterRemoteChannel(TypeId type);
+
+    /**
+     * Set the expected event rate of a node, in any unit.
+     * \param [in] node The node.
+     * \param [in] weight The weight of the node.
+     */
+    void SetNodeWeight(Ptr<Node> node, double weight);
+    /**
+     * Set the expected packet rate of a link, in any unit.
+     * \param [in] channel The channel.
+     * \param [in] weight The weight of the link.
+     */
+    void SetChannelWeight(Ptr<Channel> channel, double weight);
+    /**
+     * Set the load imbalance accepted in exchange for a larger lookahead.
+     * \param [in] tolerance The accepted excess of the most loaded rank
+     *             over the mean load, 0.1 by default.
+     */
+    void SetImbalanceTolerance(double tolerance);
+
+    /**
+     * Partition the nodes, set their system id and replace the cut channels.
+     * \param [in] nodes The nodes; should be all the nodes of the simulation.
+     * \param [in] nRanks The number of ranks.
+     */
+    void Partition(NodeContainer nodes, uint32_t nRanks);
+
+    /** \return The lookahead, or the maximum time if no link is cut. */
+    Time GetLookAhead() const;
+    /** \return The number of links cut between ranks. */
+    uint32_t GetCutCount() const;
+    /**
+     * \param [in] rank The rank.
+     * \return The sum of the weights of the nodes of the rank.
+     */
+    double GetLoad(uint32_t rank) const;
+    /** \return How much the most loaded rank exceeds the mean load. */
+    double GetImbalance() const;
+    /**
+     * Print the lookahead, the cut links and the load of each rank.
+     * \param [in,out] os The output stream.
+     */
+    void Report(std::ostream& os) const;
+
+  private:
+    /** A link which can be cut. */
+    struct Link
+    {
+        Ptr<Channel> channel; //!< The channel.
+        uint32_t a;           //!< Index of the first node.
+        uint32_t b;           //!< Index of the second node.
+        Time delay;           //!< The delay of the channel.
+        double weight;        //!< The weight of the link.
+    };
+
+    /**
+     * Split groups of nodes into balanced partitions.
+     * \param [in] weights The weight of each group.
+     * \param [in] links The links between groups, with their weight.
+     * \param [in] nParts The number of partitions.
+     * \return The partition of each group.
+     */
+    std::vector<uint32_t> Split(
+        const std::vector<double>& weights,
+        const std::vector<std::vector<std::pair<uint32_t, double>>>& links,
+        uint32_t nParts) const;
+
+    /** \return The registered channel types. */
+    static std::map<TypeId, RemoteChannelCallback>& GetRemoteChannels();
+
+    std::map<Ptr<Node>, double> m_nodeWeights;       //!< Weights set by the user.
+    std::map<Ptr<Channel>, double> m_channelWeights; //!< Weights set by the user.
+    double m_tolerance;                              //!< Accepted load imbalance.
+
+    Time m_lookAhead;                   //!< Lookahead of the last partition.
+    uint32_t m_cutCount;                //!< Links cut by the last partition.
+    double m_cutWeight;                 //!< Weight of the cut links.
+    std::vector<double> m_loads;        //!< Load of each rank.
+    std::vector<uint32_t> m_nodeCounts; //!< Number of nodes of each rank.
+};
+
+} // namespace ns3
+
+#endif /* NS3_MPI_PARTITION_HELPER_H */
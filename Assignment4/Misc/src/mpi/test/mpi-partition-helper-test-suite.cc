@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mpi-partition-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * MpiPartitionHelper test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief Check the partition of two clusters of nodes joined by a long
+ * link, one of them with a shared channel.
+ *
+ * Cluster A is a chain of nodes 0 to 3, cluster B a chain of nodes 4 to 7
+ * with a shared channel between nodes 5, 6 and 7.  The chain links last
+ * 1 ms, the link between nodes 3 and 4 lasts 10 ms.  SimpleChannel stands
+ * for a channel with a remote counterpart.
+ */
+class MpiPartitionHelperTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] nRanks The number of ranks.
+     * \param [in] tolerance The accepted load imbalance.
+     */
+    MpiPartitionHelperTestCase(uint32_t nRanks, double tolerance);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Record a channel replaced by the partitioner.
+     * \param [in] channel The channel.
+     */
+    static void Replace(Ptr<Channel> channel);
+
+    /**
+     * Join two nodes with a simple channel.
+     * \param [in] a The first node.
+     * \param [in] b The second node.
+     * \param [in] delay The delay of the channel.
+     * \return The channel.
+     */
+    Ptr<SimpleChannel> Link(Ptr<Node> a, Ptr<Node> b, Time delay);
+
+    uint32_t m_nRanks;                           //!< The number of ranks.
+    double m_tolerance;                          //!< The accepted load imbalance.
+    static std::vector<Ptr<Channel>> m_replaced; //!< The channels replaced.
+};
+
+std::vector<Ptr<Channel>> MpiPartitionHelperTestCase::m_replaced;
+
+MpiPartitionHelperTestCase::MpiPartitionHelperTestCase(uint32_t nRanks, double tolerance)
+    : TestCase("Check MpiPartitionHelper with " + std::to_string(nRanks) + " ranks"),
+      m_nRanks(nRanks),
+      m_tolerance(tolerance)
+{
+}
+
+void
+MpiPartitionHelperTestCase::Replace(Ptr<Channel> channel)
+{
+    m_replaced.push_back(channel);
+}
+
+Ptr<SimpleChannel>
+MpiPartitionHelperTestCase::Link(Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+    Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+    channel->SetAttribute("Delay", TimeValue(delay));
+    SimpleNetDeviceHelper helper;
+    helper.Install(a, channel);
+    helper.Install(b, channel);
+    return channel;
+}
+
+void
+MpiPartitionHelperTestCase::DoRun()
+{
+    MpiPartitionHelper::RegisterRemoteChannel(
+        SimpleChannel::GetTypeId(),
+        MakeCallback(&MpiPartitionHelperTestCase::Replace));
+    m_replaced.clear();
+
+    NodeContainer nodes(8);
+    for (uint32_t i = 0; i + 1 < 8; ++i)
+    {
+        Link(nodes.Get(i), nodes.Get(i + 1), MilliSeconds(i == 3 ? 10 : 1));
+    }
+    Ptr<SimpleChannel> lan = CreateObject<SimpleChannel>();
+    lan->SetAttribute("Delay", TimeValue(MilliSeconds(1)));
+    SimpleNetDeviceHelper helper;
+    helper.Install(NodeContainer(nodes.Get(5), nodes.Get(6), nodes.Get(7)), lan);
+
+    MpiPartitionHelper partitioner;
+    partitioner.SetImbalanceTolerance(m_tolerance);
+    partitioner.Partition(nodes, m_nRanks);
+
+    NS_TEST_EXPECT_MSG_EQ(nodes.Get(5)->GetSystemId(),
+                          nodes.Get(6)->GetSystemId(),
+                          "Nodes sharing a channel split");
+    NS_TEST_EXPECT_MSG_EQ(nodes.Get(5)->GetSystemId(),
+                          nodes.Get(7)->GetSystemId(),
+                          "Nodes sharing a channel split");
+    NS_TEST_EXPECT_MSG_NE(nodes.Get(0)->GetSystemId(),
+                          nodes.Get(7)->GetSystemId(),
+                          "Nodes not partitioned");
+    NS_TEST_EXPECT_MSG_EQ(m_replaced.size(),
+                          partitioner.GetCutCount(),
+                          "Cut links not replaced");
+    double total = 0;
+    for (uint32_t rank = 0; rank < m_nRanks; ++rank)
+    {
+        NS_TEST_EXPECT_MSG_GT(partitioner.GetLoad(rank), 0, "Empty rank " << rank);
+        total += partitioner.GetLoad(rank);
+    }
+    // One plus the number of devices of each node
+    NS_TEST_EXPECT_MSG_EQ(total, 25, "Wrong total load");
+
+    if (m_nRanks == 2)
+    {
+        // The long link can be cut: the clusters are the partitions
+        NS_TEST_EXPECT_MSG_EQ(partitioner.GetCutCount(), 1, "Expected a single cut link");
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ(nodes.Get(i)->GetSystemId(),
+                                  nodes.Get(0)->GetSystemId(),
+                                  "Cluster A split");
+            NS_TEST_EXPECT_MSG_EQ(nodes.Get(4 + i)->GetSystemId(),
+                                  nodes.Get(4)->GetSystemId(),
+                                  "Cluster B split");
+        }
+        NS_TEST_EXPECT_MSG_EQ(partitioner.GetLookAhead(), MilliSeconds(10), "Wrong lookahead");
+        NS_TEST_EXPECT_MSG_EQ_TOL(partitioner.GetImbalance(), 0.12, 1e-9, "Wrong imbalance");
+    }
+    else
+    {
+        // Three ranks cannot be balanced without cutting the short links
+        NS_TEST_EXPECT_MSG_GT(partitioner.GetCutCount(), 1, "Expected several cut links");
+        NS_TEST_EXPECT_MSG_EQ(partitioner.GetLookAhead(), MilliSeconds(1), "Wrong lookahead");
+    }
+
+    MpiPartitionHelper::UnregisterRemoteChannel(SimpleChannel::GetTypeId());
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * \brief The MpiPartitionHelper test suite.
+ */
+class MpiPartitionHelperTestSuite : public TestSuite
+{
+  public:
+    MpiPartitionHelperTestSuite()
+        : TestSuite("mpi-partition-helper", Type::UNIT)
+    {
+        AddTestCase(new MpiPartitionHelperTestCase(2, 0.25), TestCase::Duration::QUICK);
+        AddTestCase(new MpiPartitionHelperTestCase(3, 0.1), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization.
+static MpiPartitionHelperTestSuite g_mpiPartitionHelperTestSuite;
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "logical-process.h"
+
+#include "ns3/assert.h"
+#include "ns3/event-impl.h"
+#include "ns3/log.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::LogicalProcess.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LogicalProcess");
+
+LogicalProcess::LogicalProcess(SimulatorImpl* owner,
+                               uint32_t id,
+                               Ptr<Scheduler> scheduler,
+                               uint32_t inboxCapacity)
+    : m_owner(owner),
+      m_id(id),
+      m_events(scheduler),
+      m_uid(EventId::UID::VALID),
+      m_currentUid(EventId::UID::INVALID),
+      m_currentTs(0),
+      m_currentContext(Simulator::NO_CONTEXT),
+      m_eventCount(0),
+      m_stop(false),
+      m_sendSequence(0),
+      m_inbox(inboxCapacity)
+{
+    NS_LOG_FUNCTION(this << id << scheduler << inboxCapacity);
+}
+
+LogicalProcess::~LogicalProcess()
+{
+    NS_LOG_FUNCTION(this);
+    ReceiveMessages();
+    while (!m_events->IsEmpty())
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+        next.impl->Unref();
+    }
+}
+
+uint32_t
+LogicalProcess::GetId() const
+{
+    return m_id;
+}
+
+void
+LogicalProcess::SetScheduler(Ptr<Scheduler> scheduler)
+{
+    NS_LOG_FUNCTION(this << scheduler);
+    while (!m_events->IsEmpty())
+    {
+        scheduler->Insert(m_events->RemoveNext());
+    }
+    m_events = scheduler;
+}
+
+EventId
+LogicalProcess::Insert(uint64_t ts, uint32_t context, EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+LogicalProcess::InsertEvent(const Scheduler::Event& ev)
+{
+    m_events->Insert(ev);
+}
+
+void
+LogicalProcess::Post(uint64_t ts, uint32_t context, EventImpl* event, LogicalProcess* sender)
+{
+    Message message;
+    message.ev.impl = event;
+    message.ev.key.m_ts = ts;
+    message.ev.key.m_context = context;
+    message.ev.key.m_uid = EventId::UID::INVALID;
+    message.sender = sender->m_id;
+    message.sequence = sender->m_sendSequence++;
+    if (!m_inbox.TryPush(message))
+    {
+        std::unique_lock lock{m_overflowMutex};
+        m_overflow.push_back(message);
+    }
+}
+
+void
+LogicalProcess::ReceiveMessages()
+{
+    Message message;
+    while (m_inbox.TryPop(message))
+    {
+        m_received.push_back(message);
+    }
+    if (!m_overflow.empty())
+    {
+        std::unique_lock lock{m_overflowMutex};
+        m_received.insert(m_received.end(), m_overflow.begin(), m_overflow.end());
+        m_overflow.clear();
+    }
+    if (m_received.empty())
+    {
+        return;
+    }
+    // Number the events in an order which does not depend on which thread
+    // posted first
+    std::sort(m_received.begin(), m_received.end(), [](const Message& a, const Message& b) {
+        if (a.ev.key.m_ts != b.ev.key.m_ts)
+        {
+            return a.ev.key.m_ts < b.ev.key.m_ts;
+        }
+        if (a.sender != b.sender)
+        {
+            return a.sender < b.sender;
+        }
+        return a.sequence < b.sequence;
+    });
+    for (auto& received : m_received)
+    {
+        NS_ASSERT(received.ev.key.m_ts >= m_currentTs);
+        received.ev.key.m_uid = m_uid;
+        m_uid++;
+        m_events->Insert(received.ev);
+    }
+    m_received.clear();
+}
+
+void
+LogicalProcess::ProcessEvents(uint64_t end)
+{
+    while (!m_stop && !m_events->IsEmpty() && m_events->PeekNext().key.m_ts < end)
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+
+        m_owner->PreEventHook(
+            EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+        NS_ASSERT(next.key.m_ts >= m_currentTs);
+        m_eventCount++;
+
+        NS_LOG_LOGIC("handle " << next.key.m_ts);
+        m_currentTs = next.key.m_ts;
+        m_currentContext = next.key.m_context;
+        m_currentUid = next.key.m_uid;
+        next.impl->Invoke();
+        next.impl->Unref();
+    }
+}
+
+void
+LogicalProcess::Stop()
+{
+    m_stop = true;
+}
+
+void
+LogicalProcess::ClearStop()
+{
+    m_stop = false;
+}
+
+bool
+LogicalProcess::IsEmpty() const
+{
+    return m_events->IsEmpty();
+}
+
+uint64_t
+LogicalProcess::GetNextTs() const
+{
+    if (m_events->IsEmpty())
+    {
+        return MAXIMUM_TS;
+    }
+    return m_events->PeekNext().key.m_ts;
+}
+
+uint64_t
+LogicalProcess::GetCurrentTs() const
+{
+    return m_currentTs;
+}
+
+void
+LogicalProcess::SetCurrentTs(uint64_t ts)
+{
+    NS_ASSERT(ts >= m_currentTs);
+    m_currentTs = ts;
+}
+
+uint32_t
+LogicalProcess::GetContext() const
+{
+    return m_currentContext;
+}
+
+uint64_t
+LogicalProcess::GetEventCount() const
+{
+    return m_eventCount;
+}
+
+uint32_t
+LogicalProcess::GetNextUid() const
+{
+    return m_uid;
+}
+
+void
+LogicalProcess::SetNextUid(uint32_t uid)
+{
+    m_uid = uid;
+}
+
+bool
+LogicalProcess::IsExpired(const EventId& id) const
+{
+    return id.PeekEventImpl() == nullptr || id.GetTs() < m_currentTs ||
+           (id.GetTs() == m_currentTs && id.GetUid() <= m_currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+void
+LogicalProcess::Remove(const EventId& id)
+{
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    m_events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+}
+
+void
+LogicalProcess::RemoveAll(std::vector<Scheduler::Event>& events)
+{
+    while (!m_events->IsEmpty())
+    {
+        events.push_back(m_events->RemoveNext());
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOGICAL_PROCESS_H
+#define NS3_LOGICAL_PROCESS_H
+
+#include "ns3/event-id.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::LogicalProcess.
+ */
+
+namespace ns3
+{
+
+class SimulatorImpl;
+
+/**
+ * \ingroup mtp
+ * \brief A partition of a multithreaded simulation.
+ *
+ * A logical process owns the events of a subset of the nodes, and is
+ * executed by one worker thread at a time.  Its clock and its event
+ * uids are private: events scheduled by the nodes of the partition go
+ * straight to its own scheduler, while events sent by other partitions
+ * are posted to its inbox and merged between two time windows.
+ *
+ * Posted events are sorted by timestamp, sending partition and sending
+ * order before they are given a uid, so that the order of simultaneous
+ * events does not depend on the thread timing.
+ */
+class LogicalProcess
+{
+  public:
+    /** The largest timestamp, returned by GetNextTs() when no event is pending. */
+    static constexpr uint64_t MAXIMUM_TS = 0x7fffffffffffffffULL;
+
+    /**
+     * Constructor.
+     *
+     * \param [in] owner The simulator, notified before each event.
+     * \param [in] id The partition index.
+     * \param [in] scheduler The event scheduler.
+     * \param [in] inboxCapacity The number of events the inbox can hold
+     *             before falling back to a locked list.
+     */
+    LogicalProcess(SimulatorImpl* owner,
+                   uint32_t id,
+                   Ptr<Scheduler> scheduler,
+                   uint32_t inboxCapacity);
+    /** Destructor: releases the pending events. */
+    ~LogicalProcess();
+
+    /// Non-copyable.
+    LogicalProcess(const LogicalProcess&) = delete;
+    /**
+     * Non-copyable.
+     * \return The logical process.
+     */
+    LogicalProcess& operator=(const LogicalProcess&) = delete;
+
+    /** \return The partition index. */
+    uint32_t GetId() const;
+    /**
+     * Replace the scheduler, moving the pending events to the new one.
+     * \param [in] scheduler The new event scheduler.
+     */
+    void SetScheduler(Ptr<Scheduler> scheduler);
+
+    /**
+     * Insert an event in the scheduler, with a new uid.
+     * Must only be called by the thread running this partition, or while
+     * no partition runs.
+     *
+     * \param [in] ts The timestamp of the event.
+     * \param [in] context The context of the event.
+     * \param [in] event The event.
+     * \return The id of the event.
+     */
+    EventId Insert(uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Insert an event keeping its key, to move it between partitions.
+     * \param [in] ev The event.
+     */
+    void InsertEvent(const Scheduler::Event& ev);
+
+    /**
+     * Post an event sent by another partition.  Thread safe.
+     *
+     * \param [in] ts The timestamp of the event.
+     * \param [in] context The context of the event.
+     * \param [in] event The event.
+     * \param [in] sender The sending partition.
+     */
+    void Post(uint64_t ts, uint32_t context, EventImpl* event, LogicalProcess* sender);
+    /**
+     * Merge the posted events in the scheduler.  Must not run concurrently
+     * with Post().
+     */
+    void ReceiveMessages();
+
+    /**
+     * Execute the events older than a time.
+     * Stops early if Stop() is called.
+     * \param [in] end The end of the time window, exclusive.
+     */
+    void ProcessEvents(uint64_t end);
+    /** Stop processing the current time window. */
+    void Stop();
+    /** Clear the stop request. */
+    void ClearStop();
+
+    /** \return \c true if no event is pending. */
+    bool IsEmpty() const;
+    /** \return The timestamp of the next event, or the maximum time if there is none. */
+    uint64_t GetNextTs() const;
+    /** \return The timestamp of the current event. */
+    uint64_t GetCurrentTs() const;
+    /**
+     * Move the clock forward, when the partition is idle.
+     * \param [in] ts The new time, no earlier than the current time.
+     */
+    void SetCurrentTs(uint64_t ts);
+    /** \return The context of the current event. */
+    uint32_t GetContext() const;
+    /** \return The number of events executed. */
+    uint64_t GetEventCount() const;
+    /** \return The next uid this partition will use. */
+    uint32_t GetNextUid() const;
+    /**
+     * Set the next uid this partition will use.
+     * \param [in] uid The uid.
+     */
+    void SetNextUid(uint32_t uid);
+
+    /**
+     * \param [in] id The event id, owned by this partition.
+     * \return \c true if the event has run, has been cancelled or removed.
+     */
+    bool IsExpired(const EventId& id) const;
+    /**
+     * Remove an event owned by this partition from the scheduler.
+     * \param [in] id The event id.
+     */
+    void Remove(const EventId& id);
+    /**
+     * Move all pending events to a vector, emptying the scheduler.
+     * \param [out] events The events.
+     */
+    void RemoveAll(std::vector<Scheduler::Event>& events);
+
+  private:
+    /** An event posted by another partition. */
+    struct Message
+    {
+        Scheduler::Event ev; //!< The event; the uid is not set yet.
+        uint32_t sender;     //!< The sending partition.
+        uint64_t sequence;   //!< The sending order within the sender.
+    };
+
+    SimulatorImpl* m_owner;    //!< The simulator.
+    uint32_t m_id;             //!< The partition index.
+    Ptr<Scheduler> m_events;   //!< The event scheduler.
+    uint32_t m_uid;            //!< Next event uid.
+    uint32_t m_currentUid;     //!< Uid of the current event.
+    uint64_t m_currentTs;      //!< Timestamp of the current event.
+    uint32_t m_currentContext; //!< Context of the current event.
+    uint64_t m_eventCount;     //!< Number of events executed.
+    bool m_stop;               //!< Stop processing the current time window.
+    uint64_t m_sendSequence;   //!< Number of events posted to other partitions.
+
+    MpscQueue<Message> m_inbox;      //!< Events posted by other partitions.
+    std::mutex m_overflowMutex;      //!< Protects m_overflow.
+    std::vector<Message> m_overflow; //!< Posted events which did not fit in the inbox.
+    std::vector<Message> m_received; //!< Scratch space used to sort posted events.
+};
+
+} // namespace ns3
+
+#endif /* NS3_LOGICAL_PROCESS_H */
@@ -0,0 +1,746 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "logical-process.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <queue>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+namespace
+{
+
+/** The partition executed by the current thread, if any. */
+thread_local LogicalProcess* t_current = nullptr;
+
+/** Number of times a worker polls a barrier before yielding its core. */
+constexpr uint32_t BARRIER_SPINS = 4096;
+
+} // namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("MaxThreads",
+                          "The maximum number of worker threads, 0 for one per core.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxThreads),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Partitions",
+                          "The number of partitions to split the nodes into, 0 for one per "
+                          "thread.  More partitions than threads help balancing the load.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxPartitions),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MinLookAhead",
+                          "Links with a smaller delay are never cut between partitions.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_minLookAhead),
+                          MakeTimeChecker())
+            .AddAttribute("InboxCapacity",
+                          "The number of events each partition can receive from the others "
+                          "in one window before falling back to a locked list.",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_inboxCapacity),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_partitioned(false),
+      m_lookAhead(TimeStep(LogicalProcess::MAXIMUM_TS)),
+      m_nThreads(1),
+      m_windowEnd(0),
+      m_windowCount(0),
+      m_parallel(false),
+      m_finished(false),
+      m_stop(false),
+      m_nextPartition(0),
+      m_arrived(0),
+      m_generation(0),
+      m_processPhase(true)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitions.clear();
+    m_serial = nullptr;
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    NS_ASSERT_MSG(!m_parallel.load(std::memory_order_relaxed),
+                  "Cannot change the scheduler while the simulation runs");
+
+    m_schedulerFactory = schedulerFactory;
+    if (!m_serial)
+    {
+        m_serial = std::make_unique<LogicalProcess>(this,
+                                                    0xffffffff,
+                                                    schedulerFactory.Create<Scheduler>(),
+                                                    m_inboxCapacity);
+        return;
+    }
+    m_serial->SetScheduler(schedulerFactory.Create<Scheduler>());
+    for (auto& partition : m_partitions)
+    {
+        partition->SetScheduler(schedulerFactory.Create<Scheduler>());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Partition()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitioned = true;
+
+    m_nThreads = m_maxThreads;
+    if (m_nThreads == 0)
+    {
+        m_nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    uint32_t nPartitions = m_maxPartitions > 0 ? m_maxPartitions : m_nThreads;
+    uint32_t nNodes = NodeList::GetNNodes();
+
+    // Group the nodes which cannot be split: they share a channel which
+    // is not a delayed point to point link
+    std::vector<uint32_t> group(nNodes);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        group[i] = i;
+    }
+    auto find = [&group](uint32_t node) {
+        while (group[node] != node)
+        {
+            group[node] = group[group[node]];
+            node = group[node];
+        }
+        return node;
+    };
+    std::vector<std::vector<uint32_t>> links(nNodes);
+    std::vector<Ptr<Channel>> cuttable;
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        std::vector<uint32_t> nodes;
+        for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(j);
+            if (device && device->GetNode())
+            {
+                nodes.push_back(device->GetNode()->GetId());
+            }
+        }
+        if (nodes.size() < 2)
+        {
+            continue;
+        }
+        TimeValue delay;
+        TypeId::AttributeInformation info;
+        if (nodes.size() == 2 && channel->GetAttributeFailSafe("Delay", delay) &&
+            delay.Get().IsStrictlyPositive() && delay.Get() >= m_minLookAhead &&
+            channel->GetInstanceTypeId().LookupAttributeByName("DeepCopy", &info))
+        {
+            cuttable.push_back(channel);
+            links[nodes[0]].push_back(nodes[1]);
+            links[nodes[1]].push_back(nodes[0]);
+            continue;
+        }
+        for (auto node : nodes)
+        {
+            group[find(node)] = find(nodes[0]);
+        }
+    }
+
+    // Walk the groups breadth first, so that consecutive groups tend to be
+    // neighbours, and weight them by their number of devices
+    std::vector<std::vector<uint32_t>> members(nNodes);
+    std::vector<uint64_t> weight(nNodes, 0);
+    uint64_t totalWeight = 0;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        uint32_t root = find(i);
+        members[root].push_back(i);
+        weight[root] += 1 + NodeList::GetNode(i)->GetNDevices();
+        totalWeight += 1 + NodeList::GetNode(i)->GetNDevices();
+    }
+    std::vector<uint32_t> order;
+    std::vector<bool> visited(nNodes, false);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        uint32_t root = find(i);
+        if (visited[root])
+        {
+            continue;
+        }
+        std::queue<uint32_t> pending;
+        pending.push(root);
+        visited[root] = true;
+        while (!pending.empty())
+        {
+            uint32_t current = pending.front();
+            pending.pop();
+            order.push_back(current);
+            for (auto member : members[current])
+            {
+                for (auto neighbour : links[member])
+                {
+                    uint32_t next = find(neighbour);
+                    if (!visited[next])
+                    {
+                        visited[next] = true;
+                        pending.push(next);
+                    }
+                }
+            }
+        }
+    }
+
+    // Cut the walk into partitions of similar weight
+    nPartitions = std::max(std::min<uint32_t>(nPartitions, order.size()), 1U);
+    std::vector<uint32_t> groupPartition(nNodes, 0);
+    uint32_t partition = 0;
+    uint64_t cumulated = 0;
+    for (auto root : order)
+    {
+        groupPartition[root] = partition;
+        cumulated += weight[root];
+        if (partition + 1 < nPartitions && cumulated * nPartitions >= (partition + 1) * totalWeight)
+        {
+            partition++;
+        }
+    }
+    nPartitions = std::min(nPartitions, partition + 1);
+    m_nodePartition.resize(nNodes);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        m_nodePartition[i] = groupPartition[find(i)];
+    }
+
+    // The channels between partitions bound the lookahead, and must not
+    // share packet data between their two ends
+    for (const auto& channel : cuttable)
+    {
+        uint32_t a = channel->GetDevice(0)->GetNode()->GetId();
+        uint32_t b = channel->GetDevice(1)->GetNode()->GetId();
+        if (m_nodePartition[a] == m_nodePartition[b])
+        {
+            continue;
+        }
+        TimeValue delay;
+        channel->GetAttribute("Delay", delay);
+        m_lookAhead = Min(m_lookAhead, delay.Get());
+        channel->SetAttribute("DeepCopy", BooleanValue(true));
+    }
+
+    m_nThreads = std::min(m_nThreads, nPartitions);
+    for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+        auto scheduler = m_schedulerFactory.Create<Scheduler>();
+        auto logicalProcess =
+            std::make_unique<LogicalProcess>(this, i, scheduler, m_inboxCapacity);
+        logicalProcess->SetNextUid(m_serial->GetNextUid());
+        logicalProcess->SetCurrentTs(m_serial->GetCurrentTs());
+        m_partitions.push_back(std::move(logicalProcess));
+    }
+
+    // Move the events scheduled so far to their partition
+    std::vector<Scheduler::Event> events;
+    m_serial->RemoveAll(events);
+    for (const auto& ev : events)
+    {
+        GetLogicalProcess(ev.key.m_context)->InsertEvent(ev);
+    }
+
+    NS_LOG_INFO(nNodes << " nodes in " << nPartitions << " partitions on " << m_nThreads
+                       << " threads, lookahead " << m_lookAhead.As(Time::S));
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetLogicalProcess(uint32_t context) const
+{
+    if (context < m_nodePartition.size())
+    {
+        return m_partitions[m_nodePartition[context]].get();
+    }
+    return m_serial.get();
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetCurrent() const
+{
+    return t_current != nullptr ? t_current : m_serial.get();
+}
+
+void
+MultithreadedSimulatorImpl::BoundLookAhead(const Time lookAhead)
+{
+    if (lookAhead.IsStrictlyPositive())
+    {
+        NS_LOG_FUNCTION(this << lookAhead);
+        m_lookAhead = Min(m_lookAhead, lookAhead);
+    }
+    else
+    {
+        NS_LOG_WARN("attempted to set lookahead to a non positive time: " << lookAhead);
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead() const
+{
+    return m_lookAhead;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount() const
+{
+    return m_partitions.size();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetThreadCount() const
+{
+    return m_nThreads;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition(uint32_t nodeId) const
+{
+    if (nodeId < m_nodePartition.size())
+    {
+        return m_nodePartition[nodeId];
+    }
+    return m_partitions.size();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount() const
+{
+    return m_windowCount;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+    for (const auto& partition : m_partitions)
+    {
+        if (!partition->IsEmpty())
+        {
+            return false;
+        }
+    }
+    return m_serial->IsEmpty();
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (!m_partitioned)
+    {
+        Partition();
+    }
+    m_stop = false;
+    m_serial->ClearStop();
+    for (auto& partition : m_partitions)
+    {
+        partition->ClearStop();
+        partition->ReceiveMessages();
+    }
+    m_serial->ReceiveMessages();
+
+    m_finished = false;
+    NextWindow();
+    if (!m_finished)
+    {
+        m_processPhase = true;
+        m_nextPartition = 0;
+        m_arrived = 0;
+        std::vector<std::thread> threads;
+        for (uint32_t i = 1; i < m_nThreads; ++i)
+        {
+            threads.emplace_back(&MultithreadedSimulatorImpl::Work, this, i);
+        }
+        Work(0);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // Report the time of the most advanced partition from now on
+    uint64_t now = m_serial->GetCurrentTs();
+    for (const auto& partition : m_partitions)
+    {
+        now = std::max(now, partition->GetCurrentTs());
+    }
+    m_serial->SetCurrentTs(now);
+}
+
+void
+MultithreadedSimulatorImpl::Work(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    uint32_t nPartitions = m_partitions.size();
+    while (true)
+    {
+        // Execute the window
+        for (uint32_t i = m_nextPartition.fetch_add(1, std::memory_order_relaxed); i < nPartitions;
+             i = m_nextPartition.fetch_add(1, std::memory_order_relaxed))
+        {
+            t_current = m_partitions[i].get();
+            t_current->ProcessEvents(m_windowEnd);
+        }
+        t_current = nullptr;
+        Synchronize();
+
+        // Merge the events sent during the window
+        for (uint32_t i = m_nextPartition.fetch_add(1, std::memory_order_relaxed); i < nPartitions;
+             i = m_nextPartition.fetch_add(1, std::memory_order_relaxed))
+        {
+            m_partitions[i]->ReceiveMessages();
+        }
+        Synchronize();
+
+        if (m_finished)
+        {
+            break;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Synchronize()
+{
+    uint32_t generation = m_generation.load(std::memory_order_acquire);
+    if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_nThreads)
+    {
+        m_arrived.store(0, std::memory_order_relaxed);
+        EndPhase();
+        m_generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    uint32_t spins = 0;
+    while (m_generation.load(std::memory_order_acquire) == generation)
+    {
+        if (++spins > BARRIER_SPINS)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::EndPhase()
+{
+    m_nextPartition.store(0, std::memory_order_relaxed);
+    if (m_processPhase)
+    {
+        m_parallel.store(false, std::memory_order_relaxed);
+        m_processPhase = false;
+    }
+    else
+    {
+        NextWindow();
+        m_processPhase = true;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::NextWindow()
+{
+    t_current = m_serial.get();
+    while (true)
+    {
+        if (m_stop.load(std::memory_order_relaxed))
+        {
+            m_finished = true;
+            break;
+        }
+        uint64_t next = LogicalProcess::MAXIMUM_TS;
+        for (const auto& partition : m_partitions)
+        {
+            next = std::min(next, partition->GetNextTs());
+        }
+        uint64_t serialNext = m_serial->GetNextTs();
+        if (serialNext != LogicalProcess::MAXIMUM_TS && serialNext <= next)
+        {
+            // Serial events run before the partition events at the same time
+            m_serial->ProcessEvents(serialNext + 1);
+            continue;
+        }
+        if (next == LogicalProcess::MAXIMUM_TS)
+        {
+            m_finished = true;
+            break;
+        }
+        uint64_t lookAhead = m_lookAhead.GetTimeStep();
+        m_windowEnd = next > LogicalProcess::MAXIMUM_TS - lookAhead ? LogicalProcess::MAXIMUM_TS
+                                                                     : next + lookAhead;
+        m_windowEnd = std::min(m_windowEnd, serialNext);
+        m_windowCount++;
+        NS_LOG_LOGIC("window [" << next << ", " << m_windowEnd << ")");
+        break;
+    }
+    t_current = nullptr;
+    m_parallel.store(!m_finished, std::memory_order_relaxed);
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop.store(true, std::memory_order_relaxed);
+    GetCurrent()->Stop();
+}
+
+EventId
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    if (t_current == nullptr || !m_parallel.load(std::memory_order_relaxed))
+    {
+        return Simulator::Schedule(delay, &Simulator::Stop);
+    }
+    // The other partitions may already be past the stop time: stop at the
+    // end of the window at the earliest
+    uint64_t ts = std::max(t_current->GetCurrentTs() + delay.GetTimeStep(), m_windowEnd);
+    EventImpl* event = MakeEvent(&Simulator::Stop);
+    m_serial->Post(ts, Simulator::NO_CONTEXT, event, t_current);
+    return EventId(event, ts, Simulator::NO_CONTEXT, EventId::UID::INVALID);
+}
+
+EventId
+MultithreadedSimulatorImpl::DoSchedule(uint32_t context, const Time& delay, EventImpl* event)
+{
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+    LogicalProcess* current = GetCurrent();
+    LogicalProcess* target = GetLogicalProcess(context);
+    uint64_t ts = current->GetCurrentTs() + delay.GetTimeStep();
+    if (target == t_current || !m_parallel.load(std::memory_order_relaxed))
+    {
+        return target->Insert(ts, context, event);
+    }
+    NS_ASSERT_MSG(t_current != nullptr,
+                  "MultithreadedSimulatorImpl: events can only be scheduled by the simulation");
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event from context " << current->GetContext() << " to context " << context
+                                          << " with a delay of " << delay.As(Time::S)
+                                          << ", below the lookahead of " << m_lookAhead.As(Time::S)
+                                          << ": see MultithreadedSimulatorImpl::BoundLookAhead()");
+    target->Post(ts, context, event, t_current);
+    return EventId();
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    return DoSchedule(GetContext(), delay, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    DoSchedule(context, delay, event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return DoSchedule(GetContext(), Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    std::unique_lock lock{m_destroyMutex};
+    EventId id(Ptr<EventImpl>(event, false),
+               GetCurrent()->GetCurrentTs(),
+               0xffffffff,
+               EventId::UID::DESTROY);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(GetCurrent()->GetCurrentTs());
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - GetCurrent()->GetCurrentTs());
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        std::unique_lock lock{m_destroyMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    GetLogicalProcess(id.GetContext())->Remove(id);
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        std::unique_lock lock{m_destroyMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return GetLogicalProcess(id.GetContext())->IsExpired(id);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(LogicalProcess::MAXIMUM_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return GetCurrent()->GetContext();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = m_serial->GetEventCount();
+    for (const auto& partition : m_partitions)
+    {
+        count += partition->GetEventCount();
+    }
+    return count;
+}
+
+} // namespace ns3
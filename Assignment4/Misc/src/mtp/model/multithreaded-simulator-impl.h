@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3
+{
+
+/**
+ * \defgroup mtp Multithreaded simulation
+ *
+ * Parallel simulation on the cores of a single host, without MPI.
+ */
+
+class LogicalProcess;
+
+/**
+ * \ingroup simulator
+ * \ingroup mtp
+ * \brief Parallel simulator implementation running partitions of the
+ * nodes on worker threads, synchronized with lookahead.
+ *
+ * When the simulation starts, the nodes are split into partitions
+ * (logical processes).  Only channels joining exactly two devices, with a
+ * positive \c Delay attribute and a \c DeepCopy attribute, such as
+ * ns3::PointToPointChannel, are cut between partitions; the nodes sharing
+ * any other channel are kept together.  The partitions are balanced on
+ * the number of devices, following a breadth first walk of the topology
+ * so that neighbour nodes tend to share a partition.  The smallest delay
+ * of the cut channels is the lookahead.
+ *
+ * The partitions then advance in time windows: all the partitions
+ * execute their events older than the smallest next event timestamp plus
+ * the lookahead, in parallel, after which the events they sent to each
+ * other are merged.  This is the same conservative algorithm as
+ * ns3::DistributedSimulatorImpl, with the all-gather replaced by a thread
+ * barrier and the messages by lock-free queues.
+ *
+ * Events without a node context, such as the ones scheduled by the main
+ * program with Simulator::Schedule(), and the events of contexts which
+ * are not nodes, are executed alone between two windows.
+ *
+ * The order of the events within a partition only depends on the
+ * partitioning, not on the number of threads nor on their timing.
+ *
+ * Objects shared between nodes of different partitions, such as trace
+ * sinks writing to a common stream or a FlowMonitor, must be made
+ * thread safe by the user.  Simulator::Stop() called from an event takes
+ * effect at the end of the current window in the other partitions.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    EventId Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Add an additional bound to the lookahead.
+     * This is needed when events are scheduled between nodes of
+     * different partitions other than through a cut channel.
+     * The method may be invoked more than once, the minimum time will
+     * be used to constrain lookahead.
+     * \param [in] lookAhead The maximum lookahead; must be > 0.
+     */
+    void BoundLookAhead(const Time lookAhead);
+
+    /** \return The lookahead, once the simulation has started. */
+    Time GetLookAhead() const;
+    /** \return The number of partitions, once the simulation has started. */
+    uint32_t GetPartitionCount() const;
+    /** \return The number of worker threads, once the simulation has started. */
+    uint32_t GetThreadCount() const;
+    /**
+     * \param [in] nodeId The node id.
+     * \return The partition of the node, once the simulation has started.
+     */
+    uint32_t GetPartition(uint32_t nodeId) const;
+    /** \return The number of time windows executed. */
+    uint64_t GetWindowCount() const;
+
+  private:
+    // Inherited from Object
+    void DoDispose() override;
+
+    /**
+     * Split the nodes into partitions, compute the lookahead and move the
+     * events scheduled so far to their partition.
+     */
+    void Partition();
+    /**
+     * Get the partition executing the events of a context.
+     * \param [in] context The context.
+     * \return The partition, or the serial partition if the context is not
+     *         a partitioned node.
+     */
+    LogicalProcess* GetLogicalProcess(uint32_t context) const;
+    /** \return The partition of the calling thread, or the serial partition. */
+    LogicalProcess* GetCurrent() const;
+    /**
+     * Schedule an event, from any thread running the simulation.
+     * \param [in] context The context of the event.
+     * \param [in] delay The delay relative to the current time.
+     * \param [in] event The event.
+     * \return The event id, or an invalid id if the event crossed partitions.
+     */
+    EventId DoSchedule(uint32_t context, const Time& delay, EventImpl* event);
+
+    /**
+     * The body of a worker thread.
+     * \param [in] index The worker index.
+     */
+    void Work(uint32_t index);
+    /**
+     * Wait for all the workers, running EndPhase() once all have arrived.
+     */
+    void Synchronize();
+    /** Run by the last worker reaching a barrier. */
+    void EndPhase();
+    /**
+     * Execute the serial events due before the next window, and compute
+     * the end of that window.  Called while no partition runs.
+     */
+    void NextWindow();
+
+    /** The partitions. */
+    std::vector<std::unique_ptr<LogicalProcess>> m_partitions;
+    /** The partition executing the serial events, between two windows. */
+    std::unique_ptr<LogicalProcess> m_serial;
+    /** Partition index of each node; the nodes added later are serial. */
+    std::vector<uint32_t> m_nodePartition;
+    /** Whether Partition() has run. */
+    bool m_partitioned;
+    /** Factory for the schedulers of the partitions. */
+    ObjectFactory m_schedulerFactory;
+
+    /** Maximum number of worker threads, 0 for one per core. */
+    uint32_t m_maxThreads;
+    /** Requested number of partitions, 0 for one per thread. */
+    uint32_t m_maxPartitions;
+    /** Links with a smaller delay are not cut. */
+    Time m_minLookAhead;
+    /** Size of the lock-free inbox of each partition. */
+    uint32_t m_inboxCapacity;
+
+    /** The lookahead. */
+    Time m_lookAhead;
+    /** The number of worker threads of the current run. */
+    uint32_t m_nThreads;
+    /** End of the current window, exclusive. */
+    uint64_t m_windowEnd;
+    /** Number of windows executed. */
+    uint64_t m_windowCount;
+    /** The partitions are executing a window. */
+    std::atomic<bool> m_parallel;
+    /** The run is over. */
+    bool m_finished;
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+
+    /** Next partition to be taken by a worker, in the current phase. */
+    std::atomic<uint32_t> m_nextPartition;
+    /** Number of workers which have reached the barrier. */
+    std::atomic<uint32_t> m_arrived;
+    /** Incremented each time all the workers have reached the barrier. */
+    std::atomic<uint32_t> m_generation;
+    /** Whether the current phase executes events, or receives them. */
+    bool m_processPhase;
+
+    /** The event list of events to be executed on destroy. */
+    std::list<EventId> m_destroyEvents;
+    /** Protects m_destroyEvents. */
+    mutable std::mutex m_destroyMutex;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded simulation tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Run chains of events hopping between nodes, and check that the
+ * multithreaded simulator executes the same events as the default one,
+ * whatever the number of threads.
+ */
+class MtpEventsTestCase : public TestCase
+{
+  public:
+    MtpEventsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Events executed by a node: (time in us, context, hop). */
+    using Log = std::vector<std::tuple<int64_t, uint32_t, uint32_t>>;
+
+    /** The outcome of a run. */
+    struct Result
+    {
+        std::vector<Log> logs;              //!< Events executed by each node, sorted.
+        std::vector<std::size_t> globalLog; //!< Progress of the nodes seen by Global().
+        uint64_t eventCount;                //!< Number of events executed.
+        uint32_t cancelled;                 //!< Number of events cancelled.
+        Time end;                           //!< Time at the end of the run.
+    };
+
+    /**
+     * Run the scenario.
+     * \param [in] impl The simulator implementation to use.
+     * \return The outcome.
+     */
+    Result RunScenario(Ptr<SimulatorImpl> impl);
+    /**
+     * Check two runs executed the same events.
+     * \param [in] result The run to check.
+     * \param [in] reference The reference run.
+     */
+    void Compare(const Result& result, const Result& reference);
+
+    /**
+     * One hop of a chain: alternately move to the next node, or stay.
+     * \param [in] node The node executing the event.
+     * \param [in] hop The hop number.
+     */
+    void Hop(uint32_t node, uint32_t hop);
+    /** An event without context, recording the progress of all the nodes. */
+    void Global();
+
+    /** The number of nodes. */
+    static constexpr uint32_t N_NODES = 8;
+
+    std::vector<Log> m_logs;              //!< Events executed by each node.
+    std::vector<std::size_t> m_globalLog; //!< Progress of the nodes seen by Global().
+    std::vector<uint32_t> m_cancelled;    //!< Events cancelled by each node.
+};
+
+MtpEventsTestCase::MtpEventsTestCase()
+    : TestCase("Check the events executed by MultithreadedSimulatorImpl")
+{
+}
+
+void
+MtpEventsTestCase::Hop(uint32_t node, uint32_t hop)
+{
+    m_logs[node].emplace_back(Simulator::Now().GetMicroSeconds(), Simulator::GetContext(), hop);
+    if (hop % 2 == 0)
+    {
+        Simulator::ScheduleWithContext((node + 1) % N_NODES,
+                                       MilliSeconds(10),
+                                       &MtpEventsTestCase::Hop,
+                                       this,
+                                       (node + 1) % N_NODES,
+                                       hop + 1);
+        return;
+    }
+    EventId id = Simulator::Schedule(MilliSeconds(1), &MtpEventsTestCase::Hop, this, node, 0);
+    if (!Simulator::IsExpired(id))
+    {
+        Simulator::Cancel(id);
+        if (Simulator::IsExpired(id))
+        {
+            m_cancelled[node]++;
+        }
+    }
+    Simulator::Schedule(MilliSeconds(3), &MtpEventsTestCase::Hop, this, node, hop + 1);
+}
+
+void
+MtpEventsTestCase::Global()
+{
+    for (const auto& log : m_logs)
+    {
+        m_globalLog.push_back(log.size());
+    }
+}
+
+MtpEventsTestCase::Result
+MtpEventsTestCase::RunScenario(Ptr<SimulatorImpl> impl)
+{
+    Simulator::SetImplementation(impl);
+    m_logs.assign(N_NODES, {});
+    m_globalLog.clear();
+    m_cancelled.assign(N_NODES, 0);
+
+    NodeContainer nodes(N_NODES);
+    for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+        Simulator::ScheduleWithContext(i,
+                                       MicroSeconds(i + 1),
+                                       &MtpEventsTestCase::Hop,
+                                       this,
+                                       i,
+                                       0);
+    }
+    Simulator::Schedule(MicroSeconds(500500), &MtpEventsTestCase::Global, this);
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+
+    Result result;
+    result.logs = m_logs;
+    for (auto& log : result.logs)
+    {
+        std::sort(log.begin(), log.end());
+    }
+    result.globalLog = m_globalLog;
+    result.eventCount = Simulator::GetEventCount();
+    result.cancelled = 0;
+    for (auto cancelled : m_cancelled)
+    {
+        result.cancelled += cancelled;
+    }
+    result.end = Simulator::Now();
+    Simulator::Destroy();
+    return result;
+}
+
+void
+MtpEventsTestCase::Compare(const Result& result, const Result& reference)
+{
+    for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(result.logs[i].size(),
+                              reference.logs[i].size(),
+                              "Wrong number of events on node " << i);
+        NS_TEST_EXPECT_MSG_EQ((result.logs[i] == reference.logs[i]),
+                              true,
+                              "Different events on node " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ((result.globalLog == reference.globalLog),
+                          true,
+                          "Global event saw a different progress");
+    NS_TEST_EXPECT_MSG_EQ(result.eventCount, reference.eventCount, "Wrong event count");
+    NS_TEST_EXPECT_MSG_EQ(result.cancelled, reference.cancelled, "Wrong cancelled count");
+    NS_TEST_EXPECT_MSG_EQ(result.end, reference.end, "Wrong end time");
+}
+
+void
+MtpEventsTestCase::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId("ns3::DefaultSimulatorImpl");
+    Result reference = RunScenario(factory.Create<SimulatorImpl>());
+    NS_TEST_ASSERT_MSG_EQ(reference.end, Seconds(1), "Wrong stop time");
+    NS_TEST_ASSERT_MSG_EQ(reference.globalLog.size(), N_NODES, "Global event not executed");
+    NS_TEST_ASSERT_MSG_GT(reference.cancelled, 0, "No event cancelled");
+
+    for (uint32_t threads : {1, 2, 4})
+    {
+        factory.SetTypeId("ns3::MultithreadedSimulatorImpl");
+        factory.Set("MaxThreads", UintegerValue(threads));
+        factory.Set("Partitions", UintegerValue(4));
+        auto impl = factory.Create<MultithreadedSimulatorImpl>();
+        impl->BoundLookAhead(MilliSeconds(10));
+        Result result = RunScenario(impl);
+
+        NS_TEST_EXPECT_MSG_EQ(impl->GetPartitionCount(), 4, "Wrong number of partitions");
+        NS_TEST_EXPECT_MSG_EQ(impl->GetThreadCount(), threads, "Wrong number of threads");
+        NS_TEST_EXPECT_MSG_EQ(impl->GetLookAhead(), MilliSeconds(10), "Wrong lookahead");
+        NS_TEST_EXPECT_MSG_GT(impl->GetWindowCount(), 1, "Expected several windows");
+        NS_TEST_EXPECT_MSG_NE(impl->GetPartition(0),
+                              impl->GetPartition(N_NODES - 1),
+                              "Expected nodes in different partitions");
+        Compare(result, reference);
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief The MultithreadedSimulatorImpl test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp", Type::UNIT)
+    {
+        AddTestCase(new MtpEventsTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization.
+static MtpTestSuite g_mtpTestSuite;
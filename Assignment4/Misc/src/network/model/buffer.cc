@@ -18,6 +18,8 @@
  */
 #include "buffer.h"
 
+#include "packet-pool.h"
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -54,7 +56,8 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint64_t Buffer::g_copiedBytes = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -79,9 +82,9 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED(x) && !IS_DESTROYED(x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList* Buffer::g_freeList = nullptr;
-Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList* Buffer::g_freeList = nullptr;
+thread_local Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor()
 {
@@ -102,7 +105,19 @@ Buffer::Recycle(Buffer::Data* data)
 {
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
-    NS_ASSERT(!IS_UNINITIALIZED(g_freeList));
+    if (PacketPool::IsEnabled())
+    {
+        // The pool keeps the blocks of every size
+        Buffer::Deallocate(data);
+        return;
+    }
+    if (IS_UNINITIALIZED(g_freeList))
+    {
+        // The buffer was created by another thread, e.g., in another
+        // partition of a multithreaded simulation
+        g_freeList = new Buffer::FreeList();
+        g_localStaticDestructor.active = true;
+    }
     g_maxSize = std::max(g_maxSize, data->m_size);
     /* feed into free list */
     if (data->m_size < g_maxSize || IS_DESTROYED(g_freeList) || g_freeList->size() > 1000)
@@ -120,10 +135,15 @@ Buffer::Data*
 Buffer::Create(uint32_t dataSize)
 {
     NS_LOG_FUNCTION(dataSize);
+    if (PacketPool::IsEnabled())
+    {
+        return Buffer::Allocate(dataSize);
+    }
     /* try to find a buffer correctly sized. */
     if (IS_UNINITIALIZED(g_freeList))
     {
         g_freeList = new Buffer::FreeList();
+        g_localStaticDestructor.active = true;
     }
     else if (IS_INITIALIZED(g_freeList))
     {
@@ -172,7 +192,15 @@ Buffer::Allocate(uint32_t reqSize)
     }
     NS_ASSERT(reqSize >= 1);
     reqSize += ALLOC_OVER_PROVISION;
-    uint32_t size = reqSize - 1 + sizeof(Buffer::Data);
+    std::size_t size = reqSize - 1 + sizeof(Buffer::Data);
+    if (PacketPool::IsEnabled())
+    {
+        // Use the whole block of the size class
+        auto data = static_cast<Buffer::Data*>(PacketPool::Allocate(size));
+        data->m_size = size + 1 - sizeof(Buffer::Data);
+        data->m_count = 1;
+        return data;
+    }
     auto b = new uint8_t[size];
     auto data = reinterpret_cast<Buffer::Data*>(b);
     data->m_size = reqSize;
@@ -185,8 +213,7 @@ Buffer::Deallocate(Buffer::Data* data)
 {
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
-    auto buf = reinterpret_cast<uint8_t*>(data);
-    delete[] buf;
+    PacketPool::Deallocate(data, data->m_size - 1 + sizeof(Buffer::Data));
 }
 
 Buffer::Buffer()
@@ -333,6 +360,7 @@ Buffer::AddAtStart(uint32_t start)
         uint32_t newSize = GetInternalSize() + start;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
+        g_copiedBytes += GetInternalSize();
         m_data->m_count--;
         if (m_data->m_count == 0)
         {
@@ -379,6 +407,7 @@ Buffer::AddAtEnd(uint32_t end)
         uint32_t newSize = GetInternalSize() + end;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
+        g_copiedBytes += GetInternalSize();
         m_data->m_count--;
         if (m_data->m_count == 0)
         {
@@ -407,39 +436,64 @@ Buffer::AddAtEnd(const Buffer& o)
 {
     NS_LOG_FUNCTION(this << &o);
 
-    if (m_data->m_count == 1 && (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
-        m_end == m_data->m_dirtyEnd && o.m_start == o.m_zeroAreaStart &&
-        o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+    if (GetSize() == 0)
+    {
+        *this = o;
+        return;
+    }
+    if ((m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
+        o.m_start == o.m_zeroAreaStart && o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
         /**
          * This is an optimization which kicks in when
          * we attempt to aggregate two buffers which contain
-         * adjacent zero areas.
+         * adjacent zero areas. Only the real bytes of this
+         * buffer are copied if they are shared.
          */
+        Buffer src = o;
+        if (m_data->m_count != 1 || m_end != m_data->m_dirtyEnd)
+        {
+            Unshare();
+        }
         if (m_zeroAreaStart == m_zeroAreaEnd)
         {
             m_zeroAreaStart = m_end;
         }
-        uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+        uint32_t zeroSize = src.m_zeroAreaEnd - src.m_zeroAreaStart;
         m_zeroAreaEnd = m_end + zeroSize;
         m_end = m_zeroAreaEnd;
         m_data->m_dirtyEnd = m_zeroAreaEnd;
-        uint32_t endData = o.m_end - o.m_zeroAreaEnd;
+        uint32_t endData = src.m_end - src.m_zeroAreaEnd;
         AddAtEnd(endData);
-        Buffer::Iterator dst = End();
-        dst.Prev(endData);
-        Buffer::Iterator src = o.End();
-        src.Prev(endData);
-        dst.Write(src, o.End());
+        src.RemoveAtStart(src.GetSize() - endData);
+        src.CopyData(m_data->m_data + GetInternalEnd() - endData, endData);
+        g_copiedBytes += endData;
+        m_maxZeroAreaStart = std::max(m_maxZeroAreaStart, m_zeroAreaStart);
         NS_ASSERT(CheckInternalState());
         return;
     }
 
-    *this = CreateFullCopy();
-    AddAtEnd(o.GetSize());
-    Buffer::Iterator destStart = End();
-    destStart.Prev(o.GetSize());
-    destStart.Write(o.Begin(), o.End());
+    /**
+     * The zero areas are not adjacent: keep the larger one
+     * virtual, and copy the other buffer into real bytes.
+     */
+    if (o.m_zeroAreaEnd - o.m_zeroAreaStart > m_zeroAreaEnd - m_zeroAreaStart)
+    {
+        Buffer dst = o;
+        uint32_t size = GetSize();
+        dst.AddAtStart(size);
+        CopyData(dst.m_data->m_data + dst.m_start, size);
+        g_copiedBytes += size;
+        *this = dst;
+    }
+    else
+    {
+        Buffer src = o;
+        uint32_t size = src.GetSize();
+        AddAtEnd(size);
+        src.CopyData(m_data->m_data + GetInternalEnd() - size, size);
+        g_copiedBytes += size;
+    }
     NS_ASSERT(CheckInternalState());
 }
 
@@ -537,6 +591,30 @@ Buffer::CreateFragment(uint32_t start, uint32_t length) const
     return tmp;
 }
 
+void
+Buffer::Unshare()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(CheckInternalState());
+    Buffer::Data* newData = Buffer::Create(GetInternalSize());
+    memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
+    g_copiedBytes += GetInternalSize();
+    m_data->m_count--;
+    if (m_data->m_count == 0)
+    {
+        Buffer::Recycle(m_data);
+    }
+    m_data = newData;
+
+    m_zeroAreaStart -= m_start;
+    m_zeroAreaEnd -= m_start;
+    m_end -= m_start;
+    m_start = 0;
+    m_data->m_dirtyStart = m_start;
+    m_data->m_dirtyEnd = m_end;
+    NS_ASSERT(CheckInternalState());
+}
+
 Buffer
 Buffer::CreateFullCopy() const
 {
@@ -544,6 +622,7 @@ Buffer::CreateFullCopy() const
     NS_ASSERT(CheckInternalState());
     if (m_zeroAreaEnd - m_zeroAreaStart != 0)
     {
+        g_copiedBytes += GetSize();
         Buffer tmp;
         tmp.AddAtStart(m_zeroAreaEnd - m_zeroAreaStart);
         tmp.Begin().WriteU8(0, m_zeroAreaEnd - m_zeroAreaStart);
@@ -562,6 +641,13 @@ Buffer::CreateFullCopy() const
     return *this;
 }
 
+uint64_t
+Buffer::GetCopiedBytes()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    return g_copiedBytes;
+}
+
 uint32_t
 Buffer::GetSerializedSize() const
 {
@@ -528,6 +528,11 @@ class Buffer
      * Add bytes at the end of the Buffer.
      * Any call to this method invalidates any Iterator
      * pointing to this Buffer.
+     *
+     * The virtual zero areas of the two buffers are merged when they
+     * are adjacent. Otherwise, only the smaller of the two is turned
+     * into real bytes, so that concatenating fragments of application
+     * payload does not copy the payload.
      */
     void AddAtEnd(const Buffer& o);
     /**
@@ -612,6 +617,18 @@ class Buffer
      */
     uint32_t CopyData(uint8_t* buffer, uint32_t size) const;
 
+    /**
+     * \brief Get the number of bytes moved by the buffers of the calling
+     * thread.
+     *
+     * This counts the bytes copied when a buffer is reallocated, when its
+     * zero area is turned into real bytes, and when buffers are
+     * concatenated; it is meant for benchmarks.
+     *
+     * \returns the number of bytes copied since the thread started.
+     */
+    static uint64_t GetCopiedBytes();
+
     /**
      * \brief Copy constructor
      * \param o the buffer to copy
@@ -699,6 +716,11 @@ class Buffer
      * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
      */
     void TransformIntoRealBuffer() const;
+    /**
+     * \brief Move the real bytes of the buffer to a buffer data storage
+     * which is not shared, leaving the zero area virtual.
+     */
+    void Unshare();
     /**
      * \brief Checks the internal buffer structures consistency
      *
@@ -767,9 +789,11 @@ class Buffer
     /**
      * location in a newly-allocated buffer where you should start
      * writing data. i.e., m_start should be initialized to this
-     * value.
+     * value.  Each thread keeps its own.
      */
-    static uint32_t g_recommendedStart;
+    static thread_local uint32_t g_recommendedStart;
+    /// Bytes copied by the buffers of each thread, see GetCopiedBytes()
+    static thread_local uint64_t g_copiedBytes;
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -796,15 +820,18 @@ class Buffer
     /// Container for buffer data
     typedef std::vector<Buffer::Data*> FreeList;
 
-    /// Local static destructor structure
+    /// Local static destructor structure, releasing the free list of a thread
     struct LocalStaticDestructor
     {
         ~LocalStaticDestructor();
+        bool active{false}; //!< Set when the thread creates its free list
     };
 
-    static uint32_t g_maxSize;                            //!< Max observed data size
-    static FreeList* g_freeList;                          //!< Buffer data container
-    static LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+    // The free lists are per thread, so that simulation threads do not share them
+    static thread_local uint32_t g_maxSize;   //!< Max observed data size
+    static thread_local FreeList* g_freeList; //!< Buffer data container
+    /// Local static destructor
+    static thread_local LocalStaticDestructor g_localStaticDestructor;
 #endif
 };
 
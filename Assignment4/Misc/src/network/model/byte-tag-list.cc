@@ -56,13 +56,16 @@ struct ByteTagListData
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
+static thread_local class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
 {
   public:
     ~ByteTagListDataFreeList();
-} g_freeList; //!< Container for struct ByteTagListData
+} g_freeList; //!< Container for struct ByteTagListData, per thread
 
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+
+/// Set when the free list of this thread is destroyed
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList()
 {
@@ -72,9 +75,13 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList()
         auto buffer = (uint8_t*)(*i);
         delete[] buffer;
     }
+    g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
+/// Number of tag buffers allocated by this thread
+static thread_local uint64_t g_allocations = 0;
+
 ByteTagList::Iterator::Item::Item(TagBuffer buf_)
     : buf(buf_)
 {
@@ -169,6 +176,10 @@ ByteTagList::ByteTagList(const ByteTagList& o)
     {
         m_data->count++;
     }
+    else
+    {
+        std::memcpy(m_inline, o.m_inline, m_used);
+    }
 }
 
 ByteTagList&
@@ -189,6 +200,10 @@ ByteTagList::operator=(const ByteTagList& o)
     {
         m_data->count++;
     }
+    else
+    {
+        std::memcpy(m_inline, o.m_inline, m_used);
+    }
     return *this;
 }
 
@@ -208,8 +223,12 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
     NS_ASSERT(m_used <= spaceNeeded);
     if (m_data == nullptr)
     {
-        m_data = Allocate(spaceNeeded);
-        m_used = 0;
+        if (spaceNeeded > INLINE_SIZE)
+        {
+            // Move the tags out of the inline buffer
+            m_data = Allocate(spaceNeeded);
+            std::memcpy(&m_data->data, m_inline, m_used);
+        }
     }
     else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
     {
@@ -218,7 +237,8 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         Deallocate(m_data);
         m_data = newData;
     }
-    TagBuffer tag = TagBuffer(&m_data->data[m_used], &m_data->data[spaceNeeded]);
+    uint8_t* buffer = GetStart();
+    TagBuffer tag = TagBuffer(buffer + m_used, buffer + spaceNeeded);
     tag.WriteU32(tid.GetUid());
     tag.WriteU32(bufferSize);
     tag.WriteU32(start - m_adjustment);
@@ -232,7 +252,10 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_maxEnd = end - m_adjustment;
     }
     m_used = spaceNeeded;
-    m_data->dirty = m_used;
+    if (m_data != nullptr)
+    {
+        m_data->dirty = m_used;
+    }
     return tag;
 }
 
@@ -274,14 +297,20 @@ ByteTagList::Iterator
 ByteTagList::Begin(int32_t offsetStart, int32_t offsetEnd) const
 {
     NS_LOG_FUNCTION(this << offsetStart << offsetEnd);
-    if (m_data == nullptr)
-    {
-        return Iterator(nullptr, nullptr, offsetStart, offsetEnd, 0);
-    }
-    else
-    {
-        return Iterator(m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
-    }
+    uint8_t* start = GetStart();
+    return Iterator(start, start + m_used, offsetStart, offsetEnd, m_adjustment);
+}
+
+uint8_t*
+ByteTagList::GetStart() const
+{
+    return m_data != nullptr ? m_data->data : const_cast<uint8_t*>(m_inline);
+}
+
+uint64_t
+ByteTagList::GetAllocations()
+{
+    return g_allocations;
 }
 
 void
@@ -355,7 +384,8 @@ ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
+    g_allocations++;
+    while (!g_freeListDestroyed && !g_freeList.empty())
     {
         ByteTagListData* data = g_freeList.back();
         g_freeList.pop_back();
@@ -389,7 +419,7 @@ ByteTagList::Deallocate(ByteTagListData* data)
     data->count--;
     if (data->count == 0)
     {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
+        if (g_freeListDestroyed || g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
         {
             auto buffer = (uint8_t*)data;
             delete[] buffer;
@@ -407,6 +437,7 @@ ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
+    g_allocations++;
     uint8_t* buffer = new uint8_t[size + sizeof(ByteTagListData) - 4];
     ByteTagListData* data = (ByteTagListData*)buffer;
     data->count = 1;
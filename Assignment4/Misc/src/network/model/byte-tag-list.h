@@ -47,9 +47,11 @@ struct ByteTagListData;
  *     as 4 32bit integers (TypeId, tag data size, start, end) followed
  *     by the tag data as generated by Tag::Serialize.
  *
- *   - The struct ByteTagListData structure which contains the tag byte buffer
- *     is shared and, thus, reference-counted. This data structure is unshared
- *     as-needed to emulate COW semantics.
+ *   - The byte buffer of a list holding a few small tags is stored inline, in
+ *     the ByteTagList itself, and copied with the list.  Larger buffers are
+ *     stored in a struct ByteTagListData structure, which is shared and,
+ *     thus, reference-counted. This data structure is unshared as-needed to
+ *     emulate COW semantics.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
@@ -262,6 +264,12 @@ class ByteTagList
      */
     uint32_t Deserialize(const uint32_t* buffer, uint32_t size);
 
+    /**
+     * \returns the number of tag buffers allocated by the calling thread,
+     *          to measure the allocations of a workload.
+     */
+    static uint64_t GetAllocations();
+
   private:
     /**
      * \brief Returns an iterator pointing to the very first tag in this list.
@@ -283,11 +291,22 @@ class ByteTagList
      */
     void Deallocate(ByteTagListData* data);
 
+    /**
+     * \brief Returns the start of the tag byte buffer
+     * \returns the start of the buffer, inline or in the ByteTagListData
+     */
+    uint8_t* GetStart() const;
+
+    /// Size of the inline buffer, enough for two tags of up to 4 bytes
+    static constexpr uint32_t INLINE_SIZE = 40;
+
     int32_t m_minStart;      //!< minimal start offset
     int32_t m_maxEnd;        //!< maximal end offset
     int32_t m_adjustment;    //!< adjustment to byte tag offsets
     uint32_t m_used;         //!< the number of used bytes in the buffer
-    ByteTagListData* m_data; //!< the ByteTagListData structure
+    ByteTagListData* m_data; //!< the ByteTagListData structure, or null if stored inline
+    /// Inline byte buffer, used until the tags do not fit
+    alignas(uint32_t) uint8_t m_inline[INLINE_SIZE];
 };
 
 void
@@ -55,6 +55,12 @@ class ChannelListPriv : public Object
      */
     uint32_t Add(Ptr<Channel> channel);
 
+    /**
+     * \param channel The channel to replace.
+     * \param replacement The channel replacing it, the last one added.
+     */
+    void Replace(Ptr<Channel> channel, Ptr<Channel> replacement);
+
     /**
      * \returns a C++ iterator located at the beginning of this
      *          list.
@@ -182,6 +188,20 @@ ChannelListPriv::Add(Ptr<Channel> channel)
     return index;
 }
 
+void
+ChannelListPriv::Replace(Ptr<Channel> channel, Ptr<Channel> replacement)
+{
+    NS_LOG_FUNCTION(this << channel << replacement);
+    uint32_t index = channel->GetId();
+    NS_ASSERT_MSG(index < m_channels.size() && m_channels[index] == channel,
+                  "Channel " << index << " is not in the list");
+    NS_ASSERT_MSG(!m_channels.empty() && m_channels.back() == replacement && channel != replacement,
+                  "The replacement must be the channel added last");
+    m_channels[index] = replacement;
+    m_channels.pop_back();
+    replacement->m_id = index;
+}
+
 ChannelList::Iterator
 ChannelListPriv::Begin() const
 {
@@ -220,6 +240,13 @@ ChannelList::Add(Ptr<Channel> channel)
     return ChannelListPriv::Get()->Add(channel);
 }
 
+void
+ChannelList::Replace(Ptr<Channel> channel, Ptr<Channel> replacement)
+{
+    NS_LOG_FUNCTION(channel << replacement);
+    ChannelListPriv::Get()->Replace(channel, replacement);
+}
+
 ChannelList::Iterator
 ChannelList::Begin()
 {
@@ -49,6 +49,18 @@ class ChannelList
      * the user has little reason to call it himself.
      */
     static uint32_t Add(Ptr<Channel> channel);
+    /**
+     * \brief Replace a channel by another one, which takes its id and its
+     * index in the list.
+     *
+     * Used to substitute a channel once the topology is built, e.g., by a
+     * remote channel between two ranks.  The replacement must be the
+     * channel created last, so that no other channel id changes.
+     *
+     * \param channel The channel to replace.
+     * \param replacement The channel replacing it.
+     */
+    static void Replace(Ptr<Channel> channel, Ptr<Channel> replacement);
     /**
      * \returns a C++ iterator located at the beginning of this
      *          list.
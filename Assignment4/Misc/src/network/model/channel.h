@@ -76,6 +76,8 @@ class Channel : public Object
     virtual Ptr<NetDevice> GetDevice(std::size_t i) const = 0;
 
   private:
+    friend class ChannelListPriv;
+
     uint32_t m_id; //!< Channel id for this channel
 };
 
@@ -40,4 +40,10 @@ NetDevice::~NetDevice()
     NS_LOG_FUNCTION(this);
 }
 
+bool
+NetDevice::SupportsGso() const
+{
+    return false;
+}
+
 } // namespace ns3
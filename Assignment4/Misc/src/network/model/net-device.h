@@ -367,6 +367,17 @@ class NetDevice : public Object
      * \return true if this interface supports a bridging mode, false otherwise.
      */
     virtual bool SupportsSendFrom() const = 0;
+
+    /**
+     * \brief Whether the device splits the packets carrying a GsoTag itself
+     *
+     * Such devices receive a batch of transport segments as a single packet
+     * and send the segments on the wire one at a time (see GsoTag::Segment).
+     * The network layer segments the batches for the other devices.
+     *
+     * \return true if this interface segments the GSO batches, false otherwise.
+     */
+    virtual bool SupportsGso() const;
 };
 
 } // namespace ns3
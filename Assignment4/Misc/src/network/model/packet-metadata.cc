@@ -36,10 +36,13 @@ NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+bool PacketMetadata::m_enableCompact = false;
+thread_local bool PacketMetadata::m_metadataSkipped = false;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+std::atomic<uint16_t> PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
+thread_local PacketMetadata::LogFreeList PacketMetadata::m_logFreeList;
 
 PacketMetadata::DataFreeList::~DataFreeList()
 {
@@ -48,7 +51,18 @@ PacketMetadata::DataFreeList::~DataFreeList()
     {
         PacketMetadata::Deallocate(*i);
     }
-    PacketMetadata::m_enable = false;
+    PacketMetadata::m_freeListDestroyed = true;
+}
+
+PacketMetadata::LogFreeList::~LogFreeList()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto i = begin(); i != end(); i++)
+    {
+        delete *i;
+    }
+    clear();
+    PacketMetadata::m_freeListDestroyed = true;
 }
 
 void
@@ -71,6 +85,126 @@ PacketMetadata::EnableChecking()
     NS_LOG_FUNCTION_NOARGS();
     Enable();
     m_enableChecking = true;
+    m_enableCompact = false;
+}
+
+void
+PacketMetadata::EnableCompact()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    Enable();
+    m_enableCompact = !m_enableChecking;
+}
+
+void
+PacketMetadata::Record(LogOperation op,
+                       uint32_t typeUid,
+                       uint32_t size,
+                       uint16_t chunkUid,
+                       const PacketMetadata* other)
+{
+    NS_LOG_FUNCTION(this << static_cast<uint32_t>(op) << typeUid << size << chunkUid << other);
+    NS_ASSERT(m_data == nullptr);
+    LogEntry* entry;
+    if (m_logFreeList.empty())
+    {
+        entry = new LogEntry;
+    }
+    else
+    {
+        entry = m_logFreeList.back();
+        m_logFreeList.pop_back();
+    }
+    entry->count = 1;
+    entry->op = op;
+    entry->chunkUid = chunkUid;
+    entry->typeUid = typeUid;
+    entry->size = size;
+    // the new entry takes over our reference to the previous one
+    entry->prev = m_log;
+    entry->other = other != nullptr ? new PacketMetadata(*other) : nullptr;
+    m_log = entry;
+}
+
+void
+PacketMetadata::Release(LogEntry* entry)
+{
+    while (entry != nullptr)
+    {
+        NS_ASSERT(entry->count > 0);
+        entry->count--;
+        if (entry->count != 0)
+        {
+            return;
+        }
+        LogEntry* prev = entry->prev;
+        delete entry->other;
+        if (m_freeListDestroyed || m_logFreeList.size() > 1000)
+        {
+            delete entry;
+        }
+        else
+        {
+            m_logFreeList.push_back(entry);
+        }
+        entry = prev;
+    }
+}
+
+void
+PacketMetadata::Materialize()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_data != nullptr)
+    {
+        return;
+    }
+    std::vector<const LogEntry*> entries;
+    for (const LogEntry* entry = m_log; entry != nullptr; entry = entry->prev)
+    {
+        entries.push_back(entry);
+    }
+    LogEntry* log = m_log;
+    m_log = nullptr;
+    // AddAtEnd() may adopt the uid of the other packet, but the uid seen
+    // by the user must not change when the items are built.
+    uint64_t packetUid = m_packetUid;
+    m_data = PacketMetadata::Create(10);
+    memset(m_data->m_data, 0xff, 4);
+    m_head = 0xffff;
+    m_tail = 0xffff;
+    m_used = 0;
+    for (auto i = entries.rbegin(); i != entries.rend(); i++)
+    {
+        const LogEntry* entry = *i;
+        switch (entry->op)
+        {
+        case ADD_HEADER:
+            AddHeaderItem(entry->typeUid, entry->size, entry->chunkUid);
+            break;
+        case REMOVE_HEADER:
+            RemoveHeaderItem(entry->typeUid, entry->size);
+            break;
+        case ADD_TRAILER:
+            AddTrailerItem(entry->typeUid, entry->size, entry->chunkUid);
+            break;
+        case REMOVE_TRAILER:
+            RemoveTrailerItem(entry->typeUid, entry->size);
+            break;
+        case ADD_AT_END:
+            AddAtEnd(*entry->other);
+            break;
+        case REMOVE_AT_START:
+            RemoveAtStart(entry->size);
+            break;
+        case REMOVE_AT_END:
+            RemoveAtEnd(entry->size);
+            break;
+        }
+    }
+    m_packetUid = packetUid;
+    Release(log);
+    NS_ASSERT(IsStateOk());
 }
 
 void
@@ -136,6 +270,10 @@ bool
 PacketMetadata::IsStateOk() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_data == nullptr)
+    {
+        return true;
+    }
     bool ok = m_used <= m_data->m_size;
     ok &= IsPointerOk(m_head);
     ok &= IsPointerOk(m_tail);
@@ -593,7 +731,7 @@ void
 PacketMetadata::Recycle(PacketMetadata::Data* data)
 {
     NS_LOG_FUNCTION(data);
-    if (!m_enable)
+    if (!m_enable || m_freeListDestroyed)
     {
         PacketMetadata::Deallocate(data);
         return;
@@ -664,14 +802,25 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    uint16_t chunkUid = m_chunkUid.fetch_add(1, std::memory_order_relaxed);
+    if (m_data == nullptr)
+    {
+        Record(ADD_HEADER, uid, size, chunkUid);
+        return;
+    }
+    AddHeaderItem(uid, size, chunkUid);
+}
 
+void
+PacketMetadata::AddHeaderItem(uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+    NS_LOG_FUNCTION(this << uid << size << chunkUid);
     PacketMetadata::SmallItem item;
     item.next = m_head;
     item.prev = 0xffff;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = chunkUid;
     uint16_t written = AddSmall(&item);
     UpdateHead(written);
 }
@@ -686,6 +835,18 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        Record(REMOVE_HEADER, uid, size);
+        return;
+    }
+    RemoveHeaderItem(uid, size);
+}
+
+void
+PacketMetadata::RemoveHeaderItem(uint32_t uid, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << uid << size);
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
     uint32_t read = ReadItems(m_head, &item, &extraItem);
@@ -731,16 +892,28 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    uint16_t chunkUid = m_chunkUid.fetch_add(1, std::memory_order_relaxed);
+    if (m_data == nullptr)
+    {
+        Record(ADD_TRAILER, uid, size, chunkUid);
+        return;
+    }
+    AddTrailerItem(uid, size, chunkUid);
+    NS_ASSERT(IsStateOk());
+}
+
+void
+PacketMetadata::AddTrailerItem(uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+    NS_LOG_FUNCTION(this << uid << size << chunkUid);
     PacketMetadata::SmallItem item;
     item.next = 0xffff;
     item.prev = m_tail;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = chunkUid;
     uint16_t written = AddSmall(&item);
     UpdateTail(written);
-    NS_ASSERT(IsStateOk());
 }
 
 void
@@ -753,6 +926,18 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        Record(REMOVE_TRAILER, uid, size);
+        return;
+    }
+    RemoveTrailerItem(uid, size);
+}
+
+void
+PacketMetadata::RemoveTrailerItem(uint32_t uid, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << uid << size);
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
     uint32_t read = ReadItems(m_tail, &item, &extraItem);
@@ -797,6 +982,18 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
         m_metadataSkipped = true;
         return;
     }
+    if (m_data == nullptr)
+    {
+        Record(ADD_AT_END, 0, 0, 0, &o);
+        return;
+    }
+    if (o.m_data == nullptr)
+    {
+        PacketMetadata other = o;
+        other.Materialize();
+        AddAtEnd(other);
+        return;
+    }
     if (m_tail == 0xffff)
     {
         // We have no items so 'AddAtEnd' is
@@ -884,7 +1081,14 @@ PacketMetadata::RemoveAtStart(uint32_t start)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
+    if (m_data == nullptr)
+    {
+        if (start > 0)
+        {
+            Record(REMOVE_AT_START, 0, start);
+        }
+        return;
+    }
     uint32_t leftToRemove = start;
     uint16_t current = m_head;
     while (current != 0xffff && leftToRemove > 0)
@@ -911,6 +1115,7 @@ PacketMetadata::RemoveAtStart(uint32_t start)
         {
             // fragment the list item.
             PacketMetadata fragment(m_packetUid, 0);
+            fragment.Materialize();
             extraItem.fragmentStart += leftToRemove;
             leftToRemove = 0;
             uint16_t written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
@@ -945,7 +1150,14 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
+    if (m_data == nullptr)
+    {
+        if (end > 0)
+        {
+            Record(REMOVE_AT_END, 0, end);
+        }
+        return;
+    }
 
     uint32_t leftToRemove = end;
     uint16_t current = m_tail;
@@ -973,6 +1185,7 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
         {
             // fragment the list item.
             PacketMetadata fragment(m_packetUid, 0);
+            fragment.Materialize();
             NS_ASSERT(extraItem.fragmentEnd > leftToRemove);
             extraItem.fragmentEnd -= leftToRemove;
             leftToRemove = 0;
@@ -1033,6 +1246,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem(Buffer buffer) const
 {
     NS_LOG_FUNCTION(this << &buffer);
+    const_cast<PacketMetadata*>(this)->Materialize();
     return ItemIterator(this, buffer);
 }
 
@@ -1128,6 +1342,12 @@ PacketMetadata::GetSerializedSize() const
     {
         return totalSize;
     }
+    if (m_data == nullptr)
+    {
+        PacketMetadata metadata = *this;
+        metadata.Materialize();
+        return metadata.GetSerializedSize();
+    }
 
     PacketMetadata::SmallItem item;
     PacketMetadata::ExtraItem extraItem;
@@ -1161,6 +1381,12 @@ uint32_t
 PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
 {
     NS_LOG_FUNCTION(this << &buffer << maxSize);
+    if (m_data == nullptr)
+    {
+        PacketMetadata metadata = *this;
+        metadata.Materialize();
+        return metadata.Serialize(buffer, maxSize);
+    }
     uint8_t* start = buffer;
 
     buffer = AddToRawU64(m_packetUid, start, buffer, maxSize);
@@ -1267,6 +1493,14 @@ uint32_t
 PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
+    if (m_data == nullptr)
+    {
+        // the items are deserialized, not the log
+        Release(m_log);
+        m_log = nullptr;
+        m_data = PacketMetadata::Create(10);
+        memset(m_data->m_data, 0xff, 4);
+    }
     const uint8_t* start = buffer;
     uint32_t desSize = size - 4;
 
@@ -25,6 +25,7 @@
 #include "ns3/callback.h"
 #include "ns3/type-id.h"
 
+#include <atomic>
 #include <limits>
 #include <stdint.h>
 #include <vector>
@@ -76,6 +77,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When the compact mode is enabled with EnableCompact(), the packets
+ * created afterwards do not maintain this linked list. They only record
+ * the operations performed on them (the type uid and size of the headers
+ * and trailers added or removed, the bytes removed and the packets
+ * appended) in a log shared with their copies, which costs a single
+ * allocation per operation and no copy. The linked list is built from
+ * the log when it is needed, that is, when the items of the packet are
+ * iterated over with BeginItem(), for instance by Packet::Print(), or
+ * when the packet is serialized.
  */
 class PacketMetadata
 {
@@ -167,8 +178,16 @@ class PacketMetadata
     static void Enable();
     /**
      * \brief Enable the packet metadata checking
+     *
+     * Checking requires the linked list of items to be kept up to
+     * date, so this disables the compact mode.
      */
     static void EnableChecking();
+    /**
+     * \brief Enable the packet metadata, recording only a log of the
+     * operations performed on the packets created afterwards.
+     */
+    static void EnableCompact();
 
     /**
      * \brief Constructor
@@ -267,6 +286,9 @@ class PacketMetadata
      * \brief Initialize the item iterator to the buffer begin
      * \param buffer buffer to initialize.
      * \return the buffer iterator.
+     *
+     * If the metadata only holds a log of operations, the items are
+     * built from it first.
      */
     ItemIterator BeginItem(Buffer buffer) const;
 
@@ -518,7 +540,46 @@ class PacketMetadata
         ~DataFreeList();
     };
 
+    /// Operations recorded in the log of the compact mode
+    enum LogOperation : uint8_t
+    {
+        ADD_HEADER,      //!< AddHeader()
+        REMOVE_HEADER,   //!< RemoveHeader()
+        ADD_TRAILER,     //!< AddTrailer()
+        REMOVE_TRAILER,  //!< RemoveTrailer()
+        ADD_AT_END,      //!< AddAtEnd()
+        REMOVE_AT_START, //!< RemoveAtStart()
+        REMOVE_AT_END,   //!< RemoveAtEnd()
+    };
+
+    /**
+     * \brief An operation of the log of the compact mode.
+     *
+     * The entries form a list from the newest to the oldest operation;
+     * copies of a packet share the entries recorded before the copy.
+     */
+    struct LogEntry
+    {
+        uint32_t count;        //!< number of references to this entry
+        LogOperation op;       //!< the operation
+        uint16_t chunkUid;     //!< chunk uid of the header or trailer added
+        uint32_t typeUid;      //!< type uid of the header or trailer
+        uint32_t size;         //!< size of the header, trailer or bytes removed
+        LogEntry* prev;        //!< the previous operation
+        PacketMetadata* other; //!< the metadata appended by ADD_AT_END
+    };
+
+    /**
+     * \brief Class to hold the free log entries
+     */
+    class LogFreeList : public std::vector<LogEntry*>
+    {
+      public:
+        ~LogFreeList();
+    };
+
     friend DataFreeList::~DataFreeList();
+    friend LogFreeList::~LogFreeList();
     /// Friend class
     friend class ItemIterator;
 
@@ -634,6 +695,56 @@ class PacketMetadata
      * \param size header serialized size
      */
     void DoAddHeader(uint32_t uid, uint32_t size);
+    /**
+     * \brief Add an header item to the linked list
+     * \param uid header's uid to add
+     * \param size header serialized size
+     * \param chunkUid the chunk uid of the header
+     */
+    void AddHeaderItem(uint32_t uid, uint32_t size, uint16_t chunkUid);
+    /**
+     * \brief Remove an header item from the linked list
+     * \param uid header's uid to remove
+     * \param size header serialized size
+     */
+    void RemoveHeaderItem(uint32_t uid, uint32_t size);
+    /**
+     * \brief Add a trailer item to the linked list
+     * \param uid trailer's uid to add
+     * \param size trailer serialized size
+     * \param chunkUid the chunk uid of the trailer
+     */
+    void AddTrailerItem(uint32_t uid, uint32_t size, uint16_t chunkUid);
+    /**
+     * \brief Remove a trailer item from the linked list
+     * \param uid trailer's uid to remove
+     * \param size trailer serialized size
+     */
+    void RemoveTrailerItem(uint32_t uid, uint32_t size);
+
+    /**
+     * \brief Record an operation in the log of the compact mode
+     * \param op the operation
+     * \param typeUid the type uid of the header or trailer
+     * \param size the size of the header, trailer or bytes removed
+     * \param chunkUid the chunk uid of the header or trailer added
+     * \param other the metadata appended, for ADD_AT_END
+     */
+    void Record(LogOperation op,
+                uint32_t typeUid,
+                uint32_t size,
+                uint16_t chunkUid = 0,
+                const PacketMetadata* other = nullptr);
+    /**
+     * \brief Build the linked list of items from the log, if the
+     * metadata only holds a log.
+     */
+    void Materialize();
+    /**
+     * \brief Release a reference to a log entry
+     * \param entry the entry
+     */
+    static void Release(LogEntry* entry);
     /**
      * \brief Check if the metadata state is ok
      * \returns true if the internal state is ok
@@ -675,21 +786,27 @@ class PacketMetadata
      */
     static void Deallocate(PacketMetadata::Data* data);
 
-    static DataFreeList m_freeList; //!< the metadata data storage
-    static bool m_enable;           //!< Enable the packet metadata
-    static bool m_enableChecking;   //!< Enable the packet metadata checking
+    // The free list is per thread, so that simulation threads do not share it
+    static thread_local DataFreeList m_freeList;   //!< the metadata data storage
+    static thread_local bool m_freeListDestroyed;  //!< The thread is exiting
+    static thread_local LogFreeList m_logFreeList; //!< the free log entries
+    static bool m_enable;                          //!< Enable the packet metadata
+    static bool m_enableChecking;                  //!< Enable the packet metadata checking
+    static bool m_enableCompact;                   //!< Record a log of the operations only
 
     /**
      * Set to true when adding metadata to a packet is skipped because
      * m_enable is false; used to detect enabling of metadata in the
-     * middle of a simulation, which isn't allowed.
+     * middle of a simulation, which isn't allowed.  Checked on the thread
+     * enabling the metadata only.
      */
-    static bool m_metadataSkipped;
+    static thread_local bool m_metadataSkipped;
 
-    static uint32_t m_maxSize;  //!< maximum metadata size
-    static uint16_t m_chunkUid; //!< Chunk Uid
+    static thread_local uint32_t m_maxSize;  //!< maximum metadata size
+    static std::atomic<uint16_t> m_chunkUid; //!< Chunk Uid
 
-    Data* m_data; //!< Metadata storage
+    Data* m_data;    //!< Metadata storage, null if the metadata only holds a log
+    LogEntry* m_log; //!< Latest operation of the log, if m_data is null
     /*
        head -(next)-> tail
          ^             |
@@ -707,13 +824,18 @@ namespace ns3
 {
 
 PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
-    : m_data(PacketMetadata::Create(10)),
+    : m_data(nullptr),
+      m_log(nullptr),
       m_head(0xffff),
       m_tail(0xffff),
       m_used(0),
       m_packetUid(uid)
 {
-    memset(m_data->m_data, 0xff, 4);
+    if (!m_enableCompact)
+    {
+        m_data = PacketMetadata::Create(10);
+        memset(m_data->m_data, 0xff, 4);
+    }
     if (size > 0)
     {
         DoAddHeader(0, size);
@@ -722,14 +844,21 @@ PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
 
 PacketMetadata::PacketMetadata(const PacketMetadata& o)
     : m_data(o.m_data),
+      m_log(o.m_log),
       m_head(o.m_head),
       m_tail(o.m_tail),
       m_used(o.m_used),
       m_packetUid(o.m_packetUid)
 {
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
-    m_data->m_count++;
+    if (m_data != nullptr)
+    {
+        NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
+        m_data->m_count++;
+    }
+    if (m_log != nullptr)
+    {
+        m_log->count++;
+    }
 }
 
 PacketMetadata&
@@ -738,15 +867,28 @@ PacketMetadata::operator=(const PacketMetadata& o)
     if (m_data != o.m_data)
     {
         // not self assignment
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (m_data != nullptr)
         {
-            PacketMetadata::Recycle(m_data);
+            m_data->m_count--;
+            if (m_data->m_count == 0)
+            {
+                PacketMetadata::Recycle(m_data);
+            }
         }
         m_data = o.m_data;
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count++;
+        if (m_data != nullptr)
+        {
+            m_data->m_count++;
+        }
+    }
+    if (m_log != o.m_log)
+    {
+        if (o.m_log != nullptr)
+        {
+            o.m_log->count++;
+        }
+        PacketMetadata::Release(m_log);
+        m_log = o.m_log;
     }
     m_head = o.m_head;
     m_tail = o.m_tail;
@@ -757,12 +899,15 @@ PacketMetadata::operator=(const PacketMetadata& o)
 
 PacketMetadata::~PacketMetadata()
 {
-    NS_ASSERT(m_data != nullptr);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (m_data != nullptr)
     {
-        PacketMetadata::Recycle(m_data);
+        m_data->m_count--;
+        if (m_data->m_count == 0)
+        {
+            PacketMetadata::Recycle(m_data);
+        }
     }
+    PacketMetadata::Release(m_log);
 }
 
 } // namespace ns3
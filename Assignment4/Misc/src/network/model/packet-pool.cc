@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-pool.h"
+
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup packet
+ * Implementation of class ns3::PacketPool.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketPool");
+
+/**
+ * \ingroup packet
+ * \anchor GlobalValuePacketPool
+ * Recycle the memory of the packets; see PacketPool.
+ */
+static GlobalValue g_packetPool =
+    GlobalValue("PacketPool",
+                "Recycle the memory of the Packet objects and of their buffer data",
+                BooleanValue(false),
+                MakeBooleanChecker());
+
+namespace
+{
+
+/// Smallest size class, as a power of two
+constexpr uint32_t MIN_CLASS = 5;
+/// Largest size class, as a power of two
+constexpr uint32_t MAX_CLASS = 16;
+/// Largest number of blocks kept in each size class
+constexpr std::size_t MAX_BLOCKS = 1024;
+
+/**
+ * \ingroup packet
+ * The free lists of a thread.
+ */
+struct FreeLists
+{
+    /** Free the blocks. */
+    void Clear();
+    /** Destructor. */
+    ~FreeLists();
+
+    /// Blocks of each size class
+    std::vector<uint8_t*> blocks[MAX_CLASS - MIN_CLASS + 1];
+    std::vector<void*> objects;       //!< Packet objects
+    uint64_t held{0};                 //!< Number of blocks held
+    PacketPool::Stats stats{0, 0, 0}; //!< Statistics
+};
+
+/// Free lists of this thread
+thread_local FreeLists g_freeLists;
+/// Set when the free lists of this thread are destroyed
+thread_local bool g_freeListsDestroyed = false;
+
+void
+FreeLists::Clear()
+{
+    for (auto& list : blocks)
+    {
+        for (auto block : list)
+        {
+            delete[] block;
+        }
+        list.clear();
+    }
+    for (auto object : objects)
+    {
+        ::operator delete(object);
+    }
+    objects.clear();
+    held = 0;
+}
+
+FreeLists::~FreeLists()
+{
+    Clear();
+    g_freeListsDestroyed = true;
+}
+
+} // namespace
+
+std::atomic<PacketPool::State> PacketPool::m_state{PacketPool::UNKNOWN};
+
+void
+PacketPool::Enable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_state.store(ENABLED);
+}
+
+void
+PacketPool::Disable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_state.store(DISABLED);
+    if (!g_freeListsDestroyed)
+    {
+        g_freeLists.Clear();
+    }
+}
+
+bool
+PacketPool::IsEnabled()
+{
+    State state = m_state.load(std::memory_order_relaxed);
+    if (state == UNKNOWN)
+    {
+        // Only the first thread to read the global value sets the state, so
+        // that a concurrent Enable() or Disable() is not overwritten
+        BooleanValue enabled;
+        g_packetPool.GetValue(enabled);
+        State expected = UNKNOWN;
+        m_state.compare_exchange_strong(expected, enabled.Get() ? ENABLED : DISABLED);
+        state = m_state.load(std::memory_order_relaxed);
+    }
+    return state == ENABLED;
+}
+
+PacketPool::Stats
+PacketPool::GetStats()
+{
+    if (g_freeListsDestroyed)
+    {
+        return Stats{0, 0, 0};
+    }
+    return g_freeLists.stats;
+}
+
+void
+PacketPool::ResetStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    if (!g_freeListsDestroyed)
+    {
+        g_freeLists.stats = Stats{0, 0, g_freeLists.held};
+    }
+}
+
+uint32_t
+PacketPool::GetClass(std::size_t size)
+{
+    uint32_t sizeClass = MIN_CLASS;
+    while (sizeClass <= MAX_CLASS && (std::size_t(1) << sizeClass) < size)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+std::size_t
+PacketPool::GetBlockSize(std::size_t size)
+{
+    uint32_t sizeClass = GetClass(size);
+    return sizeClass > MAX_CLASS ? size : std::size_t(1) << sizeClass;
+}
+
+void*
+PacketPool::Allocate(std::size_t& size)
+{
+    // Round up even when the pool is disabled, so that the blocks can be
+    // recycled if it is enabled later
+    size = GetBlockSize(size);
+    uint32_t sizeClass = GetClass(size);
+    if (sizeClass <= MAX_CLASS && IsEnabled() && !g_freeListsDestroyed)
+    {
+        auto& list = g_freeLists.blocks[sizeClass - MIN_CLASS];
+        if (!list.empty())
+        {
+            uint8_t* block = list.back();
+            list.pop_back();
+            g_freeLists.held--;
+            g_freeLists.stats.hits++;
+            return block;
+        }
+        g_freeLists.stats.misses++;
+    }
+    return new uint8_t[size];
+}
+
+void
+PacketPool::Deallocate(void* block, std::size_t size)
+{
+    auto buffer = static_cast<uint8_t*>(block);
+    if (IsEnabled() && !g_freeListsDestroyed && size >= (std::size_t(1) << MIN_CLASS))
+    {
+        // The class of the largest blocks not larger than this one
+        uint32_t sizeClass = GetClass(size);
+        if ((std::size_t(1) << sizeClass) > size)
+        {
+            sizeClass--;
+        }
+        if (sizeClass <= MAX_CLASS)
+        {
+            auto& list = g_freeLists.blocks[sizeClass - MIN_CLASS];
+            if (list.size() < MAX_BLOCKS)
+            {
+                list.push_back(buffer);
+                g_freeLists.held++;
+                g_freeLists.stats.highWater =
+                    std::max(g_freeLists.stats.highWater, g_freeLists.held);
+                return;
+            }
+        }
+    }
+    delete[] buffer;
+}
+
+void*
+PacketPool::AllocateObject(std::size_t size)
+{
+    if (IsEnabled() && !g_freeListsDestroyed)
+    {
+        if (!g_freeLists.objects.empty())
+        {
+            void* object = g_freeLists.objects.back();
+            g_freeLists.objects.pop_back();
+            g_freeLists.held--;
+            g_freeLists.stats.hits++;
+            return object;
+        }
+        g_freeLists.stats.misses++;
+    }
+    return ::operator new(size);
+}
+
+void
+PacketPool::DeallocateObject(void* object, std::size_t size)
+{
+    if (IsEnabled() && !g_freeListsDestroyed && g_freeLists.objects.size() < MAX_BLOCKS)
+    {
+        g_freeLists.objects.push_back(object);
+        g_freeLists.held++;
+        g_freeLists.stats.highWater = std::max(g_freeLists.stats.highWater, g_freeLists.held);
+        return;
+    }
+    ::operator delete(object, size);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const PacketPool::Stats& stats)
+{
+    os << "hits=" << stats.hits << " misses=" << stats.misses
+       << " high-water=" << stats.highWater;
+    return os;
+}
+
+} // namespace ns3
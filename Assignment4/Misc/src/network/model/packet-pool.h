@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * Declaration of class ns3::PacketPool.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup packet
+ *
+ * \brief Recycle the memory of the Packet objects and of their buffer data.
+ *
+ * Every packet sent by an application allocates a Packet object and a
+ * buffer data block, which are freed when the last Ptr to the packet is
+ * dropped.  When the pool is enabled, these blocks are kept in free lists
+ * by size class instead, and handed out again to the next packets: a
+ * simulation which keeps sending packets stops allocating memory once the
+ * pool holds as many blocks as there are packets in flight.
+ *
+ * The pool is disabled by default.  It is enabled by
+ * Packet::EnablePool(), or by setting the \c PacketPool global value
+ * before the first packet is created:
+ *
+ * \code
+ *   ./ns3 run "my-program --PacketPool=1"
+ * \endcode
+ *
+ * Each thread has its own pool, so the simulator threads do not contend for
+ * it; the blocks are freed by Disable() and when the thread exits.  The size
+ * classes of the buffer data are the powers of two from 32 bytes to 64 KiB;
+ * larger blocks are not pooled.  The Packet objects, which all have the same
+ * size, are kept in a free list of their own and are never rounded up.
+ */
+class PacketPool
+{
+  public:
+    /** Statistics of the pool of a thread. */
+    struct Stats
+    {
+        uint64_t hits;      //!< Blocks handed out from the pool
+        uint64_t misses;    //!< Blocks allocated because the pool was empty
+        uint64_t highWater; //!< Largest number of blocks held by the pool
+    };
+
+    /** Enable the pool. */
+    static void Enable();
+    /** Disable the pool, and free the blocks it holds on this thread. */
+    static void Disable();
+    /** \return \c true if the pool is enabled. */
+    static bool IsEnabled();
+
+    /**
+     * \return The statistics of the pool of this thread.
+     */
+    static Stats GetStats();
+    /** Reset the statistics of the pool of this thread. */
+    static void ResetStats();
+
+    /**
+     * \param [in] size The requested size of a block.
+     * \return The size of the block returned by Allocate().
+     */
+    static std::size_t GetBlockSize(std::size_t size);
+    /**
+     * Allocate a block.
+     *
+     * \param [in,out] size The requested size, rounded up to the size of
+     *                 the block.
+     * \return The block.
+     */
+    static void* Allocate(std::size_t& size);
+    /**
+     * Free a block, keeping it in the pool if it is enabled.
+     *
+     * \param [in] block The block, allocated by Allocate() or by
+     *             <tt>new uint8_t[size]</tt>.
+     * \param [in] size The size of the block.
+     */
+    static void Deallocate(void* block, std::size_t size);
+
+    /**
+     * Allocate the memory of a Packet object.
+     *
+     * \param [in] size The size of the object.
+     * \return The memory of the object.
+     */
+    static void* AllocateObject(std::size_t size);
+    /**
+     * Free the memory of a Packet object, keeping it in the pool if it is
+     * enabled.
+     *
+     * \param [in] object The memory of the object, allocated by
+     *             AllocateObject() or by <tt>::operator new(size)</tt>.
+     * \param [in] size The size of the object.
+     */
+    static void DeallocateObject(void* object, std::size_t size);
+
+  private:
+    /**
+     * \param [in] size The size of a block.
+     * \return The size class of the smallest blocks at least this large.
+     */
+    static uint32_t GetClass(std::size_t size);
+
+    /** State of the pool. */
+    enum State
+    {
+        UNKNOWN,  //!< Not read from the \c PacketPool global value yet
+        ENABLED,  //!< Enabled
+        DISABLED, //!< Disabled
+    };
+
+    /**
+     * State of the pool; atomic, since it is read from the \c PacketPool
+     * global value by the first thread allocating a block.
+     */
+    static std::atomic<State> m_state;
+};
+
+/**
+ * \ingroup packet
+ * Output streamer for PacketPool::Stats.
+ *
+ * \param [in,out] os The output stream.
+ * \param [in] stats The statistics.
+ * \returns The stream.
+ */
+std::ostream& operator<<(std::ostream& os, const PacketPool::Stats& stats);
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
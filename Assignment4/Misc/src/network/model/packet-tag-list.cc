@@ -19,7 +19,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -30,232 +30,150 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("PacketTagList");
 
-PacketTagList::TagData*
-PacketTagList::CreateTagData(size_t dataSize)
-{
-    NS_ASSERT_MSG(dataSize < std::numeric_limits<decltype(TagData::size)>::max(),
-                  "Requested TagData size " << dataSize << " exceeds maximum "
-                                            << std::numeric_limits<decltype(TagData::size)>::max());
-
-    void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+/// Number of tag buffers allocated on the heap by this thread
+static thread_local uint64_t g_allocations = 0;
 
-    auto tag = new (p) TagData;
-    tag->size = dataSize;
-    return tag;
+uint64_t
+PacketTagList::GetAllocations()
+{
+    return g_allocations;
 }
 
-bool
-PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
+void
+PacketTagList::Deallocate(TagListData* data)
 {
-    TypeId tid = tag.GetInstanceTypeId();
-    NS_LOG_FUNCTION(this << tid);
-    NS_LOG_INFO("looking for " << tid);
-
-    // trivial case when list is empty
-    if (m_next == nullptr)
-    {
-        return false;
-    }
-
-    bool found = false;
-
-    TagData** prevNext = &m_next; // previous node's next pointer
-    TagData* cur = m_next;        // cursor to current node
-    TagData* it = nullptr;        // utility
-
-    // Search from the head of the list until we find tid or a merge
-    while (cur != nullptr)
-    {
-        if (cur->count > 1)
-        {
-            // found merge
-            NS_LOG_INFO("found initial merge before tid");
-            break;
-        }
-        else if (cur->tid == tid)
-        {
-            NS_LOG_INFO("found tid before initial merge, calling writer");
-            found = (this->*Writer)(tag, true, cur, prevNext);
-            break;
-        }
-        else
-        {
-            // no merge or tid found yet, move on
-            prevNext = &cur->next;
-            cur = cur->next;
-        }
-    } // while !found && !cow
-
-    // did we find it or run out of tags?
-    if (cur == nullptr || found)
+    data->count--;
+    if (data->count == 0)
     {
-        NS_LOG_INFO("returning after header with found: " << found);
-        return found;
+        auto buffer = reinterpret_cast<uint8_t*>(data);
+        delete[] buffer;
     }
+}
 
-    // From here on out, we have to copy the list
-    // until we find tid, then link past it
-
-    // Before we do all that work, let's make sure tid really exists
-    for (it = cur; it != nullptr; it = it->next)
-    {
-        if (it->tid == tid)
-        {
-            break;
-        }
-    }
-    if (it == nullptr)
+void
+PacketTagList::Reserve(uint32_t extraSize)
+{
+    NS_LOG_FUNCTION(this << extraSize);
+    uint32_t size = m_used + extraSize;
+    if (m_data == nullptr ? size <= INLINE_SIZE : (m_data->count == 1 && size <= m_data->size))
     {
-        // got to end of list without finding tid
-        NS_LOG_INFO("tid not found after first merge");
-        return found;
+        return;
     }
-
-    // At this point cur is a merge, but untested for tid
-    NS_ASSERT(cur != nullptr);
-    NS_ASSERT(cur->count > 1);
-
-    /*
-       Walk the remainder of the list, copying, until we find tid
-       As we put a copy of the cur node onto our list,
-       we move the merge point down the list.
-
-       Starting position                  End position
-         T1 is a merge                     T1.count decremented
-                                           T2 is a merge
-                                           T1' is a copy of T1
-
-            other                             other
-                 \                                 \
-        Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-             /   /                                         /|
-        pNext cur                         Prev  ->  T1' --/ |
-                                                       /    |
-                                                  pNext   cur
-
-       When we reach tid, we link past it, decrement count, and we're done.
-    */
-
-    // Should normally check for null cur pointer,
-    // but since we know tid exists, we'll skip this test
-    while (/* cur && */ cur->tid != tid)
+    // Leave some room for the next tags
+    uint32_t capacity = std::max(size, 2 * INLINE_SIZE);
+    auto buffer = new uint8_t[sizeof(TagListData) - 4 + capacity];
+    g_allocations++;
+    auto data = reinterpret_cast<TagListData*>(buffer);
+    data->count = 1;
+    data->size = capacity;
+    std::memcpy(data->data, GetStart(), m_used);
+    if (m_data != nullptr)
     {
-        NS_ASSERT(cur != nullptr);
-        NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
-        TagData* copy = CreateTagData(cur->size);
-        copy->tid = cur->tid;
-        copy->count = 1;
-        copy->size = cur->size;
-        memcpy(copy->data, cur->data, copy->size);
-        copy->next = cur->next; // merge into tail
-        copy->next->count++;    // mark new merge
-        *prevNext = copy;       // point prior list at copy
-        prevNext = &copy->next; // advance
-        cur = copy->next;
+        Deallocate(m_data);
     }
-    // Sanity check:
-    NS_ASSERT(cur != nullptr);  // cur should be non-zero
-    NS_ASSERT(cur->tid == tid); // cur->tid should be tid
-    NS_ASSERT(cur->count > 1);  // cur should be a merge
-
-    // link around tid, removing it from our list
-    found = (this->*Writer)(tag, false, cur, prevNext);
-    return found;
+    m_data = data;
 }
 
-bool
-PacketTagList::Remove(Tag& tag)
+PacketTagList::TagData*
+PacketTagList::CreateTagData(TypeId tid, uint32_t dataSize)
 {
-    return COWTraverse(tag, &PacketTagList::RemoveWriter);
+    NS_ASSERT_MSG(dataSize < std::numeric_limits<decltype(TagData::size)>::max(),
+                  "Requested TagData size " << dataSize << " exceeds maximum "
+                                            << std::numeric_limits<decltype(TagData::size)>::max());
+
+    uint32_t tagDataSize = GetTagDataSize(dataSize);
+    Reserve(tagDataSize);
+    auto tag = new (GetStart() + m_used) TagData;
+    tag->tid = tid;
+    tag->size = dataSize;
+    m_used += tagDataSize;
+    m_types |= GetTypeBit(tid);
+    return tag;
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter(Tag& tag,
-                            bool preMerge,
-                            PacketTagList::TagData* cur,
-                            PacketTagList::TagData** prevNext)
+void
+PacketTagList::Erase(TagData* tag)
 {
-    NS_LOG_FUNCTION_NOARGS();
-
-    // found tid
-    bool found = true;
-    tag.Deserialize(TagBuffer(cur->data, cur->data + cur->size));
-    *prevNext = cur->next; // link around cur
+    NS_LOG_FUNCTION(this << tag->tid);
+    auto start = reinterpret_cast<uint8_t*>(tag);
+    uint32_t tagDataSize = GetTagDataSize(tag->size);
+    uint8_t* end = GetStart() + m_used;
+    std::memmove(start, start + tagDataSize, end - start - tagDataSize);
+    m_used -= tagDataSize;
+
+    // Another tag may share the bit of the removed one
+    m_types = 0;
+    for (const TagData* cur = Head(); cur != End(); cur = Next(cur))
+    {
+        m_types |= GetTypeBit(cur->tid);
+    }
+}
 
-    if (preMerge)
+PacketTagList::TagData*
+PacketTagList::Find(TypeId tid) const
+{
+    if ((m_types & GetTypeBit(tid)) == 0)
     {
-        // found tid before first merge, so delete cur
-        cur->~TagData();
-        std::free(cur);
+        return nullptr;
     }
-    else
+    for (const TagData* cur = Head(); cur != End(); cur = Next(cur))
     {
-        // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
-        if (cur->next != nullptr)
+        if (cur->tid == tid)
         {
-            // there's a next, so make it a merge
-            cur->next->count++;
+            return const_cast<TagData*>(cur);
         }
     }
-    return found;
+    return nullptr;
 }
 
 bool
-PacketTagList::Replace(Tag& tag)
+PacketTagList::Remove(Tag& tag)
 {
-    bool found = COWTraverse(tag, &PacketTagList::ReplaceWriter);
-    if (!found)
+    NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
+    TagData* cur = Find(tag.GetInstanceTypeId());
+    if (cur == nullptr)
     {
-        Add(tag);
+        return false;
     }
-    return found;
+    tag.Deserialize(TagBuffer(cur->data, cur->data + cur->size));
+    // Copy the buffer if it is shared
+    uint32_t offset = reinterpret_cast<uint8_t*>(cur) - GetStart();
+    Reserve(0);
+    Erase(reinterpret_cast<TagData*>(GetStart() + offset));
+    return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter(Tag& tag,
-                             bool preMerge,
-                             PacketTagList::TagData* cur,
-                             PacketTagList::TagData** prevNext)
+PacketTagList::Replace(Tag& tag)
 {
-    NS_LOG_FUNCTION_NOARGS();
-
-    // found tid
-    bool found = true;
-    if (preMerge)
+    NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
+    TagData* cur = Find(tag.GetInstanceTypeId());
+    if (cur == nullptr)
     {
-        // found tid before first merge, so just rewrite
-        tag.Serialize(TagBuffer(cur->data, cur->data + cur->size));
+        Add(tag);
+        return false;
     }
-    else
+    uint32_t offset = reinterpret_cast<uint8_t*>(cur) - GetStart();
+    Reserve(0);
+    cur = reinterpret_cast<TagData*>(GetStart() + offset);
+    if (cur->size == tag.GetSerializedSize())
     {
-        // cur is always a merge at this point
-        // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
-        TagData* copy = CreateTagData(tag.GetSerializedSize());
-        copy->tid = tag.GetInstanceTypeId();
-        copy->count = 1;
-        tag.Serialize(TagBuffer(copy->data, copy->data + copy->size));
-        copy->next = cur->next; // merge into tail
-        if (copy->next != nullptr)
-        {
-            copy->next->count++; // mark new merge
-        }
-        *prevNext = copy; // point prior list at copy
+        // just rewrite
+        tag.Serialize(TagBuffer(cur->data, cur->data + cur->size));
+        return true;
     }
-    return found;
+    Erase(cur);
+    Add(tag);
+    return true;
 }
 
 void
@@ -263,44 +181,40 @@ PacketTagList::Add(const Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     // ensure this id was not yet added
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
-    {
-        NS_ASSERT_MSG(cur->tid != tag.GetInstanceTypeId(),
-                      "Error: cannot add the same kind of tag twice. The tag type is "
-                          << tag.GetInstanceTypeId().GetName());
-    }
-    TagData* head = CreateTagData(tag.GetSerializedSize());
-    head->count = 1;
-    head->next = nullptr;
-    head->tid = tag.GetInstanceTypeId();
-    head->next = m_next;
+    NS_ASSERT_MSG(Find(tag.GetInstanceTypeId()) == nullptr,
+                  "Error: cannot add the same kind of tag twice. The tag type is "
+                      << tag.GetInstanceTypeId().GetName());
+    auto self = const_cast<PacketTagList*>(this);
+    TagData* head = self->CreateTagData(tag.GetInstanceTypeId(), tag.GetSerializedSize());
     tag.Serialize(TagBuffer(head->data, head->data + head->size));
-
-    const_cast<PacketTagList*>(this)->m_next = head;
 }
 
 bool
 PacketTagList::Peek(Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
-    TypeId tid = tag.GetInstanceTypeId();
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    const TagData* cur = Find(tag.GetInstanceTypeId());
+    if (cur == nullptr)
     {
-        if (cur->tid == tid)
-        {
-            /* found tag */
-            tag.Deserialize(TagBuffer(cur->data, cur->data + cur->size));
-            return true;
-        }
+        /* no tag found */
+        return false;
     }
-    /* no tag found */
-    return false;
+    /* found tag */
+    tag.Deserialize(TagBuffer(const_cast<uint8_t*>(cur->data),
+                              const_cast<uint8_t*>(cur->data) + cur->size));
+    return true;
 }
 
 const PacketTagList::TagData*
 PacketTagList::Head() const
 {
-    return m_next;
+    return reinterpret_cast<const TagData*>(GetStart());
+}
+
+const PacketTagList::TagData*
+PacketTagList::End() const
+{
+    return reinterpret_cast<const TagData*>(GetStart() + m_used);
 }
 
 uint32_t
@@ -312,7 +226,7 @@ PacketTagList::GetSerializedSize() const
 
     size = 4; // numberOfTags
 
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    for (const TagData* cur = Head(); cur != End(); cur = Next(cur))
     {
         size += 4; // TagData -> size
 
@@ -346,7 +260,7 @@ PacketTagList::Serialize(uint32_t* buffer, uint32_t maxSize) const
     uint32_t* numberOfTags = p;
     *p++ = 0;
 
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    for (const TagData* cur = Head(); cur != End(); cur = Next(cur))
     {
         size += 4;
 
@@ -404,7 +318,6 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
     NS_LOG_INFO("Deserializing number of tags " << numberOfTags);
 
-    TagData* prevTag = nullptr;
     for (uint32_t i = 0; i < numberOfTags; ++i)
     {
         NS_ASSERT(sizeCheck >= 4);
@@ -422,10 +335,7 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
         NS_LOG_INFO("Deserializing tag of type " << tid);
 
-        TagData* newTag = CreateTagData(tagSize);
-        newTag->count = 1;
-        newTag->next = nullptr;
-        newTag->tid = tid;
+        TagData* newTag = CreateTagData(tid, tagSize);
 
         NS_ASSERT(sizeCheck >= tagSize);
         memcpy(newTag->data, p, tagSize);
@@ -434,18 +344,6 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
         uint32_t tagWordSize = (tagSize + 3) & (~3);
         p += tagWordSize / 4;
         sizeCheck -= tagWordSize;
-
-        // Set link list pointers.
-        if (i == 0)
-        {
-            m_next = newTag;
-        }
-        else
-        {
-            prevTag->next = newTag;
-        }
-
-        prevTag = newTag;
     }
 
     NS_ASSERT(sizeCheck == 0);
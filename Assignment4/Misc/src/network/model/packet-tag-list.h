@@ -21,11 +21,13 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags, including copy-on-write semantics.
 */
 
 #include "ns3/type-id.h"
 
+#include <cstddef>
+#include <cstring>
 #include <ostream>
 #include <stdint.h>
 
@@ -44,88 +46,32 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * Tags are stored in serialized form, one TagData after the other, in a
+ * single byte buffer:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ *   - The buffer of a list holding a few small tags is stored inline, in
+ *     the PacketTagList itself, so adding them does not allocate memory.
+ *     A copy of the list copies these bytes.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
+ *   - When the tags do not fit inline, they are moved to a TagListData
+ *     structure allocated on the heap.  This structure is shared by the
+ *     copies of the list, and reference-counted: #Add, #Remove and
+ *     #Replace copy it first if it is shared, to emulate copy-on-write
+ *     semantics.
  *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
+ *   - A bit set of the types of the tags, indexed by the uid of their
+ *     TypeId, lets #Peek, #Remove and #Replace return at once when the
+ *     type of the tag is absent, and only compare the types of the few
+ *     stored tags otherwise.
  *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ * #Add appends the new tag, so the tags are visited in the order they
+ * were added.
  */
 class PacketTagList
 {
   public:
     /**
-     * Tree node for sharing serialized tags.
+     * Serialized tag, stored in the buffer of a PacketTagList.
      *
      * See PacketTagList for a discussion of the data structure.
      *
@@ -135,14 +81,12 @@ class PacketTagList
      * The Item nested class can't be forward declared, so friending isn't
      * possible.
      *
-     * We use placement new so we can allocate enough room for the Tag
+     * We use placement new in a buffer with enough room for the Tag
      * type which will be serialized into data.  See Object::Aggregates
      * for a similar construction.
      */
     struct TagData
     {
-        TagData* next;   //!< Pointer to next in list
-        uint32_t count;  //!< Number of incoming links
         TypeId tid;      //!< Type of the tag serialized into #data
         uint32_t size;   //!< Size of the \c data buffer
         uint8_t data[1]; //!< Serialization buffer
@@ -157,8 +101,8 @@ class PacketTagList
      *
      * \param [in] o The PacketTagList to copy.
      *
-     * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * This copies the tags stored inline, or points to the same
+     * heap buffer as \pname{o}.
      */
     inline PacketTagList(const PacketTagList& o);
     /**
@@ -168,18 +112,19 @@ class PacketTagList
      * \returns the copied object
      *
      * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * copying the tags stored inline, or pointing to the same
+     * heap buffer as \pname{o}.
      */
     inline PacketTagList& operator=(const PacketTagList& o);
     /**
      * Destructor
      *
-     * #RemoveAll's the tags up to the first merge.
+     * #RemoveAll's the tags.
      */
     inline ~PacketTagList();
 
     /**
-     * Add a tag to the head of this branch.
+     * Add a tag at the end of the list.
      *
      * \param [in] tag The tag to add
      */
@@ -211,13 +156,22 @@ class PacketTagList
      */
     bool Peek(Tag& tag) const;
     /**
-     * Remove all tags from this list (up to the first merge).
+     * Remove all tags from this list.
      */
     inline void RemoveAll();
     /**
-     * \returns pointer to head of tag list
+     * \returns pointer to the first tag of the list
      */
     const PacketTagList::TagData* Head() const;
+    /**
+     * \returns pointer past the last tag of the list
+     */
+    const PacketTagList::TagData* End() const;
+    /**
+     * \param [in] tag A tag of the list.
+     * \returns pointer to the tag following \pname{tag}
+     */
+    static inline const PacketTagList::TagData* Next(const PacketTagList::TagData* tag);
     /**
      * Returns number of bytes required for packet serialization.
      *
@@ -243,68 +197,83 @@ class PacketTagList
      */
     uint32_t Deserialize(const uint32_t* buffer, uint32_t size);
 
+    /**
+     * \returns the number of tag buffers allocated on the heap by the
+     *          calling thread, to measure the allocations of a workload.
+     */
+    static uint64_t GetAllocations();
+
   private:
     /**
-     * Allocate and construct a TagData struct, sizing the data area
-     * large enough to serialize dataSize bytes from a Tag.
-     *
-     * \param [in] dataSize The serialized size of the Tag.
-     * \returns The newly constructed TagData object.
+     * Heap buffer of the tags, when they do not fit inline.
      */
-    static TagData* CreateTagData(size_t dataSize);
+    struct TagListData
+    {
+        uint32_t count;  //!< Number of PacketTagList sharing this buffer
+        uint32_t size;   //!< Size of the \c data buffer
+        uint8_t data[4]; //!< Serialized tags
+    };
 
+    /// Size of the inline buffer, enough for four tags of up to 4 bytes
+    static constexpr uint32_t INLINE_SIZE = 48;
+
+    /**
+     * \param [in] dataSize The serialized size of a Tag.
+     * \returns The number of bytes taken by a TagData holding the tag.
+     */
+    static inline uint32_t GetTagDataSize(uint32_t dataSize);
     /**
-     * Typedef of method function pointer for copy-on-write operations
+     * \param [in] tid The type of a tag.
+     * \returns The bit of the type in #m_types.
+     */
+    static inline uint64_t GetTypeBit(TypeId tid);
+    /**
+     * Release a heap buffer, deleting it if it is no longer shared.
      *
-     * \param [in] tag The tag type to operate on.
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *             false otherwise.
-     * \param [in] cur Pointer to the tag.
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True if operation successful, false otherwise
+     * \param [in] data The buffer.
+     */
+    static void Deallocate(TagListData* data);
+
+    /**
+     * \returns The start of the buffer holding the tags.
      */
-    typedef bool (PacketTagList::*COWWriter)(Tag& tag,
-                                             bool preMerge,
-                                             TagData* cur,
-                                             TagData** prevNext);
+    inline uint8_t* GetStart() const;
     /**
-     * Traverse the list implementing copy-on-write, using \pname{Writer}.
+     * Find a tag.
      *
-     * \param [in] tag The tag type to operate on.
-     * \param [in] Writer The copy-on-write function to use.
-     * \returns True if \pname{tag} found, false otherwise.
+     * \param [in] tid The type of the tag.
+     * \returns The tag, or a null pointer if no tag of this type is stored.
      */
-    bool COWTraverse(Tag& tag, PacketTagList::COWWriter Writer);
+    TagData* Find(TypeId tid) const;
     /**
-     * Copy-on-write implementing Remove.
+     * Make the buffer writable, with enough room for more tags.
      *
-     * \param [in] tag The target tag type to remove.
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *             false otherwise.
-     * \param [in] cur Pointer to the tag.
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True, since tag will definitely be removed.
+     * The buffer is copied if it is shared, or moved to a larger heap
+     * buffer if it is too small; this invalidates the pointers to the tags.
+     *
+     * \param [in] extraSize The number of bytes to add.
      */
-    bool RemoveWriter(Tag& tag, bool preMerge, TagData* cur, TagData** prevNext);
+    void Reserve(uint32_t extraSize);
     /**
-     * Copy-on-write implementing Replace
+     * Append a tag whose data is not initialized yet.
      *
-     * \param [in] tag The target tag type to replace
-     * \param [in] preMerge True if \pname{tag} was found before the first merge,
-     *          false otherwise.
-     * \param [in] cur Pointer to the tag
-     * \param [in] prevNext Pointer to the struct TagData.next pointer
-     *          pointing to \pname{cur}.
-     * \returns True, since tag value will definitely be replaced.
+     * \param [in] tid The type of the tag.
+     * \param [in] dataSize The serialized size of the Tag.
+     * \returns The newly constructed TagData object.
      */
-    bool ReplaceWriter(Tag& tag, bool preMerge, TagData* cur, TagData** prevNext);
-
+    TagData* CreateTagData(TypeId tid, uint32_t dataSize);
     /**
-     * Pointer to first \ref TagData on the list
+     * Remove a tag from the buffer, which must be writable.
+     *
+     * \param [in] tag The tag to remove.
      */
-    TagData* m_next;
+    void Erase(TagData* tag);
+
+    TagListData* m_data; //!< Heap buffer of the tags, or null if stored inline
+    uint32_t m_used;     //!< Number of bytes used by the tags
+    uint64_t m_types;    //!< Bit set of the types of the tags
+    /// Inline buffer of the tags
+    alignas(TagData) uint8_t m_inline[INLINE_SIZE];
 };
 
 } // namespace ns3
@@ -317,16 +286,25 @@ namespace ns3
 {
 
 PacketTagList::PacketTagList()
-    : m_next()
+    : m_data(nullptr),
+      m_used(0),
+      m_types(0)
 {
 }
 
 PacketTagList::PacketTagList(const PacketTagList& o)
-    : m_next(o.m_next)
+    : m_data(o.m_data),
+      m_used(o.m_used),
+      m_types(o.m_types)
 {
-    if (m_next != nullptr)
+    if (m_data != nullptr)
+    {
+        m_data->count++;
+    }
+    else
     {
-        m_next->count++;
+        // A constant size is cheaper to copy
+        std::memcpy(m_inline, o.m_inline, INLINE_SIZE);
     }
 }
 
@@ -334,15 +312,22 @@ PacketTagList&
 PacketTagList::operator=(const PacketTagList& o)
 {
     // self assignment
-    if (m_next == o.m_next)
+    if (this == &o)
     {
         return *this;
     }
     RemoveAll();
-    m_next = o.m_next;
-    if (m_next != nullptr)
+    m_data = o.m_data;
+    m_used = o.m_used;
+    m_types = o.m_types;
+    if (m_data != nullptr)
     {
-        m_next->count++;
+        m_data->count++;
+    }
+    else
+    {
+        // A constant size is cheaper to copy
+        std::memcpy(m_inline, o.m_inline, INLINE_SIZE);
     }
     return *this;
 }
@@ -355,27 +340,39 @@ PacketTagList::~PacketTagList()
 void
 PacketTagList::RemoveAll()
 {
-    TagData* prev = nullptr;
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
-    {
-        cur->count--;
-        if (cur->count > 0)
-        {
-            break;
-        }
-        if (prev != nullptr)
-        {
-            prev->~TagData();
-            std::free(prev);
-        }
-        prev = cur;
-    }
-    if (prev != nullptr)
+    if (m_data != nullptr)
     {
-        prev->~TagData();
-        std::free(prev);
+        Deallocate(m_data);
+        m_data = nullptr;
     }
-    m_next = nullptr;
+    m_used = 0;
+    m_types = 0;
+}
+
+const PacketTagList::TagData*
+PacketTagList::Next(const PacketTagList::TagData* tag)
+{
+    return reinterpret_cast<const TagData*>(reinterpret_cast<const uint8_t*>(tag) +
+                                            GetTagDataSize(tag->size));
+}
+
+uint32_t
+PacketTagList::GetTagDataSize(uint32_t dataSize)
+{
+    // Keep the next TagData aligned
+    return (offsetof(TagData, data) + dataSize + alignof(TagData) - 1) & ~(alignof(TagData) - 1);
+}
+
+uint64_t
+PacketTagList::GetTypeBit(TypeId tid)
+{
+    return uint64_t(1) << (tid.GetUid() % 64);
+}
+
+uint8_t*
+PacketTagList::GetStart() const
+{
+    return m_data != nullptr ? m_data->data : const_cast<uint8_t*>(m_inline);
 }
 
 } // namespace ns3
@@ -18,6 +18,8 @@
  */
 #include "packet.h"
 
+#include "packet-pool.h"
+
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -30,7 +32,7 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid = 0;
 
 TypeId
 ByteTagIterator::Item::GetTypeId() const
@@ -89,15 +91,17 @@ ByteTagIterator::ByteTagIterator(ByteTagList::Iterator i)
 {
 }
 
-PacketTagIterator::PacketTagIterator(const PacketTagList::TagData* head)
-    : m_current(head)
+PacketTagIterator::PacketTagIterator(const PacketTagList::TagData* head,
+                                     const PacketTagList::TagData* end)
+    : m_current(head),
+      m_end(end)
 {
 }
 
 bool
 PacketTagIterator::HasNext() const
 {
-    return m_current != nullptr;
+    return m_current != m_end;
 }
 
 PacketTagIterator::Item
@@ -105,7 +109,7 @@ PacketTagIterator::Next()
 {
     NS_ASSERT(HasNext());
     const PacketTagList::TagData* prev = m_current;
-    m_current = m_current->next;
+    m_current = PacketTagList::Next(m_current);
     return PacketTagIterator::Item(prev);
 }
 
@@ -146,10 +150,11 @@ Packet::Packet()
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, 0),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 |
+                     m_globalUid.fetch_add(1, std::memory_order_relaxed),
+                 0),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const Packet& o)
@@ -186,10 +191,11 @@ Packet::Packet(uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 |
+                     m_globalUid.fetch_add(1, std::memory_order_relaxed),
+                 size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
@@ -213,10 +219,11 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 |
+                     m_globalUid.fetch_add(1, std::memory_order_relaxed),
+                 size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
     m_buffer.AddAtStart(size);
     Buffer::Iterator i = m_buffer.Begin();
     i.Write(buffer, size);
@@ -599,6 +606,13 @@ Packet::EnablePrinting()
     PacketMetadata::Enable();
 }
 
+void
+Packet::EnableCompactPrinting()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    PacketMetadata::EnableCompact();
+}
+
 void
 Packet::EnableChecking()
 {
@@ -606,6 +620,34 @@ Packet::EnableChecking()
     PacketMetadata::EnableChecking();
 }
 
+void
+Packet::EnablePool()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    PacketPool::Enable();
+}
+
+void*
+Packet::operator new(std::size_t size)
+{
+    if (!PacketPool::IsEnabled())
+    {
+        return ::operator new(size);
+    }
+    return PacketPool::AllocateObject(size);
+}
+
+void
+Packet::operator delete(void* p, std::size_t size)
+{
+    if (!PacketPool::IsEnabled())
+    {
+        ::operator delete(p, size);
+        return;
+    }
+    PacketPool::DeallocateObject(p, size);
+}
+
 uint32_t
 Packet::GetSerializedSize() const
 {
@@ -1019,7 +1061,7 @@ Packet::PrintPacketTags(std::ostream& os) const
 PacketTagIterator
 Packet::GetPacketTagIterator() const
 {
-    return PacketTagIterator(m_packetTagList.Head());
+    return PacketTagIterator(m_packetTagList.Head(), m_packetTagList.End());
 }
 
 std::ostream&
@@ -33,6 +33,8 @@
 #include "ns3/mac48-address.h"
 #include "ns3/ptr.h"
 
+#include <atomic>
+#include <cstddef>
 #include <stdint.h>
 
 namespace ns3
@@ -181,9 +183,11 @@ class PacketTagIterator
     /**
      * Constructor
      * \param head head of the items
+     * \param end end of the items
      */
-    PacketTagIterator(const PacketTagList::TagData* head);
+    PacketTagIterator(const PacketTagList::TagData* head, const PacketTagList::TagData* end);
     const PacketTagList::TagData* m_current; //!< actual position over the set of tags in a packet
+    const PacketTagList::TagData* m_end;     //!< end of the set of tags in a packet
 };
 
 /**
@@ -203,9 +207,10 @@ class PacketTagIterator
  * were serialized in the byte buffer. The maintenance of metadata is
  * optional and disabled by default. To enable it, you must call
  * Packet::EnablePrinting and this will allow you to get non-empty
- * output from Packet::Print. If you wish to only enable
- * checking of metadata, and do not need any printing capability, you can
- * call Packet::EnableChecking: its runtime cost is lower than
+ * output from Packet::Print. Packet::EnableCompactPrinting provides the
+ * same output, but delays the work until a packet is printed. If you wish
+ * to only enable checking of metadata, and do not need any printing
+ * capability, you can call Packet::EnableChecking: its runtime cost is lower than
  * Packet::EnablePrinting.
  *
  * - The set of tags contain simulation-specific information which cannot
@@ -525,6 +530,19 @@ class Packet : public SimpleRefCount<Packet>
      * simulation setup and before any packet is created.
      */
     static void EnablePrinting();
+    /**
+     * \brief Enable printing packets metadata, at a lower cost for the
+     * packets which are not printed.
+     *
+     * Like EnablePrinting(), but the packets only record a compact log
+     * of the headers and trailers added and removed, from which the
+     * metadata is rebuilt when the packet is printed. This is cheaper
+     * when only a small part of the packets are printed, and more
+     * expensive when all of them are printed at every hop.
+     *
+     * This has no effect if EnableChecking() is called.
+     */
+    static void EnableCompactPrinting();
     /**
      * \brief Enable packets metadata checking.
      *
@@ -536,6 +554,31 @@ class Packet : public SimpleRefCount<Packet>
      * errors will be detected and will abort the program.
      */
     static void EnableChecking();
+    /**
+     * \brief Enable the recycling of the memory of the packets.
+     *
+     * The Packet objects and their buffer data are kept in a PacketPool
+     * when they are freed, and reused by the next packets, instead of
+     * being allocated for every packet.  The statistics of the pool are
+     * returned by PacketPool::GetStats().
+     */
+    static void EnablePool();
+
+    /**
+     * \brief Allocate a Packet, from the PacketPool if it is enabled.
+     *
+     * \param [in] size The size of the object.
+     * \returns The memory of the object.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * \brief Free a Packet, keeping its memory in the PacketPool if it
+     * is enabled.
+     *
+     * \param [in] p The memory of the object.
+     * \param [in] size The size of the object.
+     */
+    static void operator delete(void* p, std::size_t size);
 
     /**
      * \brief Returns number of bytes required for packet
@@ -795,7 +838,7 @@ class Packet : public SimpleRefCount<Packet>
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-    static uint32_t m_globalUid; //!< Global counter of packets Uid
+    static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -22,6 +22,8 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/test.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -395,6 +397,157 @@ BufferTest::DoRun()
     NS_TEST_ASSERT_MSG_EQ(val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that concatenating fragments of buffers preserves their content,
+ * and keeps the zero areas virtual.
+ */
+class BufferConcatenationTest : public TestCase
+{
+  public:
+    BufferConcatenationTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create a buffer with real bytes around a zero area.
+     * \param start The number of real bytes before the zero area.
+     * \param zero The size of the zero area.
+     * \param end The number of real bytes after the zero area.
+     * \param seed The value of the first real byte.
+     * \return The buffer.
+     */
+    Buffer MakeBuffer(uint32_t start, uint32_t zero, uint32_t end, uint8_t seed);
+    /**
+     * \param buffer A buffer.
+     * \return The content of the buffer.
+     */
+    std::vector<uint8_t> GetContent(const Buffer& buffer);
+};
+
+BufferConcatenationTest::BufferConcatenationTest()
+    : TestCase("Buffer concatenation")
+{
+}
+
+Buffer
+BufferConcatenationTest::MakeBuffer(uint32_t start, uint32_t zero, uint32_t end, uint8_t seed)
+{
+    Buffer buffer(zero);
+    buffer.AddAtStart(start);
+    buffer.AddAtEnd(end);
+    Buffer::Iterator i = buffer.Begin();
+    for (uint32_t j = 0; j < start; j++)
+    {
+        i.WriteU8(seed++);
+    }
+    i = buffer.End();
+    i.Prev(end);
+    for (uint32_t j = 0; j < end; j++)
+    {
+        i.WriteU8(seed++);
+    }
+    return buffer;
+}
+
+std::vector<uint8_t>
+BufferConcatenationTest::GetContent(const Buffer& buffer)
+{
+    std::vector<uint8_t> content(buffer.GetSize());
+    buffer.CopyData(content.data(), content.size());
+    return content;
+}
+
+void
+BufferConcatenationTest::DoRun()
+{
+    // Reassemble the fragments of a payload shared with the original buffer
+    Buffer payload(2000);
+    Buffer whole = payload.CreateFragment(0, 500);
+    uint64_t copied = Buffer::GetCopiedBytes();
+    for (uint32_t offset = 500; offset < 2000; offset += 500)
+    {
+        whole.AddAtEnd(payload.CreateFragment(offset, 500));
+    }
+    NS_TEST_EXPECT_MSG_EQ(Buffer::GetCopiedBytes() - copied, 0, "Zero area copied");
+    NS_TEST_EXPECT_MSG_EQ((GetContent(whole) == std::vector<uint8_t>(2000)),
+                          true,
+                          "Wrong content");
+
+    // Only the header is copied when appending a payload to a header
+    Buffer header = MakeBuffer(40, 1000, 0, 1);
+    Buffer frame = header;
+    copied = Buffer::GetCopiedBytes();
+    frame.AddAtEnd(payload);
+    NS_TEST_EXPECT_MSG_EQ(Buffer::GetCopiedBytes() - copied, 40, "Zero area copied");
+    std::vector<uint8_t> expected = GetContent(header);
+    expected.resize(3040);
+    NS_TEST_EXPECT_MSG_EQ((GetContent(frame) == expected), true, "Wrong content");
+    NS_TEST_EXPECT_MSG_EQ((GetContent(header) == std::vector<uint8_t>(expected.begin(),
+                                                                       expected.begin() + 1040)),
+                          true,
+                          "Original buffer modified");
+
+    // The smaller zero area is copied when the zero areas are not adjacent
+    Buffer small = MakeBuffer(10, 20, 10, 50);
+    Buffer large = MakeBuffer(10, 2000, 10, 100);
+    for (bool smallFirst : {true, false})
+    {
+        Buffer first = smallFirst ? small : large;
+        Buffer second = smallFirst ? large : small;
+        expected = GetContent(first);
+        std::vector<uint8_t> tail = GetContent(second);
+        expected.insert(expected.end(), tail.begin(), tail.end());
+        copied = Buffer::GetCopiedBytes();
+        first.AddAtEnd(second);
+        NS_TEST_EXPECT_MSG_LT(Buffer::GetCopiedBytes() - copied, 200, "Large zero area copied");
+        NS_TEST_EXPECT_MSG_EQ((GetContent(first) == expected), true, "Wrong content");
+    }
+
+    // Append a buffer to itself
+    Buffer twice = MakeBuffer(3, 5, 3, 7);
+    expected = GetContent(twice);
+    expected.insert(expected.end(), expected.begin(), expected.end());
+    twice.AddAtEnd(twice);
+    NS_TEST_EXPECT_MSG_EQ((GetContent(twice) == expected), true, "Wrong content");
+
+    // Concatenate random fragments of random buffers
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    for (uint32_t run = 0; run < 200; run++)
+    {
+        Buffer source = MakeBuffer(rng->GetInteger(0, 50),
+                                   rng->GetInteger(0, 500),
+                                   rng->GetInteger(0, 50),
+                                   rng->GetInteger(0, 255));
+        std::vector<uint8_t> sourceContent = GetContent(source);
+        Buffer result;
+        expected.clear();
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            uint32_t start = rng->GetInteger(0, source.GetSize());
+            uint32_t length = rng->GetInteger(0, source.GetSize() - start);
+            Buffer fragment = source.CreateFragment(start, length);
+            if (rng->GetInteger(0, 1) == 1)
+            {
+                fragment.AddAtStart(1);
+                fragment.Begin().WriteU8(k);
+                expected.push_back(k);
+            }
+            expected.insert(expected.end(),
+                            sourceContent.begin() + start,
+                            sourceContent.begin() + start + length);
+            result.AddAtEnd(fragment);
+        }
+        NS_TEST_ASSERT_MSG_EQ((GetContent(result) == expected), true, "Wrong content");
+        NS_TEST_ASSERT_MSG_EQ((GetContent(source) == sourceContent),
+                              true,
+                              "Original buffer modified");
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -411,6 +564,7 @@ BufferTestSuite::BufferTestSuite()
     : TestSuite("buffer", Type::UNIT)
 {
     AddTestCase(new BufferTest, TestCase::Duration::QUICK);
+    AddTestCase(new BufferConcatenationTest, TestCase::Duration::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -326,7 +326,11 @@ HistoryTrailer<N>::Deserialize(Buffer::Iterator start)
 class PacketMetadataTest : public TestCase
 {
   public:
-    PacketMetadataTest();
+    /**
+     * Constructor
+     * \param compact Whether to enable the compact mode of the metadata
+     */
+    PacketMetadataTest(bool compact);
     ~PacketMetadataTest() override;
     /**
      * Checks the packet header and trailer history
@@ -344,10 +348,13 @@ class PacketMetadataTest : public TestCase
      * \return The packet with the header added.
      */
     Ptr<Packet> DoAddHeader(Ptr<Packet> p);
+
+    bool m_compact; //!< Whether to enable the compact mode of the metadata
 };
 
-PacketMetadataTest::PacketMetadataTest()
-    : TestCase("Packet metadata")
+PacketMetadataTest::PacketMetadataTest(bool compact)
+    : TestCase(compact ? "Packet metadata, compact mode" : "Packet metadata"),
+      m_compact(compact)
 {
 }
 
@@ -460,7 +467,7 @@ error:
     }
 #define CHECK_HISTORY(p, ...)                                                                      \
     {                                                                                              \
-        CheckHistory(p, __VA_ARGS__);                                                              \
+        CheckHistory(p->Copy(), __VA_ARGS__);                                                      \
         uint32_t size = p->GetSerializedSize();                                                    \
         uint8_t* buffer = new uint8_t[size];                                                       \
         p->Serialize(buffer, size);                                                                \
@@ -479,7 +486,14 @@ PacketMetadataTest::DoAddHeader(Ptr<Packet> p)
 void
 PacketMetadataTest::DoRun()
 {
-    PacketMetadata::Enable();
+    if (m_compact)
+    {
+        PacketMetadata::EnableCompact();
+    }
+    else
+    {
+        PacketMetadata::Enable();
+    }
 
     Ptr<Packet> p = Create<Packet>(0);
     Ptr<Packet> p1 = Create<Packet>(0);
@@ -896,7 +910,9 @@ class PacketMetadataTestSuite : public TestSuite
 PacketMetadataTestSuite::PacketMetadataTestSuite()
     : TestSuite("packet-metadata", Type::UNIT)
 {
-    AddTestCase(new PacketMetadataTest, TestCase::Duration::QUICK);
+    AddTestCase(new PacketMetadataTest(false), TestCase::Duration::QUICK);
+    // The compact mode cannot be disabled, so it is checked last
+    AddTestCase(new PacketMetadataTest(true), TestCase::Duration::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -16,6 +16,7 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/packet-pool.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/packet.h"
 #include "ns3/test.h"
@@ -26,6 +27,7 @@
 #include <iostream>
 #include <limits> // std:numeric_limits
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -1136,6 +1138,24 @@ PacketTagListTest::DoRun()
         }
     }
 
+    // Inline storage
+    {
+        std::cout << GetName() << "check a few small tags are stored inline" << std::endl;
+        uint64_t allocations = PacketTagList::GetAllocations();
+        PacketTagList ptl;
+        ptl.Add(t1);
+        ptl.Add(t2);
+        ptl.Add(t3);
+        PacketTagList copy = ptl;
+        copy.Remove(t2);
+        CheckRef(ptl, t2, "inline orig");
+        CheckRef(copy, t2, "inline copy", true);
+        CheckRef(copy, t3, "inline copy");
+        NS_TEST_EXPECT_MSG_EQ(PacketTagList::GetAllocations(),
+                              allocations,
+                              "small tag list allocated memory");
+    }
+
     // Removal
     {
 #define RemoveCheck(n)                                                                             \
@@ -1268,6 +1288,72 @@ PacketTagListTest::DoRun()
     } // Timing
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet pool unit tests.
+ */
+class PacketPoolTest : public TestCase
+{
+  public:
+    PacketPoolTest();
+
+  private:
+    void DoRun() override;
+    /**
+     * Create a packet holding some data, check it and drop it.
+     */
+    void CreatePacket();
+};
+
+PacketPoolTest::PacketPoolTest()
+    : TestCase("Check the recycling of the packets by PacketPool")
+{
+}
+
+void
+PacketPoolTest::CreatePacket()
+{
+    std::vector<uint8_t> data(1500);
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = i % 251;
+    }
+    Ptr<Packet> p = Create<Packet>(data.data(), data.size());
+    ATestHeader<10> header;
+    p->AddHeader(header);
+    p->RemoveHeader(header);
+    std::vector<uint8_t> copy(data.size());
+    p->CopyData(copy.data(), copy.size());
+    NS_TEST_EXPECT_MSG_EQ((copy == data), true, "Wrong packet content");
+}
+
+void
+PacketPoolTest::DoRun()
+{
+    PacketPool::Enable();
+    PacketPool::ResetStats();
+
+    CreatePacket();
+    PacketPool::Stats first = PacketPool::GetStats();
+    NS_TEST_EXPECT_MSG_GT(first.misses, 0, "No block allocated");
+    NS_TEST_EXPECT_MSG_GT(first.highWater, 0, "No block pooled");
+
+    // The second packet only uses the blocks freed by the first one
+    CreatePacket();
+    PacketPool::Stats second = PacketPool::GetStats();
+    NS_TEST_EXPECT_MSG_EQ(second.misses, first.misses, "Block not recycled");
+    NS_TEST_EXPECT_MSG_GT(second.hits, first.hits, "Block not recycled");
+    NS_TEST_EXPECT_MSG_EQ(second.highWater, first.highWater, "Pool grew");
+
+    PacketPool::Disable();
+    CreatePacket();
+    NS_TEST_EXPECT_MSG_EQ(PacketPool::GetStats().misses,
+                          second.misses,
+                          "Disabled pool used");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1285,6 +1371,7 @@ PacketTestSuite::PacketTestSuite()
 {
     AddTestCase(new PacketTest, TestCase::Duration::QUICK);
     AddTestCase(new PacketTagListTest, TestCase::Duration::QUICK);
+    AddTestCase(new PacketPoolTest, TestCase::Duration::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
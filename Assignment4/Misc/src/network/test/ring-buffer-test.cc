@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include "ns3/ring-buffer.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <list>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer test, comparing its content with that of a std::list after
+ * insertions and erasures at the ends and in the middle of the sequence.
+ */
+class RingBufferTestCase : public TestCase
+{
+  public:
+    RingBufferTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Check that the ring buffer and the list store the same elements
+     * \param ring the ring buffer
+     * \param list the list
+     * \param step the step of the test
+     */
+    void Compare(const RingBuffer<uint32_t>& ring, const std::list<uint32_t>& list, uint32_t step);
+};
+
+RingBufferTestCase::RingBufferTestCase()
+    : TestCase("Check the insertions and erasures of RingBuffer against std::list")
+{
+}
+
+void
+RingBufferTestCase::Compare(const RingBuffer<uint32_t>& ring,
+                            const std::list<uint32_t>& list,
+                            uint32_t step)
+{
+    NS_TEST_ASSERT_MSG_EQ(ring.size(), list.size(), "Wrong size at step " << step);
+    auto it = ring.begin();
+    for (uint32_t value : list)
+    {
+        NS_TEST_ASSERT_MSG_EQ(*it, value, "Wrong element at step " << step);
+        it++;
+    }
+    NS_TEST_ASSERT_MSG_EQ((it == ring.end()), true, "Wrong end at step " << step);
+}
+
+void
+RingBufferTestCase::DoRun()
+{
+    RingBuffer<uint32_t> ring;
+    std::list<uint32_t> list;
+
+    // a deterministic sequence of operations, mostly FIFO so that the elements
+    // wrap around the array, with insertions and erasures in the middle
+    uint32_t state = 1;
+    for (uint32_t step = 0; step < 5000; step++)
+    {
+        state = state * 1103515245 + 12345;
+        uint32_t op = (state >> 16) % 10;
+        uint32_t pos = (list.empty() ? 0 : (state >> 8) % (list.size() + 1));
+        if (op < 5 || list.empty())
+        {
+            // insert at the end, at the beginning or in the middle
+            pos = (op < 3 ? list.size() : (op == 3 ? 0 : pos));
+            auto ret = ring.insert(ring.begin() + pos, step);
+            list.insert(std::next(list.begin(), pos), step);
+            NS_TEST_ASSERT_MSG_EQ(*ret, step, "Wrong inserted element at step " << step);
+        }
+        else
+        {
+            // erase at the beginning, at the end or in the middle
+            pos = (op < 8 ? 0 : (op == 8 ? list.size() - 1 : pos % list.size()));
+            auto ret = ring.erase(ring.cbegin() + pos);
+            auto listRet = list.erase(std::next(list.begin(), pos));
+            NS_TEST_ASSERT_MSG_EQ((ret == ring.end()),
+                                  (listRet == list.end()),
+                                  "Wrong element after the erased one at step " << step);
+        }
+        Compare(ring, list, step);
+    }
+
+    // the array only grows to the next power of two
+    uint32_t capacity = ring.capacity();
+    while (ring.size() < capacity)
+    {
+        ring.insert(ring.end(), 0);
+    }
+    NS_TEST_EXPECT_MSG_EQ(ring.capacity(), capacity, "The array must not grow until full");
+    ring.insert(ring.begin(), 0);
+    NS_TEST_EXPECT_MSG_EQ(ring.capacity(), 2 * capacity, "The array must double when full");
+
+    ring.clear();
+    NS_TEST_EXPECT_MSG_EQ(ring.empty(), true, "The ring buffer must be empty");
+    NS_TEST_EXPECT_MSG_EQ(ring.capacity(), 2 * capacity, "Clear must keep the array");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a DropTailQueue, which stores its packets in a RingBuffer, keeps
+ * no reference to the packets it dequeued, and keeps the FIFO order when its
+ * packets wrap around the array and when the array grows.
+ */
+class RingBufferQueueTestCase : public TestCase
+{
+  public:
+    RingBufferQueueTestCase();
+    void DoRun() override;
+};
+
+RingBufferQueueTestCase::RingBufferQueueTestCase()
+    : TestCase("Check a drop tail queue storing its packets in a RingBuffer")
+{
+}
+
+void
+RingBufferQueueTestCase::DoRun()
+{
+    Ptr<DropTailQueue<Packet>> queue = CreateObject<DropTailQueue<Packet>>();
+    queue->SetAttribute("MaxSize", StringValue("100000B"));
+
+    std::list<Ptr<Packet>> packets;
+    for (uint32_t round = 0; round < 10; round++)
+    {
+        // the backlog grows, so that the array wraps around and grows
+        for (uint32_t i = 0; i < 10 * round + 5; i++)
+        {
+            packets.push_back(Create<Packet>(100));
+            NS_TEST_ASSERT_MSG_EQ(queue->Enqueue(packets.back()), true, "Enqueue failed");
+        }
+        for (uint32_t i = 0; i < 5 * round + 3; i++)
+        {
+            Ptr<Packet> p = queue->Dequeue();
+            NS_TEST_ASSERT_MSG_EQ(p, packets.front(), "The packets must be dequeued in order");
+            packets.pop_front();
+            // p now holds the only reference to the packet
+            NS_TEST_EXPECT_MSG_EQ(p->GetReferenceCount(), 1, "The queue must release the packet");
+        }
+        NS_TEST_ASSERT_MSG_EQ(queue->GetNPackets(), packets.size(), "Wrong number of packets");
+    }
+
+    queue->Dispose();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief RingBuffer TestSuite
+ */
+class RingBufferTestSuite : public TestSuite
+{
+  public:
+    RingBufferTestSuite()
+        : TestSuite("ring-buffer", Type::UNIT)
+    {
+        AddTestCase(new RingBufferTestCase(), TestCase::Duration::QUICK);
+        AddTestCase(new RingBufferQueueTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+static RingBufferTestSuite g_ringBufferTestSuite; //!< Static variable for test initialization
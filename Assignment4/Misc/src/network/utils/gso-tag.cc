@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "gso-tag.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <map>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("GsoTag");
+
+NS_OBJECT_ENSURE_REGISTERED(GsoTag);
+
+/**
+ * \returns The segmenters, indexed by network protocol number
+ */
+static std::map<uint16_t, GsoTag::Segmenter>&
+GetSegmenters()
+{
+    static std::map<uint16_t, GsoTag::Segmenter> segmenters;
+    return segmenters;
+}
+
+TypeId
+GsoTag::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::GsoTag")
+                            .SetParent<Tag>()
+                            .SetGroupName("Network")
+                            .AddConstructor<GsoTag>();
+    return tid;
+}
+
+TypeId
+GsoTag::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+uint32_t
+GsoTag::GetSerializedSize() const
+{
+    return 6;
+}
+
+void
+GsoTag::Serialize(TagBuffer buf) const
+{
+    buf.WriteU16(m_segmentSize);
+    buf.WriteU16(m_headerSize);
+    buf.WriteU16(m_segments);
+}
+
+void
+GsoTag::Deserialize(TagBuffer buf)
+{
+    m_segmentSize = buf.ReadU16();
+    m_headerSize = buf.ReadU16();
+    m_segments = buf.ReadU16();
+}
+
+void
+GsoTag::Print(std::ostream& os) const
+{
+    os << "SegmentSize=" << m_segmentSize << " HeaderSize=" << m_headerSize
+       << " Segments=" << m_segments;
+}
+
+GsoTag::GsoTag()
+    : Tag(),
+      m_segmentSize(0),
+      m_headerSize(0),
+      m_segments(0)
+{
+}
+
+GsoTag::GsoTag(uint16_t segmentSize, uint16_t headerSize, uint16_t segments)
+    : Tag(),
+      m_segmentSize(segmentSize),
+      m_headerSize(headerSize),
+      m_segments(segments)
+{
+}
+
+void
+GsoTag::SetSegmentSize(uint16_t segmentSize)
+{
+    m_segmentSize = segmentSize;
+}
+
+uint16_t
+GsoTag::GetSegmentSize() const
+{
+    return m_segmentSize;
+}
+
+void
+GsoTag::SetHeaderSize(uint16_t headerSize)
+{
+    m_headerSize = headerSize;
+}
+
+uint16_t
+GsoTag::GetHeaderSize() const
+{
+    return m_headerSize;
+}
+
+void
+GsoTag::SetSegments(uint16_t segments)
+{
+    m_segments = segments;
+}
+
+uint16_t
+GsoTag::GetSegments() const
+{
+    return m_segments;
+}
+
+void
+GsoTag::RegisterSegmenter(uint16_t protocol, Segmenter segmenter)
+{
+    NS_LOG_FUNCTION(protocol);
+    if (segmenter.IsNull())
+    {
+        GetSegmenters().erase(protocol);
+        return;
+    }
+    GetSegmenters()[protocol] = segmenter;
+}
+
+GsoTag::Segmenter
+GsoTag::GetSegmenter(uint16_t protocol)
+{
+    NS_LOG_FUNCTION(protocol);
+    auto it = GetSegmenters().find(protocol);
+    return it == GetSegmenters().end() ? Segmenter() : it->second;
+}
+
+std::list<Ptr<Packet>>
+GsoTag::Segment(Ptr<const Packet> packet, uint16_t protocol)
+{
+    NS_LOG_FUNCTION(packet << protocol);
+    auto it = GetSegmenters().find(protocol);
+    NS_ABORT_MSG_IF(it == GetSegmenters().end(),
+                    "No GSO segmenter registered for protocol " << protocol);
+    return it->second(packet);
+}
+
+} // namespace ns3
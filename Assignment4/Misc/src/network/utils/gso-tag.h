@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/callback.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+
+#include <list>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief Segmentation descriptor of a batch of transport segments
+ *
+ * A transport protocol doing generic segmentation offload (GSO) sends a
+ * batch of consecutive segments down the stack as a single packet: one
+ * transport header followed by the payload of all the segments. This
+ * packet tag tells how to split the batch back into segments: each segment
+ * carries a copy of the transport header followed by at most
+ * GetSegmentSize() bytes of the payload.
+ *
+ * The split is done by the segmenter registered by the transport protocol
+ * for the network protocol of the packet. It is called by the devices
+ * supporting GSO (see NetDevice::SupportsGso) right before the
+ * transmission, and by the network layer for the other devices.
+ *
+ * The tag also describes the chunks made of several received segments merged
+ * by a receive offload, so that the transport protocol can account for each
+ * of them.
+ */
+class GsoTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(TagBuffer buf) const override;
+    void Deserialize(TagBuffer buf) override;
+    void Print(std::ostream& os) const override;
+    GsoTag();
+
+    /**
+     * Constructs a GsoTag
+     *
+     * \param segmentSize The size of the payload of the segments
+     * \param headerSize The size of the transport header of the segments
+     * \param segments The number of segments
+     */
+    GsoTag(uint16_t segmentSize, uint16_t headerSize, uint16_t segments);
+
+    /**
+     * \param segmentSize The size of the payload of the segments
+     */
+    void SetSegmentSize(uint16_t segmentSize);
+    /**
+     * \returns The size of the payload of the segments, except the last one
+     * which may be smaller
+     */
+    uint16_t GetSegmentSize() const;
+    /**
+     * \param headerSize The size of the transport header of the segments
+     */
+    void SetHeaderSize(uint16_t headerSize);
+    /**
+     * \returns The size of the transport header of the segments
+     */
+    uint16_t GetHeaderSize() const;
+    /**
+     * \param segments The number of segments
+     */
+    void SetSegments(uint16_t segments);
+    /**
+     * \returns The number of segments
+     */
+    uint16_t GetSegments() const;
+
+    /**
+     * Callback splitting a batch into segments. The packet starts with the
+     * network header; the segments are returned in order, each with its
+     * own network header, and without the GsoTag.
+     */
+    typedef Callback<std::list<Ptr<Packet>>, Ptr<const Packet>> Segmenter;
+
+    /**
+     * \brief Register the segmenter of the batches of a network protocol
+     * \param protocol The network protocol number (e.g., 0x0800 for IPv4)
+     * \param segmenter The segmenter, or a null callback to unregister the
+     *        segmenter of the protocol
+     */
+    static void RegisterSegmenter(uint16_t protocol, Segmenter segmenter);
+
+    /**
+     * \brief Get the segmenter of the batches of a network protocol
+     * \param protocol The network protocol number
+     * \returns The segmenter, or a null callback if none is registered
+     */
+    static Segmenter GetSegmenter(uint16_t protocol);
+
+    /**
+     * \brief Split a batch into segments
+     * \param packet The batch, starting with its network header
+     * \param protocol The network protocol number of the batch
+     * \returns The segments
+     */
+    static std::list<Ptr<Packet>> Segment(Ptr<const Packet> packet, uint16_t protocol);
+
+  private:
+    uint16_t m_segmentSize; //!< Size of the payload of the segments
+    uint16_t m_headerSize;  //!< Size of the transport header of the segments
+    uint16_t m_segments;    //!< Number of segments
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
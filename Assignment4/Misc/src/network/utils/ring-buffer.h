@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup queue
+ * ns3::RingBuffer declaration and template implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ *
+ * \brief A sequence container storing its elements in a circular array
+ *
+ * RingBuffer provides the subset of the interface of std::list used by the
+ * Queue class (insert(), erase(), clear(), iterators and const iterators), so
+ * that it can be used as the container of a Queue. Unlike std::list, it does
+ * not allocate memory for each inserted element: the elements are stored in
+ * an array whose size is a power of two, which is doubled when full and
+ * never shrunk. Hence, the array of a queue whose maximum size is given in
+ * packets is bounded by twice that size, and a queue stops allocating memory
+ * once it has been filled.
+ *
+ * Inserting or erasing an element at the beginning or at the end takes
+ * constant time, as in a FIFO queue. Inserting or erasing an element
+ * elsewhere moves the elements between it and the closest end of the
+ * sequence. As with std::deque, inserting or erasing an element invalidates
+ * all the iterators.
+ *
+ * \tparam T \explicit Type of the stored elements
+ */
+template <typename T>
+class RingBuffer
+{
+  public:
+    /// Type of the stored elements
+    typedef T value_type;
+    /// Type of the number of elements
+    typedef std::size_t size_type;
+    /// Type of the distance between elements
+    typedef std::ptrdiff_t difference_type;
+
+    /**
+     * \brief Iterator over the elements of a RingBuffer
+     *
+     * The iterator refers to an element through its position in the
+     * sequence, hence it is a random access iterator.
+     *
+     * \tparam IsConst \explicit whether the iterator gives const access to the elements
+     */
+    template <bool IsConst>
+    class Iter
+    {
+      public:
+        /// Iterator category
+        typedef std::random_access_iterator_tag iterator_category;
+        /// Type of the elements
+        typedef T value_type;
+        /// Type of the distance between elements
+        typedef std::ptrdiff_t difference_type;
+        /// Pointer to an element
+        typedef std::conditional_t<IsConst, const T*, T*> pointer;
+        /// Reference to an element
+        typedef std::conditional_t<IsConst, const T&, T&> reference;
+
+        /// Type of the ring buffer
+        typedef std::conditional_t<IsConst, const RingBuffer, RingBuffer> Buffer;
+
+        Iter() = default;
+
+        /**
+         * Constructor
+         * \param buffer the ring buffer
+         * \param pos the position of the element in the sequence
+         */
+        Iter(Buffer* buffer, size_type pos)
+            : m_buffer(buffer),
+              m_pos(pos)
+        {
+        }
+
+        /**
+         * Conversion from an iterator to a const iterator
+         * \param it the iterator
+         */
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iter(const Iter<OtherConst>& it)
+            : m_buffer(it.m_buffer),
+              m_pos(it.m_pos)
+        {
+        }
+
+        /// \return a reference to the element
+        reference operator*() const
+        {
+            return m_buffer->At(m_pos);
+        }
+
+        /// \return a pointer to the element
+        pointer operator->() const
+        {
+            return &m_buffer->At(m_pos);
+        }
+
+        /**
+         * \param n the distance from this element
+         * \return a reference to the element at the given distance
+         */
+        reference operator[](difference_type n) const
+        {
+            return m_buffer->At(m_pos + n);
+        }
+
+        /// \return this iterator, moved to the next element
+        Iter& operator++()
+        {
+            m_pos++;
+            return *this;
+        }
+
+        /// \return a copy of this iterator, before moving it to the next element
+        Iter operator++(int)
+        {
+            Iter it = *this;
+            m_pos++;
+            return it;
+        }
+
+        /// \return this iterator, moved to the previous element
+        Iter& operator--()
+        {
+            m_pos--;
+            return *this;
+        }
+
+        /// \return a copy of this iterator, before moving it to the previous element
+        Iter operator--(int)
+        {
+            Iter it = *this;
+            m_pos--;
+            return it;
+        }
+
+        /**
+         * \param n the number of elements to move forward
+         * \return this iterator, moved forward by n elements
+         */
+        Iter& operator+=(difference_type n)
+        {
+            m_pos += n;
+            return *this;
+        }
+
+        /**
+         * \param n the number of elements to move backward
+         * \return this iterator, moved backward by n elements
+         */
+        Iter& operator-=(difference_type n)
+        {
+            m_pos -= n;
+            return *this;
+        }
+
+        /**
+         * \param it an iterator
+         * \param n the number of elements to move forward
+         * \return an iterator to the element n elements after that of it
+         */
+        friend Iter operator+(Iter it, difference_type n)
+        {
+            return it += n;
+        }
+
+        /**
+         * \param n the number of elements to move forward
+         * \param it an iterator
+         * \return an iterator to the element n elements after that of it
+         */
+        friend Iter operator+(difference_type n, Iter it)
+        {
+            return it += n;
+        }
+
+        /**
+         * \param it an iterator
+         * \param n the number of elements to move backward
+         * \return an iterator to the element n elements before that of it
+         */
+        friend Iter operator-(Iter it, difference_type n)
+        {
+            return it -= n;
+        }
+
+        /**
+         * \param a an iterator
+         * \param b an iterator over the same ring buffer
+         * \return the number of elements from b to a
+         */
+        friend difference_type operator-(const Iter& a, const Iter& b)
+        {
+            return static_cast<difference_type>(a.m_pos) - static_cast<difference_type>(b.m_pos);
+        }
+
+        /**
+         * \param a an iterator
+         * \param b an iterator over the same ring buffer
+         * \return whether the iterators refer to the same element
+         */
+        friend bool operator==(const Iter& a, const Iter& b)
+        {
+            return a.m_pos == b.m_pos;
+        }
+
+        /**
+         * \param a an iterator
+         * \param b an iterator over the same ring buffer
+         * \return the ordering of the elements the iterators refer to
+         */
+        friend auto operator<=>(const Iter& a, const Iter& b)
+        {
+            return a.m_pos <=> b.m_pos;
+        }
+
+      private:
+        friend class RingBuffer;
+        friend class Iter<!IsConst>;
+
+        Buffer* m_buffer{nullptr}; //!< the ring buffer
+        size_type m_pos{0};        //!< the position of the element in the sequence
+    };
+
+    /// Iterator
+    typedef Iter<false> iterator;
+    /// Const iterator
+    typedef Iter<true> const_iterator;
+
+    RingBuffer() = default;
+
+    /// \return an iterator to the first element
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    /// \return an iterator past the last element
+    iterator end()
+    {
+        return iterator(this, m_size);
+    }
+
+    /// \return a const iterator to the first element
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// \return a const iterator past the last element
+    const_iterator end() const
+    {
+        return const_iterator(this, m_size);
+    }
+
+    /// \return a const iterator to the first element
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    /// \return a const iterator past the last element
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    /// \return the number of elements
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    /// \return whether there is no element
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /// \return the number of elements that can be stored without allocating memory
+    size_type capacity() const
+    {
+        return m_slots.size();
+    }
+
+    /// \return a reference to the first element
+    T& front()
+    {
+        NS_ASSERT(m_size > 0);
+        return At(0);
+    }
+
+    /// \return a const reference to the first element
+    const T& front() const
+    {
+        NS_ASSERT(m_size > 0);
+        return At(0);
+    }
+
+    /// \return a reference to the last element
+    T& back()
+    {
+        NS_ASSERT(m_size > 0);
+        return At(m_size - 1);
+    }
+
+    /// \return a const reference to the last element
+    const T& back() const
+    {
+        NS_ASSERT(m_size > 0);
+        return At(m_size - 1);
+    }
+
+    /**
+     * Allocate memory for at least the given number of elements
+     * \param n the number of elements
+     */
+    void reserve(size_type n)
+    {
+        size_type slots = (m_slots.empty() ? MIN_CAPACITY : m_slots.size());
+        while (slots < n)
+        {
+            slots *= 2;
+        }
+        if (slots != m_slots.size())
+        {
+            Resize(slots);
+        }
+    }
+
+    /**
+     * Insert an element
+     * \param pos the position before which the element is inserted
+     * \param value the element
+     * \return an iterator to the inserted element
+     */
+    iterator insert(const_iterator pos, T value)
+    {
+        size_type index = pos.m_pos;
+        NS_ASSERT(index <= m_size);
+        if (m_size == m_slots.size())
+        {
+            reserve(m_size + 1);
+        }
+        if (index < m_size - index)
+        {
+            // move the elements before the position backward
+            m_head = (m_head - 1) & (m_slots.size() - 1);
+            for (size_type i = 0; i < index; i++)
+            {
+                At(i) = std::move(At(i + 1));
+            }
+        }
+        else
+        {
+            // move the elements from the position forward
+            for (size_type i = m_size; i > index; i--)
+            {
+                At(i) = std::move(At(i - 1));
+            }
+        }
+        At(index) = std::move(value);
+        m_size++;
+        return iterator(this, index);
+    }
+
+    /**
+     * Erase an element
+     * \param pos the position of the element
+     * \return an iterator to the element following the erased one
+     */
+    iterator erase(const_iterator pos)
+    {
+        size_type index = pos.m_pos;
+        NS_ASSERT(index < m_size);
+        if (index < m_size - index - 1)
+        {
+            // move the elements before the position forward
+            for (size_type i = index; i > 0; i--)
+            {
+                At(i) = std::move(At(i - 1));
+            }
+            // release the element left in the freed slot
+            At(0) = T();
+            m_head = (m_head + 1) & (m_slots.size() - 1);
+        }
+        else
+        {
+            // move the elements after the position backward
+            for (size_type i = index; i + 1 < m_size; i++)
+            {
+                At(i) = std::move(At(i + 1));
+            }
+            At(m_size - 1) = T();
+        }
+        m_size--;
+        return iterator(this, index);
+    }
+
+    /**
+     * Erase all the elements, keeping the allocated memory
+     */
+    void clear()
+    {
+        for (size_type i = 0; i < m_size; i++)
+        {
+            At(i) = T();
+        }
+        m_head = 0;
+        m_size = 0;
+    }
+
+  private:
+    /// Number of slots allocated when the first element is inserted
+    static constexpr size_type MIN_CAPACITY = 16;
+
+    /**
+     * \param i the position of an element in the sequence
+     * \return a reference to the slot of the element
+     */
+    T& At(size_type i)
+    {
+        return m_slots[(m_head + i) & (m_slots.size() - 1)];
+    }
+
+    /**
+     * \param i the position of an element in the sequence
+     * \return a const reference to the slot of the element
+     */
+    const T& At(size_type i) const
+    {
+        return m_slots[(m_head + i) & (m_slots.size() - 1)];
+    }
+
+    /**
+     * Move the elements to a new array, the first one in the first slot
+     * \param slots the number of slots of the new array, a power of two
+     */
+    void Resize(size_type slots)
+    {
+        NS_ASSERT(slots >= m_size && (slots & (slots - 1)) == 0);
+        std::vector<T> newSlots(slots);
+        for (size_type i = 0; i < m_size; i++)
+        {
+            newSlots[i] = std::move(At(i));
+        }
+        m_slots = std::move(newSlots);
+        m_head = 0;
+    }
+
+    std::vector<T> m_slots; //!< the slots, whose number is zero or a power of two
+    size_type m_head{0};    //!< the slot of the first element
+    size_type m_size{0};    //!< the number of elements
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -19,11 +19,14 @@
 
 #include "point-to-point-net-device.h"
 
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -44,6 +47,13 @@ PointToPointChannel::GetTypeId()
                           TimeValue(Seconds(0)),
                           MakeTimeAccessor(&PointToPointChannel::m_delay),
                           MakeTimeChecker())
+            .AddAttribute("DeepCopy",
+                          "Deliver a serialized copy of each packet, sharing no state with "
+                          "the sender.  Set by parallel simulators on the links they cut "
+                          "between threads.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PointToPointChannel::m_deepCopy),
+                          MakeBooleanChecker())
             .AddTraceSource("TxRxPointToPoint",
                             "Trace source indicating transmission of packet "
                             "from the PointToPointChannel, used by the Animation "
@@ -59,6 +69,7 @@ PointToPointChannel::GetTypeId()
 PointToPointChannel::PointToPointChannel()
     : Channel(),
       m_delay(Seconds(0.)),
+      m_deepCopy(false),
       m_nDevices(0)
 {
     NS_LOG_FUNCTION_NOARGS();
@@ -82,6 +93,13 @@ PointToPointChannel::Attach(Ptr<PointToPointNetDevice> device)
         m_link[1].m_dst = m_link[0].m_src;
         m_link[0].m_state = IDLE;
         m_link[1].m_state = IDLE;
+        for (auto& link : m_link)
+        {
+            if (link.m_dst->GetNode())
+            {
+                link.m_dstContext = link.m_dst->GetNode()->GetId();
+            }
+        }
     }
 }
 
@@ -96,6 +114,26 @@ PointToPointChannel::TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevic
 
     uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+    if (m_deepCopy)
+    {
+        // The receiver may run on another thread: hand it a packet sharing
+        // no buffer with the sender, and do not touch the reference counts
+        // of its device and node
+        uint32_t size = p->GetSerializedSize();
+        std::vector<uint8_t> buffer(size);
+        p->Serialize(buffer.data(), size);
+        Simulator::ScheduleWithContext(m_link[wire].m_dstContext,
+                                       txTime + m_delay,
+                                       &PointToPointNetDevice::Receive,
+                                       PeekPointer(m_link[wire].m_dst),
+                                       Create<Packet>(buffer.data(), size, true));
+        if (!m_txrxPointToPoint.IsEmpty())
+        {
+            m_txrxPointToPoint(p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+        }
+        return true;
+    }
+
     Simulator::ScheduleWithContext(m_link[wire].m_dst->GetNode()->GetId(),
                                    txTime + m_delay,
                                    &PointToPointNetDevice::Receive,
@@ -107,6 +145,19 @@ PointToPointChannel::TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevic
     return true;
 }
 
+void
+PointToPointChannel::DoDispose()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (auto& link : m_link)
+    {
+        link.m_src = nullptr;
+        link.m_dst = nullptr;
+    }
+    m_nDevices = 0;
+    Channel::DoDispose();
+}
+
 std::size_t
 PointToPointChannel::GetNDevices() const
 {
@@ -102,6 +102,8 @@ class PointToPointChannel : public Channel
     Ptr<NetDevice> GetDevice(std::size_t i) const override;
 
   protected:
+    void DoDispose() override;
+
     /**
      * \brief Get the delay associated with this channel
      * \returns Time delay
@@ -152,6 +154,7 @@ class PointToPointChannel : public Channel
     static const std::size_t N_DEVICES = 2;
 
     Time m_delay;           //!< Propagation delay
+    bool m_deepCopy;        //!< Deliver serialized copies of the packets
     std::size_t m_nDevices; //!< Devices of this channel
 
     /**
@@ -202,6 +205,7 @@ class PointToPointChannel : public Channel
         WireState m_state{INITIALIZING};  //!< State of the link
         Ptr<PointToPointNetDevice> m_src; //!< First NetDevice
         Ptr<PointToPointNetDevice> m_dst; //!< Second NetDevice
+        uint32_t m_dstContext{0};         //!< Id of the node of the second NetDevice
     };
 
     Link m_link[N_DEVICES]; //!< Link model
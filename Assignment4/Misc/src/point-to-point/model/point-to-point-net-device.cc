@@ -21,6 +21,7 @@
 #include "ppp-header.h"
 
 #include "ns3/error-model.h"
+#include "ns3/gso-tag.h"
 #include "ns3/llc-snap-header.h"
 #include "ns3/log.h"
 #include "ns3/mac48-address.h"
@@ -215,6 +216,7 @@ PointToPointNetDevice::DoDispose()
     m_channel = nullptr;
     m_receiveErrorModel = nullptr;
     m_currentPkt = nullptr;
+    m_gsoSegments.clear();
     m_queue = nullptr;
     NetDevice::DoDispose();
 }
@@ -233,6 +235,30 @@ PointToPointNetDevice::SetInterframeGap(Time t)
     m_tInterframeGap = t;
 }
 
+Ptr<Packet>
+PointToPointNetDevice::SplitGsoBatch(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+
+    GsoTag gsoTag;
+    if (!p->PeekPacketTag(gsoTag))
+    {
+        return p;
+    }
+    NS_LOG_LOGIC("Split a GSO batch of " << gsoTag.GetSegments() << " segments");
+    Ptr<Packet> batch = p->Copy();
+    PppHeader ppp;
+    batch->RemoveHeader(ppp);
+    for (const auto& segment : GsoTag::Segment(batch, PppToEther(ppp.GetProtocol())))
+    {
+        segment->AddHeader(ppp);
+        m_gsoSegments.push_back(segment);
+    }
+    p = m_gsoSegments.front();
+    m_gsoSegments.pop_front();
+    return p;
+}
+
 bool
 PointToPointNetDevice::TransmitStart(Ptr<Packet> p)
 {
@@ -282,11 +308,22 @@ PointToPointNetDevice::TransmitComplete()
     m_phyTxEndTrace(m_currentPkt);
     m_currentPkt = nullptr;
 
-    Ptr<Packet> p = m_queue->Dequeue();
-    if (!p)
+    Ptr<Packet> p;
+    if (!m_gsoSegments.empty())
     {
-        NS_LOG_LOGIC("No pending packets in device queue after tx complete");
-        return;
+        // Finish the transmission of a GSO batch first
+        p = m_gsoSegments.front();
+        m_gsoSegments.pop_front();
+    }
+    else
+    {
+        p = m_queue->Dequeue();
+        if (!p)
+        {
+            NS_LOG_LOGIC("No pending packets in device queue after tx complete");
+            return;
+        }
+        p = SplitGsoBatch(p);
     }
 
     //
@@ -309,9 +346,13 @@ PointToPointNetDevice::Attach(Ptr<PointToPointChannel> ch)
     //
     // This device is up whenever it is attached to a channel.  A better plan
     // would be to have the link come up when both devices are attached, but this
-    // is not done for now.
+    // is not done for now.  A device moved to another channel, e.g., to a
+    // remote channel by a partitioner, is already up.
     //
-    NotifyLinkUp();
+    if (!m_linkUp)
+    {
+        NotifyLinkUp();
+    }
     return true;
 }
 
@@ -544,7 +585,7 @@ PointToPointNetDevice::Send(Ptr<Packet> packet, const Address& dest, uint16_t pr
         //
         if (m_txMachineState == READY)
         {
-            packet = m_queue->Dequeue();
+            packet = SplitGsoBatch(m_queue->Dequeue());
             m_snifferTrace(packet);
             m_promiscSnifferTrace(packet);
             bool ret = TransmitStart(packet);
@@ -608,6 +649,13 @@ PointToPointNetDevice::SupportsSendFrom() const
     return false;
 }
 
+bool
+PointToPointNetDevice::SupportsGso() const
+{
+    NS_LOG_FUNCTION(this);
+    return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive(Ptr<Packet> p)
 {
@@ -31,6 +31,7 @@
 #include "ns3/traced-callback.h"
 
 #include <cstring>
+#include <deque>
 
 namespace ns3
 {
@@ -197,6 +198,7 @@ class PointToPointNetDevice : public NetDevice
 
     void SetPromiscReceiveCallback(PromiscReceiveCallback cb) override;
     bool SupportsSendFrom() const override;
+    bool SupportsGso() const override;
 
   protected:
     /**
@@ -253,6 +255,17 @@ class PointToPointNetDevice : public NetDevice
      */
     bool TransmitStart(Ptr<Packet> p);
 
+    /**
+     * Split a packet carrying a GsoTag into segments.
+     *
+     * The first segment is returned, and the others are kept in
+     * m_gsoSegments, to be transmitted before the next packet of the queue.
+     *
+     * \param p a packet dequeued from the transmit queue
+     * \returns the first segment, or p if it does not carry a GsoTag
+     */
+    Ptr<Packet> SplitGsoBatch(Ptr<Packet> p);
+
     /**
      * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
      *
@@ -444,6 +457,8 @@ class PointToPointNetDevice : public NetDevice
 
     Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+    std::deque<Ptr<Packet>> m_gsoSegments; //!< Segments of a GSO batch left to transmit
+
     /**
      * \brief PPP to Ethernet protocol number mapping
      * \param protocol A PPP protocol number
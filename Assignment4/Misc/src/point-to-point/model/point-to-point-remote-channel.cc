@@ -21,8 +21,11 @@
 
 #include "point-to-point-net-device.h"
 
+#include "ns3/channel-list.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/mpi-partition-helper.h"
+#include "ns3/mpi-receiver.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
@@ -35,6 +38,22 @@ NS_LOG_COMPONENT_DEFINE("PointToPointRemoteChannel");
 
 NS_OBJECT_ENSURE_REGISTERED(PointToPointRemoteChannel);
 
+/**
+ * \ingroup point-to-point
+ * Register the point-to-point channels with MpiPartitionHelper.
+ */
+static struct PointToPointRemoteChannelRegistration
+{
+    PointToPointRemoteChannelRegistration()
+    {
+        MpiPartitionHelper::RegisterRemoteChannel(
+            PointToPointChannel::GetTypeId(),
+            MakeCallback(&PointToPointRemoteChannel::Replace));
+        MpiPartitionHelper::RegisterRemoteChannel(PointToPointRemoteChannel::GetTypeId(),
+                                                  MpiPartitionHelper::RemoteChannelCallback());
+    }
+} g_pointToPointRemoteChannelRegistration; //!< Static variable for registration
+
 TypeId
 PointToPointRemoteChannel::GetTypeId()
 {
@@ -73,4 +92,35 @@ PointToPointRemoteChannel::TransmitStart(Ptr<const Packet> p,
     return true;
 }
 
+void
+PointToPointRemoteChannel::Replace(Ptr<Channel> channel)
+{
+    NS_LOG_FUNCTION(channel);
+    Ptr<PointToPointChannel> local = DynamicCast<PointToPointChannel>(channel);
+    NS_ASSERT_MSG(local, "Not a point-to-point channel");
+    if (DynamicCast<PointToPointRemoteChannel>(local))
+    {
+        return;
+    }
+    TimeValue delay;
+    local->GetAttribute("Delay", delay);
+    Ptr<PointToPointRemoteChannel> remote = CreateObject<PointToPointRemoteChannel>();
+    remote->SetAttribute("Delay", delay);
+    for (std::size_t i = 0; i < local->GetNDevices(); ++i)
+    {
+        Ptr<PointToPointNetDevice> device = local->GetPointToPointDevice(i);
+        if (!device->GetObject<MpiReceiver>())
+        {
+            Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver>();
+            receiver->SetReceiveCallback(MakeCallback(&PointToPointNetDevice::Receive, device));
+            device->AggregateObject(receiver);
+        }
+        device->Attach(remote);
+    }
+    // The remote channel takes the id and the slot of the local one, which
+    // would otherwise stay in the ChannelList with stale links
+    ChannelList::Replace(local, remote);
+    local->Dispose();
+}
+
 } // namespace ns3
@@ -67,6 +67,19 @@ class PointToPointRemoteChannel : public PointToPointChannel
      * \returns true if successful (currently always true)
      */
     bool TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime) override;
+
+    /**
+     * \brief Replace a channel by a remote channel with the same delay,
+     * attaching the same devices
+     *
+     * The remote channel takes the id and the index of the channel in the
+     * ChannelList, and the replaced channel is disposed.  Registered with
+     * MpiPartitionHelper, to cut point-to-point links between ranks once
+     * the topology is built.
+     *
+     * \param channel The PointToPointChannel to replace
+     */
+    static void Replace(Ptr<Channel> channel);
 };
 
 } // namespace ns3
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/channel-list.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/mpi-partition-helper.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/node-container.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \brief Check the replacement of a point-to-point link cut by
+ * MpiPartitionHelper with a PointToPointRemoteChannel.
+ *
+ * Two nodes are joined by a 5 ms point-to-point link, split between two
+ * ranks.  The remote channel must take the id and the ChannelList slot of
+ * the replaced channel, keep its delay and its devices, and the devices
+ * must not report their link up again.
+ */
+class PointToPointRemoteChannelTest : public TestCase
+{
+  public:
+    PointToPointRemoteChannelTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Count a link change of a device
+     *
+     * \param device The index of the device.
+     */
+    void LinkChange(uint32_t device);
+
+    uint32_t m_linkChanges[2]; //!< Link changes of each device
+};
+
+PointToPointRemoteChannelTest::PointToPointRemoteChannelTest()
+    : TestCase("Check the replacement of a cut link by a PointToPointRemoteChannel"),
+      m_linkChanges{0, 0}
+{
+}
+
+void
+PointToPointRemoteChannelTest::LinkChange(uint32_t device)
+{
+    m_linkChanges[device]++;
+}
+
+void
+PointToPointRemoteChannelTest::DoRun()
+{
+    NodeContainer nodes(2);
+    Ptr<PointToPointChannel> local = CreateObject<PointToPointChannel>();
+    local->SetAttribute("Delay", TimeValue(MilliSeconds(5)));
+    // A channel created later, whose id must not change
+    Ptr<PointToPointChannel> other = CreateObject<PointToPointChannel>();
+    uint32_t id = local->GetId();
+    uint32_t otherId = other->GetId();
+    uint32_t nChannels = ChannelList::GetNChannels();
+
+    Ptr<PointToPointNetDevice> devices[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        devices[i] = CreateObject<PointToPointNetDevice>();
+        devices[i]->SetAddress(Mac48Address::Allocate());
+        devices[i]->SetQueue(CreateObject<DropTailQueue<Packet>>());
+        nodes.Get(i)->AddDevice(devices[i]);
+        devices[i]->AddLinkChangeCallback(
+            MakeCallback(&PointToPointRemoteChannelTest::LinkChange, this).Bind(i));
+        devices[i]->Attach(local);
+    }
+
+    MpiPartitionHelper partitioner;
+    partitioner.Partition(nodes, 2);
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetCutCount(), 1, "The link was not cut");
+    NS_TEST_EXPECT_MSG_NE(nodes.Get(0)->GetSystemId(),
+                          nodes.Get(1)->GetSystemId(),
+                          "Nodes not partitioned");
+
+    Ptr<PointToPointRemoteChannel> remote =
+        DynamicCast<PointToPointRemoteChannel>(ChannelList::GetChannel(id));
+    NS_TEST_ASSERT_MSG_NE(remote, nullptr, "The channel was not replaced in the ChannelList");
+    NS_TEST_EXPECT_MSG_EQ(remote->GetId(), id, "The remote channel did not take the id");
+    NS_TEST_EXPECT_MSG_EQ(ChannelList::GetNChannels(), nChannels, "Wrong number of channels");
+    NS_TEST_EXPECT_MSG_EQ(other->GetId(), otherId, "The id of another channel changed");
+    NS_TEST_EXPECT_MSG_EQ(ChannelList::GetChannel(otherId), other, "Another channel moved");
+
+    TimeValue delay;
+    remote->GetAttribute("Delay", delay);
+    NS_TEST_EXPECT_MSG_EQ(delay.Get(), MilliSeconds(5), "Wrong delay");
+    NS_TEST_EXPECT_MSG_EQ(remote->GetNDevices(), 2, "Wrong number of devices");
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(remote->GetPointToPointDevice(i),
+                              devices[i],
+                              "Device " << i << " not attached to the remote channel");
+        NS_TEST_EXPECT_MSG_EQ(devices[i]->GetChannel(),
+                              remote,
+                              "Device " << i << " still on the local channel");
+        NS_TEST_EXPECT_MSG_NE(devices[i]->GetObject<MpiReceiver>(),
+                              nullptr,
+                              "Device " << i << " without a receiver");
+        NS_TEST_EXPECT_MSG_EQ(devices[i]->IsLinkUp(), true, "Link " << i << " down");
+        NS_TEST_EXPECT_MSG_EQ(m_linkChanges[i],
+                              1,
+                              "Wrong number of link changes of device " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(local->GetNDevices(), 0, "The replaced channel kept its devices");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \brief TestSuite for PointToPointRemoteChannel
+ */
+class PointToPointRemoteChannelTestSuite : public TestSuite
+{
+  public:
+    /**
+     * \brief Constructor
+     */
+    PointToPointRemoteChannelTestSuite();
+};
+
+PointToPointRemoteChannelTestSuite::PointToPointRemoteChannelTestSuite()
+    : TestSuite("devices-point-to-point-remote", Type::UNIT)
+{
+    AddTestCase(new PointToPointRemoteChannelTest(), TestCase::Duration::QUICK);
+}
+
+static PointToPointRemoteChannelTestSuite g_pointToPointRemoteChannelTestSuite; //!< The testsuite
@@ -17,14 +17,19 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/gso-tag.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <list>
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -32,15 +37,17 @@ using namespace ns3;
  * \brief Test class for PointToPoint model
  *
  * It tries to send one packet from one NetDevice to another, over a
- * PointToPointChannel.
+ * PointToPointChannel, optionally delivering deep copies of the packets.
  */
 class PointToPointTest : public TestCase
 {
   public:
     /**
      * \brief Create the test
+     *
+     * \param deepCopy Value of the channel DeepCopy attribute.
      */
-    PointToPointTest();
+    PointToPointTest(bool deepCopy);
 
     /**
      * \brief Run the test
@@ -48,6 +55,8 @@ class PointToPointTest : public TestCase
     void DoRun() override;
 
   private:
+    bool m_deepCopy;                 //!< channel DeepCopy attribute
+    Ptr<const Packet> m_sentPacket;  //!< sent packet
     Ptr<const Packet> m_recvdPacket; //!< received packet
     /**
      * \brief Send one packet to the device specified
@@ -70,8 +79,9 @@ class PointToPointTest : public TestCase
     bool RxPacket(Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address& sender);
 };
 
-PointToPointTest::PointToPointTest()
-    : TestCase("PointToPoint")
+PointToPointTest::PointToPointTest(bool deepCopy)
+    : TestCase(deepCopy ? "PointToPoint with deep copies" : "PointToPoint"),
+      m_deepCopy(deepCopy)
 {
 }
 
@@ -81,6 +91,7 @@ PointToPointTest::SendOnePacket(Ptr<PointToPointNetDevice> device,
                                 uint32_t size)
 {
     Ptr<Packet> p = Create<Packet>(buffer, size);
+    m_sentPacket = p;
     device->Send(p, device->GetBroadcast(), 0x800);
 }
 
@@ -102,6 +113,7 @@ PointToPointTest::DoRun()
     Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice>();
     Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice>();
     Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel>();
+    channel->SetAttribute("DeepCopy", BooleanValue(m_deepCopy));
 
     devA->Attach(channel);
     devA->SetAddress(Mac48Address::Allocate());
@@ -135,6 +147,167 @@ PointToPointTest::DoRun()
 
     m_recvdPacket->CopyData(rxBuffer, txBufferSize);
     NS_TEST_EXPECT_MSG_EQ(memcmp(rxBuffer, txBuffer, txBufferSize), 0, "trivial");
+    NS_TEST_EXPECT_MSG_EQ(m_recvdPacket->GetUid(), m_sentPacket->GetUid(), "Packet uid lost");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \brief Test the split of the GSO batches by the PointToPointNetDevice
+ *
+ * A batch of segments is sent as a single packet. The segments must be
+ * received one at a time, each after its own transmission time.
+ */
+class PointToPointGsoTest : public TestCase
+{
+  public:
+    PointToPointGsoTest();
+
+    /**
+     * \brief Register the test segmenter of IPv4
+     */
+    void DoSetup() override;
+    /**
+     * \brief Run the test
+     */
+    void DoRun() override;
+    /**
+     * \brief Restore the segmenter of IPv4
+     */
+    void DoTeardown() override;
+
+  private:
+    /**
+     * \brief Split a batch into segments of raw bytes (no header)
+     *
+     * \param batch The batch.
+     * \return The segments.
+     */
+    static std::list<Ptr<Packet>> Segment(Ptr<const Packet> batch);
+
+    /**
+     * \brief Callback function which stores the received packets
+     *
+     * \param dev The receiving device.
+     * \param pkt The received packet.
+     * \param mode The protocol mode used.
+     * \param sender The sender address.
+     *
+     * \return A boolean indicating packet handled properly.
+     */
+    bool RxPacket(Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address& sender);
+
+    std::vector<Ptr<const Packet>> m_recvdPackets; //!< received packets
+    std::vector<Time> m_recvdTimes;                //!< reception times
+    GsoTag::Segmenter m_ipv4Segmenter;             //!< segmenter replaced by the test
+};
+
+PointToPointGsoTest::PointToPointGsoTest()
+    : TestCase("PointToPoint GSO batch split")
+{
+}
+
+std::list<Ptr<Packet>>
+PointToPointGsoTest::Segment(Ptr<const Packet> batch)
+{
+    Ptr<Packet> packet = batch->Copy();
+    GsoTag gsoTag;
+    packet->RemovePacketTag(gsoTag);
+    std::list<Ptr<Packet>> segments;
+    for (uint32_t offset = 0; offset < packet->GetSize(); offset += gsoTag.GetSegmentSize())
+    {
+        uint32_t size = std::min<uint32_t>(gsoTag.GetSegmentSize(), packet->GetSize() - offset);
+        segments.push_back(packet->CreateFragment(offset, size));
+    }
+    return segments;
+}
+
+bool
+PointToPointGsoTest::RxPacket(Ptr<NetDevice> dev,
+                              Ptr<const Packet> pkt,
+                              uint16_t mode,
+                              const Address& sender)
+{
+    m_recvdPackets.push_back(pkt);
+    m_recvdTimes.push_back(Simulator::Now());
+    return true;
+}
+
+void
+PointToPointGsoTest::DoSetup()
+{
+    // The segmenter of IPv4 is normally registered by the TCP of the internet
+    // module: keep it for the following tests
+    m_ipv4Segmenter = GsoTag::GetSegmenter(0x800);
+    GsoTag::RegisterSegmenter(0x800, MakeCallback(&PointToPointGsoTest::Segment));
+}
+
+void
+PointToPointGsoTest::DoTeardown()
+{
+    GsoTag::RegisterSegmenter(0x800, m_ipv4Segmenter);
+}
+
+void
+PointToPointGsoTest::DoRun()
+{
+    Ptr<Node> a = CreateObject<Node>();
+    Ptr<Node> b = CreateObject<Node>();
+    Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice>();
+    Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice>();
+    Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel>();
+
+    devA->Attach(channel);
+    devA->SetAddress(Mac48Address::Allocate());
+    devA->SetQueue(CreateObject<DropTailQueue<Packet>>());
+    devA->SetDataRate(DataRate("8Mbps"));
+    devB->Attach(channel);
+    devB->SetAddress(Mac48Address::Allocate());
+    devB->SetQueue(CreateObject<DropTailQueue<Packet>>());
+
+    a->AddDevice(devA);
+    b->AddDevice(devB);
+
+    devB->SetReceiveCallback(MakeCallback(&PointToPointGsoTest::RxPacket, this));
+    NS_TEST_EXPECT_MSG_EQ(devA->SupportsGso(), true, "PointToPointNetDevice should support GSO");
+
+    // A batch of 4 segments of 500 bytes and a last one of 100 bytes, followed by
+    // a regular packet
+    std::vector<uint8_t> txBuffer(2100);
+    for (uint32_t i = 0; i < txBuffer.size(); i++)
+    {
+        txBuffer[i] = i % 251;
+    }
+    Ptr<Packet> batch = Create<Packet>(txBuffer.data(), txBuffer.size());
+    GsoTag gsoTag(500, 0, 5);
+    batch->AddPacketTag(gsoTag);
+    Simulator::Schedule(Seconds(1.0), [devA, batch]() {
+        devA->Send(batch, devA->GetBroadcast(), 0x800);
+        devA->Send(Create<Packet>(200), devA->GetBroadcast(), 0x800);
+    });
+
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_recvdPackets.size(), 6, "The batch was not split");
+    // 8 Mbps: a byte per microsecond, with the 2 bytes of the PPP header
+    Time end = Seconds(1.0);
+    for (uint32_t i = 0; i < m_recvdPackets.size(); i++)
+    {
+        uint32_t size = (i < 4 ? 500 : (i == 4 ? 100 : 200));
+        NS_TEST_EXPECT_MSG_EQ(m_recvdPackets[i]->GetSize(), size, "Wrong segment size");
+        end += MicroSeconds(size + 2);
+        NS_TEST_EXPECT_MSG_EQ(m_recvdTimes[i], end, "Wrong segment reception time");
+        GsoTag tag;
+        NS_TEST_EXPECT_MSG_EQ(m_recvdPackets[i]->PeekPacketTag(tag), false, "Tag not removed");
+        if (i < 5)
+        {
+            std::vector<uint8_t> rxBuffer(size);
+            m_recvdPackets[i]->CopyData(rxBuffer.data(), size);
+            NS_TEST_EXPECT_MSG_EQ(memcmp(rxBuffer.data(), &txBuffer[i * 500], size),
+                                  0,
+                                  "Wrong segment content");
+        }
+    }
 
     Simulator::Destroy();
 }
@@ -154,7 +327,9 @@ class PointToPointTestSuite : public TestSuite
 PointToPointTestSuite::PointToPointTestSuite()
     : TestSuite("devices-point-to-point", Type::UNIT)
 {
-    AddTestCase(new PointToPointTest, TestCase::Duration::QUICK);
+    AddTestCase(new PointToPointTest(false), TestCase::Duration::QUICK);
+    AddTestCase(new PointToPointTest(true), TestCase::Duration::QUICK);
+    AddTestCase(new PointToPointGsoTest(), TestCase::Duration::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -73,6 +73,13 @@
  * \brief TracedCallback System Tests
  */
 
+/**
+ * \ingroup system-tests
+ * \ingroup mtp-tests
+ * \defgroup system-tests-mtp Multithreaded Simulation System Tests
+ * \brief Multithreaded Simulation System Tests
+ */
+
 /**
  * \ingroup system-tests
  * \ingroup csma
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/string.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup system-tests-mtp
+ * MultithreadedSimulatorImpl system test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup system-tests-mtp
+ *
+ * \brief Run TCP bulk transfers across the partitions of a chain of point to
+ * point links, and check that the multithreaded simulator delivers the same
+ * data at the same times as the default one.
+ *
+ * The link in the middle of the chain is shorter than the MinLookAhead of
+ * the multithreaded simulator, so that it must not be cut, and the links
+ * which are cut must bound the lookahead and copy the packets they carry.
+ */
+class MtpTcpTestCase : public TestCase
+{
+  public:
+    MtpTcpTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Data received by a socket: (time in ns, bytes). */
+    using Log = std::vector<std::pair<int64_t, uint32_t>>;
+
+    /** A TCP bulk transfer. */
+    class Flow
+    {
+      public:
+        /**
+         * Schedule the transfer.
+         * \param [in] sender The node sending the data.
+         * \param [in] receiver The node receiving the data.
+         * \param [in] address The address of the receiver.
+         * \param [in] port The port of the receiver.
+         * \param [in] size The number of bytes to send.
+         */
+        void Start(Ptr<Node> sender,
+                   Ptr<Node> receiver,
+                   Ipv4Address address,
+                   uint16_t port,
+                   uint32_t size);
+        /**
+         * Open the receiving socket.
+         * \param [in] receiver The node receiving the data.
+         */
+        void Listen(Ptr<Node> receiver);
+        /**
+         * Open the sending socket.
+         * \param [in] sender The node sending the data.
+         * \param [in] address The address of the receiver.
+         */
+        void Connect(Ptr<Node> sender, Ipv4Address address);
+        /**
+         * Fill the transmit buffer of the sending socket.
+         * \param [in] socket The socket.
+         * \param [in] available The space available in the buffer.
+         */
+        void Send(Ptr<Socket> socket, uint32_t available);
+        /**
+         * Receive the connection of the sender.
+         * \param [in] socket The new socket.
+         * \param [in] from The address of the sender.
+         */
+        void Accept(Ptr<Socket> socket, const Address& from);
+        /**
+         * Read the data received.
+         * \param [in] socket The socket.
+         */
+        void Receive(Ptr<Socket> socket);
+
+        uint16_t m_port{0};      //!< Port of the receiver.
+        uint32_t m_remaining{0}; //!< Bytes left to send.
+        Log m_log;               //!< Data received.
+    };
+
+    /** The outcome of a run. */
+    struct Result
+    {
+        std::vector<Log> logs; //!< Data received by each flow.
+        uint64_t eventCount;   //!< Number of events executed.
+        Time end;              //!< Time at the end of the run.
+    };
+
+    /**
+     * Run the scenario, leaving the simulator to destroy.
+     * \param [in] impl The simulator implementation to use.
+     * \return The outcome.
+     */
+    Result RunScenario(Ptr<SimulatorImpl> impl);
+    /**
+     * Check the partitions and the lookahead of a run.
+     * \param [in] impl The simulator implementation used by the run.
+     */
+    void CheckPartitions(Ptr<MultithreadedSimulatorImpl> impl);
+
+    /** The number of nodes of the chain. */
+    static constexpr uint32_t N_NODES = 5;
+    /** The link between these node and the next one is not cut. */
+    static constexpr uint32_t SHORT_LINK = 2;
+
+    std::vector<Flow> m_flows; //!< The transfers.
+};
+
+/** The port of the receiver of the first transfer. */
+static const uint16_t PORT = 5000;
+/** The number of bytes sent from one end of the chain to the other. */
+static const uint32_t BULK_SIZE = 300000;
+
+void
+MtpTcpTestCase::Flow::Start(Ptr<Node> sender,
+                            Ptr<Node> receiver,
+                            Ipv4Address address,
+                            uint16_t port,
+                            uint32_t size)
+{
+    m_port = port;
+    m_remaining = size;
+    // Each node opens its socket in its own partition
+    Simulator::ScheduleWithContext(receiver->GetId(),
+                                   MilliSeconds(100),
+                                   &Flow::Listen,
+                                   this,
+                                   receiver);
+    Simulator::ScheduleWithContext(sender->GetId(),
+                                   MilliSeconds(200),
+                                   &Flow::Connect,
+                                   this,
+                                   sender,
+                                   address);
+}
+
+void
+MtpTcpTestCase::Flow::Listen(Ptr<Node> receiver)
+{
+    Ptr<Socket> sink = Socket::CreateSocket(receiver, TcpSocketFactory::GetTypeId());
+    sink->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port));
+    sink->Listen();
+    sink->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                            MakeCallback(&Flow::Accept, this));
+}
+
+void
+MtpTcpTestCase::Flow::Connect(Ptr<Node> sender, Ipv4Address address)
+{
+    Ptr<Socket> source = Socket::CreateSocket(sender, TcpSocketFactory::GetTypeId());
+    source->Bind();
+    source->SetSendCallback(MakeCallback(&Flow::Send, this));
+    source->Connect(InetSocketAddress(address, m_port));
+}
+
+void
+MtpTcpTestCase::Flow::Send(Ptr<Socket> socket, uint32_t available)
+{
+    while (m_remaining > 0 && socket->GetTxAvailable() > 0)
+    {
+        uint32_t size = std::min({m_remaining, socket->GetTxAvailable(), 1000U});
+        int sent = socket->Send(Create<Packet>(size));
+        if (sent <= 0)
+        {
+            break;
+        }
+        m_remaining -= sent;
+    }
+}
+
+void
+MtpTcpTestCase::Flow::Accept(Ptr<Socket> socket, const Address& from)
+{
+    socket->SetRecvCallback(MakeCallback(&Flow::Receive, this));
+}
+
+void
+MtpTcpTestCase::Flow::Receive(Ptr<Socket> socket)
+{
+    while (Ptr<Packet> packet = socket->Recv())
+    {
+        m_log.emplace_back(Simulator::Now().GetNanoSeconds(), packet->GetSize());
+    }
+}
+
+MtpTcpTestCase::MtpTcpTestCase()
+    : TestCase("Check TCP transfers across the partitions of MultithreadedSimulatorImpl")
+{
+}
+
+MtpTcpTestCase::Result
+MtpTcpTestCase::RunScenario(Ptr<SimulatorImpl> impl)
+{
+    Simulator::SetImplementation(impl);
+    Ipv4AddressGenerator::Reset();
+
+    NodeContainer nodes(N_NODES);
+    InternetStackHelper internet;
+    internet.SetIpv6StackInstall(false);
+    internet.Install(nodes);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("20Mbps"));
+    Ipv4AddressHelper addresses("10.1.0.0", "255.255.255.0");
+    std::vector<Ipv4Address> ends;
+    for (uint32_t i = 0; i + 1 < N_NODES; ++i)
+    {
+        p2p.SetChannelAttribute("Delay",
+                                StringValue(i == SHORT_LINK ? "1ms" : i % 2 ? "3ms" : "5ms"));
+        NetDeviceContainer devices = p2p.Install(nodes.Get(i), nodes.Get(i + 1));
+        Ipv4InterfaceContainer interfaces = addresses.Assign(devices);
+        ends.push_back(interfaces.GetAddress(0));
+        ends.push_back(interfaces.GetAddress(1));
+        addresses.NewNetwork();
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    internet.AssignStreams(nodes, 0);
+
+    // One transfer each way between the ends of the chain, and a shorter
+    // one from the middle
+    m_flows.assign(3, Flow());
+    m_flows[0].Start(nodes.Get(0), nodes.Get(N_NODES - 1), ends.back(), PORT, BULK_SIZE);
+    m_flows[1].Start(nodes.Get(N_NODES - 1), nodes.Get(0), ends.front(), PORT + 1, BULK_SIZE);
+    m_flows[2].Start(nodes.Get(SHORT_LINK), nodes.Get(0), ends.front(), PORT + 2, BULK_SIZE / 3);
+
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+
+    Result result;
+    for (const auto& flow : m_flows)
+    {
+        result.logs.push_back(flow.m_log);
+    }
+    result.eventCount = Simulator::GetEventCount();
+    result.end = Simulator::Now();
+    return result;
+}
+
+void
+MtpTcpTestCase::CheckPartitions(Ptr<MultithreadedSimulatorImpl> impl)
+{
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartition(SHORT_LINK),
+                          impl->GetPartition(SHORT_LINK + 1),
+                          "Link shorter than MinLookAhead cut");
+    Time lookAhead = Time::Max();
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        uint32_t a = channel->GetDevice(0)->GetNode()->GetId();
+        uint32_t b = channel->GetDevice(1)->GetNode()->GetId();
+        bool cut = impl->GetPartition(a) != impl->GetPartition(b);
+        BooleanValue deepCopy;
+        channel->GetAttribute("DeepCopy", deepCopy);
+        NS_TEST_EXPECT_MSG_EQ(deepCopy.Get(),
+                              cut,
+                              "Wrong DeepCopy on the link between nodes " << a << " and " << b);
+        if (cut)
+        {
+            TimeValue delay;
+            channel->GetAttribute("Delay", delay);
+            lookAhead = Min(lookAhead, delay.Get());
+        }
+    }
+    NS_TEST_EXPECT_MSG_NE(lookAhead, Time::Max(), "No link cut between partitions");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookAhead(),
+                          lookAhead,
+                          "The lookahead is not the delay of the shortest link cut");
+}
+
+void
+MtpTcpTestCase::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId("ns3::DefaultSimulatorImpl");
+    Result reference = RunScenario(factory.Create<SimulatorImpl>());
+    Simulator::Destroy();
+    const uint32_t sizes[] = {BULK_SIZE, BULK_SIZE, BULK_SIZE / 3};
+    for (std::size_t i = 0; i < reference.logs.size(); ++i)
+    {
+        uint32_t received = 0;
+        for (const auto& entry : reference.logs[i])
+        {
+            received += entry.second;
+        }
+        NS_TEST_ASSERT_MSG_EQ(received, sizes[i], "Transfer " << i << " not completed");
+    }
+
+    for (uint32_t threads : {1, 2, 4})
+    {
+        factory.SetTypeId("ns3::MultithreadedSimulatorImpl");
+        factory.Set("MaxThreads", UintegerValue(threads));
+        factory.Set("Partitions", UintegerValue(4));
+        factory.Set("MinLookAhead", StringValue("2ms"));
+        auto impl = factory.Create<MultithreadedSimulatorImpl>();
+        Result result = RunScenario(impl);
+        CheckPartitions(impl);
+        Simulator::Destroy();
+
+        NS_TEST_EXPECT_MSG_GT(impl->GetPartitionCount(), 1, "Expected several partitions");
+        NS_TEST_EXPECT_MSG_GT(impl->GetWindowCount(), 1, "Expected several windows");
+        for (std::size_t i = 0; i < reference.logs.size(); ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ(result.logs[i].size(),
+                                  reference.logs[i].size(),
+                                  "Wrong number of receptions of flow " << i);
+            NS_TEST_EXPECT_MSG_EQ((result.logs[i] == reference.logs[i]),
+                                  true,
+                                  "Different receptions of flow " << i);
+        }
+        NS_TEST_EXPECT_MSG_EQ(result.eventCount, reference.eventCount, "Wrong event count");
+        NS_TEST_EXPECT_MSG_EQ(result.end, reference.end, "Wrong end time");
+    }
+}
+
+/**
+ * \ingroup system-tests-mtp
+ *
+ * \brief The MultithreadedSimulatorImpl system test suite.
+ */
+class MtpSystemTestSuite : public TestSuite
+{
+  public:
+    MtpSystemTestSuite()
+        : TestSuite("mtp-system", Type::SYSTEM)
+    {
+        AddTestCase(new MtpTcpTestCase(), TestCase::Duration::QUICK);
+    }
+};
+
+/// Static variable for test initialization.
+static MtpSystemTestSuite g_mtpSystemTestSuite;
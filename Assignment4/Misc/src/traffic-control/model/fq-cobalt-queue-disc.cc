@@ -212,6 +212,42 @@ FqCobaltQueueDisc::~FqCobaltQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqCobaltQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_flowQueues.clear();
+    QueueDisc::DoDispose();
+}
+
+void
+FqCobaltQueueDisc::PushBack(FlowList& list, uint32_t index)
+{
+    m_nextFlow[index] = NO_FLOW;
+    if (list.tail == NO_FLOW)
+    {
+        list.head = index;
+    }
+    else
+    {
+        m_nextFlow[list.tail] = index;
+    }
+    list.tail = index;
+}
+
+uint32_t
+FqCobaltQueueDisc::PopFront(FlowList& list)
+{
+    NS_ASSERT(list.head != NO_FLOW);
+    uint32_t index = list.head;
+    list.head = m_nextFlow[index];
+    if (list.head == NO_FLOW)
+    {
+        list.tail = NO_FLOW;
+    }
+    return index;
+}
+
 void
 FqCobaltQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -236,12 +272,11 @@ FqCobaltQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t index = m_flowsIndices[i];
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqCobaltFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqCobaltFlow::INACTIVE)
+        // a queue gets its tag when it is created
+        if (index == NO_FLOW || m_tags[i] == flowHash ||
+            m_flowQueues[index]->GetStatus() == FqCobaltFlow::INACTIVE)
         {
             // this queue has not been created yet or is associated with this flow
             // or is inactive, hence we can use it
@@ -292,11 +327,11 @@ FqCobaltQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqCobaltFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t index = m_flowsIndices[h];
+    if (index == NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqCobaltFlow>();
+        Ptr<FqCobaltFlow> flow = m_flowFactory.Create<FqCobaltFlow>();
         Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
         // If Cobalt, Set values of CobaltQueueDisc to match this QueueDisc
         Ptr<CobaltQueueDisc> cobalt = qd->GetObject<CobaltQueueDisc>();
@@ -312,23 +347,23 @@ FqCobaltQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         flow->SetIndex(h);
         AddQueueDiscClass(flow);
 
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
-    }
-    else
-    {
-        flow = StaticCast<FqCobaltFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        index = GetNQueueDiscClasses() - 1;
+        m_flowsIndices[h] = index;
+        m_flowQueues.push_back(PeekPointer(flow));
+        m_nextFlow.push_back(NO_FLOW);
     }
+    FqCobaltFlow* flow = m_flowQueues[index];
 
     if (flow->GetStatus() == FqCobaltFlow::INACTIVE)
     {
         flow->SetStatus(FqCobaltFlow::NEW_FLOW);
         flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        PushBack(m_newFlows, index);
     }
 
     flow->GetQueueDisc()->Enqueue(item);
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << index);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -344,24 +379,23 @@ FqCobaltQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<FqCobaltFlow> flow;
+    FqCobaltFlow* flow = nullptr;
     Ptr<QueueDiscItem> item;
 
     do
     {
         bool found = false;
 
-        while (!found && !m_newFlows.empty())
+        while (!found && m_newFlows.head != NO_FLOW)
         {
-            flow = m_newFlows.front();
+            flow = m_flowQueues[m_newFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
                 flow->SetStatus(FqCobaltFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
@@ -370,16 +404,15 @@ FqCobaltQueueDisc::DoDequeue()
             }
         }
 
-        while (!found && !m_oldFlows.empty())
+        while (!found && m_oldFlows.head != NO_FLOW)
         {
-            flow = m_oldFlows.front();
+            flow = m_flowQueues[m_oldFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.push_back(flow);
-                m_oldFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_oldFlows));
             }
             else
             {
@@ -399,16 +432,15 @@ FqCobaltQueueDisc::DoDequeue()
         if (!item)
         {
             NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
+            if (m_newFlows.head != NO_FLOW)
             {
                 flow->SetStatus(FqCobaltFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
                 flow->SetStatus(FqCobaltFlow::INACTIVE);
-                m_oldFlows.pop_front();
+                PopFront(m_oldFlows);
             }
         }
         else
@@ -484,6 +516,9 @@ FqCobaltQueueDisc::InitializeParams()
 
     m_flowFactory.SetTypeId("ns3::FqCobaltFlow");
 
+    m_flowsIndices.assign(m_flows, NO_FLOW);
+    m_tags.assign(m_flows, 0);
+
     m_queueDiscFactory.SetTypeId("ns3::CobaltQueueDisc");
     m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
     m_queueDiscFactory.Set("Interval", StringValue(m_interval));
@@ -500,13 +535,11 @@ FqCobaltQueueDisc::FqCobaltDrop()
 
     uint32_t maxBacklog = 0;
     uint32_t index = 0;
-    Ptr<QueueDisc> qd;
 
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    for (uint32_t i = 0; i < m_flowQueues.size(); i++)
     {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
+        uint32_t bytes = m_flowQueues[i]->GetQueueDisc()->GetNBytes();
         if (bytes > maxBacklog)
         {
             maxBacklog = bytes;
@@ -518,7 +551,7 @@ FqCobaltQueueDisc::FqCobaltDrop()
     uint32_t len = 0;
     uint32_t count = 0;
     uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    Ptr<QueueDisc> qd = m_flowQueues[index]->GetQueueDisc();
     Ptr<QueueDiscItem> item;
 
     do
@@ -31,8 +31,8 @@
 
 #include "ns3/object-factory.h"
 
-#include <list>
-#include <map>
+#include <limits>
+#include <vector>
 
 namespace ns3
 {
@@ -153,6 +153,12 @@ class FqCobaltQueueDisc : public QueueDisc
         "Unclassified drop"; //!< No packet filter able to classify packet
     static constexpr const char* OVERLIMIT_DROP = "Overlimit drop"; //!< Overlimit dropped packets
 
+  protected:
+    /**
+     * \brief Dispose of the object
+     */
+    void DoDispose() override;
+
   private:
     bool DoEnqueue(Ptr<QueueDiscItem> item) override;
     Ptr<QueueDiscItem> DoDequeue() override;
@@ -190,11 +196,37 @@ class FqCobaltQueueDisc : public QueueDisc
     double m_Pdrop;       //!< Drop Probability
     Time m_blueThreshold; //!< Threshold to enable blue enhancement
 
-    std::list<Ptr<FqCobaltFlow>> m_newFlows; //!< The list of new flows
-    std::list<Ptr<FqCobaltFlow>> m_oldFlows; //!< The list of old flows
+    /// Index of no flow queue, in the lists of flows and in m_flowsIndices
+    static constexpr uint32_t NO_FLOW = std::numeric_limits<uint32_t>::max();
+
+    /// A list of flow queues, linked through m_nextFlow
+    struct FlowList
+    {
+        uint32_t head{NO_FLOW}; //!< Index of class of the first flow queue
+        uint32_t tail{NO_FLOW}; //!< Index of class of the last flow queue
+    };
+
+    /**
+     * \brief Append a flow queue to a list of flows
+     * \param list the list of flows
+     * \param index the index of class of the flow queue
+     */
+    void PushBack(FlowList& list, uint32_t index);
+
+    /**
+     * \brief Remove the first flow queue of a list of flows
+     * \param list the list of flows, not empty
+     * \return the index of class of the removed flow queue
+     */
+    uint32_t PopFront(FlowList& list);
+
+    FlowList m_newFlows; //!< The list of new flows
+    FlowList m_oldFlows; //!< The list of old flows
 
-    std::map<uint32_t, uint32_t> m_flowsIndices; //!< Map with the index of class for each flow
-    std::map<uint32_t, uint32_t> m_tags;         //!< Tags used by set associative hash
+    std::vector<FqCobaltFlow*> m_flowQueues; //!< The flow queues, by index of class
+    std::vector<uint32_t> m_nextFlow;        //!< Next flow queue of the list of each flow queue
+    std::vector<uint32_t> m_flowsIndices;    //!< Index of class for each flow, or NO_FLOW
+    std::vector<uint32_t> m_tags;            //!< Tags used by set associative hash
 
     ObjectFactory m_flowFactory;      //!< Factory to create a new flow
     ObjectFactory m_queueDiscFactory; //!< Factory to create a new queue
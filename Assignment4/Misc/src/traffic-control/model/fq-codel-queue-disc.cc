@@ -186,6 +186,42 @@ FqCoDelQueueDisc::~FqCoDelQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqCoDelQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_flowQueues.clear();
+    QueueDisc::DoDispose();
+}
+
+void
+FqCoDelQueueDisc::PushBack(FlowList& list, uint32_t index)
+{
+    m_nextFlow[index] = NO_FLOW;
+    if (list.tail == NO_FLOW)
+    {
+        list.head = index;
+    }
+    else
+    {
+        m_nextFlow[list.tail] = index;
+    }
+    list.tail = index;
+}
+
+uint32_t
+FqCoDelQueueDisc::PopFront(FlowList& list)
+{
+    NS_ASSERT(list.head != NO_FLOW);
+    uint32_t index = list.head;
+    list.head = m_nextFlow[index];
+    if (list.head == NO_FLOW)
+    {
+        list.tail = NO_FLOW;
+    }
+    return index;
+}
+
 void
 FqCoDelQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -210,12 +246,11 @@ FqCoDelQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t index = m_flowsIndices[i];
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqCoDelFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqCoDelFlow::INACTIVE)
+        // a queue gets its tag when it is created
+        if (index == NO_FLOW || m_tags[i] == flowHash ||
+            m_flowQueues[index]->GetStatus() == FqCoDelFlow::INACTIVE)
         {
             // this queue has not been created yet or is associated with this flow
             // or is inactive, hence we can use it
@@ -266,11 +301,11 @@ FqCoDelQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqCoDelFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t index = m_flowsIndices[h];
+    if (index == NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqCoDelFlow>();
+        Ptr<FqCoDelFlow> flow = m_flowFactory.Create<FqCoDelFlow>();
         Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
         // If CoDel, Set values of CoDelQueueDisc to match this QueueDisc
         Ptr<CoDelQueueDisc> codel = qd->GetObject<CoDelQueueDisc>();
@@ -285,23 +320,23 @@ FqCoDelQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         flow->SetIndex(h);
         AddQueueDiscClass(flow);
 
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
-    }
-    else
-    {
-        flow = StaticCast<FqCoDelFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        index = GetNQueueDiscClasses() - 1;
+        m_flowsIndices[h] = index;
+        m_flowQueues.push_back(PeekPointer(flow));
+        m_nextFlow.push_back(NO_FLOW);
     }
+    FqCoDelFlow* flow = m_flowQueues[index];
 
     if (flow->GetStatus() == FqCoDelFlow::INACTIVE)
     {
         flow->SetStatus(FqCoDelFlow::NEW_FLOW);
         flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        PushBack(m_newFlows, index);
     }
 
     flow->GetQueueDisc()->Enqueue(item);
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << index);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -317,23 +352,23 @@ FqCoDelQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<FqCoDelFlow> flow;
+    FqCoDelFlow* flow = nullptr;
     Ptr<QueueDiscItem> item;
 
     do
     {
         bool found = false;
 
-        while (!found && !m_newFlows.empty())
+        while (!found && m_newFlows.head != NO_FLOW)
         {
-            flow = m_newFlows.front();
+            flow = m_flowQueues[m_newFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
                 flow->SetStatus(FqCoDelFlow::OLD_FLOW);
-                m_oldFlows.splice(m_oldFlows.end(), m_newFlows, m_newFlows.begin());
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
@@ -342,15 +377,15 @@ FqCoDelQueueDisc::DoDequeue()
             }
         }
 
-        while (!found && !m_oldFlows.empty())
+        while (!found && m_oldFlows.head != NO_FLOW)
         {
-            flow = m_oldFlows.front();
+            flow = m_flowQueues[m_oldFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.splice(m_oldFlows.end(), m_oldFlows, m_oldFlows.begin());
+                PushBack(m_oldFlows, PopFront(m_oldFlows));
             }
             else
             {
@@ -370,16 +405,15 @@ FqCoDelQueueDisc::DoDequeue()
         if (!item)
         {
             NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
+            if (m_newFlows.head != NO_FLOW)
             {
                 flow->SetStatus(FqCoDelFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
                 flow->SetStatus(FqCoDelFlow::INACTIVE);
-                m_oldFlows.pop_front();
+                PopFront(m_oldFlows);
             }
         }
         else
@@ -455,6 +489,9 @@ FqCoDelQueueDisc::InitializeParams()
 
     m_flowFactory.SetTypeId("ns3::FqCoDelFlow");
 
+    m_flowsIndices.assign(m_flows, NO_FLOW);
+    m_tags.assign(m_flows, 0);
+
     m_queueDiscFactory.SetTypeId("ns3::CoDelQueueDisc");
     m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
     m_queueDiscFactory.Set("Interval", StringValue(m_interval));
@@ -468,13 +505,11 @@ FqCoDelQueueDisc::FqCoDelDrop()
 
     uint32_t maxBacklog = 0;
     uint32_t index = 0;
-    Ptr<QueueDisc> qd;
 
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    for (uint32_t i = 0; i < m_flowQueues.size(); i++)
     {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
+        uint32_t bytes = m_flowQueues[i]->GetQueueDisc()->GetNBytes();
         if (bytes > maxBacklog)
         {
             maxBacklog = bytes;
@@ -486,7 +521,7 @@ FqCoDelQueueDisc::FqCoDelDrop()
     uint32_t len = 0;
     uint32_t count = 0;
     uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    Ptr<QueueDisc> qd = m_flowQueues[index]->GetQueueDisc();
     Ptr<QueueDiscItem> item;
 
     do
@@ -241,6 +241,42 @@ FqPieQueueDisc::~FqPieQueueDisc()
     NS_LOG_FUNCTION(this);
 }
 
+void
+FqPieQueueDisc::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_flowQueues.clear();
+    QueueDisc::DoDispose();
+}
+
+void
+FqPieQueueDisc::PushBack(FlowList& list, uint32_t index)
+{
+    m_nextFlow[index] = NO_FLOW;
+    if (list.tail == NO_FLOW)
+    {
+        list.head = index;
+    }
+    else
+    {
+        m_nextFlow[list.tail] = index;
+    }
+    list.tail = index;
+}
+
+uint32_t
+FqPieQueueDisc::PopFront(FlowList& list)
+{
+    NS_ASSERT(list.head != NO_FLOW);
+    uint32_t index = list.head;
+    list.head = m_nextFlow[index];
+    if (list.head == NO_FLOW)
+    {
+        list.tail = NO_FLOW;
+    }
+    return index;
+}
+
 void
 FqPieQueueDisc::SetQuantum(uint32_t quantum)
 {
@@ -265,12 +301,11 @@ FqPieQueueDisc::SetAssociativeHash(uint32_t flowHash)
 
     for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
     {
-        auto it = m_flowsIndices.find(i);
+        uint32_t index = m_flowsIndices[i];
 
-        if (it == m_flowsIndices.end() ||
-            (m_tags.find(i) != m_tags.end() && m_tags[i] == flowHash) ||
-            StaticCast<FqPieFlow>(GetQueueDiscClass(it->second))->GetStatus() ==
-                FqPieFlow::INACTIVE)
+        // a queue gets its tag when it is created
+        if (index == NO_FLOW || m_tags[i] == flowHash ||
+            m_flowQueues[index]->GetStatus() == FqPieFlow::INACTIVE)
         {
             // this queue has not been created yet or is associated with this flow
             // or is inactive, hence we can use it
@@ -321,11 +356,11 @@ FqPieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         h = flowHash % m_flows;
     }
 
-    Ptr<FqPieFlow> flow;
-    if (m_flowsIndices.find(h) == m_flowsIndices.end())
+    uint32_t index = m_flowsIndices[h];
+    if (index == NO_FLOW)
     {
         NS_LOG_DEBUG("Creating a new flow queue with index " << h);
-        flow = m_flowFactory.Create<FqPieFlow>();
+        Ptr<FqPieFlow> flow = m_flowFactory.Create<FqPieFlow>();
         Ptr<QueueDisc> qd = m_queueDiscFactory.Create<QueueDisc>();
         // If Pie, Set values of PieQueueDisc to match this QueueDisc
         Ptr<PieQueueDisc> pie = qd->GetObject<PieQueueDisc>();
@@ -340,23 +375,23 @@ FqPieQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         flow->SetIndex(h);
         AddQueueDiscClass(flow);
 
-        m_flowsIndices[h] = GetNQueueDiscClasses() - 1;
-    }
-    else
-    {
-        flow = StaticCast<FqPieFlow>(GetQueueDiscClass(m_flowsIndices[h]));
+        index = GetNQueueDiscClasses() - 1;
+        m_flowsIndices[h] = index;
+        m_flowQueues.push_back(PeekPointer(flow));
+        m_nextFlow.push_back(NO_FLOW);
     }
+    FqPieFlow* flow = m_flowQueues[index];
 
     if (flow->GetStatus() == FqPieFlow::INACTIVE)
     {
         flow->SetStatus(FqPieFlow::NEW_FLOW);
         flow->SetDeficit(m_quantum);
-        m_newFlows.push_back(flow);
+        PushBack(m_newFlows, index);
     }
 
     flow->GetQueueDisc()->Enqueue(item);
 
-    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << m_flowsIndices[h]);
+    NS_LOG_DEBUG("Packet enqueued into flow " << h << "; flow index " << index);
 
     if (GetCurrentSize() > GetMaxSize())
     {
@@ -372,24 +407,23 @@ FqPieQueueDisc::DoDequeue()
 {
     NS_LOG_FUNCTION(this);
 
-    Ptr<FqPieFlow> flow;
+    FqPieFlow* flow = nullptr;
     Ptr<QueueDiscItem> item;
 
     do
     {
         bool found = false;
 
-        while (!found && !m_newFlows.empty())
+        while (!found && m_newFlows.head != NO_FLOW)
         {
-            flow = m_newFlows.front();
+            flow = m_flowQueues[m_newFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for new flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
                 flow->SetStatus(FqPieFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
@@ -398,16 +432,15 @@ FqPieQueueDisc::DoDequeue()
             }
         }
 
-        while (!found && !m_oldFlows.empty())
+        while (!found && m_oldFlows.head != NO_FLOW)
         {
-            flow = m_oldFlows.front();
+            flow = m_flowQueues[m_oldFlows.head];
 
             if (flow->GetDeficit() <= 0)
             {
                 NS_LOG_DEBUG("Increase deficit for old flow index " << flow->GetIndex());
                 flow->IncreaseDeficit(m_quantum);
-                m_oldFlows.push_back(flow);
-                m_oldFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_oldFlows));
             }
             else
             {
@@ -427,16 +460,15 @@ FqPieQueueDisc::DoDequeue()
         if (!item)
         {
             NS_LOG_DEBUG("Could not get a packet from the selected flow queue");
-            if (!m_newFlows.empty())
+            if (m_newFlows.head != NO_FLOW)
             {
                 flow->SetStatus(FqPieFlow::OLD_FLOW);
-                m_oldFlows.push_back(flow);
-                m_newFlows.pop_front();
+                PushBack(m_oldFlows, PopFront(m_newFlows));
             }
             else
             {
                 flow->SetStatus(FqPieFlow::INACTIVE);
-                m_oldFlows.pop_front();
+                PopFront(m_oldFlows);
             }
         }
         else
@@ -512,6 +544,9 @@ FqPieQueueDisc::InitializeParams()
 
     m_flowFactory.SetTypeId("ns3::FqPieFlow");
 
+    m_flowsIndices.assign(m_flows, NO_FLOW);
+    m_tags.assign(m_flows, 0);
+
     m_queueDiscFactory.SetTypeId("ns3::PieQueueDisc");
     m_queueDiscFactory.Set("MaxSize", QueueSizeValue(GetMaxSize()));
     m_queueDiscFactory.Set("MeanPktSize", UintegerValue(m_meanPktSize));
@@ -534,13 +569,11 @@ FqPieQueueDisc::FqPieDrop()
 
     uint32_t maxBacklog = 0;
     uint32_t index = 0;
-    Ptr<QueueDisc> qd;
 
     /* Queue is full! Find the fat flow and drop packet(s) from it */
-    for (uint32_t i = 0; i < GetNQueueDiscClasses(); i++)
+    for (uint32_t i = 0; i < m_flowQueues.size(); i++)
     {
-        qd = GetQueueDiscClass(i)->GetQueueDisc();
-        uint32_t bytes = qd->GetNBytes();
+        uint32_t bytes = m_flowQueues[i]->GetQueueDisc()->GetNBytes();
         if (bytes > maxBacklog)
         {
             maxBacklog = bytes;
@@ -552,7 +585,7 @@ FqPieQueueDisc::FqPieDrop()
     uint32_t len = 0;
     uint32_t count = 0;
     uint32_t threshold = maxBacklog >> 1;
-    qd = GetQueueDiscClass(index)->GetQueueDisc();
+    Ptr<QueueDisc> qd = m_flowQueues[index]->GetQueueDisc();
     Ptr<QueueDiscItem> item;
 
     do
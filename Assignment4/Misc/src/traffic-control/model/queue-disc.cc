@@ -24,11 +24,15 @@
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-limits.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
 #include "ns3/socket.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace ns3
 {
 
@@ -102,6 +106,9 @@ QueueDisc::Stats::Stats()
       nTotalDroppedBytesAfterDequeue(0),
       nTotalRequeuedPackets(0),
       nTotalRequeuedBytes(0),
+      nTotalBulkDequeues(0),
+      nTotalBulkPackets(0),
+      nMaxBulkPackets(0),
       nTotalMarkedPackets(0),
       nTotalMarkedBytes(0)
 {
@@ -186,8 +193,18 @@ QueueDisc::Stats::Print(std::ostream& os) const
        << "Packets/Bytes dequeued: " << nTotalDequeuedPackets << " / " << nTotalDequeuedBytes
        << std::endl
        << "Packets/Bytes requeued: " << nTotalRequeuedPackets << " / " << nTotalRequeuedBytes
-       << std::endl
-       << "Packets/Bytes dropped: " << nTotalDroppedPackets << " / " << nTotalDroppedBytes
+       << std::endl;
+
+    if (nTotalBulkDequeues > 0)
+    {
+        // each batch takes one restart of the queue disc instead of one per packet
+        os << "Bulk dequeues/packets (max): " << nTotalBulkDequeues << " / " << nTotalBulkPackets
+           << " (" << nMaxBulkPackets << ")" << std::endl
+           << "Restarts saved by bulk dequeues: " << nTotalBulkPackets - nTotalBulkDequeues
+           << std::endl;
+    }
+
+    os << "Packets/Bytes dropped: " << nTotalDroppedPackets << " / " << nTotalDroppedBytes
        << std::endl
        << "Packets/Bytes dropped before enqueue: " << nTotalDroppedPacketsBeforeEnqueue << " / "
        << nTotalDroppedBytesBeforeEnqueue;
@@ -257,6 +274,18 @@ QueueDisc::GetTypeId()
                           UintegerValue(DEFAULT_QUOTA),
                           MakeUintegerAccessor(&QueueDisc::SetQuota, &QueueDisc::GetQuota),
                           MakeUintegerChecker<uint32_t>())
+            .AddAttribute("BulkPackets",
+                          "The maximum number of packets dequeued at once by a root queue disc "
+                          "installed on a single queue device (1 disables bulk dequeues)",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&QueueDisc::m_bulkPackets),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("BulkBytes",
+                          "The maximum number of bytes dequeued at once by a root queue disc "
+                          "(0 means no limit other than the queue limits of the device queue)",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&QueueDisc::m_bulkBytes),
+                          MakeUintegerChecker<uint32_t>())
             .AddAttribute("InternalQueueList",
                           "The list of internal queues.",
                           ObjectVectorValue(),
@@ -381,7 +410,8 @@ QueueDisc::DoDispose()
     m_classes.clear();
     m_devQueueIface = nullptr;
     m_send = nullptr;
-    m_requeued = nullptr;
+    m_requeued.clear();
+    m_bulk.clear();
     m_internalQueueDbeFunctor = nullptr;
     m_internalQueueDadFunctor = nullptr;
     m_childQueueDiscDbeFunctor = nullptr;
@@ -419,11 +449,15 @@ QueueDisc::GetStats()
     // the total number of sent packets is only updated here to avoid to increase it
     // after a dequeue and then having to decrease it if the packet is dropped after
     // dequeue or requeued
-    m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0) -
+    uint64_t requeuedBytes = 0;
+    for (const auto& item : m_requeued)
+    {
+        requeuedBytes += item->GetSize();
+    }
+    m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - m_requeued.size() -
                                 m_stats.nTotalDroppedPacketsAfterDequeue;
-    m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes -
-                              (m_requeued ? m_requeued->GetSize() : 0) -
-                              m_stats.nTotalDroppedBytesAfterDequeue;
+    m_stats.nTotalSentBytes =
+        m_stats.nTotalDequeuedBytes - requeuedBytes - m_stats.nTotalDroppedBytesAfterDequeue;
 
     return m_stats;
 }
@@ -890,20 +924,14 @@ QueueDisc::Dequeue()
     // The QueueDisc::DoPeek method dequeues a packet and keeps it as a requeued
     // packet. Thus, first check whether a peeked packet exists. Otherwise, call
     // the private DoDequeue method.
-    Ptr<QueueDiscItem> item = m_requeued;
+    Ptr<QueueDiscItem> item;
 
-    if (item)
+    if (!m_requeued.empty())
     {
-        m_requeued = nullptr;
-        if (m_peeked)
-        {
-            // If the packet was requeued because a peek operation was requested
-            // (which is the case here because DequeuePacket calls Dequeue only
-            // when m_requeued is null), we need to explicitly call PacketDequeued
-            // to update statistics about dequeued packets and fire the dequeue trace.
-            m_peeked = false;
-            PacketDequeued(item);
-        }
+        // If the packet was requeued because a peek operation was requested
+        // (which is the case here because DequeuePacket calls Dequeue only
+        // when m_requeued is empty), PopRequeued calls PacketDequeued
+        item = PopRequeued();
     }
     else
     {
@@ -928,17 +956,19 @@ QueueDisc::DoPeek()
 {
     NS_LOG_FUNCTION(this);
 
-    if (!m_requeued)
+    if (m_requeued.empty())
     {
         m_peeked = true;
-        m_requeued = Dequeue();
+        Ptr<QueueDiscItem> item = Dequeue();
         // if no packet is returned, reset the m_peeked flag
-        if (!m_requeued)
+        if (!item)
         {
             m_peeked = false;
+            return nullptr;
         }
+        m_requeued.push_back(item);
     }
-    return m_requeued;
+    return m_requeued.front();
 }
 
 void
@@ -949,10 +979,9 @@ QueueDisc::Run()
     if (RunBegin())
     {
         uint32_t quota = m_quota;
-        while (Restart())
+        while (Restart(quota))
         {
-            quota -= 1;
-            if (quota <= 0)
+            if (quota == 0)
             {
                 /// \todo netif_schedule (q);
                 break;
@@ -983,9 +1012,9 @@ QueueDisc::RunEnd()
 }
 
 bool
-QueueDisc::Restart()
+QueueDisc::Restart(uint32_t& quota)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << quota);
     Ptr<QueueDiscItem> item = DequeuePacket();
     if (!item)
     {
@@ -993,6 +1022,15 @@ QueueDisc::Restart()
         return false;
     }
 
+    // Like Linux, only dequeue in bulk if the device has a single transmission queue,
+    // otherwise the packets of a batch could be destined to different queues
+    if (m_bulkPackets > 1 && quota > 1 &&
+        (!m_devQueueIface || m_devQueueIface->GetNTxQueues() == 1))
+    {
+        return TransmitBulk(item, quota);
+    }
+
+    quota--;
     return Transmit(item);
 }
 
@@ -1004,24 +1042,15 @@ QueueDisc::DequeuePacket()
     Ptr<QueueDiscItem> item;
 
     // First check if there is a requeued packet
-    if (m_requeued)
+    if (!m_requeued.empty())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
         if (!m_devQueueIface ||
-            !m_devQueueIface->GetTxQueue(m_requeued->GetTxQueueIndex())->IsStopped())
+            !m_devQueueIface->GetTxQueue(m_requeued.front()->GetTxQueueIndex())->IsStopped())
         {
-            item = m_requeued;
-            m_requeued = nullptr;
-            if (m_peeked)
-            {
-                // If the packet was requeued because a peek operation was requested
-                // we need to explicitly call PacketDequeued to update statistics
-                // about dequeued packets and fire the dequeue trace.
-                m_peeked = false;
-                PacketDequeued(item);
-            }
+            item = PopRequeued();
         }
     }
     else
@@ -1040,17 +1069,36 @@ QueueDisc::DequeuePacket()
             {
                 item->AddHeader();
             }
-            // Here, Linux tries bulk dequeues
+            // Here, Linux tries bulk dequeues (see TransmitBulk)
         }
     }
     return item;
 }
 
+Ptr<QueueDiscItem>
+QueueDisc::PopRequeued()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!m_requeued.empty());
+    Ptr<QueueDiscItem> item = m_requeued.front();
+    m_requeued.pop_front();
+    if (m_peeked)
+    {
+        // If the packet was requeued because a peek operation was requested
+        // we need to explicitly call PacketDequeued to update statistics
+        // about dequeued packets and fire the dequeue trace.
+        m_peeked = false;
+        PacketDequeued(item);
+    }
+    return item;
+}
+
 void
-QueueDisc::Requeue(Ptr<QueueDiscItem> item)
+QueueDisc::Requeue(Ptr<QueueDiscItem> item, std::size_t pos)
 {
-    NS_LOG_FUNCTION(this << item);
-    m_requeued = item;
+    NS_LOG_FUNCTION(this << item << pos);
+    NS_ASSERT(pos <= m_requeued.size());
+    m_requeued.insert(m_requeued.begin() + pos, item);
     /// \todo netif_schedule (q);
 
     m_stats.nTotalRequeuedPackets++;
@@ -1101,8 +1149,81 @@ QueueDisc::Transmit(Ptr<QueueDiscItem> item)
     // if the queue disc is empty or the device queue is now stopped, return false so
     // that the Run method does not attempt to dequeue other packets and exits
     return !(
-        GetNPackets() == 0 ||
+        (GetNPackets() == 0 && m_requeued.empty()) ||
         (m_devQueueIface && m_devQueueIface->GetTxQueue(item->GetTxQueueIndex())->IsStopped()));
 }
 
+bool
+QueueDisc::TransmitBulk(Ptr<QueueDiscItem> item, uint32_t& quota)
+{
+    NS_LOG_FUNCTION(this << item << quota);
+
+    Ptr<NetDeviceQueue> txq = m_devQueueIface ? m_devQueueIface->GetTxQueue(0) : nullptr;
+
+    // As in Linux, the batch may exceed the byte budget by its last packet only,
+    // so that the queue limits of the device queue stop it after the whole batch
+    int64_t bytes = (m_bulkBytes > 0 ? m_bulkBytes : std::numeric_limits<int64_t>::max());
+    Ptr<QueueLimits> limits = txq ? txq->GetQueueLimits() : nullptr;
+    if (limits)
+    {
+        bytes = std::min<int64_t>(bytes, limits->Available());
+    }
+    uint32_t packets = std::min(m_bulkPackets, quota);
+
+    // The device queue was checked by DequeuePacket for the whole batch. The requeued
+    // packets come first, then those dequeued from the queue disc
+    m_bulk.push_back(item);
+    bytes -= item->GetSize();
+    while (bytes > 0 && m_bulk.size() < packets)
+    {
+        if (!m_requeued.empty())
+        {
+            item = PopRequeued();
+        }
+        else
+        {
+            item = Dequeue();
+            if (!item)
+            {
+                break;
+            }
+            item->AddHeader();
+        }
+        m_bulk.push_back(item);
+        bytes -= item->GetSize();
+    }
+
+    m_stats.nTotalBulkDequeues++;
+    m_stats.nTotalBulkPackets += m_bulk.size();
+    m_stats.nMaxBulkPackets = std::max<uint32_t>(m_stats.nMaxBulkPackets, m_bulk.size());
+    NS_LOG_LOGIC("Dequeued " << m_bulk.size() << " packets in bulk");
+
+    NS_ASSERT_MSG(m_send, "Send callback not set");
+    std::size_t sent = 0;
+    for (; sent < m_bulk.size(); sent++)
+    {
+        // The device queue may get stopped by any packet of the batch (e.g., if the
+        // device queue gets full), in which case the next packets are requeued
+        if (txq && txq->IsStopped())
+        {
+            break;
+        }
+        // a single queue device makes no use of the priority tag
+        SocketPriorityTag priorityTag;
+        m_bulk[sent]->GetPacket()->RemovePacketTag(priorityTag);
+        m_send(m_bulk[sent]);
+    }
+    quota -= sent;
+
+    // The packets not sent go before the packets that are still requeued
+    for (std::size_t i = sent; i < m_bulk.size(); i++)
+    {
+        Requeue(m_bulk[i], i - sent);
+    }
+    bool more = (sent == m_bulk.size());
+    m_bulk.clear();
+
+    return more && (GetNPackets() > 0 || !m_requeued.empty()) && !(txq && txq->IsStopped());
+}
+
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/traced-callback.h"
 #include "ns3/traced-value.h"
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <string>
@@ -151,6 +152,13 @@ enum QueueDiscSizePolicy
  * is room for another packet in its transmission queue, but the transmission queue
  * is stopped. Waking a queue disc is equivalent to make it run.
  *
+ * If the device has a single transmission queue, a root queue disc can be configured
+ * (BulkPackets and BulkBytes attributes) to dequeue packets in batches, as Linux does
+ * with bulk dequeues: the device queue is checked once per batch instead of once per
+ * packet, and the batch size is bounded by the budget of the queue limits (BQL) of
+ * the device queue, if any. The packets of a batch that cannot be sent because the
+ * device queue gets stopped are requeued, in order.
+ *
  * Every queue disc collects statistics about the total number of packets/bytes
  * received from the upper layers (in case of root queue disc) or from the parent
  * queue disc (in case of child queue disc), enqueued, dequeued, requeued, dropped,
@@ -162,7 +170,7 @@ enum QueueDiscSizePolicy
  * - dropped = dropped before enqueue + dropped after dequeue
  * - received = dropped before enqueue + enqueued
  * - queued = enqueued - dequeued
- * - sent = dequeued - dropped after dequeue (- 1 if there is a requeued packet)
+ * - sent = dequeued - dropped after dequeue - requeued packets still retained
  *
  * Separate counters are also kept for each possible reason to drop a packet.
  * When a packet is dropped by an internal queue, e.g., because the queue is full,
@@ -226,6 +234,12 @@ class QueueDisc : public Object
         uint32_t nTotalRequeuedPackets;
         /// Total requeued bytes
         uint64_t nTotalRequeuedBytes;
+        /// Total bulk dequeues, i.e., batches of packets dequeued at once
+        uint32_t nTotalBulkDequeues;
+        /// Total packets dequeued in bulk
+        uint32_t nTotalBulkPackets;
+        /// Largest number of packets dequeued in bulk at once
+        uint32_t nMaxBulkPackets;
         /// Total marked packets
         uint32_t nTotalMarkedPackets;
         /// Marked packets, for each reason
@@ -643,10 +657,14 @@ class QueueDisc : public Object
 
     /**
      * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
-     * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-     * \return true if a packet is successfully sent to the device.
+     * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit),
+     * or dequeue and send a batch of packets (by calling TransmitBulk) if bulk dequeues are
+     * enabled.
+     * \param quota the number of packets that can still be sent in this run, decreased by
+     *              the number of packets sent
+     * \return true if the packets are successfully sent to the device.
      */
-    bool Restart();
+    bool Restart(uint32_t& quota);
 
     /**
      * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -654,12 +672,19 @@ class QueueDisc : public Object
      */
     Ptr<QueueDiscItem> DequeuePacket();
 
+    /**
+     * Remove the first requeued packet.
+     * \return the first requeued packet
+     */
+    Ptr<QueueDiscItem> PopRequeued();
+
     /**
      * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
      * Requeues a packet whose transmission failed.
      * \param item the packet to requeue
+     * \param pos the position of the packet among the requeued packets
      */
-    void Requeue(Ptr<QueueDiscItem> item);
+    void Requeue(Ptr<QueueDiscItem> item, std::size_t pos = 0);
 
     /**
      * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
@@ -670,6 +695,21 @@ class QueueDisc : public Object
      */
     bool Transmit(Ptr<QueueDiscItem> item);
 
+    /**
+     * Modelled after the Linux functions try_bulk_dequeue_skb and sch_direct_xmit
+     * (net/sched/sch_generic.c)
+     * Dequeues more packets after the given one, up to the BulkPackets and BulkBytes
+     * limits, the byte budget of the queue limits of the device queue and the quota,
+     * and sends them to the device in order. The packets that are not sent because
+     * the device queue gets stopped are requeued.
+     * \param item the packet dequeued by DequeuePacket
+     * \param quota the number of packets that can still be sent in this run, decreased by
+     *              the number of packets sent
+     * \return true if all the packets are sent, the device queue is not stopped and the
+     *         queue disc is not empty
+     */
+    bool TransmitBulk(Ptr<QueueDiscItem> item, uint32_t& quota);
+
     /**
      * \brief Perform the actions required when the queue disc is notified of
      *        a packet enqueue
@@ -696,13 +736,16 @@ class QueueDisc : public Object
     TracedCallback<Time> m_sojourn;   //!< Sojourn time of the latest dequeued packet
     QueueSize m_maxSize;              //!< max queue size
 
-    Stats m_stats;    //!< The collected statistics
-    uint32_t m_quota; //!< Maximum number of packets dequeued in a qdisc run
+    Stats m_stats;          //!< The collected statistics
+    uint32_t m_quota;       //!< Maximum number of packets dequeued in a qdisc run
+    uint32_t m_bulkPackets; //!< Maximum number of packets dequeued at once
+    uint32_t m_bulkBytes;   //!< Maximum number of bytes dequeued at once (0: no limit)
     Ptr<NetDeviceQueueInterface> m_devQueueIface; //!< NetDevice queue interface
     SendCallback m_send;           //!< Callback used to send a packet to the receiving object
-    bool m_running;                //!< The queue disc is performing multiple dequeue operations
-    Ptr<QueueDiscItem> m_requeued; //!< The last packet that failed to be transmitted
-    bool m_peeked;                 //!< A packet was dequeued because Peek was called
+    bool m_running; //!< The queue disc is performing multiple dequeue operations
+    std::deque<Ptr<QueueDiscItem>> m_requeued; //!< The packets that failed to be transmitted
+    std::vector<Ptr<QueueDiscItem>> m_bulk;    //!< The packets dequeued at once
+    bool m_peeked; //!< A packet was dequeued because Peek was called
     std::string m_childQueueDiscDropMsg; //!< Reason why a packet was dropped by a child queue disc
     std::string m_childQueueDiscMarkMsg; //!< Reason why a packet was marked by a child queue disc
     QueueDiscSizePolicy m_sizePolicy;    //!< The queue disc size policy
@@ -36,6 +36,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -492,6 +493,152 @@ TcFlowControlTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup traffic-control-test
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ *
+ * A number of packets is enqueued in the root queue disc, which then runs with
+ * bulk dequeues enabled. The packets must reach the device in the order they
+ * were enqueued, including those requeued because the device queue got stopped
+ * in the middle of a batch.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param deviceQueueLength the queue length of the device, in packets
+     * \param bulkPackets the maximum number of packets dequeued at once
+     * \param totalTxPackets the total number of packets to transmit
+     */
+    TcBulkDequeueTestCase(uint32_t deviceQueueLength,
+                          uint32_t bulkPackets,
+                          uint32_t totalTxPackets);
+
+  private:
+    void DoRun() override;
+    /**
+     * Enqueue packets in the queue disc and run it
+     * \param qdisc the queue disc
+     */
+    void EnqueueAndRun(Ptr<QueueDisc> qdisc);
+    /**
+     * Record a packet enqueued in the device queue
+     * \param p the packet
+     */
+    void DeviceEnqueue(Ptr<const Packet> p);
+    uint32_t m_deviceQueueLength;    //!< the queue length of the device
+    uint32_t m_bulkPackets;          //!< the maximum number of packets dequeued at once
+    uint32_t m_totalTxPackets;       //!< the total number of packets to transmit
+    std::vector<uint64_t> m_sentUid; //!< the uids of the packets, in enqueue order
+    std::vector<uint64_t> m_devUid;  //!< the uids of the packets, in device queue order
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase(uint32_t deviceQueueLength,
+                                             uint32_t bulkPackets,
+                                             uint32_t totalTxPackets)
+    : TestCase("Test the bulk dequeues of a queue disc with a " +
+               std::to_string(deviceQueueLength) + " packet device queue and batches of " +
+               std::to_string(bulkPackets) + " packets"),
+      m_deviceQueueLength(deviceQueueLength),
+      m_bulkPackets(bulkPackets),
+      m_totalTxPackets(totalTxPackets)
+{
+}
+
+void
+TcBulkDequeueTestCase::EnqueueAndRun(Ptr<QueueDisc> qdisc)
+{
+    for (uint32_t i = 0; i < m_totalTxPackets; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1000);
+        m_sentUid.push_back(p->GetUid());
+        qdisc->Enqueue(Create<QueueDiscTestItem>(p));
+    }
+    qdisc->Run();
+}
+
+void
+TcBulkDequeueTestCase::DeviceEnqueue(Ptr<const Packet> p)
+{
+    m_devUid.push_back(p->GetUid());
+}
+
+void
+TcBulkDequeueTestCase::DoRun()
+{
+    NodeContainer n;
+    n.Create(2);
+
+    n.Get(0)->AggregateObject(CreateObject<TrafficControlLayer>());
+    n.Get(1)->AggregateObject(CreateObject<TrafficControlLayer>());
+
+    SimpleNetDeviceHelper simple;
+
+    NetDeviceContainer rxDevC = simple.Install(n.Get(1));
+
+    simple.SetDeviceAttribute("DataRate", DataRateValue(DataRate("1Mb/s")));
+    simple.SetQueue("ns3::DropTailQueue",
+                    "MaxSize",
+                    StringValue(std::to_string(m_deviceQueueLength) + "p"));
+
+    Ptr<NetDevice> txDev;
+    txDev =
+        simple.Install(n.Get(0), DynamicCast<SimpleChannel>(rxDevC.Get(0)->GetChannel())).Get(0);
+
+    PointerValue ptr;
+    txDev->GetAttributeFailSafe("TxQueue", ptr);
+    ptr.Get<Queue<Packet>>()->TraceConnectWithoutContext(
+        "Enqueue",
+        MakeCallback(&TcBulkDequeueTestCase::DeviceEnqueue, this));
+
+    TrafficControlHelper tch;
+    tch.SetRootQueueDisc("ns3::FifoQueueDisc",
+                         "MaxSize",
+                         StringValue("1000p"),
+                         "BulkPackets",
+                         UintegerValue(m_bulkPackets));
+    Ptr<QueueDisc> qdisc = tch.Install(txDev).Get(0);
+
+    Simulator::Schedule(Seconds(0), &TcBulkDequeueTestCase::EnqueueAndRun, this, qdisc);
+
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_devUid.size(),
+                          m_totalTxPackets,
+                          "All the packets must be sent to the device");
+    NS_TEST_EXPECT_MSG_EQ((m_devUid == m_sentUid),
+                          true,
+                          "The packets must be sent to the device in order");
+
+    QueueDisc::Stats stats = qdisc->GetStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalSentPackets,
+                          m_totalTxPackets,
+                          "All the packets must be sent by the queue disc");
+    NS_TEST_EXPECT_MSG_EQ(stats.nTotalDroppedPackets, 0, "No packet must be dropped");
+    NS_TEST_EXPECT_MSG_EQ(stats.nMaxBulkPackets,
+                          std::min(m_bulkPackets, m_totalTxPackets),
+                          "Unexpected size of the largest batch");
+    if (m_deviceQueueLength >= m_totalTxPackets)
+    {
+        // The device queue is never stopped, all the packets are sent in the first run
+        NS_TEST_EXPECT_MSG_EQ(stats.nTotalBulkDequeues,
+                              (m_totalTxPackets + m_bulkPackets - 1) / m_bulkPackets,
+                              "Unexpected number of batches");
+        NS_TEST_EXPECT_MSG_EQ(stats.nTotalRequeuedPackets, 0, "No packet must be requeued");
+    }
+    else if (m_deviceQueueLength + 1 < std::min(m_bulkPackets, m_totalTxPackets))
+    {
+        // The device transmits a packet and queues m_deviceQueueLength packets before
+        // stopping the queue in the middle of the first batch
+        NS_TEST_EXPECT_MSG_GT(stats.nTotalRequeuedPackets, 0, "Packets must be requeued");
+    }
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup traffic-control-test
  *
@@ -526,5 +673,10 @@ static class TcFlowControlTestSuite : public TestSuite
         // also be made parametric.
         AddTestCase(new TcFlowControlTestCase(QueueSizeUnit::BYTES, 5000, 10),
                     TestCase::Duration::QUICK);
+
+        AddTestCase(new TcBulkDequeueTestCase(100, 4, 10), TestCase::Duration::QUICK);
+        AddTestCase(new TcBulkDequeueTestCase(100, 16, 10), TestCase::Duration::QUICK);
+        AddTestCase(new TcBulkDequeueTestCase(3, 8, 20), TestCase::Duration::QUICK);
+        AddTestCase(new TcBulkDequeueTestCase(1, 64, 20), TestCase::Duration::QUICK);
     }
 } g_tcFlowControlTestSuite; ///< the test suite
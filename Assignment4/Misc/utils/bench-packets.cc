@@ -23,6 +23,7 @@
 
 #include "ns3/command-line.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-pool.h"
 #include "ns3/packet.h"
 #include "ns3/system-wall-clock-ms.h"
 
@@ -32,6 +33,7 @@
 #include <sstream>
 #include <stdlib.h> // for exit ()
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -332,6 +334,104 @@ benchFragment(uint32_t n)
     }
 }
 
+static void
+benchForward(uint32_t n)
+{
+    BenchHeader<14> ethernet;
+    BenchHeader<25> ipv4;
+    BenchHeader<8> udp;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(4000);
+        p->AddHeader(udp);
+
+        /* Fragment the datagram */
+        std::vector<Ptr<Packet>> fragments;
+        for (uint32_t offset = 0; offset < p->GetSize(); offset += 1480)
+        {
+            Ptr<Packet> fragment =
+                p->CreateFragment(offset, std::min<uint32_t>(1480, p->GetSize() - offset));
+            fragment->AddHeader(ipv4);
+            fragment->AddHeader(ethernet);
+            fragments.push_back(fragment);
+        }
+
+        /* Receive a copy of each fragment and reassemble the datagram */
+        Ptr<Packet> whole = Create<Packet>();
+        for (const auto& fragment : fragments)
+        {
+            Ptr<Packet> received = fragment->Copy();
+            received->RemoveHeader(ethernet);
+            received->RemoveHeader(ipv4);
+            whole->AddAtEnd(received);
+        }
+        whole->RemoveHeader(udp);
+    }
+}
+
+static void
+benchPrint(uint32_t n)
+{
+    BenchHeader<14> ethernet;
+    BenchHeader<25> ipv4;
+    BenchHeader<8> udp;
+    std::ostringstream os;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1000);
+        p->AddHeader(udp);
+        p->AddHeader(ipv4);
+
+        /* Forward a copy of the packet over a few hops */
+        for (uint32_t hop = 0; hop < 4; hop++)
+        {
+            p->AddHeader(ethernet);
+            p = p->Copy();
+            p->RemoveHeader(ethernet);
+        }
+
+        /* Print one packet out of a hundred */
+        if (i % 100 == 0)
+        {
+            p->Print(os);
+            os.str("");
+        }
+    }
+}
+
+static void
+benchPacketTags(uint32_t n)
+{
+    BenchHeader<14> ethernet;
+    BenchTag<1> tos;
+    BenchTag<4> flowId;
+    BenchTag<8> timestamp;
+    BenchTag<9> missing;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1000);
+        p->AddPacketTag(tos);
+        p->AddPacketTag(flowId);
+        p->AddPacketTag(timestamp);
+
+        /* Forward a copy of the packet over a few hops, looking up its tags */
+        for (uint32_t hop = 0; hop < 4; hop++)
+        {
+            p->AddHeader(ethernet);
+            p = p->Copy();
+            p->RemoveHeader(ethernet);
+            p->PeekPacketTag(missing);
+            p->PeekPacketTag(flowId);
+            p->ReplacePacketTag(tos);
+        }
+        p->RemovePacketTag(timestamp);
+        p->AddByteTag(flowId);
+    }
+}
+
 static void
 benchByteTags(uint32_t n)
 {
@@ -364,16 +464,27 @@ static void
 runBench(void (*bench)(uint32_t), uint32_t n, uint32_t minIterations, const char* name)
 {
     uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+    uint64_t copiedBytes = Buffer::GetCopiedBytes();
+    uint64_t tagAllocations = PacketTagList::GetAllocations() + ByteTagList::GetAllocations();
     for (uint32_t i = 0; i < minIterations; i++)
     {
         uint64_t delay = runBenchOneIteration(bench, n);
         minDelay = std::min(minDelay, delay);
     }
+    copiedBytes = Buffer::GetCopiedBytes() - copiedBytes;
+    tagAllocations =
+        PacketTagList::GetAllocations() + ByteTagList::GetAllocations() - tagAllocations;
     double ps = n;
     ps *= 1000;
     ps /= minDelay;
+    double copiedPerPacket = copiedBytes;
+    copiedPerPacket /= static_cast<double>(n) * minIterations;
+    double allocationsPerPacket = tagAllocations;
+    allocationsPerPacket /= static_cast<double>(n) * minIterations;
     std::cout << ps << " packets/s"
-              << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+              << " (" << minDelay << " ms elapsed, " << copiedPerPacket
+              << " bytes copied/packet, " << allocationsPerPacket << " tag allocations/packet)\t"
+              << name << std::endl;
 }
 
 int
@@ -382,6 +493,7 @@ main(int argc, char* argv[])
     uint32_t n = 0;
     uint32_t minIterations = 1;
     bool enablePrinting = false;
+    bool enableCompactPrinting = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark Packet class");
@@ -390,6 +502,9 @@ main(int argc, char* argv[])
                  "number of subiterations to minimize iteration time over",
                  minIterations);
     cmd.AddValue("enable-printing", "enable packet printing", enablePrinting);
+    cmd.AddValue("enable-compact-printing",
+                 "enable packet printing with compact metadata",
+                 enableCompactPrinting);
     cmd.Parse(argc, argv);
 
     if (n == 0)
@@ -398,7 +513,18 @@ main(int argc, char* argv[])
                   << "by command-line argument --n=(number of packets)" << std::endl;
         exit(1);
     }
-    std::cout << "Running bench-packets with n=" << n << std::endl;
+    if (enableCompactPrinting)
+    {
+        Packet::EnableCompactPrinting();
+    }
+    else if (enablePrinting)
+    {
+        Packet::EnablePrinting();
+    }
+
+    std::cout << "Running bench-packets with n=" << n << ", metadata "
+              << (enableCompactPrinting ? "compact" : (enablePrinting ? "enabled" : "disabled"))
+              << std::endl;
     std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
     runBench(&benchA, n, minIterations, "Copy packet, remove headers");
@@ -406,7 +532,15 @@ main(int argc, char* argv[])
     runBench(&benchC, n, minIterations, "Remove by func call");
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
+    runBench(&benchForward, n, minIterations, "Fragmentation and reassembly of copies");
+    runBench(&benchPrint, n, minIterations, "Forward over 4 hops, print 1% of the packets");
+    runBench(&benchPacketTags, n, minIterations, "Forward over 4 hops with packet tags");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
 
+    if (PacketPool::IsEnabled())
+    {
+        std::cout << "Packet pool: " << PacketPool::GetStats() << std::endl;
+    }
+
     return 0;
 }
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program compares the cost of an enqueue and a dequeue in a drop tail
+// queue storing its packets in a RingBuffer (the default container of Queue)
+// and in a std::list, for various numbers of packets 'backlog' in the queue.
+// Sample usage:  ./ns3 run 'bench-queue --backlog=1000 --n=1000000'
+
+#include "ns3/abort.h"
+#include "ns3/command-line.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/packet.h"
+#include "ns3/queue-size.h"
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+namespace ns3
+{
+
+/// Container of the queue to compare with
+typedef std::list<Ptr<Packet>> PacketList;
+
+NS_OBJECT_TEMPLATE_CLASS_TWO_DEFINE(Queue, Packet, PacketList);
+
+} // namespace ns3
+
+/**
+ * A drop tail queue storing its packets in a std::list, i.e., a
+ * DropTailQueue<Packet> before RingBuffer became the default container.
+ */
+class ListDropTailQueue : public Queue<Packet, PacketList>
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    bool Enqueue(Ptr<Packet> item) override;
+    Ptr<Packet> Dequeue() override;
+    Ptr<Packet> Remove() override;
+    Ptr<const Packet> Peek() const override;
+};
+
+TypeId
+ListDropTailQueue::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ListDropTailQueue")
+                            .SetParent<Queue<Packet, PacketList>>()
+                            .SetGroupName("Network")
+                            .AddConstructor<ListDropTailQueue>();
+    return tid;
+}
+
+bool
+ListDropTailQueue::Enqueue(Ptr<Packet> item)
+{
+    return DoEnqueue(GetContainer().end(), item);
+}
+
+Ptr<Packet>
+ListDropTailQueue::Dequeue()
+{
+    return DoDequeue(GetContainer().begin());
+}
+
+Ptr<Packet>
+ListDropTailQueue::Remove()
+{
+    return DoRemove(GetContainer().begin());
+}
+
+Ptr<const Packet>
+ListDropTailQueue::Peek() const
+{
+    return DoPeek(GetContainer().begin());
+}
+
+/**
+ * Time enqueues and dequeues in a queue holding a backlog of packets.
+ * \param queue the queue
+ * \param packets the packets to enqueue, at least backlog + 1
+ * \param backlog the number of packets in the queue before each enqueue
+ * \param n the number of enqueues and dequeues
+ * \return the time per enqueue and dequeue, in ns
+ */
+template <typename Q>
+double
+Bench(Ptr<Q> queue, const std::vector<Ptr<Packet>>& packets, uint32_t backlog, uint32_t n)
+{
+    queue->SetMaxSize(QueueSize(QueueSizeUnit::PACKETS, backlog + 1));
+    for (uint32_t i = 0; i < backlog; i++)
+    {
+        queue->Enqueue(packets[i]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t next = backlog;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        queue->Enqueue(packets[next]);
+        queue->Dequeue();
+        next = (next + 1 == packets.size() ? 0 : next + 1);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    NS_ABORT_MSG_IF(queue->GetNPackets() != backlog, "Unexpected number of packets");
+    queue->Dispose();
+    return std::chrono::duration<double>(end - start).count() * 1e9 / n;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 1000000;
+    uint32_t backlog = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark drop tail queues storing their packets in a RingBuffer and a std::list");
+    cmd.AddValue("n", "number of enqueues and dequeues", n);
+    cmd.AddValue("backlog",
+                 "number of packets in the queue (default: 1, 100, 1000 and 10000 in turn)",
+                 backlog);
+    cmd.Parse(argc, argv);
+
+    std::cout << "Running bench-queue with n=" << n << std::endl;
+
+    std::vector<uint32_t> backlogs{1, 100, 1000, 10000};
+    if (backlog > 0)
+    {
+        backlogs = {backlog};
+    }
+    for (uint32_t b : backlogs)
+    {
+        std::vector<Ptr<Packet>> packets;
+        for (uint32_t i = 0; i <= b; i++)
+        {
+            packets.push_back(Create<Packet>(1000));
+        }
+        double list = Bench(CreateObject<ListDropTailQueue>(), packets, b, n);
+        double ring = Bench(CreateObject<DropTailQueue<Packet>>(), packets, b, n);
+        std::cout << "backlog " << b << ":\t" << list << " ns std::list, " << ring
+                  << " ns RingBuffer (speedup " << list / ring << ")" << std::endl;
+    }
+    return 0;
+}
@@ -19,10 +19,13 @@
 
 #include "ns3/core-module.h"
 
+#include <atomic>
 #include <cmath> // sqrt
+#include <cstdlib> // malloc, free
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <new>
 #include <string.h>
 #include <vector>
 
@@ -47,6 +50,46 @@ std::string g_me;
 /** Output field width for numeric data. */
 int g_fwidth = 6;
 
+/** Number of heap allocations made so far by the whole program. */
+std::atomic<uint64_t> g_allocations{0};
+
+/**
+ * Replacement of the global allocation function, counting the allocations.
+ * \param [in] size The number of bytes to allocate.
+ * \returns The allocated memory.
+ */
+void*
+operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Replacement of the global deallocation function, matching operator new().
+ * \param [in] p The memory to release.
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Replacement of the global sized deallocation function, matching operator new().
+ * \param [in] p The memory to release.
+ */
+void
+operator delete(void* p, std::size_t /* size */) noexcept
+{
+    std::free(p);
+}
+
 /**
  *  Benchmark instance which can do a single run.
  *
@@ -103,10 +146,12 @@ class Bench
     /** The output. */
     struct Result
     {
-        double init;     /**< Time (s) for initialization. */
-        double simu;     /**< Time (s) for simulation. */
-        uint64_t pop;    /**< Event population. */
-        uint64_t events; /**< Number of events executed. */
+        double init;         /**< Time (s) for initialization. */
+        double simu;         /**< Time (s) for simulation. */
+        uint64_t pop;        /**< Event population. */
+        uint64_t events;     /**< Number of events executed. */
+        uint64_t initAllocs; /**< Heap allocations during initialization. */
+        uint64_t simuAllocs; /**< Heap allocations during simulation. */
     };
 
     /**
@@ -136,10 +181,13 @@ Bench::Run()
     SystemWallClockMs timer;
     double init;
     double simu;
+    uint64_t initAllocs;
+    uint64_t simuAllocs;
 
     DEB("initializing");
     m_count = 0;
 
+    uint64_t allocs = g_allocations.load(std::memory_order_relaxed);
     timer.Start();
     for (uint64_t i = 0; i < m_population; ++i)
     {
@@ -147,17 +195,20 @@ Bench::Run()
         Simulator::Schedule(at, &Bench::Cb, this);
     }
     init = timer.End() / 1000.0;
-    DEB("initialization took " << init << "s");
+    initAllocs = g_allocations.load(std::memory_order_relaxed) - allocs;
+    DEB("initialization took " << init << "s, " << initAllocs << " allocations");
 
     DEB("running");
+    allocs = g_allocations.load(std::memory_order_relaxed);
     timer.Start();
     Simulator::Run();
     simu = timer.End() / 1000.0;
-    DEB("run took " << simu << "s");
+    simuAllocs = g_allocations.load(std::memory_order_relaxed) - allocs;
+    DEB("run took " << simu << "s, " << simuAllocs << " allocations");
 
     Simulator::Destroy();
 
-    return Result{init, simu, m_population, m_count};
+    return Result{init, simu, m_population, m_count, initAllocs, simuAllocs};
 }
 
 void
@@ -214,6 +265,7 @@ class BenchSuite
         double time;   /**< Phase run time time (s). */
         double rate;   /**< Phase event rate (events/s). */
         double period; /**< Phase period (s/event). */
+        double allocs; /**< Phase heap allocations per event. */
     };
 
     /** Results from initialization and execution of a single run. */
@@ -248,8 +300,14 @@ class BenchSuite
 BenchSuite::Result
 BenchSuite::Result::Bench(Bench::Result r)
 {
-    return Result{{r.init, r.pop / r.init, r.init / r.pop},
-                  {r.simu, r.events / r.simu, r.simu / r.events}};
+    return Result{{r.init,
+                   r.pop / r.init,
+                   r.init / r.pop,
+                   static_cast<double>(r.initAllocs) / r.pop},
+                  {r.simu,
+                   r.events / r.simu,
+                   r.simu / r.events,
+                   static_cast<double>(r.simuAllocs) / r.events}};
 }
 
 template <typename T>
@@ -260,8 +318,9 @@ BenchSuite::Result::Log(T label) const
 
     LOG(std::left << std::setw(g_fwidth) << label << std::setw(g_fwidth) << init.time
                   << std::setw(g_fwidth) << init.rate << std::setw(g_fwidth) << init.period
-                  << std::setw(g_fwidth) << run.time << std::setw(g_fwidth) << run.rate
-                  << std::setw(g_fwidth) << run.period);
+                  << std::setw(g_fwidth) << init.allocs << std::setw(g_fwidth) << run.time
+                  << std::setw(g_fwidth) << run.rate << std::setw(g_fwidth) << run.period
+                  << std::setw(g_fwidth) << run.allocs);
 }
 
 BenchSuite::BenchSuite(ObjectFactory& factory,
@@ -299,6 +358,8 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     // Perform the actual runs
     for (uint64_t i = 0; i < runs; i++)
     {
+        // Simulator::Destroy() at the end of the previous run reset the scheduler
+        Simulator::SetScheduler(factory);
         auto run = bench.Run();
         m_results.push_back(Result::Bench(run));
         m_results.back().Log(i);
@@ -314,18 +375,21 @@ BenchSuite::Header() const
     // table header
     LOG("");
     LOG(m_scheduler);
-    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(3 * g_fwidth)
+    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(4 * g_fwidth)
                   << "Initialization:" << std::left << "Simulation:");
     LOG(std::left << std::setw(g_fwidth) << "" << std::left << std::setw(g_fwidth) << "Time (s)"
                   << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
                   << std::setw(g_fwidth) << "Per (s/ev)" << std::left << std::setw(g_fwidth)
-                  << "Time (s)" << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
-                  << "Per (s/ev)");
+                  << "Allocs/ev" << std::left << std::setw(g_fwidth) << "Time (s)" << std::left
+                  << std::setw(g_fwidth) << "Rate (ev/s)" << std::left << std::setw(g_fwidth)
+                  << "Per (s/ev)" << std::left << "Allocs/ev");
     LOG(std::setfill('-') << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
                           << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
-                          << std::right << std::setw(g_fwidth) << " " << std::setfill(' '));
+                          << std::right << std::setw(g_fwidth) << " " << std::right
+                          << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
+                          << std::setfill(' '));
 }
 
 void
@@ -345,8 +409,8 @@ BenchSuite::Log() const
 
     uint64_t n{0};                // number of samples
     Result average{m_results[0]}; // average
-    Result moment2{{0, 0, 0},     // 2nd moment, to calculate stdev
-                   {0, 0, 0}};
+    Result moment2{{0, 0, 0, 0},  // 2nd moment, to calculate stdev
+                   {0, 0, 0, 0}};
 
     for (; n < m_results.size(); ++n)
     {
@@ -364,9 +428,11 @@ BenchSuite::Log() const
         ACCUMULATE(init, time);
         ACCUMULATE(init, rate);
         ACCUMULATE(init, period);
+        ACCUMULATE(init, allocs);
         ACCUMULATE(run, time);
         ACCUMULATE(run, rate);
         ACCUMULATE(run, period);
+        ACCUMULATE(run, allocs);
 
 #undef ACCUMULATE
     }
@@ -374,10 +440,12 @@ BenchSuite::Log() const
     auto stdev = Result{
         {std::sqrt(moment2.init.time / n),
          std::sqrt(moment2.init.rate / n),
-         std::sqrt(moment2.init.period / n)},
+         std::sqrt(moment2.init.period / n),
+         std::sqrt(moment2.init.allocs / n)},
         {std::sqrt(moment2.run.time / n),
          std::sqrt(moment2.run.rate / n),
-         std::sqrt(moment2.run.period / n)},
+         std::sqrt(moment2.run.period / n),
+         std::sqrt(moment2.run.allocs / n)},
     };
 
     average.Log("average");
@@ -390,21 +458,53 @@ BenchSuite::Log() const
 /**
  *  Create a RandomVariableStream to generate next event delays.
  *
- *  If the \p filename parameter is empty a default exponential time
- *  distribution will be used, with mean delay of 100 ns.
+ *  If the \p filename parameter is empty the \p dist distribution will
+ *  be used:
+ *    - `exp`, an exponential time distribution with mean delay of 100 ns;
+ *    - `clustered`, a mix of delays typical of wireless and TCP models:
+ *      60% wifi slot timers (multiples of 9 us, up to 15 slots),
+ *      30% frame durations (uniform between 1 us and 100 us),
+ *      10% retransmission timeouts (uniform between 200 ms and 1 s).
  *
  *  If the \p filename is `-` standard input will be used.
  *
  *  \param [in] filename The delay interval source file name.
+ *  \param [in] dist The name of the generated distribution.
  *  \returns The RandomVariableStream.
  */
 Ptr<RandomVariableStream>
-GetRandomStream(std::string filename)
+GetRandomStream(std::string filename, std::string dist)
 {
     Ptr<RandomVariableStream> stream = nullptr;
 
-    if (filename.empty())
+    if (filename.empty() && dist == "clustered")
     {
+        LOG("  Event time distribution:      clustered (slots, frames, timeouts)");
+        auto urv = CreateObject<UniformRandomVariable>();
+        std::vector<double> nsValues(1000000);
+        for (auto& ns : nsValues)
+        {
+            double kind = urv->GetValue();
+            if (kind < 0.6)
+            {
+                ns = urv->GetInteger(0, 15) * 9000.0;
+            }
+            else if (kind < 0.9)
+            {
+                ns = urv->GetInteger(1000, 100000);
+            }
+            else
+            {
+                ns = urv->GetInteger(200000000, 1000000000);
+            }
+        }
+        auto drv = CreateObject<DeterministicRandomVariable>();
+        drv->SetValueArray(nsValues);
+        stream = drv;
+    }
+    else if (filename.empty())
+    {
+        NS_ABORT_MSG_UNLESS(dist == "exp", "Unknown event time distribution " << dist);
         LOG("  Event time distribution:      default exponential");
         auto erv = CreateObject<ExponentialRandomVariable>();
         erv->SetAttribute("Mean", DoubleValue(100));
@@ -457,6 +557,7 @@ main(int argc, char* argv[])
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -465,6 +566,7 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    std::string dist = "exp";
     bool calRev = false;
 
     CommandLine cmd(__FILE__);
@@ -472,6 +574,7 @@ main(int argc, char* argv[])
               "\n"
               "Event intervals are taken from one of:\n"
               "  an exponential distribution, with mean 100 ns,\n"
+              "  a clustered mix of slot, frame and timeout delays, by --dist=clustered,\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
@@ -482,6 +585,7 @@ main(int argc, char* argv[])
     cmd.AddValue("cal", "use CalendarScheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListScheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -490,6 +594,7 @@ main(int argc, char* argv[])
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
+    cmd.AddValue("dist", "event time distribution: exp or clustered", dist);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
 
@@ -505,15 +610,15 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = GetRandomStream(filename, dist);
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
@@ -532,6 +637,11 @@ main(int argc, char* argv[])
         factory.SetTypeId("ns3::HeapScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
     if (schedList)
     {
         factory.SetTypeId("ns3::ListScheduler");
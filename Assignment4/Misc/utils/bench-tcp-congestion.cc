@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2024
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program compares the cost per ACK of the congestion controls when
+// called through the per-ACK virtual interface of TcpCongestionOps, and when
+// run in batches by a TcpCongestionEngine, for many connections.
+// Sample usage:  ./ns3 run 'bench-tcp-congestion --connections=10000 --cc=TcpCubic'
+
+#include "ns3/command-line.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-congestion-engine.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-cubic.h"
+#include "ns3/tcp-socket-state.h"
+#include "ns3/tcpOjus.h"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/// A connection, with a congestion control and its state
+struct Connection
+{
+    Ptr<TcpCongestionOps> cong; //!< Congestion control
+    Ptr<TcpSocketState> tcb;    //!< Congestion state
+};
+
+/// Benchmark of the congestion controls of many connections
+class Bench
+{
+  public:
+    /**
+     * Constructor.
+     * \param cc The congestion control of the connections, or "mixed".
+     * \param connections The number of connections.
+     * \param rounds The number of rounds of ACKs, one per millisecond.
+     */
+    Bench(const std::string& cc, uint32_t connections, uint32_t rounds);
+
+    /**
+     * Run the benchmark and print the results.
+     * \return Whether both interfaces gave the same windows.
+     */
+    bool Run();
+
+  private:
+    /**
+     * Create a congestion control.
+     * \param i The index of the connection.
+     * \return The congestion control.
+     */
+    Ptr<TcpCongestionOps> CreateCongestionOps(uint32_t i) const;
+
+    /**
+     * Give a round of ACKs to both sets of connections.
+     * \param round The index of the round.
+     */
+    void Round(uint32_t round);
+
+    std::string m_cc;                  //!< Congestion control of the connections
+    uint32_t m_rounds;                 //!< Number of rounds
+    std::vector<Connection> m_perAck;  //!< Connections updated per ACK
+    std::vector<Connection> m_batched; //!< Connections updated by the engine
+    TcpCongestionEngine m_engine;      //!< The engine
+    std::vector<uint32_t> m_acked;     //!< Segments acked by the round, per connection
+    std::vector<Time> m_rtt;           //!< RTT samples of the round, per connection
+    double m_perAckTime{0};            //!< Time spent in the per-ACK interface, in s
+    double m_batchedTime{0};           //!< Time spent in the engine, in s
+    bool m_same{true};                 //!< Whether both interfaces gave the same windows
+};
+
+Bench::Bench(const std::string& cc, uint32_t connections, uint32_t rounds)
+    : m_cc(cc),
+      m_rounds(rounds)
+{
+    for (uint32_t i = 0; i < connections; i++)
+    {
+        for (auto set : {&m_perAck, &m_batched})
+        {
+            Connection connection{CreateCongestionOps(i), CreateObject<TcpSocketState>()};
+            connection.tcb->m_segmentSize = 1448;
+            connection.tcb->m_cWnd = 10 * 1448;
+            connection.tcb->m_ssThresh = std::numeric_limits<uint32_t>::max();
+            connection.tcb->m_isCwndLimited = true;
+            connection.cong->Init(connection.tcb);
+            set->push_back(connection);
+        }
+    }
+    m_acked.resize(connections);
+    m_rtt.resize(connections);
+}
+
+Ptr<TcpCongestionOps>
+Bench::CreateCongestionOps(uint32_t i) const
+{
+    std::string cc = m_cc;
+    if (cc == "mixed")
+    {
+        const char* names[] = {"TcpCubic", "TcpOjus", "TcpNewReno"};
+        cc = names[i % 3];
+    }
+    if (cc == "TcpCubic")
+    {
+        return CreateObject<TcpCubic>();
+    }
+    if (cc == "TcpOjus")
+    {
+        return CreateObject<TcpOjus>();
+    }
+    return CreateObject<TcpNewReno>();
+}
+
+void
+Bench::Round(uint32_t round)
+{
+    for (uint32_t i = 0; i < m_perAck.size(); i++)
+    {
+        m_acked[i] = 1 + (i + round) % 2;
+        m_rtt[i] = MilliSeconds(20 + i % 50) + MicroSeconds((round * 37 + i * 101) % 1000);
+        for (auto set : {&m_perAck, &m_batched})
+        {
+            Ptr<TcpSocketState> tcb = (*set)[i].tcb;
+            tcb->m_lastAckedSeq += m_acked[i] * tcb->m_segmentSize;
+            tcb->m_highTxMark = tcb->m_lastAckedSeq + tcb->m_cWnd;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < m_perAck.size(); i++)
+    {
+        const Connection& connection = m_perAck[i];
+        connection.cong->PktsAcked(connection.tcb, m_acked[i], m_rtt[i]);
+        connection.cong->IncreaseWindow(connection.tcb, m_acked[i]);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < m_batched.size(); i++)
+    {
+        m_engine.Add(m_batched[i].cong, m_batched[i].tcb, m_acked[i], m_rtt[i]);
+    }
+    m_engine.Process();
+    auto end = std::chrono::steady_clock::now();
+    m_perAckTime += std::chrono::duration<double>(middle - start).count();
+    m_batchedTime += std::chrono::duration<double>(end - middle).count();
+
+    for (uint32_t i = 0; i < m_perAck.size(); i++)
+    {
+        Ptr<TcpSocketState> perAck = m_perAck[i].tcb;
+        Ptr<TcpSocketState> batched = m_batched[i].tcb;
+        m_same = m_same && perAck->m_cWnd == batched->m_cWnd &&
+                 perAck->m_ssThresh == batched->m_ssThresh;
+        // A loss on each connection every 500 rounds keeps the windows realistic
+        if ((round + i) % 500 == 0)
+        {
+            for (auto set : {&m_perAck, &m_batched})
+            {
+                const Connection& connection = (*set)[i];
+                Ptr<TcpSocketState> tcb = connection.tcb;
+                connection.cong->CongestionStateSet(tcb, TcpSocketState::CA_LOSS);
+                tcb->m_ssThresh = connection.cong->GetSsThresh(tcb, tcb->m_cWnd);
+                tcb->m_cWnd = tcb->m_ssThresh;
+            }
+        }
+    }
+
+    if (round + 1 < m_rounds)
+    {
+        Simulator::Schedule(MilliSeconds(1), &Bench::Round, this, round + 1);
+    }
+}
+
+bool
+Bench::Run()
+{
+    Simulator::Schedule(MilliSeconds(1), &Bench::Round, this, 0);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    double acks = static_cast<double>(m_perAck.size()) * m_rounds;
+    std::cout << m_perAckTime * 1e9 / acks << " ns/ACK per ACK, " << m_batchedTime * 1e9 / acks
+              << " ns/ACK batched (speedup " << m_perAckTime / m_batchedTime << ")\t" << m_cc
+              << (m_same ? "" : " (RESULTS DIFFER)") << std::endl;
+    return m_same;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t connections = 10000;
+    uint32_t rounds = 1000;
+    std::string cc;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the per-ACK and batched interfaces of the congestion controls");
+    cmd.AddValue("connections", "number of connections", connections);
+    cmd.AddValue("rounds", "number of rounds of ACKs, one ACK per connection each", rounds);
+    cmd.AddValue("cc", "TcpCubic, TcpOjus, TcpNewReno or mixed (default: all in turn)", cc);
+    cmd.Parse(argc, argv);
+
+    std::cout << "Running bench-tcp-congestion with " << connections << " connections, "
+              << rounds << " rounds" << std::endl;
+
+    bool same = true;
+    for (const std::string& name : {"TcpCubic", "TcpOjus", "TcpNewReno", "mixed"})
+    {
+        if (cc.empty() || cc == name)
+        {
+            same = Bench(name, connections, rounds).Run() && same;
+        }
+    }
+    return same ? 0 : 1;
+}